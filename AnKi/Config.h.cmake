@@ -148,11 +148,18 @@
 #if ${_ANKI_GR_BACKEND} == 0
 #	define ANKI_GR_BACKEND_VULKAN 1
 #	define ANKI_GR_BACKEND_DIRECT3D 0
+#	define ANKI_GR_BACKEND_NULL 0
 #	define ANKI_GR_BACKEND_STR "Vulkan"
-#else
+#elif ${_ANKI_GR_BACKEND} == 1
 #	define ANKI_GR_BACKEND_VULKAN 0
 #	define ANKI_GR_BACKEND_DIRECT3D 1
+#	define ANKI_GR_BACKEND_NULL 0
 #	define ANKI_GR_BACKEND_STR "D3D"
+#else
+#	define ANKI_GR_BACKEND_VULKAN 0
+#	define ANKI_GR_BACKEND_DIRECT3D 0
+#	define ANKI_GR_BACKEND_NULL 1
+#	define ANKI_GR_BACKEND_STR "Null"
 #endif
 
 // Windowing system
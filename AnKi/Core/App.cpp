@@ -35,6 +35,7 @@
 #include <AnKi/Ui/UiCanvas.h>
 #include <AnKi/Scene/DeveloperConsoleUiNode.h>
 #include <AnKi/Resource/ScriptResource.h>
+#include <AnKi/Resource/ShaderVariantWarmup.h>
 
 #if ANKI_OS_ANDROID
 #	include <android_native_app_glue.h>
@@ -161,6 +162,11 @@ void App::cleanup()
 	Renderer::freeSingleton();
 	UiManager::freeSingleton();
 	GpuSceneMicroPatcher::freeSingleton();
+	if(ShaderVariantWarmup::isAllocated() && ShaderVariantWarmup::getSingleton().writeManifest())
+	{
+		ANKI_CORE_LOGE("Failed to write the shader variant manifest");
+	}
+	ShaderVariantWarmup::freeSingleton();
 	ResourceManager::freeSingleton();
 	PhysicsWorld::freeSingleton();
 	RebarTransientMemoryPool::freeSingleton();
@@ -182,6 +188,9 @@ void App::cleanup()
 
 	GlobalFrameIndex::freeSingleton();
 
+	// Some handlers might not outlive the app
+	Logger::getSingleton().stopAsync();
+
 	m_settingsDir.destroy();
 	m_cacheDir.destroy();
 	m_appName.destroy();
@@ -300,6 +309,7 @@ Error App::init()
 #endif
 
 	ANKI_CHECK(ResourceManager::allocateSingleton().init(m_allocCallback, m_allocUserData));
+	ANKI_CHECK(ShaderVariantWarmup::allocateSingleton().init(m_cacheDir.toCString()));
 
 	//
 	// UI
@@ -320,6 +330,10 @@ Error App::init()
 	renderInit.m_allocCallbackUserData = m_allocUserData;
 	ANKI_CHECK(Renderer::allocateSingleton().init(renderInit));
 
+	// Now that the renderer has created its own variants pre-create the ones the previous sessions used. There is no loading screen so it runs in
+	// the background
+	ShaderVariantWarmup::getSingleton().startWarmup();
+
 	//
 	// Script
 	//
@@ -402,6 +416,10 @@ Error App::mainLoop()
 	}
 
 	Logger::getSingleton().enableVerbosity(g_cvarCoreVerboseLog);
+	if(g_cvarCoreAsyncLog)
+	{
+		Logger::getSingleton().startAsync();
+	}
 
 	ANKI_CORE_LOGV("CVar values before initializing the subsystems");
 	CVarSet::getSingleton().iterateCVars([](CVar& cvar) {
@@ -433,7 +451,9 @@ Error App::mainLoop()
 
 	// Continue with the main loop
 	ANKI_CORE_LOGI("Entering main loop");
+	ShaderVariantWarmup::getSingleton().startGameplay();
 	Bool quit = false;
+	U32 frameCount = 0;
 
 	Second prevUpdateTime = HighRezTimer::getCurrentTime();
 
@@ -450,14 +470,33 @@ Error App::mainLoop()
 
 		GrManager::getSingleton().beginFrame();
 
+		// The user code might touch the physics so finish the physics of a pipelined frame first
+		SceneGraph::getSingleton().waitPhysicsUpdate();
+
 		GpuSceneMicroPatcher::getSingleton().beginPatching();
 		Bool userQuit = false;
 		ANKI_CHECK(userMainLoop(userQuit, crntTime - prevUpdateTime));
 		quit = quit || userQuit;
 
+		if(g_cvarCoreExitAfterFrameCount > 0 && ++frameCount >= g_cvarCoreExitAfterFrameCount)
+		{
+			quit = true;
+		}
+
 		SceneGraph::getSingleton().update(prevUpdateTime, crntTime);
 		GpuSceneMicroPatcher::getSingleton().endPatching();
 
+		// No scripts run until the next frame's update so it's a good time to collect some garbage
+		ScriptManager::getSingleton().collectGarbage();
+
+		// Overlap the physics of the next frame with the rendering of this one. The renderer doesn't touch the physics so there is no need for a
+		// snapshot. Use the time step of this frame since the next one is not known yet. The step runs before the next userMainLoop() so the
+		// input of the next frame reaches the physics a frame later
+		if(g_cvarCoreAsyncPhysics)
+		{
+			SceneGraph::getSingleton().startPhysicsUpdate(crntTime - prevUpdateTime);
+		}
+
 		FencePtr renderFence;
 		ANKI_CHECK(Renderer::getSingleton().render(renderFence, prevUpdateTime, crntTime));
 
@@ -19,8 +19,12 @@ ANKI_CVAR(NumericCVar<U32>, Core, JobThreadCount, clamp(getCpuCoresCount() / 2u,
 ANKI_CVAR(NumericCVar<U32>, Core, DisplayStats, 0, 0, 2, "Display stats, 0: None, 1: Simple, 2: Detailed")
 ANKI_CVAR(BoolCVar, Core, ClearCaches, false, "Clear all caches")
 ANKI_CVAR(BoolCVar, Core, VerboseLog, false, "Verbose logging")
+ANKI_CVAR(BoolCVar, Core, AsyncLog, true, "Pass the log messages to the log handlers from a dedicated thread")
 ANKI_CVAR(BoolCVar, Core, MeshletRendering, false, "Do meshlet culling and rendering")
 ANKI_CVAR(StringCVar, Core, StartupScene, "", "Load this scene at startup")
+ANKI_CVAR(NumericCVar<U32>, Core, ExitAfterFrameCount, 0, 0, kMaxU32, "Quit after that many frames. 0 never quits. For benchmarks and CI")
+ANKI_CVAR(BoolCVar, Core, AsyncPhysics, false,
+		  "Simulate the physics of the next frame while the renderer works on the current one. The physics see the input one frame later")
 #if ANKI_WITH_EDITOR
 ANKI_CVAR(BoolCVar, Core, ShowEditor, false, "Show the editor")
 #endif
@@ -189,6 +189,15 @@ Error CoreTracer::writeEvents(ThreadWorkItem& item)
 		const I64 startMicroSec = I64(event.m_start * 1000000.0);
 		const I64 durMicroSec = I64(event.m_duration * 1000000.0);
 
+		if(event.m_flowId)
+		{
+			// It's a dependency arrow, bind it to the enclosing event
+			ANKI_CHECK(m_traceJsonFile.writeTextf("{\"name\": \"%s\", \"cat\": \"FLOW\", \"ph\": \"%s\", \"bp\": \"e\", \"id\": %" PRIu64 ", "
+												  "\"pid\": 1, \"tid\": %" PRIu64 ", \"ts\": %" PRIi64 "},\n",
+												  event.m_name.cstr(), (event.m_flowBegin) ? "s" : "f", event.m_flowId, item.m_tid, startMicroSec));
+			continue;
+		}
+
 		// Do a hack
 		const ThreadId tid = (event.m_name == "GpuFrameTime") ? 1 : item.m_tid;
 
@@ -74,6 +74,29 @@ private:
 	void updateStats() const;
 };
 
+// A copy to the GPU scene as requested by GpuSceneMicroPatcher::newCopy().
+class GpuSceneCopy
+{
+public:
+	U32 m_dstDwordOffset;
+	U32 m_dwordCount;
+	const U32* m_srcData;
+	U32 m_order; // The global order of the newCopy() call. Copies that write the same memory are applied in that order
+};
+
+// A contiguous range of the GPU scene that is the result of merging copies.
+class GpuSceneCopyRange
+{
+public:
+	U32 m_dstDwordOffset;
+	U32 m_dwordCount;
+	U32 m_srcDwordOffset; // Offset in the merged data
+};
+
+// Merge the copies that touch or overlap into ranges and append the ranges and their data to the arrays. The copies are sorted in place.
+void mergeGpuSceneCopies(WeakArray<GpuSceneCopy> copies, DynamicArray<GpuSceneCopyRange, MemoryPoolPtrWrapper<StackMemoryPool>>& ranges,
+						 DynamicArray<U32, MemoryPoolPtrWrapper<StackMemoryPool>>& rangeData);
+
 // Creates the copy jobs that will patch the GPU Scene.
 class GpuSceneMicroPatcher : public MakeSingleton<GpuSceneMicroPatcher>
 {
@@ -92,7 +115,8 @@ public:
 	void beginPatching();
 
 	// 2nd thing to call
-	// Copy data for the GPU scene to a staging buffer.
+	// Copy data for the GPU scene to a staging buffer. Every thread writes to its own stream, only a global ticket that orders the copies is
+	// shared.
 	// Note: It's thread-safe against other newCopy()
 	void newCopy(PtrSize gpuSceneDestOffset, PtrSize dataSize, const void* data);
 
@@ -118,12 +142,11 @@ public:
 		newCopy(dest.getOffset(), sizeof(value), &value);
 	}
 
-	// 3rd thing to call after all newCopy() calls have be done
+	// 3rd thing to call after all newCopy() calls have be done. It merges the streams of all threads. Copies to the same or adjacent GPU scene
+	// ranges are coalesced. If two copies write the same memory the one whose newCopy() call took the later ticket wins. If the calls run
+	// concurrently on different threads which one that is, is not defined.
 	// Note: Not thread-safe
-	void endPatching()
-	{
-		ANKI_ASSERT(m_bPatchingMode.fetchSub(1) == 1);
-	}
+	void endPatching();
 
 	// 4th optional thing to call. Check if there is a need to call patchGpuScene or if no copies are needed
 	// Note: Not thread-safe
@@ -141,17 +164,40 @@ private:
 	static constexpr U32 kDwordsPerPatch = 64; // If you change this change the bellow as well
 	static constexpr U32 kDwordsPerPatchBitCount = 6;
 
+	// The initial capacity of the per-thread streams. After the 1st frame they reserve what they used in the previous one
+	static constexpr U32 kInitialThreadCopyCapacity = 128;
+	static constexpr U32 kInitialThreadDwordCapacity = 4 * 1024;
+
 	class PatchHeader;
+	class Copy;
+	class ThreadLocal;
+
+	// Per-thread pointer to the ThreadLocal. The generation detects the ThreadLocals of a previous GpuSceneMicroPatcher
+	class ThreadLocalRef
+	{
+	public:
+		ThreadLocal* m_threadLocal = nullptr;
+		U32 m_generation = 0;
+	};
+
+	static thread_local ThreadLocalRef m_threadLocalRef;
 
 	DynamicArray<PatchHeader, MemoryPoolPtrWrapper<StackMemoryPool>> m_crntFramePatchHeaders;
 	DynamicArray<U32, MemoryPoolPtrWrapper<StackMemoryPool>> m_crntFramePatchData;
-	Mutex m_mtx;
+
+	DynamicArray<ThreadLocal*> m_threadLocals;
+	Mutex m_threadLocalsMtx;
+	U32 m_generation = 0;
+
+	Atomic<U32> m_copyTicket = {0};
 
 	ShaderProgramResourcePtr m_copyProgram;
 	ShaderProgramPtr m_grProgram;
 
 	StackMemoryPool m_stackMemPool;
 
+	ThreadLocal& getThreadLocal();
+
 #if ANKI_ASSERTIONS_ENABLED
 	Atomic<U32> m_bPatchingMode = {0};
 #endif
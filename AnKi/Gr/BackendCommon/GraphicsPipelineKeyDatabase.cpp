@@ -0,0 +1,121 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/BackendCommon/GraphicsPipelineKeyDatabase.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Filesystem.h>
+
+namespace anki {
+
+// If the layout of GraphicsStateTracker::StaticState changes bump the version
+static constexpr U32 kPipelineKeysMagic = 0x4F535041; // "APSO"
+static constexpr U32 kPipelineKeysVersion = 1;
+
+Error GraphicsPipelineKeyDatabase::load(CString filename)
+{
+	if(!fileExists(filename))
+	{
+		ANKI_GR_LOGI("PSO keys not found: %s", filename.cstr());
+		return Error::kNone;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::kBinary | FileOpenFlag::kRead));
+
+	constexpr PtrSize kRecordSize = sizeof(U64) + sizeof(StaticState);
+	Array<U32, 4> header; // Magic, version, size of StaticState, key count
+	if(file.getSize() < sizeof(header))
+	{
+		ANKI_GR_LOGI("PSO keys file is corrupted. Will ignore: %s", filename.cstr());
+		return Error::kNone;
+	}
+
+	ANKI_CHECK(file.read(&header[0], sizeof(header)));
+	if(header[0] != kPipelineKeysMagic || header[1] != kPipelineKeysVersion || header[2] != sizeof(StaticState)
+	   || file.getSize() != sizeof(header) + header[3] * kRecordSize)
+	{
+		ANKI_GR_LOGI("PSO keys file is not compatible. Will ignore: %s", filename.cstr());
+		return Error::kNone;
+	}
+
+	LockGuard lock(m_mtx);
+
+	m_keys.resizeStorage(m_keys.getSize() + header[3]);
+	for(U32 i = 0; i < header[3]; ++i)
+	{
+		Key key;
+		ANKI_CHECK(file.read(&key.m_programHash, sizeof(key.m_programHash)));
+		ANKI_CHECK(file.read(&key.m_state, sizeof(key.m_state)));
+		addKey(key.m_programHash, key.m_state);
+	}
+
+	ANKI_GR_LOGI("Loaded %u PSO keys", m_keys.getSize());
+	return Error::kNone;
+}
+
+Error GraphicsPipelineKeyDatabase::store(CString filename) const
+{
+	LockGuard lock(m_mtx);
+
+	if(m_keys.getSize() == 0)
+	{
+		return Error::kNone;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::kBinary | FileOpenFlag::kWrite));
+
+	const Array<U32, 4> header = {kPipelineKeysMagic, kPipelineKeysVersion, sizeof(StaticState), m_keys.getSize()};
+	ANKI_CHECK(file.write(&header[0], sizeof(header)));
+
+	for(const Key& key : m_keys)
+	{
+		ANKI_CHECK(file.write(&key.m_programHash, sizeof(key.m_programHash)));
+		ANKI_CHECK(file.write(&key.m_state, sizeof(key.m_state)));
+	}
+
+	ANKI_GR_LOGI("Stored %u PSO keys", m_keys.getSize());
+	return Error::kNone;
+}
+
+void GraphicsPipelineKeyDatabase::recordKey(U64 programHash, const GraphicsStateTracker& state)
+{
+	LockGuard lock(m_mtx);
+	addKey(programHash, state.m_staticState);
+}
+
+void GraphicsPipelineKeyDatabase::getKeys(U64 programHash, GrDynamicArray<StaticState>& states) const
+{
+	LockGuard lock(m_mtx);
+
+	for(const Key& key : m_keys)
+	{
+		if(key.m_programHash == programHash)
+		{
+			states.emplaceBack(key.m_state);
+		}
+	}
+}
+
+void GraphicsPipelineKeyDatabase::addKey(U64 programHash, const StaticState& staticState)
+{
+	// Compute the persistent hash. Setting the program hash beforehand stops updateHashes() from touching the program
+	GraphicsStateTracker state;
+	state.m_staticState = staticState;
+	state.m_staticState.m_shaderProg = nullptr;
+	state.m_hashes.m_shaderProg = programHash;
+	state.updateHashes();
+
+	if(m_keyIndices.find(state.m_globalHash) == m_keyIndices.getEnd())
+	{
+		m_keyIndices.emplace(state.m_globalHash, m_keys.getSize());
+
+		Key& key = *m_keys.emplaceBack();
+		key.m_programHash = programHash;
+		key.m_state = state.m_staticState;
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,65 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/BackendCommon/GraphicsStateTracker.h>
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/Thread.h>
+
+namespace anki {
+
+/// @addtogroup graphics
+/// @{
+
+/// A database of the static state of graphics PSOs. It's stored on disk so the PSOs of the previous sessions can be pre-created. Programs are
+/// identified by a hash that stays the same across sessions (their UUIDs don't).
+class GraphicsPipelineKeyDatabase
+{
+public:
+	using StaticState = GraphicsStateTracker::StaticState;
+
+	GraphicsPipelineKeyDatabase() = default;
+
+	GraphicsPipelineKeyDatabase(const GraphicsPipelineKeyDatabase&) = delete; // Non-copyable
+
+	GraphicsPipelineKeyDatabase& operator=(const GraphicsPipelineKeyDatabase&) = delete; // Non-copyable
+
+	/// Load the keys of a file. Missing, corrupted and incompatible files are ignored.
+	Error load(CString filename);
+
+	/// Write all the keys to a file.
+	Error store(CString filename) const;
+
+	/// Remember the static state of a PSO. Thread-safe.
+	/// @param programHash The persistent hash of the program.
+	void recordKey(U64 programHash, const GraphicsStateTracker& state);
+
+	/// Get the static state of all the PSOs of a program. The shader program of the states is null. Thread-safe.
+	void getKeys(U64 programHash, GrDynamicArray<StaticState>& states) const;
+
+	U32 getKeyCount() const
+	{
+		LockGuard lock(m_mtx);
+		return m_keys.getSize();
+	}
+
+private:
+	class Key
+	{
+	public:
+		U64 m_programHash;
+		StaticState m_state; ///< The m_shaderProg is always null.
+	};
+
+	GrDynamicArray<Key> m_keys;
+	GrHashMap<U64, U32> m_keyIndices; ///< Persistent PSO hash to index in m_keys.
+	mutable Mutex m_mtx;
+
+	void addKey(U64 programHash, const StaticState& staticState);
+};
+/// @}
+
+} // end namespace anki
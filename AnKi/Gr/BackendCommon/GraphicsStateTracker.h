@@ -17,6 +17,7 @@ namespace anki {
 class GraphicsStateTracker
 {
 	friend class GraphicsPipelineFactory;
+	friend class GraphicsPipelineKeyDatabase;
 
 public:
 	void bindVertexBuffer(U32 binding, VertexStepRate stepRate
@@ -354,7 +355,7 @@ public:
 		{
 			m_staticState.m_ia.m_topology = topology;
 			m_hashes.m_ia = 0;
-#if ANKI_GR_BACKEND_DIRECT3D
+#if !ANKI_GR_BACKEND_VULKAN
 			m_dynState.m_topologyDirty = true;
 #endif
 		}
@@ -510,7 +511,7 @@ private:
 				StencilOperation m_stencilPassDepthFail = StencilOperation::kKeep;
 				StencilOperation m_stencilPassDepthPass = StencilOperation::kKeep;
 				CompareOperation m_compare = CompareOperation::kAlways;
-#if ANKI_GR_BACKEND_DIRECT3D
+#if !ANKI_GR_BACKEND_VULKAN
 				U32 m_compareMask = 0x5A5A5A5A; ///< Use a stupid number to initialize.
 				U32 m_writeMask = 0x5A5A5A5A; ///< Use a stupid number to initialize.
 #endif
@@ -56,7 +56,7 @@ ANKI_CVAR(NumericCVar<U16>, Gr, MaxGpuCbvSrvUavDescriptors, 16 * 1024, 8, kMaxU1
 ANKI_CVAR(NumericCVar<U16>, Gr, MaxGpuSamplerDescriptors, 2 * 1024, 8, kMaxU16, "Max number of sampler descriptors")
 
 ANKI_CVAR(BoolCVar, Gr, Dred, false, "Enable DRED")
-#else
+#elif ANKI_GR_BACKEND_VULKAN
 ANKI_CVAR(NumericCVar<PtrSize>, Gr, DiskShaderCacheMaxSize, 128_MB, 1_MB, 1_GB, "Max size of the pipeline cache file")
 ANKI_CVAR(BoolCVar, Gr, DebugPrintf, false, "Enable or not debug printf")
 ANKI_CVAR(BoolCVar, Gr, SamplerFilterMinMax, true, "Enable or not min/max sample filtering")
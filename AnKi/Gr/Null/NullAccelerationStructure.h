@@ -0,0 +1,33 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/AccelerationStructure.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// AccelerationStructure implementation. It has no memory, it only reserves a GPU address range.
+class AccelerationStructureImpl final : public AccelerationStructure
+{
+	friend class AccelerationStructure;
+
+public:
+	AccelerationStructureImpl(CString name, U32 uuid)
+		: AccelerationStructure(name, uuid)
+	{
+	}
+
+	Error init(const AccelerationStructureInitInfo& inf);
+
+	// A rough estimate of what a driver would ask for.
+	static void getMemoryRequirement(const AccelerationStructureInitInfo& init, PtrSize& asBufferSize, PtrSize& buildScratchBufferSize);
+
+private:
+	U64 m_gpuAddress = 0;
+};
+
+} // end namespace anki
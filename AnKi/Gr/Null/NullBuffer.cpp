@@ -0,0 +1,99 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullBuffer.h>
+#include <AnKi/Gr/Null/NullGrManager.h>
+
+namespace anki {
+
+Buffer* Buffer::newInstance(const BufferInitInfo& init, U32 uuid)
+{
+	BufferImpl* impl = anki::newInstance<BufferImpl>(GrMemoryPool::getSingleton(), init.getName(), uuid);
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+void* Buffer::map(PtrSize offset, PtrSize range)
+{
+	ANKI_NULL_SELF(BufferImpl);
+
+	ANKI_ASSERT(!!m_access);
+	ANKI_ASSERT(!self.m_mapped);
+	ANKI_ASSERT(offset < m_size);
+	if(range == kMaxPtrSize)
+	{
+		range = m_size - offset;
+	}
+	ANKI_ASSERT(offset + range <= m_size);
+
+#if ANKI_ASSERTIONS_ENABLED
+	self.m_mapped = true;
+#endif
+
+	return self.m_memory + offset;
+}
+
+void Buffer::unmap()
+{
+	ANKI_NULL_SELF(BufferImpl);
+
+	ANKI_ASSERT(self.m_mapped);
+
+#if ANKI_ASSERTIONS_ENABLED
+	self.m_mapped = false;
+#endif
+}
+
+void Buffer::flush([[maybe_unused]] PtrSize offset, [[maybe_unused]] PtrSize range) const
+{
+	// No-op
+}
+
+void Buffer::invalidate([[maybe_unused]] PtrSize offset, [[maybe_unused]] PtrSize range) const
+{
+	// No-op
+}
+
+BufferImpl::~BufferImpl()
+{
+	ANKI_ASSERT(!m_mapped);
+
+	if(m_memory)
+	{
+		GrMemoryPool::getSingleton().free(m_memory);
+		g_svarNullHostMemoryAllocated.decrement(m_size);
+	}
+}
+
+Error BufferImpl::init(const BufferInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+	m_access = inf.m_mapAccess;
+	m_usage = inf.m_usage;
+	m_size = inf.m_size;
+
+	if(!!m_access)
+	{
+		m_memory = static_cast<U8*>(GrMemoryPool::getSingleton().allocate(m_size, 16));
+		if(!m_memory)
+		{
+			ANKI_NULL_LOGE("Out of memory");
+			return Error::kOutOfMemory;
+		}
+
+		g_svarNullHostMemoryAllocated.increment(m_size);
+	}
+
+	m_gpuAddress = getGrManagerImpl().allocateGpuAddressRange(m_size);
+
+	return Error::kNone;
+}
+
+} // end namespace anki
@@ -0,0 +1,36 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Buffer.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// Buffer implementation. Only the mappable buffers have memory since no one can read the rest.
+class BufferImpl final : public Buffer
+{
+	friend class Buffer;
+
+public:
+	BufferImpl(CString name, U32 uuid)
+		: Buffer(name, uuid)
+	{
+	}
+
+	~BufferImpl();
+
+	Error init(const BufferInitInfo& inf);
+
+private:
+	U8* m_memory = nullptr;
+
+#if ANKI_ASSERTIONS_ENABLED
+	Bool m_mapped = false;
+#endif
+};
+
+} // end namespace anki
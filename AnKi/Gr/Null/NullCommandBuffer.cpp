@@ -0,0 +1,511 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullCommandBuffer.h>
+#include <AnKi/Gr/Null/NullTimestampQuery.h>
+
+namespace anki {
+
+CommandBuffer* CommandBuffer::newInstance(const CommandBufferInitInfo& init, U32 uuid)
+{
+	CommandBufferImpl* impl = anki::newInstance<CommandBufferImpl>(GrMemoryPool::getSingleton(), init.getName(), uuid);
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+void CommandBuffer::endRecording()
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(!self.m_insideRenderPass && self.m_debugMarkerDepth == 0);
+	self.m_finalized = true;
+}
+
+void CommandBuffer::bindVertexBuffer([[maybe_unused]] U32 binding, [[maybe_unused]] const BufferView& buff, [[maybe_unused]] U32 stride,
+									 [[maybe_unused]] VertexStepRate stepRate)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(buff.isValid());
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::setVertexAttribute([[maybe_unused]] VertexAttributeSemantic attribute, [[maybe_unused]] U32 buffBinding,
+									   [[maybe_unused]] Format fmt, [[maybe_unused]] U32 relativeOffset)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::bindIndexBuffer([[maybe_unused]] const BufferView& buff, [[maybe_unused]] IndexType type)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(buff.isValid());
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::setPrimitiveRestart([[maybe_unused]] Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setViewport([[maybe_unused]] U32 minx, [[maybe_unused]] U32 miny, [[maybe_unused]] U32 width, [[maybe_unused]] U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(width > 0 && height > 0);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setScissor([[maybe_unused]] U32 minx, [[maybe_unused]] U32 miny, [[maybe_unused]] U32 width, [[maybe_unused]] U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(width > 0 && height > 0);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setFillMode([[maybe_unused]] FillMode mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setCullMode([[maybe_unused]] FaceSelectionBit mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setPolygonOffset([[maybe_unused]] F32 factor, [[maybe_unused]] F32 units)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setStencilOperations([[maybe_unused]] FaceSelectionBit face, [[maybe_unused]] StencilOperation stencilFail,
+										 [[maybe_unused]] StencilOperation stencilPassDepthFail,
+										 [[maybe_unused]] StencilOperation stencilPassDepthPass)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setStencilCompareOperation([[maybe_unused]] FaceSelectionBit face, [[maybe_unused]] CompareOperation comp)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setStencilCompareMask([[maybe_unused]] FaceSelectionBit face, [[maybe_unused]] U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setStencilWriteMask([[maybe_unused]] FaceSelectionBit face, [[maybe_unused]] U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setStencilReference([[maybe_unused]] FaceSelectionBit face, [[maybe_unused]] U32 ref)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setDepthWrite([[maybe_unused]] Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setDepthCompareOperation([[maybe_unused]] CompareOperation op)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setAlphaToCoverage([[maybe_unused]] Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setColorChannelWriteMask([[maybe_unused]] U32 attachment, [[maybe_unused]] ColorBit mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(attachment < kMaxColorRenderTargets);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setBlendFactors([[maybe_unused]] U32 attachment, [[maybe_unused]] BlendFactor srcRgb, [[maybe_unused]] BlendFactor dstRgb,
+									[[maybe_unused]] BlendFactor srcA, [[maybe_unused]] BlendFactor dstA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(attachment < kMaxColorRenderTargets);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setBlendOperation([[maybe_unused]] U32 attachment, [[maybe_unused]] BlendOperation funcRgb, [[maybe_unused]] BlendOperation funcA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(attachment < kMaxColorRenderTargets);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::setLineWidth([[maybe_unused]] F32 lineWidth)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::bindConstantBuffer([[maybe_unused]] U32 reg, [[maybe_unused]] U32 space, [[maybe_unused]] const BufferView& buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(buff.isValid());
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::bindSampler([[maybe_unused]] U32 reg, [[maybe_unused]] U32 space, [[maybe_unused]] Sampler* sampler)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(sampler);
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::bindSrv([[maybe_unused]] U32 reg, [[maybe_unused]] U32 space, [[maybe_unused]] const TextureView& texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(texView.isValid());
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::bindSrv([[maybe_unused]] U32 reg, [[maybe_unused]] U32 space, [[maybe_unused]] const BufferView& buffer,
+							[[maybe_unused]] Format fmt)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(buffer.isValid());
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::bindSrv([[maybe_unused]] U32 reg, [[maybe_unused]] U32 space, [[maybe_unused]] AccelerationStructure* as)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(as);
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::bindUav([[maybe_unused]] U32 reg, [[maybe_unused]] U32 space, [[maybe_unused]] const TextureView& texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(texView.isValid());
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::bindUav([[maybe_unused]] U32 reg, [[maybe_unused]] U32 space, [[maybe_unused]] const BufferView& buffer,
+							[[maybe_unused]] Format fmt)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(buffer.isValid());
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::setFastConstants([[maybe_unused]] const void* data, [[maybe_unused]] U32 dataSize)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(data && dataSize && dataSize % 4 == 0);
+	self.pushCommand(NullCommandType::kBindResource);
+}
+
+void CommandBuffer::bindShaderProgram(ShaderProgram* prog)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(prog);
+	self.m_programBound = true;
+	self.pushCommand(NullCommandType::kBindProgram);
+}
+
+void CommandBuffer::beginRenderPass([[maybe_unused]] ConstWeakArray<RenderTarget> colorRts, [[maybe_unused]] RenderTarget* depthStencilRt,
+									[[maybe_unused]] const TextureView& vrsRt, [[maybe_unused]] U8 vrsRtTexelSizeX,
+									[[maybe_unused]] U8 vrsRtTexelSizeY)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(!self.m_insideRenderPass);
+	ANKI_ASSERT(colorRts.getSize() <= kMaxColorRenderTargets);
+	ANKI_ASSERT(colorRts.getSize() > 0 || depthStencilRt);
+	self.m_insideRenderPass = true;
+	self.pushCommand(NullCommandType::kBeginRenderPass);
+}
+
+void CommandBuffer::endRenderPass()
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(self.m_insideRenderPass);
+	self.m_insideRenderPass = false;
+	self.pushCommand(NullCommandType::kEndRenderPass);
+}
+
+void CommandBuffer::setVrsRate([[maybe_unused]] VrsRate rate)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushCommand(NullCommandType::kSetState);
+}
+
+void CommandBuffer::drawIndexed([[maybe_unused]] PrimitiveTopology topology, [[maybe_unused]] U32 count, [[maybe_unused]] U32 instanceCount,
+								[[maybe_unused]] U32 firstIndex, [[maybe_unused]] U32 baseVertex, [[maybe_unused]] U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushDrawcall(NullCommandType::kDraw);
+}
+
+void CommandBuffer::draw([[maybe_unused]] PrimitiveTopology topology, [[maybe_unused]] U32 count, [[maybe_unused]] U32 instanceCount,
+						 [[maybe_unused]] U32 first, [[maybe_unused]] U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushDrawcall(NullCommandType::kDraw);
+}
+
+void CommandBuffer::drawIndexedIndirect([[maybe_unused]] PrimitiveTopology topology, [[maybe_unused]] const BufferView& indirectBuff,
+										[[maybe_unused]] U32 drawCount)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(indirectBuff.isValid() && drawCount > 0);
+	self.pushDrawcall(NullCommandType::kDrawIndirect);
+}
+
+void CommandBuffer::drawIndirect([[maybe_unused]] PrimitiveTopology topology, [[maybe_unused]] const BufferView& indirectBuff,
+								 [[maybe_unused]] U32 drawCount)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(indirectBuff.isValid() && drawCount > 0);
+	self.pushDrawcall(NullCommandType::kDrawIndirect);
+}
+
+void CommandBuffer::drawIndexedIndirectCount([[maybe_unused]] PrimitiveTopology topology, [[maybe_unused]] const BufferView& argBuffer,
+											 [[maybe_unused]] U32 argBufferStride, [[maybe_unused]] const BufferView& countBuffer,
+											 [[maybe_unused]] U32 maxDrawCount)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(argBuffer.isValid() && countBuffer.isValid());
+	self.pushDrawcall(NullCommandType::kDrawIndirect);
+}
+
+void CommandBuffer::drawIndirectCount([[maybe_unused]] PrimitiveTopology topology, [[maybe_unused]] const BufferView& argBuffer,
+									  [[maybe_unused]] U32 argBufferStride, [[maybe_unused]] const BufferView& countBuffer,
+									  [[maybe_unused]] U32 maxDrawCount)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(argBuffer.isValid() && countBuffer.isValid());
+	self.pushDrawcall(NullCommandType::kDrawIndirect);
+}
+
+void CommandBuffer::drawMeshTasks([[maybe_unused]] U32 groupCountX, [[maybe_unused]] U32 groupCountY, [[maybe_unused]] U32 groupCountZ)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushDrawcall(NullCommandType::kDrawMesh);
+}
+
+void CommandBuffer::drawMeshTasksIndirect([[maybe_unused]] const BufferView& argBuffer, [[maybe_unused]] U32 drawCount)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(argBuffer.isValid());
+	self.pushDrawcall(NullCommandType::kDrawMesh);
+}
+
+void CommandBuffer::dispatchCompute([[maybe_unused]] U32 groupCountX, [[maybe_unused]] U32 groupCountY, [[maybe_unused]] U32 groupCountZ)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(groupCountX > 0 && groupCountY > 0 && groupCountZ > 0);
+	self.pushDispatch(NullCommandType::kDispatch);
+}
+
+void CommandBuffer::dispatchComputeIndirect([[maybe_unused]] const BufferView& argBuffer)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(argBuffer.isValid());
+	self.pushDispatch(NullCommandType::kDispatchIndirect);
+}
+
+void CommandBuffer::dispatchGraph([[maybe_unused]] const BufferView& scratchBuffer, [[maybe_unused]] const void* records,
+								  [[maybe_unused]] U32 recordCount, [[maybe_unused]] U32 recordStride)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(scratchBuffer.isValid() && records && recordCount > 0);
+	self.pushDispatch(NullCommandType::kDispatchGraph);
+}
+
+void CommandBuffer::dispatchRays([[maybe_unused]] const BufferView& sbtBuffer, [[maybe_unused]] U32 sbtRecordSize,
+								 [[maybe_unused]] U32 hitGroupSbtRecordCount, [[maybe_unused]] U32 rayTypeCount, [[maybe_unused]] U32 width,
+								 [[maybe_unused]] U32 height, [[maybe_unused]] U32 depth)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(sbtBuffer.isValid() && width > 0 && height > 0 && depth > 0);
+	self.pushDispatch(NullCommandType::kDispatchRays);
+}
+
+void CommandBuffer::dispatchRaysIndirect([[maybe_unused]] const BufferView& sbtBuffer, [[maybe_unused]] U32 sbtRecordSize,
+										 [[maybe_unused]] U32 hitGroupSbtRecordCount, [[maybe_unused]] U32 rayTypeCount,
+										 [[maybe_unused]] BufferView argsBuffer)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(sbtBuffer.isValid() && argsBuffer.isValid());
+	self.pushDispatch(NullCommandType::kDispatchRays);
+}
+
+void CommandBuffer::blitTexture([[maybe_unused]] const TextureView& srcView, [[maybe_unused]] const TextureView& destView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushTransfer(NullCommandType::kCopy);
+}
+
+void CommandBuffer::clearTexture([[maybe_unused]] const TextureView& texView, [[maybe_unused]] const ClearValue& clearValue)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(texView.isValid());
+	self.pushTransfer(NullCommandType::kClear);
+}
+
+void CommandBuffer::copyBufferToTexture([[maybe_unused]] const BufferView& buff, [[maybe_unused]] const TextureView& texView,
+										[[maybe_unused]] const TextureRect& rect)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(buff.isValid() && texView.isValid());
+	self.pushTransfer(NullCommandType::kCopy);
+}
+
+void CommandBuffer::zeroBuffer([[maybe_unused]] const BufferView& buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(buff.isValid());
+	self.pushTransfer(NullCommandType::kClear);
+}
+
+void CommandBuffer::writeOcclusionQueriesResultToBuffer([[maybe_unused]] ConstWeakArray<OcclusionQuery*> queries,
+														[[maybe_unused]] const BufferView& buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(queries.getSize() > 0 && buff.isValid());
+	self.pushTransfer(NullCommandType::kCopy);
+}
+
+void CommandBuffer::copyBufferToBuffer([[maybe_unused]] Buffer* src, [[maybe_unused]] Buffer* dst,
+									   [[maybe_unused]] ConstWeakArray<CopyBufferToBufferInfo> copies)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(src && dst && copies.getSize() > 0);
+	self.pushTransfer(NullCommandType::kCopy);
+}
+
+void CommandBuffer::buildAccelerationStructure([[maybe_unused]] AccelerationStructure* as, [[maybe_unused]] const BufferView& scratchBuffer)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(as && scratchBuffer.isValid());
+	ANKI_ASSERT(scratchBuffer.getRange() >= as->getBuildScratchBufferSize());
+	self.pushTransfer(NullCommandType::kBuildAccelerationStructure);
+}
+
+void CommandBuffer::upscale([[maybe_unused]] GrUpscaler* upscaler, [[maybe_unused]] const TextureView& inColor,
+							[[maybe_unused]] const TextureView& outUpscaledColor, [[maybe_unused]] const TextureView& motionVectors,
+							[[maybe_unused]] const TextureView& depth, [[maybe_unused]] const TextureView& exposure,
+							[[maybe_unused]] Bool resetAccumulation, [[maybe_unused]] const Vec2& jitterOffset,
+							[[maybe_unused]] const Vec2& motionVectorsScale)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(upscaler);
+	self.pushTransfer(NullCommandType::kUpscale);
+}
+
+void CommandBuffer::setPipelineBarrier(ConstWeakArray<TextureBarrierInfo> textures, ConstWeakArray<BufferBarrierInfo> buffers,
+									   ConstWeakArray<AccelerationStructureBarrierInfo> accelerationStructures)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(!self.m_insideRenderPass);
+
+	const U32 count = textures.getSize() + buffers.getSize() + accelerationStructures.getSize();
+	if(count)
+	{
+		self.m_barrierCount += count;
+		self.pushCommand(NullCommandType::kBarrier);
+	}
+}
+
+void CommandBuffer::beginOcclusionQuery([[maybe_unused]] OcclusionQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query);
+	self.pushCommand(NullCommandType::kQuery);
+}
+
+void CommandBuffer::endOcclusionQuery([[maybe_unused]] OcclusionQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query);
+	self.pushCommand(NullCommandType::kQuery);
+}
+
+void CommandBuffer::beginPipelineQuery([[maybe_unused]] PipelineQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query);
+	self.pushCommand(NullCommandType::kQuery);
+}
+
+void CommandBuffer::endPipelineQuery([[maybe_unused]] PipelineQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query);
+	self.pushCommand(NullCommandType::kQuery);
+}
+
+void CommandBuffer::writeTimestamp(TimestampQuery* query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query);
+	self.m_timestampQueries.emplaceBack(query);
+	self.pushCommand(NullCommandType::kQuery);
+}
+
+Bool CommandBuffer::isEmpty() const
+{
+	ANKI_NULL_SELF_CONST(CommandBufferImpl);
+	return self.m_commands.getSize() == 0;
+}
+
+void CommandBuffer::pushDebugMarker([[maybe_unused]] CString name, [[maybe_unused]] Vec3 color)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	++self.m_debugMarkerDepth;
+	self.pushCommand(NullCommandType::kDebugMarker);
+}
+
+void CommandBuffer::popDebugMarker()
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(self.m_debugMarkerDepth > 0);
+	--self.m_debugMarkerDepth;
+	self.pushCommand(NullCommandType::kDebugMarker);
+}
+
+Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
+{
+	m_flags = init.m_flags;
+	return Error::kNone;
+}
+
+void CommandBufferImpl::writeTimestamps(Second timestamp)
+{
+	for(TimestampQueryInternalPtr& q : m_timestampQueries)
+	{
+		static_cast<TimestampQueryImpl&>(*q).m_timestamp = timestamp;
+	}
+
+	m_timestampQueries.destroy();
+}
+
+} // end namespace anki
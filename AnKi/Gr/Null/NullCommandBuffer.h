@@ -0,0 +1,157 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/CommandBuffer.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// The commands the null command buffer keeps track of.
+enum class NullCommandType : U8
+{
+	kSetState, // Any state change that is not a binding
+	kBindResource,
+	kBindProgram,
+	kBeginRenderPass,
+	kEndRenderPass,
+	kDraw,
+	kDrawIndirect,
+	kDrawMesh,
+	kDispatch,
+	kDispatchIndirect,
+	kDispatchRays,
+	kDispatchGraph,
+	kCopy,
+	kClear,
+	kBarrier,
+	kQuery,
+	kDebugMarker,
+	kBuildAccelerationStructure,
+	kUpscale,
+
+	kCount,
+	kFirst = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(NullCommandType)
+
+// A run of commands of the same type.
+class NullCommand
+{
+public:
+	NullCommandType m_type = NullCommandType::kCount;
+	U32 m_count = 0;
+};
+
+// Command buffer implementation. It doesn't execute anything, it records a run-length encoded stream of the command types and counts them.
+class CommandBufferImpl final : public CommandBuffer
+{
+	friend class CommandBuffer;
+
+public:
+	CommandBufferImpl(CString name, U32 uuid)
+		: CommandBuffer(name, uuid)
+	{
+	}
+
+	Error init(const CommandBufferInitInfo& init);
+
+	ConstWeakArray<NullCommand> getCommands() const
+	{
+		return m_commands;
+	}
+
+	U32 getCommandCount(NullCommandType type) const
+	{
+		return m_commandCounts[type];
+	}
+
+	U32 getCommandCount() const
+	{
+		U32 count = 0;
+		for(U32 c : m_commandCounts)
+		{
+			count += c;
+		}
+		return count;
+	}
+
+	U32 getDrawcallCount() const
+	{
+		return m_commandCounts[NullCommandType::kDraw] + m_commandCounts[NullCommandType::kDrawIndirect]
+			   + m_commandCounts[NullCommandType::kDrawMesh];
+	}
+
+	U32 getDispatchCount() const
+	{
+		return m_commandCounts[NullCommandType::kDispatch] + m_commandCounts[NullCommandType::kDispatchIndirect]
+			   + m_commandCounts[NullCommandType::kDispatchRays] + m_commandCounts[NullCommandType::kDispatchGraph];
+	}
+
+	// The number of individual barriers. A single setPipelineBarrier() may contain many.
+	U32 getBarrierCount() const
+	{
+		return m_barrierCount;
+	}
+
+	Bool isFinalized() const
+	{
+		return m_finalized;
+	}
+
+	// Called on submission.
+	void writeTimestamps(Second timestamp);
+
+private:
+	GrDynamicArray<NullCommand> m_commands;
+	Array<U32, U32(NullCommandType::kCount)> m_commandCounts = {};
+	U32 m_barrierCount = 0;
+
+	GrDynamicArray<TimestampQueryInternalPtr> m_timestampQueries;
+
+	U32 m_debugMarkerDepth = 0;
+	Bool m_insideRenderPass = false;
+	Bool m_programBound = false;
+	Bool m_finalized = false;
+
+	void pushCommand(NullCommandType type)
+	{
+		ANKI_ASSERT(!m_finalized);
+
+		if(m_commands.getSize() && m_commands.getBack().m_type == type)
+		{
+			++m_commands.getBack().m_count;
+		}
+		else
+		{
+			NullCommand& cmd = *m_commands.emplaceBack();
+			cmd.m_type = type;
+			cmd.m_count = 1;
+		}
+
+		++m_commandCounts[type];
+	}
+
+	void pushDrawcall(NullCommandType type)
+	{
+		ANKI_ASSERT(m_insideRenderPass && m_programBound);
+		pushCommand(type);
+	}
+
+	void pushDispatch(NullCommandType type)
+	{
+		ANKI_ASSERT(!m_insideRenderPass && m_programBound);
+		pushCommand(type);
+	}
+
+	void pushTransfer(NullCommandType type)
+	{
+		ANKI_ASSERT(!m_insideRenderPass);
+		pushCommand(type);
+	}
+};
+
+} // end namespace anki
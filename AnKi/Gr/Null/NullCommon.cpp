@@ -0,0 +1,26 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullCommon.h>
+#include <AnKi/Gr/Null/NullGrManager.h>
+
+namespace anki {
+
+void GrObjectDeleter::operator()(GrObject* ptr)
+{
+	getGrManagerImpl().releaseObject(ptr);
+}
+
+void GrObjectDeleterInternal::operator()(GrObject* ptr)
+{
+	getGrManagerImpl().releaseObject(ptr);
+}
+
+GrManagerImpl& getGrManagerImpl()
+{
+	return static_cast<GrManagerImpl&>(GrManager::getSingleton());
+}
+
+} // end namespace anki
@@ -0,0 +1,35 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Common.h>
+#include <AnKi/Gr/BackendCommon/Common.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Core/StatsSet.h>
+
+namespace anki {
+
+// Forward
+class GrManagerImpl;
+
+ANKI_SVAR(NullDrawcalls, StatCategory::kGr, "Null: Drawcalls submitted", StatFlag::kZeroEveryFrame)
+ANKI_SVAR(NullDispatches, StatCategory::kGr, "Null: Dispatches submitted", StatFlag::kZeroEveryFrame)
+ANKI_SVAR(NullBarriers, StatCategory::kGr, "Null: Barriers submitted", StatFlag::kZeroEveryFrame)
+ANKI_SVAR(NullCommands, StatCategory::kGr, "Null: Commands submitted", StatFlag::kZeroEveryFrame)
+ANKI_SVAR(NullHostMemoryAllocated, StatCategory::kGpuMem, "Null: Buffer mem allocated (CPU)", StatFlag::kBytes)
+
+#define ANKI_NULL_LOGI(...) ANKI_LOG("NULL", kNormal, __VA_ARGS__)
+#define ANKI_NULL_LOGE(...) ANKI_LOG("NULL", kError, __VA_ARGS__)
+#define ANKI_NULL_LOGW(...) ANKI_LOG("NULL", kWarning, __VA_ARGS__)
+#define ANKI_NULL_LOGF(...) ANKI_LOG("NULL", kFatal, __VA_ARGS__)
+#define ANKI_NULL_LOGV(...) ANKI_LOG("NULL", kVerbose, __VA_ARGS__)
+
+#define ANKI_NULL_SELF(class_) class_& self = *static_cast<class_*>(this)
+#define ANKI_NULL_SELF_CONST(class_) const class_& self = *static_cast<const class_*>(this)
+
+ANKI_PURE GrManagerImpl& getGrManagerImpl();
+
+} // end namespace anki
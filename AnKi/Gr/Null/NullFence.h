@@ -0,0 +1,23 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Fence.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// Fence implementation. There is no GPU so the fences are signaled from the start.
+class FenceImpl final : public Fence
+{
+public:
+	FenceImpl(CString name, U32 uuid)
+		: Fence(name, uuid)
+	{
+	}
+};
+
+} // end namespace anki
@@ -0,0 +1,274 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullGrManager.h>
+#include <AnKi/Gr/Null/NullAccelerationStructure.h>
+#include <AnKi/Gr/Null/NullBuffer.h>
+#include <AnKi/Gr/Null/NullTexture.h>
+#include <AnKi/Gr/Null/NullSampler.h>
+#include <AnKi/Gr/Null/NullShader.h>
+#include <AnKi/Gr/Null/NullShaderProgram.h>
+#include <AnKi/Gr/Null/NullCommandBuffer.h>
+#include <AnKi/Gr/Null/NullFence.h>
+#include <AnKi/Gr/Null/NullOcclusionQuery.h>
+#include <AnKi/Gr/Null/NullTimestampQuery.h>
+#include <AnKi/Gr/Null/NullPipelineQuery.h>
+#include <AnKi/Gr/Null/NullGrUpscaler.h>
+#include <AnKi/Gr/RenderGraph.h>
+#include <AnKi/Window/NativeWindow.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/Tracer.h>
+
+namespace anki {
+
+template<>
+template<>
+GrManager& MakeSingletonPtr<GrManager>::allocateSingleton<>()
+{
+	ANKI_ASSERT(m_global == nullptr);
+	m_global = new GrManagerImpl;
+
+#if ANKI_ASSERTIONS_ENABLED
+	++g_singletonsAllocated;
+#endif
+
+	return *m_global;
+}
+
+template<>
+void MakeSingletonPtr<GrManager>::freeSingleton()
+{
+	if(m_global)
+	{
+		delete static_cast<GrManagerImpl*>(m_global);
+		m_global = nullptr;
+#if ANKI_ASSERTIONS_ENABLED
+		--g_singletonsAllocated;
+#endif
+	}
+}
+
+GrManager::GrManager()
+{
+}
+
+GrManager::~GrManager()
+{
+}
+
+PtrSize GrManager::getAccelerationStructureMemoryRequirement(const AccelerationStructureInitInfo& init) const
+{
+	PtrSize asSize, unused;
+	AccelerationStructureImpl::getMemoryRequirement(init, asSize, unused);
+	return asSize;
+}
+
+PtrSize GrManager::getTextureMemoryRequirement(const TextureInitInfo& init) const
+{
+	return TextureImpl::getMemoryRequirement(init);
+}
+
+Error GrManager::init(GrManagerInitInfo& inf)
+{
+	ANKI_NULL_SELF(GrManagerImpl);
+	return self.initInternal(inf);
+}
+
+void GrManager::beginFrame()
+{
+	// Nothing to do
+}
+
+TexturePtr GrManager::acquireNextPresentableTexture()
+{
+	ANKI_NULL_SELF(GrManagerImpl);
+	return self.acquireNextPresentableTextureInternal();
+}
+
+void GrManager::endFrame()
+{
+	// Nothing to present
+}
+
+void GrManager::finish()
+{
+	// Everything is done on submit
+}
+
+void GrManager::submit(WeakArray<CommandBuffer*> cmdbs, [[maybe_unused]] WeakArray<Fence*> waitFences, FencePtr* signalFence,
+					   [[maybe_unused]] Bool flushAndSerialize)
+{
+	ANKI_NULL_SELF(GrManagerImpl);
+	self.submitInternal(cmdbs, signalFence);
+}
+
+#define ANKI_NEW_GR_OBJECT(type) \
+	type##Ptr GrManager::new##type(const type##InitInfo& init) \
+	{ \
+		type##Ptr ptr(type::newInstance(init, newGrObjectUuid())); \
+		if(!ptr.isCreated()) [[unlikely]] \
+		{ \
+			ANKI_NULL_LOGF("Failed to create a " ANKI_STRINGIZE(type) " object"); \
+		} \
+		return ptr; \
+	}
+
+#define ANKI_NEW_GR_OBJECT_NO_INIT_INFO(type) \
+	type##Ptr GrManager::new##type() \
+	{ \
+		type##Ptr ptr(type::newInstance(newGrObjectUuid())); \
+		if(!ptr.isCreated()) [[unlikely]] \
+		{ \
+			ANKI_NULL_LOGF("Failed to create a " ANKI_STRINGIZE(type) " object"); \
+		} \
+		return ptr; \
+	}
+
+ANKI_NEW_GR_OBJECT(Buffer)
+ANKI_NEW_GR_OBJECT(Texture)
+ANKI_NEW_GR_OBJECT(Sampler)
+ANKI_NEW_GR_OBJECT(Shader)
+ANKI_NEW_GR_OBJECT(ShaderProgram)
+ANKI_NEW_GR_OBJECT(CommandBuffer)
+ANKI_NEW_GR_OBJECT_NO_INIT_INFO(OcclusionQuery)
+ANKI_NEW_GR_OBJECT_NO_INIT_INFO(TimestampQuery)
+ANKI_NEW_GR_OBJECT(PipelineQuery)
+ANKI_NEW_GR_OBJECT_NO_INIT_INFO(RenderGraph)
+ANKI_NEW_GR_OBJECT(AccelerationStructure)
+ANKI_NEW_GR_OBJECT(GrUpscaler)
+
+#undef ANKI_NEW_GR_OBJECT
+#undef ANKI_NEW_GR_OBJECT_NO_INIT_INFO
+
+GrManagerImpl::~GrManagerImpl()
+{
+	destroy();
+}
+
+Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
+{
+	ANKI_NULL_LOGI("Initializing the null backend. Nothing will be rendered");
+
+	GrMemoryPool::allocateSingleton(init.m_allocCallback, init.m_allocCallbackUserData);
+
+	m_cacheDir = init.m_cacheDirectory;
+
+	// Pretend to be a typical desktop GPU with the minimum of features
+	m_capabilities.m_constantBufferBindOffsetAlignment = 256;
+	m_capabilities.m_structuredBufferBindOffsetAlignment = 16;
+	m_capabilities.m_texelBufferBindOffsetAlignment = 16;
+	m_capabilities.m_fastConstantsSize = 128;
+	m_capabilities.m_computeSharedMemorySize = 32_KB;
+	m_capabilities.m_sbtRecordAlignment = 64;
+	m_capabilities.m_shaderGroupHandleSize = 32;
+	m_capabilities.m_minWaveSize = 32;
+	m_capabilities.m_maxWaveSize = 32;
+	m_capabilities.m_maxDrawIndirectCount = kMaxU32;
+	m_capabilities.m_gpuVendor = GpuVendor::kUnknown;
+	m_capabilities.m_discreteGpu = true;
+	m_capabilities.m_unalignedBbpTextureFormats = true;
+	m_capabilities.m_pipelineQuery = true;
+
+	ANKI_CHECK(createSwapchainTexture());
+
+	commonPostInit();
+
+	return Error::kNone;
+}
+
+void GrManagerImpl::destroy()
+{
+	ANKI_NULL_LOGI("Destroying the null backend");
+
+	commonPreDestroy();
+
+	m_swapchainTexture.reset(nullptr);
+	m_freeBindlessIndices.destroy();
+	m_cacheDir.destroy();
+
+	GrMemoryPool::freeSingleton();
+}
+
+Error GrManagerImpl::createSwapchainTexture()
+{
+	const NativeWindow& window = NativeWindow::getSingleton();
+
+	TextureInitInfo init("SwapchainImg");
+	init.m_width = window.getWidth();
+	init.m_height = window.getHeight();
+	init.m_format = Format::kR8G8B8A8_Unorm;
+	init.m_usage = TextureUsageBit::kAllSrv | TextureUsageBit::kAllUav | TextureUsageBit::kRtvDsvRead | TextureUsageBit::kRtvDsvWrite
+				   | TextureUsageBit::kPresent;
+	init.m_type = TextureType::k2D;
+
+	TextureImpl* tex = anki::newInstance<TextureImpl>(GrMemoryPool::getSingleton(), init.getName(), newGrObjectUuid());
+	m_swapchainTexture.reset(tex);
+
+	return tex->init(init);
+}
+
+TexturePtr GrManagerImpl::acquireNextPresentableTextureInternal()
+{
+	// Follow the window size like a real swapchain would
+	const NativeWindow& window = NativeWindow::getSingleton();
+	if(m_swapchainTexture->getWidth() != window.getWidth() || m_swapchainTexture->getHeight() != window.getHeight())
+	{
+		if(createSwapchainTexture())
+		{
+			ANKI_NULL_LOGF("Failed to recreate the swapchain texture");
+		}
+	}
+
+	return TexturePtr(m_swapchainTexture.get());
+}
+
+void GrManagerImpl::submitInternal(WeakArray<CommandBuffer*> cmdbs, FencePtr* signalFence)
+{
+	ANKI_TRACE_FUNCTION();
+
+	const Second now = HighRezTimer::getCurrentTime();
+
+	for(CommandBuffer* cmdb : cmdbs)
+	{
+		CommandBufferImpl& impl = static_cast<CommandBufferImpl&>(*cmdb);
+		ANKI_ASSERT(impl.isFinalized());
+
+		g_svarNullCommands.increment(impl.getCommandCount());
+		g_svarNullDrawcalls.increment(impl.getDrawcallCount());
+		g_svarNullDispatches.increment(impl.getDispatchCount());
+		g_svarNullBarriers.increment(impl.getBarrierCount());
+
+		impl.writeTimestamps(now);
+	}
+
+	if(signalFence)
+	{
+		FenceImpl* fenceImpl = anki::newInstance<FenceImpl>(GrMemoryPool::getSingleton(), "SignalFence", newGrObjectUuid());
+		signalFence->reset(fenceImpl);
+	}
+}
+
+U32 GrManagerImpl::allocateBindlessIndex()
+{
+	LockGuard lock(m_bindlessMtx);
+
+	if(m_freeBindlessIndices.getSize())
+	{
+		const U32 idx = m_freeBindlessIndices.getBack();
+		m_freeBindlessIndices.popBack();
+		return idx;
+	}
+
+	return m_bindlessIndexCount++;
+}
+
+void GrManagerImpl::freeBindlessIndex(U32 idx)
+{
+	LockGuard lock(m_bindlessMtx);
+	ANKI_ASSERT(idx < m_bindlessIndexCount);
+	m_freeBindlessIndices.emplaceBack(idx);
+}
+
+} // end namespace anki
@@ -0,0 +1,70 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/GrManager.h>
+#include <AnKi/Gr/Texture.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// GrManager implementation of the null backend. It exercises the whole CPU side of the renderer (render graph, command recording, resource
+// creation) without a GPU. Useful for CPU benchmarks and for running on headless machines.
+class GrManagerImpl : public GrManager
+{
+	friend class GrManager;
+
+public:
+	using GrManager::newGrObjectUuid;
+
+	GrManagerImpl()
+	{
+	}
+
+	~GrManagerImpl();
+
+	Error initInternal(const GrManagerInitInfo& cfg);
+
+	// There is no GPU so objects can be deleted right away. It's thread-safe.
+	void releaseObject(GrObject* object)
+	{
+		ANKI_ASSERT(object);
+		deleteInstance(GrMemoryPool::getSingleton(), object);
+	}
+
+	// Get a unique fake GPU address for a buffer or an AS. It's thread-safe.
+	U64 allocateGpuAddressRange(PtrSize size)
+	{
+		return m_gpuAddress.fetchAdd(getAlignedRoundUp(kGpuAddressAlignment, max<PtrSize>(size, 1)));
+	}
+
+	// It's thread-safe.
+	U32 allocateBindlessIndex();
+
+	// It's thread-safe.
+	void freeBindlessIndex(U32 idx);
+
+private:
+	static constexpr PtrSize kGpuAddressAlignment = 256;
+
+	Atomic<U64> m_gpuAddress = {kGpuAddressAlignment}; // Don't start from zero since zero is the invalid address
+
+	Mutex m_bindlessMtx;
+	GrDynamicArray<U32> m_freeBindlessIndices;
+	U32 m_bindlessIndexCount = 0;
+
+	TextureInternalPtr m_swapchainTexture;
+
+	void destroy();
+
+	TexturePtr acquireNextPresentableTextureInternal();
+
+	void submitInternal(WeakArray<CommandBuffer*> cmdbs, FencePtr* signalFence);
+
+	Error createSwapchainTexture();
+};
+
+} // end namespace anki
@@ -0,0 +1,17 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullGrUpscaler.h>
+
+namespace anki {
+
+GrUpscaler* GrUpscaler::newInstance(const GrUpscalerInitInfo& initInfo, U32 uuid)
+{
+	GrUpscalerImpl* impl = anki::newInstance<GrUpscalerImpl>(GrMemoryPool::getSingleton(), initInfo.getName(), uuid);
+	impl->init(initInfo);
+	return impl;
+}
+
+} // end namespace anki
@@ -0,0 +1,20 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullOcclusionQuery.h>
+
+namespace anki {
+
+OcclusionQuery* OcclusionQuery::newInstance(U32 uuid)
+{
+	return anki::newInstance<OcclusionQueryImpl>(GrMemoryPool::getSingleton(), "N/A", uuid);
+}
+
+OcclusionQueryResult OcclusionQuery::getResult() const
+{
+	return OcclusionQueryResult::kVisible;
+}
+
+} // end namespace anki
@@ -0,0 +1,22 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullPipelineQuery.h>
+
+namespace anki {
+
+PipelineQuery* PipelineQuery::newInstance(const PipelineQueryInitInfo& inf, U32 uuid)
+{
+	ANKI_ASSERT(inf.m_type == PipelineQueryType::kPrimitivesPassedClipping);
+	return anki::newInstance<PipelineQueryImpl>(GrMemoryPool::getSingleton(), inf.getName(), uuid);
+}
+
+PipelineQueryResult PipelineQuery::getResult(U64& value) const
+{
+	value = 0;
+	return PipelineQueryResult::kAvailable;
+}
+
+} // end namespace anki
@@ -0,0 +1,27 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullSampler.h>
+
+namespace anki {
+
+Sampler* Sampler::newInstance(const SamplerInitInfo& init, U32 uuid)
+{
+	SamplerImpl* impl = anki::newInstance<SamplerImpl>(GrMemoryPool::getSingleton(), init.getName(), uuid);
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+Error SamplerImpl::init([[maybe_unused]] const SamplerInitInfo& init)
+{
+	return Error::kNone;
+}
+
+} // end namespace anki
@@ -0,0 +1,25 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Sampler.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// Sampler implementation.
+class SamplerImpl final : public Sampler
+{
+public:
+	SamplerImpl(CString name, U32 uuid)
+		: Sampler(name, uuid)
+	{
+	}
+
+	Error init(const SamplerInitInfo& init);
+};
+
+} // end namespace anki
@@ -0,0 +1,33 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullShader.h>
+
+namespace anki {
+
+Shader* Shader::newInstance(const ShaderInitInfo& init, U32 uuid)
+{
+	ShaderImpl* impl = anki::newInstance<ShaderImpl>(GrMemoryPool::getSingleton(), init.getName(), uuid);
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+Error ShaderImpl::init(const ShaderInitInfo& inf)
+{
+	m_shaderType = inf.m_shaderType;
+	m_shaderBinarySize = U32(inf.m_binary.getSizeInBytes());
+	m_hasDiscard = inf.m_reflection.m_pixel.m_discards;
+	m_reflection = inf.m_reflection;
+	m_reflection.validate();
+
+	return Error::kNone;
+}
+
+} // end namespace anki
@@ -0,0 +1,127 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullShaderProgram.h>
+#include <AnKi/Gr/Null/NullShader.h>
+#include <AnKi/Gr/Null/NullGrManager.h>
+
+namespace anki {
+
+ShaderProgram* ShaderProgram::newInstance(const ShaderProgramInitInfo& init, U32 uuid)
+{
+	ShaderProgramImpl* impl = anki::newInstance<ShaderProgramImpl>(GrMemoryPool::getSingleton(), init.getName(), uuid);
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+ConstWeakArray<U8> ShaderProgram::getShaderGroupHandles() const
+{
+	ANKI_NULL_SELF_CONST(ShaderProgramImpl);
+	ANKI_ASSERT(self.m_shaderGroupHandles.getSize());
+	return self.m_shaderGroupHandles;
+}
+
+Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+
+	// Gather the shaders
+	U32 shaderGroupCount = 0;
+	if(inf.m_computeShader)
+	{
+		m_shaders.emplaceBack(inf.m_computeShader);
+	}
+	else if(inf.m_graphicsShaders[ShaderType::kPixel])
+	{
+		for(Shader* s : inf.m_graphicsShaders)
+		{
+			if(s)
+			{
+				m_shaders.emplaceBack(s);
+			}
+		}
+	}
+	else if(inf.m_workGraph.m_shader)
+	{
+		m_shaders.emplaceBack(inf.m_workGraph.m_shader);
+	}
+	else
+	{
+		// Ray tracing
+
+		for(Shader* s : inf.m_rayTracingShaders.m_rayGenShaders)
+		{
+			m_shaders.emplaceBack(s);
+		}
+
+		for(Shader* s : inf.m_rayTracingShaders.m_missShaders)
+		{
+			m_shaders.emplaceBack(s);
+		}
+
+		for(const RayTracingHitGroup& group : inf.m_rayTracingShaders.m_hitGroups)
+		{
+			if(group.m_anyHitShader)
+			{
+				m_shaders.emplaceBack(group.m_anyHitShader);
+			}
+
+			if(group.m_closestHitShader)
+			{
+				m_shaders.emplaceBack(group.m_closestHitShader);
+			}
+		}
+
+		shaderGroupCount = inf.m_rayTracingShaders.m_rayGenShaders.getSize() + inf.m_rayTracingShaders.m_missShaders.getSize()
+						   + inf.m_rayTracingShaders.m_hitGroups.getSize();
+	}
+
+	ANKI_ASSERT(m_shaders.getSize() > 0);
+
+	// Link reflection and get the shader sizes
+	ShaderReflection refl;
+	Bool firstLink = true;
+	for(ShaderInternalPtr& shader : m_shaders)
+	{
+		const ShaderImpl& simpl = static_cast<const ShaderImpl&>(*shader);
+
+		m_shaderTypes |= ShaderTypeBit(1 << shader->getShaderType());
+		m_shaderBinarySizes[shader->getShaderType()] = shader->getShaderBinarySize();
+
+		if(firstLink)
+		{
+			refl = simpl.m_reflection;
+			firstLink = false;
+		}
+		else
+		{
+			ANKI_CHECK(ShaderReflection::linkShaderReflection(refl, simpl.m_reflection, refl));
+		}
+
+		refl.validate();
+	}
+
+	m_refl = refl;
+
+	// Misc
+	if(shaderGroupCount)
+	{
+		m_shaderGroupHandles.resize(shaderGroupCount * getGrManagerImpl().getDeviceCapabilities().m_shaderGroupHandleSize, 0);
+	}
+
+	if(inf.m_workGraph.m_shader)
+	{
+		m_workGraphScratchBufferSize = 1_KB;
+	}
+
+	return Error::kNone;
+}
+
+} // end namespace anki
@@ -0,0 +1,31 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/ShaderProgram.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// ShaderProgram implementation. It links the reflection of the shaders, there is no pipeline to create.
+class ShaderProgramImpl final : public ShaderProgram
+{
+	friend class ShaderProgram;
+
+public:
+	ShaderProgramImpl(CString name, U32 uuid)
+		: ShaderProgram(name, uuid)
+	{
+	}
+
+	Error init(const ShaderProgramInitInfo& inf);
+
+private:
+	GrDynamicArray<ShaderInternalPtr> m_shaders;
+	GrDynamicArray<U8> m_shaderGroupHandles; // Zeroes. Only for ray tracing programs
+};
+
+} // end namespace anki
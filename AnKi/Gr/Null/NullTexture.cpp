@@ -0,0 +1,98 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullTexture.h>
+#include <AnKi/Gr/Null/NullGrManager.h>
+
+namespace anki {
+
+Texture* Texture::newInstance(const TextureInitInfo& init, U32 uuid)
+{
+	TextureImpl* impl = anki::newInstance<TextureImpl>(GrMemoryPool::getSingleton(), init.getName(), uuid);
+	const Error err = impl->init(init);
+	if(err)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+U32 Texture::getOrCreateBindlessTextureIndex(const TextureSubresourceDesc& subresource)
+{
+	ANKI_NULL_SELF(TextureImpl);
+	ANKI_ASSERT(TextureView(this, subresource).isGoodForSampling());
+
+	const U64 hash = computeHash(&subresource, sizeof(subresource));
+
+	LockGuard lock(self.m_bindlessIndicesLock);
+
+	auto it = self.m_bindlessIndices.find(hash);
+	if(it != self.m_bindlessIndices.getEnd())
+	{
+		return *it;
+	}
+
+	const U32 idx = getGrManagerImpl().allocateBindlessIndex();
+	self.m_bindlessIndices.emplace(hash, idx);
+	return idx;
+}
+
+TextureImpl::~TextureImpl()
+{
+	for(U32 idx : m_bindlessIndices)
+	{
+		getGrManagerImpl().freeBindlessIndex(idx);
+	}
+}
+
+Error TextureImpl::init(const TextureInitInfo& init)
+{
+	ANKI_ASSERT(init.isValid());
+	m_width = init.m_width;
+	m_height = init.m_height;
+	m_depth = init.m_depth;
+	m_layerCount = init.m_layerCount;
+	m_texType = init.m_type;
+	m_usage = init.m_usage;
+	m_format = init.m_format;
+	m_aspect = getFormatInfo(init.m_format).m_depthStencil;
+
+	if(m_texType == TextureType::k3D)
+	{
+		m_mipCount = min(init.m_mipmapCount, computeMaxMipmapCount3d(m_width, m_height, m_depth));
+	}
+	else
+	{
+		m_mipCount = min(init.m_mipmapCount, computeMaxMipmapCount2d(m_width, m_height));
+	}
+
+	return Error::kNone;
+}
+
+PtrSize TextureImpl::getMemoryRequirement(const TextureInitInfo& init)
+{
+	const FormatInfo inf = getFormatInfo(init.m_format);
+	const U32 blockWidth = (inf.isCompressed()) ? inf.m_blockWidth : 1;
+	const U32 blockHeight = (inf.isCompressed()) ? inf.m_blockHeight : 1;
+	const U32 faceCount = textureTypeIsCube(init.m_type) ? 6 : 1;
+	const U32 mipCount = (init.m_type == TextureType::k3D)
+							 ? min(init.m_mipmapCount, computeMaxMipmapCount3d(init.m_width, init.m_height, init.m_depth))
+							 : min(init.m_mipmapCount, computeMaxMipmapCount2d(init.m_width, init.m_height));
+
+	PtrSize size = 0;
+	for(U32 mip = 0; mip < mipCount; ++mip)
+	{
+		const U32 width = getAlignedRoundUp(blockWidth, max(init.m_width >> mip, 1u));
+		const U32 height = getAlignedRoundUp(blockHeight, max(init.m_height >> mip, 1u));
+		const U32 depth = (init.m_type == TextureType::k3D) ? max(init.m_depth >> mip, 1u) : 1;
+
+		size += computeVolumeSize(width, height, depth, init.m_format) * faceCount * init.m_layerCount;
+	}
+
+	return size;
+}
+
+} // end namespace anki
@@ -0,0 +1,37 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/Texture.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+#include <AnKi/Util/HashMap.h>
+
+namespace anki {
+
+// Texture implementation. It has no memory, it only keeps the properties and the bindless indices.
+class TextureImpl final : public Texture
+{
+	friend class Texture;
+
+public:
+	TextureImpl(CString name, U32 uuid)
+		: Texture(name, uuid)
+	{
+	}
+
+	~TextureImpl();
+
+	Error init(const TextureInitInfo& init);
+
+	// The size the texture would have if it had memory.
+	static PtrSize getMemoryRequirement(const TextureInitInfo& init);
+
+private:
+	GrHashMap<U64, U32> m_bindlessIndices; // Subresource hash to bindless index
+	SpinLock m_bindlessIndicesLock;
+};
+
+} // end namespace anki
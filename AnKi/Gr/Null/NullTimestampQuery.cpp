@@ -0,0 +1,28 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Gr/Null/NullTimestampQuery.h>
+
+namespace anki {
+
+TimestampQuery* TimestampQuery::newInstance(U32 uuid)
+{
+	return anki::newInstance<TimestampQueryImpl>(GrMemoryPool::getSingleton(), "N/A", uuid);
+}
+
+TimestampQueryResult TimestampQuery::getResult(Second& timestamp) const
+{
+	ANKI_NULL_SELF_CONST(TimestampQueryImpl);
+
+	if(self.m_timestamp < 0.0)
+	{
+		return TimestampQueryResult::kNotAvailable;
+	}
+
+	timestamp = self.m_timestamp;
+	return TimestampQueryResult::kAvailable;
+}
+
+} // end namespace anki
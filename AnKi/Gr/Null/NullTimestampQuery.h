@@ -0,0 +1,25 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Gr/TimestampQuery.h>
+#include <AnKi/Gr/Null/NullCommon.h>
+
+namespace anki {
+
+// Timestamp query implementation. The timestamp is the CPU time of the submission of the command buffer that wrote it.
+class TimestampQueryImpl final : public TimestampQuery
+{
+public:
+	Second m_timestamp = -1.0; // Negative if it hasn't been submitted
+
+	TimestampQueryImpl(CString name, U32 uuid)
+		: TimestampQuery(name, uuid)
+	{
+	}
+};
+
+} // end namespace anki
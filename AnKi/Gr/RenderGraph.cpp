@@ -459,11 +459,8 @@ void RenderGraph::reset()
 		{
 			const U32 surfOrVolumeCount = getTextureSurfOrVolCount(rt.m_texture);
 
-			// Create a new hash because our hash map dislikes concurent keys.
 			const U64 uuid = rt.m_texture->getUuid();
-			const U64 hash = computeHash(&uuid, sizeof(uuid));
-
-			auto it = m_importedRenderTargets.find(hash);
+			auto it = m_importedRenderTargets.find(uuid);
 			if(it != m_importedRenderTargets.getEnd())
 			{
 				// Found
@@ -473,7 +470,7 @@ void RenderGraph::reset()
 			else
 			{
 				// Not found, create
-				it = m_importedRenderTargets.emplace(hash);
+				it = m_importedRenderTargets.emplace(uuid);
 				it->m_surfOrVolLastUsages.resize(surfOrVolumeCount);
 			}
 
@@ -634,12 +631,7 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphBuilder& desc
 		if(imported && inRt.m_importedAndUndefinedUsage)
 		{
 			// Get the usage from previous frames
-
-			// Create a new hash because our hash map dislikes concurent keys.
-			const U64 uuid = outRt.m_texture->getUuid();
-			const U64 hash = computeHash(&uuid, sizeof(uuid));
-
-			auto it = m_importedRenderTargets.find(hash);
+			auto it = m_importedRenderTargets.find(outRt.m_texture->getUuid());
 			ANKI_ASSERT(it != m_importedRenderTargets.getEnd() && "Can't find the imported RT");
 
 			ANKI_ASSERT(it->m_surfOrVolLastUsages.getSize() == surfOrVolumeCount);
@@ -414,7 +414,7 @@ private:
 	SegregatedListsGpuMemoryPool m_texMemPool;
 
 	GrHashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; // Non-imported render targets.
-	GrHashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets;
+	GrHashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets; // Keyed by the texture UUID.
 
 	BakeContext* m_ctx = nullptr;
 	U64 m_version = 0;
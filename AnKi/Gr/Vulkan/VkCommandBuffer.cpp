@@ -537,7 +537,10 @@ void CommandBuffer::drawIndexed(PrimitiveTopology topology, U32 count, U32 insta
 	ANKI_TRACE_FUNCTION();
 	ANKI_VK_SELF(CommandBufferImpl);
 	self.m_graphicsState.setPrimitiveTopology(topology);
-	self.drawcallCommon();
+	if(!self.drawcallCommon())
+	{
+		return;
+	}
 	vkCmdDrawIndexed(self.m_handle, count, instanceCount, firstIndex, baseVertex, baseInstance);
 }
 
@@ -546,7 +549,10 @@ void CommandBuffer::draw(PrimitiveTopology topology, U32 count, U32 instanceCoun
 	ANKI_TRACE_FUNCTION();
 	ANKI_VK_SELF(CommandBufferImpl);
 	self.m_graphicsState.setPrimitiveTopology(topology);
-	self.drawcallCommon();
+	if(!self.drawcallCommon())
+	{
+		return;
+	}
 	vkCmdDraw(self.m_handle, count, instanceCount, first, baseInstance);
 }
 
@@ -558,7 +564,10 @@ void CommandBuffer::drawIndirect(PrimitiveTopology topology, const BufferView& b
 
 	ANKI_VK_SELF(CommandBufferImpl);
 	self.m_graphicsState.setPrimitiveTopology(topology);
-	self.drawcallCommon();
+	if(!self.drawcallCommon())
+	{
+		return;
+	}
 
 	const BufferImpl& impl = static_cast<const BufferImpl&>(buff.getBuffer());
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::kIndirectDraw));
@@ -577,7 +586,10 @@ void CommandBuffer::drawIndexedIndirect(PrimitiveTopology topology, const Buffer
 
 	ANKI_VK_SELF(CommandBufferImpl);
 	self.m_graphicsState.setPrimitiveTopology(topology);
-	self.drawcallCommon();
+	if(!self.drawcallCommon())
+	{
+		return;
+	}
 
 	const BufferImpl& impl = static_cast<const BufferImpl&>(buff.getBuffer());
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::kIndirectDraw));
@@ -596,7 +608,10 @@ void CommandBuffer::drawIndexedIndirectCount(PrimitiveTopology topology, const B
 
 	ANKI_VK_SELF(CommandBufferImpl);
 	self.m_graphicsState.setPrimitiveTopology(topology);
-	self.drawcallCommon();
+	if(!self.drawcallCommon())
+	{
+		return;
+	}
 
 	ANKI_ASSERT(argBufferStride >= sizeof(DrawIndexedIndirectArgs));
 
@@ -626,7 +641,10 @@ void CommandBuffer::drawIndirectCount(PrimitiveTopology topology, const BufferVi
 
 	ANKI_VK_SELF(CommandBufferImpl);
 	self.m_graphicsState.setPrimitiveTopology(topology);
-	self.drawcallCommon();
+	if(!self.drawcallCommon())
+	{
+		return;
+	}
 
 	ANKI_ASSERT(argBufferStride >= sizeof(DrawIndirectArgs));
 
@@ -651,7 +669,10 @@ void CommandBuffer::drawMeshTasks(U32 groupCountX, U32 groupCountY, U32 groupCou
 	ANKI_TRACE_FUNCTION();
 	ANKI_VK_SELF(CommandBufferImpl);
 	ANKI_ASSERT(!!(getGrManagerImpl().getExtensions() & VulkanExtensions::kEXT_mesh_shader));
-	self.drawcallCommon();
+	if(!self.drawcallCommon())
+	{
+		return;
+	}
 	vkCmdDrawMeshTasksEXT(self.m_handle, groupCountX, groupCountY, groupCountZ);
 }
 
@@ -670,7 +691,10 @@ void CommandBuffer::drawMeshTasksIndirect(const BufferView& argBuffer, U32 drawC
 	ANKI_VK_SELF(CommandBufferImpl);
 
 	self.m_graphicsState.setPrimitiveTopology(PrimitiveTopology::kTriangles); // Not sure if that's needed
-	self.drawcallCommon();
+	if(!self.drawcallCommon())
+	{
+		return;
+	}
 	vkCmdDrawMeshTasksIndirectEXT(self.m_handle, impl.getHandle(), argBuffer.getOffset(), drawCount, sizeof(DispatchIndirectArgs));
 }
 
@@ -1261,7 +1285,7 @@ void CommandBufferImpl::endRecording()
 #endif
 }
 
-void CommandBufferImpl::drawcallCommon()
+Bool CommandBufferImpl::drawcallCommon()
 {
 	ANKI_TRACE_FUNCTION();
 
@@ -1271,12 +1295,16 @@ void CommandBufferImpl::drawcallCommon()
 	ANKI_ASSERT(m_insideRenderpass);
 
 	// Get or create ppline
-	m_graphicsProg->getGraphicsPipelineFactory().flushState(m_graphicsState, m_handle);
+	if(!m_graphicsProg->getGraphicsPipelineFactory().flushState(m_graphicsState, m_handle))
+	{
+		return false;
+	}
 
 	// Bind dsets
 	m_descriptorState.flush(m_handle, m_microCmdb->getDSAllocator());
 
 	ANKI_TRACE_INC_COUNTER(VkDrawcall, 1);
+	return true;
 }
 
 ANKI_FORCE_INLINE void CommandBufferImpl::dispatchCommon()
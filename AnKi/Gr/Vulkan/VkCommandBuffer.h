@@ -134,7 +134,8 @@ private:
 		ANKI_ASSERT(m_handle);
 	}
 
-	void drawcallCommon();
+	/// @return False if the draw should be skipped.
+	Bool drawcallCommon();
 
 	void dispatchCommon();
 
@@ -11,6 +11,9 @@
 
 namespace anki {
 
+ANKI_SVAR(InlinePipelineCreations, StatCategory::kGr, "Graphics PSOs created while recording this frame", StatFlag::kZeroEveryFrame)
+ANKI_SVAR(PrecreatedPipelines, StatCategory::kGr, "Graphics PSOs pre-created in the background", StatFlag::kNone)
+
 static VkViewport computeViewport(const U32 viewport[], U32 fbWidth, U32 fbHeight)
 {
 	const U32 minx = viewport[0];
@@ -47,13 +50,42 @@ static VkRect2D computeScissor(const U32 scissor[], U32 fbWidth, U32 fbHeight)
 
 GraphicsPipelineFactory::~GraphicsPipelineFactory()
 {
+	// Cancel the background creations that didn't start and wait for the rest
+	{
+		LockGuard lock(m_pendingMtx);
+
+		GrDynamicArray<PendingPipeline*> canceled;
+		for(PendingPipeline* pending : m_pending)
+		{
+			U32 expected = U32(PendingStatus::kQueued);
+			if(pending->m_status.compareExchange(expected, U32(PendingStatus::kCanceled)))
+			{
+				canceled.emplaceBack(pending);
+			}
+		}
+
+		// The jobs of the canceled PSOs will just drop their reference
+		for(PendingPipeline* pending : canceled)
+		{
+			m_pending.erase(m_pending.find(pending->m_globalHash));
+			releasePendingPipeline(pending);
+		}
+
+		while(m_pending.getSize())
+		{
+			m_pendingCond.wait(m_pendingMtx);
+		}
+	}
+
+	ANKI_ASSERT(m_pending.getSize() == 0);
+
 	for(auto pso : m_map)
 	{
 		vkDestroyPipeline(getVkDevice(), pso, nullptr);
 	}
 }
 
-void GraphicsPipelineFactory::flushState(GraphicsStateTracker& state, VkCommandBuffer& cmdb)
+Bool GraphicsPipelineFactory::flushState(GraphicsStateTracker& state, VkCommandBuffer& cmdb)
 {
 	const GraphicsStateTracker::StaticState& staticState = state.m_staticState;
 	GraphicsStateTracker::DynamicState& dynState = state.m_dynState;
@@ -171,10 +203,88 @@ void GraphicsPipelineFactory::flushState(GraphicsStateTracker& state, VkCommandB
 			vkCmdBindPipeline(cmdb, VK_PIPELINE_BIND_POINT_GRAPHICS, pso);
 		}
 
-		return;
+		return true;
 	}
 
-	// PSO not found, proactively create it WITHOUT a lock (we dont't want to serialize pipeline creation)
+	PendingPipeline* pending = nullptr;
+	{
+		LockGuard lock(m_pendingMtx);
+
+		auto pendingIt = m_pending.find(state.m_globalHash);
+		if(pendingIt != m_pending.getEnd())
+		{
+			// It's queued for background creation. If no worker picked it up yet create it here
+			U32 expected = U32(PendingStatus::kQueued);
+			if((*pendingIt)->m_status.compareExchange(expected, U32(PendingStatus::kCreating)))
+			{
+				pending = *pendingIt;
+			}
+			else if(g_cvarGrSkipDrawsWithPendingPipelines)
+			{
+				// Dirty the hashes to re-bind at the next draw
+				state.m_hashes.m_shaderProg = 0;
+				state.m_globalHash = 0;
+				return false;
+			}
+			else
+			{
+				// A worker is creating the PSO
+				ANKI_TRACE_SCOPED_EVENT(VkPipelineWait);
+				while(m_pending.find(state.m_globalHash) != m_pending.getEnd())
+				{
+					m_pendingCond.wait(m_pendingMtx);
+				}
+			}
+		}
+
+		if(!pending)
+		{
+			// The PSO might have been created by a worker in the meantime
+			RLockGuard lock2(m_mtx);
+
+			auto it = m_map.find(state.m_globalHash);
+			if(it != m_map.getEnd())
+			{
+				pso = *it;
+			}
+		}
+	}
+
+	if(!pso)
+	{
+		// PSO not found, proactively create it WITHOUT a lock (we dont't want to serialize pipeline creation)
+		g_svarInlinePipelineCreations.increment(1);
+		pso = createPipeline(staticState);
+		addPipeline(state.m_globalHash, pso);
+
+		if(pending)
+		{
+			removePendingPipeline(pending);
+		}
+
+		PipelineCache::getSingleton().m_pipelineKeys.recordKey(m_persistentHash, state);
+	}
+
+	// Final thing, bind the PSO
+	vkCmdBindPipeline(cmdb, VK_PIPELINE_BIND_POINT_GRAPHICS, pso);
+	return true;
+}
+
+VkPipeline GraphicsPipelineFactory::createPipeline(const GraphicsStateTracker::StaticState& staticState)
+{
+	const auto& ss = staticState.m_stencil;
+	const Bool stencilTestEnabled = anki::stencilTestEnabled(ss.m_face[0].m_fail, ss.m_face[0].m_stencilPassDepthFail,
+															 ss.m_face[0].m_stencilPassDepthPass, ss.m_face[0].m_compare)
+									|| anki::stencilTestEnabled(ss.m_face[1].m_fail, ss.m_face[1].m_stencilPassDepthFail,
+																ss.m_face[1].m_stencilPassDepthPass, ss.m_face[1].m_compare);
+
+	const Bool hasStencilRt =
+		staticState.m_misc.m_depthStencilFormat != Format::kNone && getFormatInfo(staticState.m_misc.m_depthStencilFormat).isStencil();
+
+	const Bool hasDepthRt =
+		staticState.m_misc.m_depthStencilFormat != Format::kNone && getFormatInfo(staticState.m_misc.m_depthStencilFormat).isDepth();
+
+	const Bool depthTestEnabled = anki::depthTestEnabled(staticState.m_depth.m_compare, staticState.m_depth.m_writeEnabled);
 
 	const ShaderProgramImpl& prog = static_cast<const ShaderProgramImpl&>(*staticState.m_shaderProg);
 
@@ -355,6 +465,7 @@ void GraphicsPipelineFactory::flushState(GraphicsStateTracker& state, VkCommandB
 	ci.subpass = 0;
 
 	// Create the pipeline
+	VkPipeline pso;
 	{
 		ANKI_TRACE_SCOPED_EVENT(VkPipelineCreate);
 
@@ -377,26 +488,109 @@ void GraphicsPipelineFactory::flushState(GraphicsStateTracker& state, VkCommandB
 #endif
 	}
 
-	// Now try to add the PSO to the hashmap
+	return pso;
+}
+
+void GraphicsPipelineFactory::addPipeline(U64 globalHash, VkPipeline& pso)
+{
+	WLockGuard lock(m_mtx);
+
+	auto it = m_map.find(globalHash);
+	if(it == m_map.getEnd())
 	{
-		WLockGuard lock(m_mtx);
+		// Not found, add it
+		m_map.emplace(globalHash, pso);
+	}
+	else
+	{
+		// Found, remove the PSO that was proactively created and use the old one
+		vkDestroyPipeline(getVkDevice(), pso, nullptr);
+		pso = *it;
+	}
+}
 
-		auto it = m_map.find(state.m_globalHash);
-		if(it == m_map.getEnd())
-		{
-			// Not found, add it
-			m_map.emplace(state.m_globalHash, pso);
-		}
-		else
+void GraphicsPipelineFactory::removePendingPipeline(PendingPipeline* pending)
+{
+	LockGuard lock(m_pendingMtx);
+	m_pending.erase(m_pending.find(pending->m_globalHash));
+	releasePendingPipeline(pending);
+	m_pendingCond.notifyAll();
+}
+
+void GraphicsPipelineFactory::releasePendingPipeline(PendingPipeline* pending)
+{
+	if(pending->m_refcount.fetchSub(1) == 1)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), pending);
+	}
+}
+
+void GraphicsPipelineFactory::precreatePipelines()
+{
+	PipelineCache& cache = PipelineCache::getSingleton();
+	if(!cache.m_precreationJobManager)
+	{
+		return;
+	}
+
+	GrDynamicArray<GraphicsStateTracker::StaticState> states;
+	cache.m_pipelineKeys.getKeys(m_persistentHash, states);
+
+	for(const GraphicsStateTracker::StaticState& staticState : states)
+	{
+		// Compute the hash the PSO will have in this session
+		GraphicsStateTracker state;
+		state.m_staticState = staticState;
+		state.m_staticState.m_shaderProg = m_prog;
+		state.updateHashes();
+
+		PendingPipeline* pending;
 		{
-			// Found, remove the PSO that was proactively created and use the old one
-			vkDestroyPipeline(getVkDevice(), pso, nullptr);
-			pso = *it;
+			LockGuard lock(m_pendingMtx);
+
+			if(m_pending.find(state.m_globalHash) != m_pending.getEnd())
+			{
+				continue;
+			}
+
+			{
+				RLockGuard lock2(m_mtx);
+				if(m_map.find(state.m_globalHash) != m_map.getEnd())
+				{
+					continue;
+				}
+			}
+
+			pending = newInstance<PendingPipeline>(GrMemoryPool::getSingleton());
+			pending->m_factory = this;
+			pending->m_globalHash = state.m_globalHash;
+			pending->m_state = state.m_staticState;
+			m_pending.emplace(state.m_globalHash, pending);
 		}
+
+		// The job doesn't touch the factory if the PSO got canceled so it can outlive it
+		LockGuard lock(cache.m_precreationDispatchMtx);
+		cache.m_precreationJobManager->dispatchTask([pending]([[maybe_unused]] U32 tid) {
+			precreatePipeline(pending);
+		});
 	}
+}
 
-	// Final thing, bind the PSO
-	vkCmdBindPipeline(cmdb, VK_PIPELINE_BIND_POINT_GRAPHICS, pso);
+void GraphicsPipelineFactory::precreatePipeline(PendingPipeline* pending)
+{
+	U32 expected = U32(PendingStatus::kQueued);
+	if(pending->m_status.compareExchange(expected, U32(PendingStatus::kCreating)))
+	{
+		GraphicsPipelineFactory& self = *pending->m_factory;
+		VkPipeline pso = createPipeline(pending->m_state);
+		self.addPipeline(pending->m_globalHash, pso);
+		g_svarPrecreatedPipelines.increment(1);
+
+		// The factory might get deleted after that
+		self.removePendingPipeline(pending);
+	}
+
+	releasePendingPipeline(pending);
 }
 
 Error PipelineCache::init(CString cacheDir)
@@ -454,6 +648,15 @@ Error PipelineCache::init(CString cacheDir)
 
 	ANKI_VK_CHECK(vkCreatePipelineCache(getVkDevice(), &ci, nullptr, &m_cacheHandle));
 
+	// Load the PSO keys of the previous sessions
+	m_pipelineKeysFilename.sprintf("%s/GraphicsPipelineKeys", cacheDir.cstr());
+	ANKI_CHECK(m_pipelineKeys.load(m_pipelineKeysFilename.toCString()));
+
+	if(m_pipelineKeys.getKeyCount() && g_cvarGrPipelinePrecreationThreadCount > 0)
+	{
+		m_precreationJobManager = anki::newInstance<ThreadJobManager>(GrMemoryPool::getSingleton(), U32(g_cvarGrPipelinePrecreationThreadCount));
+	}
+
 #if ANKI_PLATFORM_MOBILE
 	ANKI_ASSERT(GrManager::getSingleton().getDeviceCapabilities().m_gpuVendor != GpuVendor::kUnknown);
 	if(GrManager::getSingleton().getDeviceCapabilities().m_gpuVendor == GpuVendor::kQualcomm)
@@ -469,6 +672,19 @@ Error PipelineCache::init(CString cacheDir)
 
 void PipelineCache::destroy()
 {
+	// All the GraphicsPipelineFactories are gone by now. Run the jobs of the canceled PSOs so they free their data
+	if(m_precreationJobManager)
+	{
+		m_precreationJobManager->waitForAllTasksToFinish();
+		deleteInstance(GrMemoryPool::getSingleton(), m_precreationJobManager);
+		m_precreationJobManager = nullptr;
+	}
+
+	if(!m_pipelineKeysFilename.isEmpty() && m_pipelineKeys.store(m_pipelineKeysFilename.toCString()))
+	{
+		ANKI_VK_LOGE("An error occurred while storing the PSO keys to disk. Will ignore");
+	}
+
 	const Error err = destroyInternal();
 	if(err)
 	{
@@ -476,6 +692,7 @@ void PipelineCache::destroy()
 	}
 
 	m_dumpFilename.destroy();
+	m_pipelineKeysFilename.destroy();
 }
 
 Error PipelineCache::destroyInternal()
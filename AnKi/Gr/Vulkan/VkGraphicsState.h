@@ -8,30 +8,92 @@
 #include <AnKi/Gr/Vulkan/VkCommon.h>
 #include <AnKi/Gr/ShaderProgram.h>
 #include <AnKi/Gr/BackendCommon/GraphicsStateTracker.h>
+#include <AnKi/Gr/BackendCommon/GraphicsPipelineKeyDatabase.h>
 #include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/ThreadJobManager.h>
 
 namespace anki {
 
+// Forward
+class ShaderProgramImpl;
+
+ANKI_CVAR(NumericCVar<U8>, Gr, PipelinePrecreationThreadCount, 2, 0, 16,
+		  "Number of threads that pre-create the PSOs of the previous sessions. 0 disables the pre-creation")
+ANKI_CVAR(BoolCVar, Gr, SkipDrawsWithPendingPipelines, false,
+		  "If a draw needs a PSO that is being created in the background skip the draw instead of waiting")
+
 /// @addtogroup vulkan
 /// @{
 
+/// Creates and caches the graphics PSOs of a single ShaderProgram.
 class GraphicsPipelineFactory
 {
 public:
+	/// @param persistentHash A hash of the program that stays the same across sessions. See PipelineCache.
+	GraphicsPipelineFactory(ShaderProgramImpl& prog, U64 persistentHash)
+		: m_prog(&prog)
+		, m_persistentHash(persistentHash)
+	{
+	}
+
 	~GraphicsPipelineFactory();
 
+	/// Create in the background the PSOs that the previous sessions used with this program. Call it when the program is fully initialized.
+	void precreatePipelines();
+
 	/// Write state to the command buffer.
 	/// @note It's thread-safe.
-	void flushState(GraphicsStateTracker& state, VkCommandBuffer& cmdb);
+	/// @return False if the draw should be skipped because the PSO is still being created in the background.
+	Bool flushState(GraphicsStateTracker& state, VkCommandBuffer& cmdb);
 
 private:
+	enum class PendingStatus : U32
+	{
+		kQueued,
+		kCreating,
+		kCanceled
+	};
+
+	/// A PSO that was queued for background creation. It's referenced by m_pending and by the job that creates it.
+	class PendingPipeline
+	{
+	public:
+		GraphicsPipelineFactory* m_factory = nullptr;
+		U64 m_globalHash = 0;
+		GraphicsStateTracker::StaticState m_state;
+		Atomic<U32> m_status = {U32(PendingStatus::kQueued)};
+		Atomic<U32> m_refcount = {2};
+	};
+
+	ShaderProgramImpl* m_prog = nullptr;
+	U64 m_persistentHash = 0;
+
 	GrHashMap<U64, VkPipeline> m_map;
 	RWMutex m_mtx;
+
+	GrHashMap<U64, PendingPipeline*> m_pending;
+	Mutex m_pendingMtx; ///< Protects m_pending. Lock it before m_mtx if both are needed.
+	ConditionVariable m_pendingCond; ///< Signaled when a PSO stops being pending.
+
+	static VkPipeline createPipeline(const GraphicsStateTracker::StaticState& staticState);
+
+	/// Add the PSO to the map. If there is one already the pso gets destroyed and replaced by the existing one.
+	void addPipeline(U64 globalHash, VkPipeline& pso);
+
+	/// Remove a PSO that got created from m_pending and wake up the threads that wait for it.
+	void removePendingPipeline(PendingPipeline* pending);
+
+	static void releasePendingPipeline(PendingPipeline* pending);
+
+	static void precreatePipeline(PendingPipeline* pending);
 };
 
-/// On disk pipeline cache.
+/// On disk pipeline cache. Apart from the driver's cache it also stores the static state of every graphics PSO that was created. At the next
+/// session the GraphicsPipelineFactory re-creates those PSOs in the background before the first draw that needs them.
 class PipelineCache : public MakeSingleton<PipelineCache>
 {
+	friend class GraphicsPipelineFactory;
+
 public:
 	VkPipelineCache m_cacheHandle = VK_NULL_HANDLE;
 #if ANKI_PLATFORM_MOBILE
@@ -50,6 +112,12 @@ private:
 	GrString m_dumpFilename;
 	PtrSize m_dumpSize = 0;
 
+	GrString m_pipelineKeysFilename;
+	GraphicsPipelineKeyDatabase m_pipelineKeys;
+
+	ThreadJobManager* m_precreationJobManager = nullptr;
+	Mutex m_precreationDispatchMtx; ///< The programs are created by many threads but ThreadJobManager accepts tasks from one thread at a time.
+
 	void destroy();
 	Error destroyInternal();
 };
@@ -121,6 +121,12 @@ ConstWeakArray<U8> ShaderProgram::getShaderGroupHandles() const
 
 ShaderProgramImpl::~ShaderProgramImpl()
 {
+	// Delete the factory first because it waits for the PSOs that are being created in the background
+	if(m_graphics.m_pplineFactory)
+	{
+		deleteInstance(GrMemoryPool::getSingleton(), m_graphics.m_pplineFactory);
+	}
+
 	const Bool graphicsProg = !!(m_shaderTypes & ShaderTypeBit::kAllGraphics);
 	if(graphicsProg)
 	{
@@ -133,11 +139,6 @@ ShaderProgramImpl::~ShaderProgramImpl()
 		}
 	}
 
-	if(m_graphics.m_pplineFactory)
-	{
-		deleteInstance(GrMemoryPool::getSingleton(), m_graphics.m_pplineFactory);
-	}
-
 	if(m_compute.m_ppline)
 	{
 		vkDestroyPipeline(getVkDevice(), m_compute.m_ppline, nullptr);
@@ -289,7 +290,14 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 	//
 	if(graphicsProg)
 	{
-		m_graphics.m_pplineFactory = anki::newInstance<GraphicsPipelineFactory>(GrMemoryPool::getSingleton());
+		// The UUID changes every session so use a hash of the code to identify the program in the PSO key database
+		U64 persistentHash = U64(m_shaderTypes);
+		for(const GrDynamicArray<U32>& spirv : rewrittenSpirvs)
+		{
+			persistentHash = appendHash(spirv.getBegin(), spirv.getSizeInBytes(), persistentHash);
+		}
+
+		m_graphics.m_pplineFactory = anki::newInstance<GraphicsPipelineFactory>(GrMemoryPool::getSingleton(), *this, persistentHash);
 	}
 
 	// Create the pipeline if compute
@@ -437,6 +445,13 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 		}
 	}
 
+	// Graphics programs are ready, start creating the PSOs of the previous sessions
+	//
+	if(graphicsProg)
+	{
+		m_graphics.m_pplineFactory->precreatePipelines();
+	}
+
 	return Error::kNone;
 }
 
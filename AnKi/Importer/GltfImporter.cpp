@@ -122,7 +122,7 @@ static Error getNodeTransform(const cgltf_node& node, Transform& trf)
 	return Error::kNone;
 }
 
-static Bool stringsExist(const ImporterHashMap<CString, ImporterString>& map, const std::initializer_list<CString>& list)
+static Bool stringsExist(const ImporterHashMap<ImporterString, ImporterString>& map, const std::initializer_list<CString>& list)
 {
 	for(CString item : list)
 	{
@@ -135,10 +135,10 @@ static Bool stringsExist(const ImporterHashMap<CString, ImporterString>& map, co
 	return false;
 }
 
-static Error getExtra(const ImporterHashMap<CString, ImporterString>& extras, CString name, F32& val, Bool& found)
+static Error getExtra(const ImporterHashMap<ImporterString, ImporterString>& extras, CString name, F32& val, Bool& found)
 {
 	found = false;
-	ImporterHashMap<CString, ImporterString>::ConstIterator it = extras.find(name);
+	ImporterHashMap<ImporterString, ImporterString>::ConstIterator it = extras.find(name);
 
 	if(it != extras.getEnd())
 	{
@@ -155,10 +155,10 @@ static Error getExtra(const ImporterHashMap<CString, ImporterString>& extras, CS
 	return Error::kNone;
 }
 
-static Error getExtra(const ImporterHashMap<CString, ImporterString>& extras, CString name, ImporterString& val, Bool& found)
+static Error getExtra(const ImporterHashMap<ImporterString, ImporterString>& extras, CString name, ImporterString& val, Bool& found)
 {
 	found = false;
-	ImporterHashMap<CString, ImporterString>::ConstIterator it = extras.find(name);
+	ImporterHashMap<ImporterString, ImporterString>::ConstIterator it = extras.find(name);
 
 	if(it != extras.getEnd())
 	{
@@ -169,10 +169,10 @@ static Error getExtra(const ImporterHashMap<CString, ImporterString>& extras, CS
 	return Error::kNone;
 }
 
-static Error getExtra(const ImporterHashMap<CString, ImporterString>& extras, CString name, Bool& val, Bool& found)
+static Error getExtra(const ImporterHashMap<ImporterString, ImporterString>& extras, CString name, Bool& val, Bool& found)
 {
 	found = false;
-	ImporterHashMap<CString, ImporterString>::ConstIterator it = extras.find(name);
+	ImporterHashMap<ImporterString, ImporterString>::ConstIterator it = extras.find(name);
 
 	if(it != extras.getEnd())
 	{
@@ -203,10 +203,10 @@ static Error getExtra(const ImporterHashMap<CString, ImporterString>& extras, CS
 	return Error::kNone;
 }
 
-static Error getExtra(const ImporterHashMap<CString, ImporterString>& extras, CString name, Vec3& val, Bool& found)
+static Error getExtra(const ImporterHashMap<ImporterString, ImporterString>& extras, CString name, Vec3& val, Bool& found)
 {
 	found = false;
-	ImporterHashMap<CString, ImporterString>::ConstIterator it = extras.find(name);
+	ImporterHashMap<ImporterString, ImporterString>::ConstIterator it = extras.find(name);
 
 	if(it != extras.getEnd())
 	{
@@ -343,7 +343,7 @@ Error GltfImporter::writeAll()
 	{
 		for(cgltf_node* const* node = scene->nodes; node < scene->nodes + scene->nodes_count; ++node)
 		{
-			ANKI_CHECK(visitNode(*(*node), Transform::getIdentity(), ImporterHashMap<CString, ImporterString>()));
+			ANKI_CHECK(visitNode(*(*node), Transform::getIdentity(), ImporterHashMap<ImporterString, ImporterString>()));
 		}
 	}
 
@@ -442,7 +442,7 @@ Error GltfImporter::writeAll()
 	return Error::kNone;
 }
 
-Error GltfImporter::appendExtras(const cgltf_extras& extras, ImporterHashMap<CString, ImporterString>& out) const
+Error GltfImporter::appendExtras(const cgltf_extras& extras, ImporterHashMap<ImporterString, ImporterString>& out) const
 {
 	cgltf_size extrasSize;
 	cgltf_copy_extras_json(m_gltf, &extras, nullptr, &extrasSize);
@@ -512,12 +512,11 @@ Error GltfImporter::appendExtras(const cgltf_extras& extras, ImporterHashMap<CSt
 	return Error::kNone;
 }
 
-static void appendExtrasMap(const ImporterHashMap<CString, ImporterString>& in, ImporterHashMap<CString, ImporterString>& out)
+static void appendExtrasMap(const ImporterHashMap<ImporterString, ImporterString>& in, ImporterHashMap<ImporterString, ImporterString>& out)
 {
-	auto& outs = out.getSparseArray();
 	for(auto it = in.getBegin(); it != in.getEnd(); ++it)
 	{
-		outs.emplace(it.getKey(), *it);
+		out.emplace(it.getKey(), *it);
 	}
 }
 
@@ -592,7 +591,7 @@ Error GltfImporter::parseArrayOfNumbers(CString str, ImporterDynamicArray<F64>&
 	return Error::kNone;
 }
 
-Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf, const ImporterHashMap<CString, ImporterString>& parentExtras)
+Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf, const ImporterHashMap<ImporterString, ImporterString>& parentExtras)
 {
 	// Check error from a thread
 	const Error threadErr = m_errorInThread.load();
@@ -602,10 +601,10 @@ Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf
 		return threadErr;
 	}
 
-	ImporterHashMap<CString, ImporterString> outExtras;
+	ImporterHashMap<ImporterString, ImporterString> outExtras;
 	if(node.light)
 	{
-		ImporterHashMap<CString, ImporterString> extras;
+		ImporterHashMap<ImporterString, ImporterString> extras;
 		ANKI_CHECK(appendExtras(node.light->extras, extras));
 		ANKI_CHECK(appendExtras(node.extras, extras));
 		appendExtrasMap(parentExtras, extras);
@@ -619,7 +618,7 @@ Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf
 	}
 	else if(node.camera)
 	{
-		ImporterHashMap<CString, ImporterString> extras;
+		ImporterHashMap<ImporterString, ImporterString> extras;
 		ANKI_CHECK(appendExtras(node.camera->extras, extras));
 		ANKI_CHECK(appendExtras(node.extras, extras));
 		appendExtrasMap(parentExtras, extras);
@@ -634,7 +633,7 @@ Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf
 	else if(node.mesh)
 	{
 		// Handle special nodes
-		ImporterHashMap<CString, ImporterString> extras;
+		ImporterHashMap<ImporterString, ImporterString> extras;
 		ANKI_CHECK(appendExtras(node.mesh->extras, extras));
 		ANKI_CHECK(appendExtras(node.extras, extras));
 		appendExtrasMap(parentExtras, extras);
@@ -855,7 +854,7 @@ Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf
 					addRequest<const cgltf_skin*>(node.skin, m_skinImportRequests);
 				}
 
-				ImporterHashMap<CString, ImporterString>::Iterator it2;
+				ImporterHashMap<ImporterString, ImporterString>::Iterator it2;
 				const Bool selfCollision = (it2 = extras.find("collision_mesh")) != extras.getEnd() && *it2 == "self";
 
 				ANKI_CHECK(writeMeshMaterialNode(node, parentExtras));
@@ -985,13 +984,13 @@ Error GltfImporter::writeSkeleton(const cgltf_skin& skin) const
 	return Error::kNone;
 }
 
-Error GltfImporter::writeLight(const cgltf_node& node, const ImporterHashMap<CString, ImporterString>& parentExtras)
+Error GltfImporter::writeLight(const cgltf_node& node, const ImporterHashMap<ImporterString, ImporterString>& parentExtras)
 {
 	const cgltf_light& light = *node.light;
 	ImporterString nodeName = getNodeName(node);
 	ANKI_IMPORTER_LOGV("Importing light %s", nodeName.cstr());
 
-	ImporterHashMap<CString, ImporterString> extras(parentExtras);
+	ImporterHashMap<ImporterString, ImporterString> extras(parentExtras);
 	ANKI_CHECK(appendExtras(light.extras, extras));
 	ANKI_CHECK(appendExtras(node.extras, extras));
 
@@ -1119,7 +1118,7 @@ Error GltfImporter::writeLight(const cgltf_node& node, const ImporterHashMap<CSt
 	return Error::kNone;
 }
 
-Error GltfImporter::writeCamera(const cgltf_node& node, [[maybe_unused]] const ImporterHashMap<CString, ImporterString>& parentExtras)
+Error GltfImporter::writeCamera(const cgltf_node& node, [[maybe_unused]] const ImporterHashMap<ImporterString, ImporterString>& parentExtras)
 {
 	if(node.camera->type != cgltf_camera_type_perspective)
 	{
@@ -1140,11 +1139,11 @@ Error GltfImporter::writeCamera(const cgltf_node& node, [[maybe_unused]] const I
 	return Error::kNone;
 }
 
-Error GltfImporter::writeMeshMaterialNode(const cgltf_node& node, const ImporterHashMap<CString, ImporterString>& parentExtras)
+Error GltfImporter::writeMeshMaterialNode(const cgltf_node& node, const ImporterHashMap<ImporterString, ImporterString>& parentExtras)
 {
 	ANKI_IMPORTER_LOGV("Importing mesh&material node %s", getNodeName(node).cstr());
 
-	ImporterHashMap<CString, ImporterString> extras(parentExtras);
+	ImporterHashMap<ImporterString, ImporterString> extras(parentExtras);
 	ANKI_CHECK(appendExtras(node.extras, extras));
 
 	ANKI_CHECK(m_sceneFile.writeTextf("\nnode = scene:newSceneNode(\"%s\")\n", getNodeName(node).cstr()));
@@ -121,7 +121,7 @@ private:
 		}
 	}
 
-	Error appendExtras(const cgltf_extras& extras, ImporterHashMap<CString, ImporterString>& out) const;
+	Error appendExtras(const cgltf_extras& extras, ImporterHashMap<ImporterString, ImporterString>& out) const;
 	Error parseArrayOfNumbers(CString str, ImporterDynamicArray<F64>& out, const U32* expectedArraySize = nullptr);
 	void populateNodePtrToIdx();
 	void populateNodePtrToIdxInternal(const cgltf_node& node, U32& idx);
@@ -175,10 +175,10 @@ private:
 
 	// Scene
 	Error writeTransform(const Transform& trf);
-	Error visitNode(const cgltf_node& node, const Transform& parentTrf, const ImporterHashMap<CString, ImporterString>& parentExtras);
-	Error writeLight(const cgltf_node& node, const ImporterHashMap<CString, ImporterString>& parentExtras);
-	Error writeCamera(const cgltf_node& node, const ImporterHashMap<CString, ImporterString>& parentExtras);
-	Error writeMeshMaterialNode(const cgltf_node& node, const ImporterHashMap<CString, ImporterString>& parentExtras);
+	Error visitNode(const cgltf_node& node, const Transform& parentTrf, const ImporterHashMap<ImporterString, ImporterString>& parentExtras);
+	Error writeLight(const cgltf_node& node, const ImporterHashMap<ImporterString, ImporterString>& parentExtras);
+	Error writeCamera(const cgltf_node& node, const ImporterHashMap<ImporterString, ImporterString>& parentExtras);
+	Error writeMeshMaterialNode(const cgltf_node& node, const ImporterHashMap<ImporterString, ImporterString>& parentExtras);
 };
 
 template<typename T, typename TFunc>
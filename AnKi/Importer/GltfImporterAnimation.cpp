@@ -4,106 +4,79 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Importer/GltfImporter.h>
-#include <AnKi/Util/Xml.h>
+#include <AnKi/Resource/AnimationResource.h>
 
 namespace anki {
 
-template<typename T>
-class GltfAnimKey
-{
-public:
-	Second m_time;
-	T m_value;
-};
-
 class GltfAnimChannel
 {
 public:
 	ImporterString m_name;
-	ImporterDynamicArray<GltfAnimKey<Vec3>> m_positions;
-	ImporterDynamicArray<GltfAnimKey<Quat>> m_rotations;
-	ImporterDynamicArray<GltfAnimKey<F32>> m_scales;
+	ImporterDynamicArray<AnimationKeyframe<Vec3>> m_positions;
+	ImporterDynamicArray<AnimationKeyframe<Quat>> m_rotations;
+	ImporterDynamicArray<AnimationKeyframe<F32>> m_scales;
 	const cgltf_node* m_targetNode;
 };
 
-/// Optimize out same animation keys.
+/// Fit a piecewise linear curve to the keys. Every segment is extended for as long as the keys it skips can be reconstructed by interpolating
+/// its ends.
 template<typename T, typename TIsIdentityFunc, typename TAlmostEqualFunc, typename TLerpFunc>
-static void optimizeChannel(ImporterDynamicArray<GltfAnimKey<T>>& arr, TIsIdentityFunc isIdentityFunc, TAlmostEqualFunc almostEqualFunc,
+static void optimizeChannel(ImporterDynamicArray<AnimationKeyframe<T>>& arr, TIsIdentityFunc isIdentityFunc, TAlmostEqualFunc almostEqualFunc,
 							TLerpFunc lerpFunc)
 {
-	constexpr F32 kMinSkippedToTotalRatio = 0.1f;
-
-	U32 iterationCount = 0;
-	while(true)
+	if(arr.getSize() == 0)
 	{
-		if(arr.getSize() < 3)
-		{
-			break;
-		}
+		return;
+	}
 
-		ImporterDynamicArray<GltfAnimKey<T>> newArr;
-		U32 it = 0;
-		while(true)
-		{
-			const GltfAnimKey<T>& left = arr[it];
-			const GltfAnimKey<T>& middle = arr[it + 1];
-			const GltfAnimKey<T>& right = arr[it + 2];
+	ImporterDynamicArray<AnimationKeyframe<T>> newArr;
+	newArr.emplaceBack(arr[0]);
 
-			newArr.emplaceBack(left);
+	U32 anchor = 0;
+	while(anchor + 1 < arr.getSize())
+	{
+		// Find the furthest key the segment can reach
+		U32 end = anchor + 1;
+		while(end + 1 < arr.getSize())
+		{
+			const U32 candidate = end + 1;
+			const Second segmentDuration = arr[candidate].getTime() - arr[anchor].getTime();
 
-			if(left.m_value == middle.m_value && middle.m_value == right.m_value)
+			Bool fits = segmentDuration > 0.0;
+			for(U32 i = anchor + 1; i < candidate && fits; ++i)
 			{
-				// Skip it
-			}
-			else
-			{
-				const F32 factor = F32((middle.m_time - left.m_time) / (right.m_time - left.m_time));
-				ANKI_ASSERT(factor > 0.0f && factor < 1.0f);
-				const T lerpRez = lerpFunc(left.m_value, right.m_value, factor);
-				if(almostEqualFunc(middle.m_value, lerpRez))
-				{
-					// It's redundant, skip it
-				}
-				else
-				{
-					newArr.emplaceBack(middle);
-				}
+				const F32 factor = F32((arr[i].getTime() - arr[anchor].getTime()) / segmentDuration);
+				fits = almostEqualFunc(arr[i].getValue(), lerpFunc(arr[anchor].getValue(), arr[candidate].getValue(), factor));
 			}
 
-			it += 2;
-			if(it + 2 >= arr.getSize())
+			if(!fits)
 			{
 				break;
 			}
-		}
-
-		for(; it < arr.getSize(); ++it)
-		{
-			newArr.emplaceBack(arr[it]);
-		}
 
-		ANKI_ASSERT(newArr.getSize() <= arr.getSize());
-
-		// Check if identity
-		if(newArr.getSize() == 2 && isIdentityFunc(newArr[0].m_value) && isIdentityFunc(newArr[1].m_value))
-		{
-			newArr.destroy();
+			end = candidate;
 		}
 
-		const F32 skippedToTotalRatio = 1.0f - F32(newArr.getSize()) / F32(arr.getSize());
-
-		arr.destroy();
-		arr = std::move(newArr);
+		newArr.emplaceBack(arr[end]);
+		anchor = end;
+	}
 
-		++iterationCount;
+	// A constant track needs a single key
+	if(newArr.getSize() == 2 && almostEqualFunc(newArr[0].getValue(), newArr[1].getValue()))
+	{
+		newArr.popBack();
+	}
 
-		if(skippedToTotalRatio <= kMinSkippedToTotalRatio)
-		{
-			break;
-		}
+	// Check if identity
+	if(newArr.getSize() == 1 && isIdentityFunc(newArr[0].getValue()))
+	{
+		newArr.destroy();
 	}
 
-	ANKI_IMPORTER_LOGV("Channel optimization iteration count: %u", iterationCount);
+	ANKI_IMPORTER_LOGV("Channel optimization: %u keys to %u", arr.getSize(), newArr.getSize());
+
+	arr.destroy();
+	arr = std::move(newArr);
 }
 
 Error GltfImporter::writeAnimation(const cgltf_animation& anim)
@@ -182,11 +155,7 @@ Error GltfImporter::writeAnimation(const cgltf_animation& anim)
 
 			for(U32 i = 0; i < keys.getSize(); ++i)
 			{
-				GltfAnimKey<Vec3> key;
-				key.m_time = keys[i];
-				key.m_value = Vec3(positions[i].x, positions[i].y, positions[i].z);
-
-				tempChannels[channelCount].m_positions.emplaceBack(key);
+				tempChannels[channelCount].m_positions.emplaceBack(keys[i], Vec3(positions[i].x, positions[i].y, positions[i].z));
 			}
 		}
 
@@ -206,11 +175,7 @@ Error GltfImporter::writeAnimation(const cgltf_animation& anim)
 
 			for(U32 i = 0; i < keys.getSize(); ++i)
 			{
-				GltfAnimKey<Quat> key;
-				key.m_time = keys[i];
-				key.m_value = Quat(rotations[i].x, rotations[i].y, rotations[i].z, rotations[i].w);
-
-				tempChannels[channelCount].m_rotations.emplaceBack(key);
+				tempChannels[channelCount].m_rotations.emplaceBack(keys[i], Quat(rotations[i].x, rotations[i].y, rotations[i].z, rotations[i].w));
 			}
 		}
 
@@ -242,16 +207,13 @@ Error GltfImporter::writeAnimation(const cgltf_animation& anim)
 					scaleErrorReported = true;
 				}
 
-				GltfAnimKey<F32> key;
-				key.m_time = keys[i];
-				key.m_value = scales[i][0];
-
-				if(absolute(key.m_value - 1.0f) <= scaleEpsilon)
+				F32 value = scales[i][0];
+				if(absolute(value - 1.0f) <= scaleEpsilon)
 				{
-					key.m_value = 1.0f;
+					value = 1.0f;
 				}
 
-				tempChannels[channelCount].m_scales.emplaceBack(key);
+				tempChannels[channelCount].m_scales.emplaceBack(keys[i], value);
 			}
 		}
 
@@ -281,10 +243,13 @@ Error GltfImporter::writeAnimation(const cgltf_animation& anim)
 					return (Vec4(a) - Vec4(0.0f, 0.0f, 0.0f, 1.0f)).abs() < 0.001f;
 				},
 				[&](const Quat& a, const Quat& b) -> Bool {
-					return (Vec4(a) - Vec4(b)).abs() < 0.001f;
+					return (Vec4(a) - Vec4(b)).abs() < 0.001f || (Vec4(a) + Vec4(b)).abs() < 0.001f;
 				},
 				[&](const Quat& a, const Quat& b, F32 u) -> Quat {
-					return a.slerp(b, u);
+					// Normalized lerp like AnimationResource does
+					const Vec4 va(a);
+					const Vec4 vb = (va.dot(Vec4(b)) < 0.0f) ? -Vec4(b) : Vec4(b);
+					return Quat(va.lerp(vb, u).normalize());
 				});
 			optimizeChannel(
 				channel.m_scales,
@@ -301,55 +266,23 @@ Error GltfImporter::writeAnimation(const cgltf_animation& anim)
 	}
 
 	// Write file
-	File file;
-	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::kWrite));
-
-	ANKI_CHECK(file.writeTextf("%s\n<animation>\n", XmlDocument<MemoryPoolPtrWrapper<BaseMemoryPool>>::kXmlHeader.cstr()));
-	ANKI_CHECK(file.writeText("\t<channels>\n"));
-
-	for(const GltfAnimChannel& channel : tempChannels)
+	ImporterDynamicArray<AnimationChannelKeyframes> keyframes;
+	keyframes.resize(tempChannels.getSize());
+	for(U32 i = 0; i < tempChannels.getSize(); ++i)
 	{
-		ANKI_CHECK(file.writeTextf("\t\t<channel name=\"%s\">\n", channel.m_name.cstr()));
-
-		// Positions
-		if(channel.m_positions.getSize())
-		{
-			ANKI_CHECK(file.writeText("\t\t\t<positionKeys>\n"));
-			for(const GltfAnimKey<Vec3>& key : channel.m_positions)
-			{
-				ANKI_CHECK(file.writeTextf("\t\t\t\t<key time=\"%f\">%f %f %f</key>\n", key.m_time, key.m_value.x, key.m_value.y, key.m_value.z));
-			}
-			ANKI_CHECK(file.writeText("\t\t\t</positionKeys>\n"));
-		}
-
-		// Rotations
-		if(channel.m_rotations.getSize())
-		{
-			ANKI_CHECK(file.writeText("\t\t\t<rotationKeys>\n"));
-			for(const GltfAnimKey<Quat>& key : channel.m_rotations)
-			{
-				ANKI_CHECK(file.writeTextf("\t\t\t\t<key time=\"%f\">%f %f %f %f</key>\n", key.m_time, key.m_value.x, key.m_value.y, key.m_value.z,
-										   key.m_value.w));
-			}
-			ANKI_CHECK(file.writeText("\t\t\t</rotationKeys>\n"));
-		}
-
-		// Scales
-		if(channel.m_scales.getSize())
-		{
-			ANKI_CHECK(file.writeText("\t\t\t<scaleKeys>\n"));
-			for(const GltfAnimKey<F32>& key : channel.m_scales)
-			{
-				ANKI_CHECK(file.writeTextf("\t\t\t\t<key time=\"%f\">%f</key>\n", key.m_time, key.m_value));
-			}
-			ANKI_CHECK(file.writeText("\t\t\t</scaleKeys>\n"));
-		}
-
-		ANKI_CHECK(file.writeText("\t\t</channel>\n"));
+		keyframes[i].m_name = tempChannels[i].m_name;
+		keyframes[i].m_positions = tempChannels[i].m_positions;
+		keyframes[i].m_rotations = tempChannels[i].m_rotations;
+		keyframes[i].m_scales = tempChannels[i].m_scales;
 	}
 
-	ANKI_CHECK(file.writeText("\t</channels>\n"));
-	ANKI_CHECK(file.writeText("</animation>\n"));
+	ImporterDynamicArrayLarge<U8> binary;
+	binary.resize(AnimationResource::computeBinarySize(keyframes));
+	ANKI_CHECK(AnimationResource::encodeBinary(keyframes, WeakArray<U8, PtrSize>(binary)));
+
+	File file;
+	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+	ANKI_CHECK(file.write(&binary[0], binary.getSizeInBytes()));
 
 	// Hook up the animation to the scene
 	for(const GltfAnimChannel& channel : tempChannels)
@@ -117,6 +117,7 @@ static Error importImage(CString in, CString out, Bool alpha)
 #endif
 
 	config.m_flipImage = false;
+	config.m_threadCount = 0; // The materials are already imported in parallel
 
 	ANKI_IMPORTER_LOGV("Importing image \"%s\" as \"%s\"", in.cstr(), out.cstr());
 	ANKI_CHECK(importImage(config));
@@ -159,7 +160,7 @@ Error GltfImporter::writeMaterialInternal(const cgltf_material& mtl, Bool writeR
 		return Error::kUserData;
 	}
 
-	ImporterHashMap<CString, ImporterString> extras;
+	ImporterHashMap<ImporterString, ImporterString> extras;
 	ANKI_CHECK(appendExtras(mtl.extras, extras));
 
 	ImporterString xml;
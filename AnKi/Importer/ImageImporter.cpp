@@ -5,11 +5,14 @@
 
 #include <AnKi/Importer/ImageImporter.h>
 #include <AnKi/Importer/TinyExr.h>
+#include <AnKi/Importer/TextureEncoder.h>
 #include <AnKi/Gr/Common.h>
 #include <AnKi/Resource/Stb.h>
 #include <AnKi/Util/Process.h>
 #include <AnKi/Util/File.h>
 #include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/System.h>
 
 namespace anki {
 
@@ -609,30 +612,20 @@ static void generateSurfaceMipmap(ConstWeakArray<U8, PtrSize> inBuffer, U32 inWi
 	}
 }
 
-static Error compressS3tc(CString tempDirectory, CString compressonatorFilename, ConstWeakArray<U8, PtrSize> inPixels, U32 inWidth, U32 inHeight,
-						  U32 channelCount, Bool hdr, WeakArray<U8, PtrSize> outPixels)
+// BC6H is not supported by the built-in encoder so it goes through compressonator.
+static Error compressBc6h(CString tempDirectory, CString compressonatorFilename, ConstWeakArray<U8, PtrSize> inPixels, U32 inWidth, U32 inHeight,
+						  U32 channelCount, WeakArray<U8, PtrSize> outPixels)
 {
-	ANKI_ASSERT(inPixels.getSizeInBytes() == PtrSize(inWidth) * inHeight * channelCount * ((hdr) ? sizeof(F32) : sizeof(U8)));
+	ANKI_ASSERT(inPixels.getSizeInBytes() == PtrSize(inWidth) * inHeight * channelCount * sizeof(F32));
 	ANKI_ASSERT(inWidth > 0 && isPowerOfTwo(inWidth) && inHeight > 0 && isPowerOfTwo(inHeight));
-	ANKI_ASSERT(outPixels.getSizeInBytes() == PtrSize((hdr || channelCount == 4) ? 16 : 8) * (inWidth / 4) * (inHeight / 4));
+	ANKI_ASSERT(outPixels.getSizeInBytes() == PtrSize(16) * (inWidth / 4) * (inHeight / 4));
 
-	// Create a PNG image to feed to the compressor
+	// Create an EXR image to feed to the compressor
 	ImporterString tmpFilename;
-	tmpFilename.sprintf("%s/AnKiImageImporter_%u.%s", tempDirectory.cstr(), g_tempFileIndex.fetchAdd(1), (hdr) ? "exr" : "png");
+	tmpFilename.sprintf("%s/AnKiImageImporter_%u.exr", tempDirectory.cstr(), g_tempFileIndex.fetchAdd(1));
 	ANKI_IMPORTER_LOGV("Will store: %s", tmpFilename.cstr());
-	Bool saveTmpImageOk = false;
-	if(!hdr)
-	{
-		const I ok = stbi_write_png(tmpFilename.cstr(), inWidth, inHeight, channelCount, inPixels.getBegin(), 0);
-		saveTmpImageOk = !!ok;
-	}
-	else
-	{
-		const I ret = SaveEXR(reinterpret_cast<const F32*>(inPixels.getBegin()), inWidth, inHeight, channelCount, 0, tmpFilename.cstr(), nullptr);
-		saveTmpImageOk = ret >= 0;
-	}
-
-	if(!saveTmpImageOk)
+	const I ret = SaveEXR(reinterpret_cast<const F32*>(inPixels.getBegin()), inWidth, inHeight, channelCount, 0, tmpFilename.cstr(), nullptr);
+	if(ret < 0)
 	{
 		ANKI_IMPORTER_LOGE("Failed to create: %s", tmpFilename.cstr());
 		return Error::kFunctionFailed;
@@ -647,7 +640,7 @@ static Error compressS3tc(CString tempDirectory, CString compressonatorFilename,
 	U32 argCount = 0;
 	args[argCount++] = "-nomipmap";
 	args[argCount++] = "-fd";
-	args[argCount++] = (hdr) ? "BC6H" : ((channelCount == 3) ? "BC1" : "BC3");
+	args[argCount++] = "BC6H";
 	args[argCount++] = tmpFilename;
 	args[argCount++] = ddsFilename;
 
@@ -682,19 +675,7 @@ static Error compressS3tc(CString tempDirectory, CString compressonatorFilename,
 	DdsHeader ddsHeader;
 	ANKI_CHECK(ddsFile.read(&ddsHeader, sizeof(DdsHeader)));
 
-	if(!hdr && channelCount == 3 && memcmp(&ddsHeader.m_ddspf.m_dwFourCC[0], "DXT1", 4) != 0)
-	{
-		ANKI_IMPORTER_LOGE("Incorrect format. Expecting DXT1");
-		return Error::kFunctionFailed;
-	}
-
-	if(!hdr && channelCount == 4 && memcmp(&ddsHeader.m_ddspf.m_dwFourCC[0], "DXT5", 4) != 0)
-	{
-		ANKI_IMPORTER_LOGE("Incorrect format. Expecting DXT5");
-		return Error::kFunctionFailed;
-	}
-
-	if(hdr && memcmp(&ddsHeader.m_ddspf.m_dwFourCC[0], "DX10", 4) != 0)
+	if(memcmp(&ddsHeader.m_ddspf.m_dwFourCC[0], "DX10", 4) != 0)
 	{
 		ANKI_IMPORTER_LOGE("Incorrect format. Expecting BC6H");
 		return Error::kFunctionFailed;
@@ -706,11 +687,8 @@ static Error compressS3tc(CString tempDirectory, CString compressonatorFilename,
 		return Error::kFunctionFailed;
 	}
 
-	if(hdr)
-	{
-		DdsHeaderDxt10 dxt10Header;
-		ANKI_CHECK(ddsFile.read(&dxt10Header, sizeof(dxt10Header)));
-	}
+	DdsHeaderDxt10 dxt10Header;
+	ANKI_CHECK(ddsFile.read(&dxt10Header, sizeof(dxt10Header)));
 
 	ANKI_CHECK(ddsFile.read(outPixels.getBegin(), outPixels.getSizeInBytes()));
 
@@ -1080,16 +1058,50 @@ static Error importImageInternal(const ImageImporterConfig& configOriginal)
 		}
 	}
 
-	// Compress
+	// Compress. Every surface is a separate task and the built-in encoder splits big surfaces further into groups of block rows
+	ThreadJobManager* jobManager = nullptr;
+	if(config.m_threadCount > 0)
+	{
+		const U32 threadCount = min(getCpuCoresCount(), config.m_threadCount);
+		jobManager = newInstance<ThreadJobManager>(ImporterMemoryPool::getSingleton(), threadCount);
+	}
+
+	Atomic<I32> errorInThread = {0};
+	auto dispatch = [&](auto func) -> Error {
+		if(jobManager)
+		{
+			jobManager->dispatchTask([func, &errorInThread]([[maybe_unused]] U32 threadId) {
+				Error err = errorInThread.load();
+
+				if(!err)
+				{
+					err = func();
+				}
+
+				if(err)
+				{
+					errorInThread.store(err._getCode());
+				}
+			});
+
+			return Error::kNone;
+		}
+		else
+		{
+			return func();
+		}
+	};
+
+	Error err = Error::kNone;
 	if(!!(config.m_compressions & ImageBinaryDataCompression::kS3tc))
 	{
 		ANKI_IMPORTER_LOGV("Will compress in S3TC");
 
-		for(U32 mip = 0; mip < mipCount; ++mip)
+		for(U32 mip = 0; mip < mipCount && !err; ++mip)
 		{
-			for(U32 l = 0; l < ctx.m_layerCount; ++l)
+			for(U32 l = 0; l < ctx.m_layerCount && !err; ++l)
 			{
-				for(U32 f = 0; f < ctx.m_faceCount; ++f)
+				for(U32 f = 0; f < ctx.m_faceCount && !err; ++f)
 				{
 					const U32 idx = l * ctx.m_faceCount + f;
 					SurfaceOrVolumeData& surface = ctx.m_mipmaps[mip].m_surfacesOrVolume[idx];
@@ -1101,8 +1113,32 @@ static Error importImageInternal(const ImageImporterConfig& configOriginal)
 
 					surface.m_s3tcPixels.resize(s3tcImageSize);
 
-					ANKI_CHECK(compressS3tc(config.m_tempDirectory, config.m_compressonatorFilename, ConstWeakArray<U8, PtrSize>(surface.m_pixels),
-											width, height, ctx.m_channelCount, ctx.m_hdr, WeakArray<U8, PtrSize>(surface.m_s3tcPixels)));
+					const ConstWeakArray<U8, PtrSize> inPixels(surface.m_pixels);
+					const WeakArray<U8, PtrSize> outPixels(surface.m_s3tcPixels);
+
+					if(ctx.m_hdr)
+					{
+						err = dispatch([&config, inPixels, outPixels, width, height, channelCount = ctx.m_channelCount]() {
+							return compressBc6h(config.m_tempDirectory, config.m_compressonatorFilename, inPixels, width, height, channelCount,
+												outPixels);
+						});
+					}
+					else
+					{
+						const TextureEncoderFormat format = (ctx.m_channelCount == 3) ? TextureEncoderFormat::kBc1 : TextureEncoderFormat::kBc3;
+						const U32 blockRowCount = height / 4;
+						constexpr U32 kBlockRowsPerTask = 16;
+						for(U32 firstBlockRow = 0; firstBlockRow < blockRowCount; firstBlockRow += kBlockRowsPerTask)
+						{
+							const U32 count = min(kBlockRowsPerTask, blockRowCount - firstBlockRow);
+							err = dispatch(
+								[&config, format, inPixels, outPixels, width, height, channelCount = ctx.m_channelCount, firstBlockRow, count]() {
+									encodeTextureBlocks(format, config.m_compressionQuality, inPixels, width, height, channelCount, firstBlockRow,
+														count, outPixels);
+									return Error::kNone;
+								});
+						}
+					}
 				}
 			}
 		}
@@ -1112,11 +1148,11 @@ static Error importImageInternal(const ImageImporterConfig& configOriginal)
 	{
 		ANKI_IMPORTER_LOGV("Will compress in ASTC");
 
-		for(U32 mip = 0; mip < mipCount; ++mip)
+		for(U32 mip = 0; mip < mipCount && !err; ++mip)
 		{
-			for(U32 l = 0; l < ctx.m_layerCount; ++l)
+			for(U32 l = 0; l < ctx.m_layerCount && !err; ++l)
 			{
-				for(U32 f = 0; f < ctx.m_faceCount; ++f)
+				for(U32 f = 0; f < ctx.m_faceCount && !err; ++f)
 				{
 					const U32 idx = l * ctx.m_faceCount + f;
 					SurfaceOrVolumeData& surface = ctx.m_mipmaps[mip].m_surfacesOrVolume[idx];
@@ -1128,14 +1164,30 @@ static Error importImageInternal(const ImageImporterConfig& configOriginal)
 
 					surface.m_astcPixels.resize(astcImageSize);
 
-					ANKI_CHECK(compressAstc(config.m_tempDirectory, config.m_astcencFilename, ConstWeakArray<U8, PtrSize>(surface.m_pixels), width,
-											height, ctx.m_channelCount, config.m_astcBlockSize, ctx.m_hdr,
-											WeakArray<U8, PtrSize>(surface.m_astcPixels)));
+					const ConstWeakArray<U8, PtrSize> inPixels(surface.m_pixels);
+					const WeakArray<U8, PtrSize> outPixels(surface.m_astcPixels);
+					err = dispatch([&config, inPixels, outPixels, width, height, channelCount = ctx.m_channelCount, hdr = ctx.m_hdr]() {
+						return compressAstc(config.m_tempDirectory, config.m_astcencFilename, inPixels, width, height, channelCount,
+											config.m_astcBlockSize, hdr, outPixels);
+					});
 				}
 			}
 		}
 	}
 
+	if(jobManager)
+	{
+		jobManager->waitForAllTasksToFinish();
+		deleteInstance(ImporterMemoryPool::getSingleton(), jobManager);
+
+		if(!err)
+		{
+			err = errorInThread.load();
+		}
+	}
+
+	ANKI_CHECK(err);
+
 	if(!!(config.m_compressions & ImageBinaryDataCompression::kEtc))
 	{
 		ANKI_ASSERT(!"TODO");
@@ -8,6 +8,7 @@
 #include <AnKi/Importer/Common.h>
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/WeakArray.h>
+#include <AnKi/Importer/TextureEncoder.h>
 #include <AnKi/Resource/ImageBinary.h>
 
 namespace anki {
@@ -24,7 +25,7 @@ public:
 	U8 m_mipmapCount = kMaxU8;
 	Bool m_noAlpha = true;
 	CString m_tempDirectory;
-	CString m_compressonatorFilename; // Optional.
+	CString m_compressonatorFilename; // Optional. Only used for BC6H.
 	CString m_astcencFilename; // Optional.
 	Vec3 m_hdrScale = Vec3(1.0f); // Scale the values of HDR textures.
 	Vec3 m_hdrBias = Vec3(0.0f); // Add that value to the HDR textures.
@@ -33,6 +34,8 @@ public:
 	Bool m_linearToSRgb = false;
 	Bool m_asSRgb = false; // Interpret the format as sRGB
 	Bool m_flipImage = false;
+	TextureEncoderQuality m_compressionQuality = TextureEncoderQuality::kNormal; // Quality of the built-in S3TC encoder.
+	U32 m_threadCount = kMaxU32; // The number of threads that will compress the surfaces. If zero it compresses in the calling thread.
 };
 
 // Converts images to AnKi's specific format.
@@ -0,0 +1,694 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Importer/TextureEncoder.h>
+#include <AnKi/Math.h>
+
+// The encoder works on Vec4 texels so most of the per texel math goes through the SIMD paths of the math library
+
+namespace anki {
+
+static constexpr U32 kTexelsPerBlock = 16;
+
+using BlockTexels = Array<Vec4, kTexelsPerBlock>;
+using BlockIndices = Array<U8, kTexelsPerBlock>;
+
+static constexpr Array<U32, 3> kRefinementPassCount = {0, 1, 3};
+
+// The interpolation weights of the 4bit indices of BC7
+static constexpr Array<U32, 16> kBc7Weights4 = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+static U32 getBlockSize(TextureEncoderFormat format)
+{
+	return (format == TextureEncoderFormat::kBc1 || format == TextureEncoderFormat::kBc4) ? 8 : 16;
+}
+
+// Writes bits starting from the LSB of the first byte.
+class BitWriter
+{
+public:
+	U8* m_out;
+	U32 m_bit = 0;
+
+	BitWriter(U8* out, U32 byteCount)
+		: m_out(out)
+	{
+		memset(out, 0, byteCount);
+	}
+
+	void write(U32 value, U32 bitCount)
+	{
+		for(U32 i = 0; i < bitCount; ++i, ++m_bit)
+		{
+			m_out[m_bit / 8] |= U8(((value >> i) & 1u) << (m_bit % 8));
+		}
+	}
+};
+
+class BitReader
+{
+public:
+	const U8* m_in;
+	U32 m_bit = 0;
+
+	BitReader(const U8* in)
+		: m_in(in)
+	{
+	}
+
+	U32 read(U32 bitCount)
+	{
+		U32 value = 0;
+		for(U32 i = 0; i < bitCount; ++i, ++m_bit)
+		{
+			value |= U32((m_in[m_bit / 8] >> (m_bit % 8)) & 1u) << i;
+		}
+		return value;
+	}
+};
+
+static void loadBlock(ConstWeakArray<U8, PtrSize> pixels, U32 width, U32 channelCount, U32 blockX, U32 blockY, BlockTexels& texels)
+{
+	for(U32 y = 0; y < 4; ++y)
+	{
+		for(U32 x = 0; x < 4; ++x)
+		{
+			const U8* texel = &pixels[(PtrSize(blockY * 4 + y) * width + blockX * 4 + x) * channelCount];
+			Vec4 v(0.0f, 0.0f, 0.0f, 255.0f);
+			for(U32 c = 0; c < channelCount; ++c)
+			{
+				v[c] = F32(texel[c]);
+			}
+			texels[y * 4 + x] = v;
+		}
+	}
+}
+
+// Find the line that best fits the texels. mask selects the channels that participate.
+static void computeEndpoints(const BlockTexels& texels, Vec4 mask, TextureEncoderQuality quality, Vec4& e0, Vec4& e1)
+{
+	Vec4 minv(kMaxF32);
+	Vec4 maxv(kMinF32);
+	Vec4 mean(0.0f);
+	for(const Vec4& t : texels)
+	{
+		minv = minv.min(t);
+		maxv = maxv.max(t);
+		mean += t;
+	}
+	mean /= F32(kTexelsPerBlock);
+
+	if(quality == TextureEncoderQuality::kFast)
+	{
+		// Bounding box with a small inset that reduces the error of the interpolated colors
+		const Vec4 inset = (maxv - minv) / 16.0f;
+		e0 = (maxv - inset) * mask;
+		e1 = (minv + inset) * mask;
+		return;
+	}
+
+	// Covariance matrix
+	Array2d<F32, 4, 4> cov = {};
+	for(const Vec4& t : texels)
+	{
+		const Vec4 d = (t - mean) * mask;
+		for(U32 i = 0; i < 4; ++i)
+		{
+			for(U32 j = 0; j < 4; ++j)
+			{
+				cov[i][j] += d[i] * d[j];
+			}
+		}
+	}
+
+	// Power iteration to find the principal axis
+	Vec4 axis = (maxv - minv) * mask;
+	for(U32 it = 0; it < 8; ++it)
+	{
+		Vec4 next(0.0f);
+		for(U32 i = 0; i < 4; ++i)
+		{
+			next[i] = cov[i][0] * axis[0] + cov[i][1] * axis[1] + cov[i][2] * axis[2] + cov[i][3] * axis[3];
+		}
+
+		const F32 maxComponent = max(max(absolute(next.x), absolute(next.y)), max(absolute(next.z), absolute(next.w)));
+		if(maxComponent < kEpsilonf)
+		{
+			break;
+		}
+		axis = next / maxComponent;
+	}
+
+	const F32 axisLenSq = axis.lengthSquared();
+	if(axisLenSq < kEpsilonf)
+	{
+		// All texels are the same
+		e0 = e1 = mean * mask;
+		return;
+	}
+	axis /= sqrt(axisLenSq);
+
+	F32 minProj = kMaxF32;
+	F32 maxProj = kMinF32;
+	for(const Vec4& t : texels)
+	{
+		const F32 proj = ((t - mean) * mask).dot(axis);
+		minProj = min(minProj, proj);
+		maxProj = max(maxProj, proj);
+	}
+
+	e0 = ((mean + axis * maxProj) * mask).clamp(0.0f, 255.0f);
+	e1 = ((mean + axis * minProj) * mask).clamp(0.0f, 255.0f);
+}
+
+// Solve the least squares problem of finding the 2 endpoints that best fit the texels given the indices.
+// weights: The weight of e1 for every index.
+template<PtrSize kIndexCount>
+static void refineEndpoints(const BlockTexels& texels, const BlockIndices& indices, const Array<F32, kIndexCount>& weights, Vec4 mask, Vec4& e0,
+							Vec4& e1)
+{
+	F32 alpha2 = 0.0f;
+	F32 beta2 = 0.0f;
+	F32 alphaBeta = 0.0f;
+	Vec4 alphaX(0.0f);
+	Vec4 betaX(0.0f);
+	for(U32 i = 0; i < kTexelsPerBlock; ++i)
+	{
+		const F32 beta = weights[indices[i]];
+		const F32 alpha = 1.0f - beta;
+		alpha2 += alpha * alpha;
+		beta2 += beta * beta;
+		alphaBeta += alpha * beta;
+		alphaX += texels[i] * alpha;
+		betaX += texels[i] * beta;
+	}
+
+	const F32 det = alpha2 * beta2 - alphaBeta * alphaBeta;
+	if(absolute(det) < kEpsilonf)
+	{
+		return;
+	}
+
+	e0 = (((alphaX * beta2 - betaX * alphaBeta) / det) * mask).clamp(0.0f, 255.0f);
+	e1 = (((betaX * alpha2 - alphaX * alphaBeta) / det) * mask).clamp(0.0f, 255.0f);
+}
+
+// Find the closest palette entry for every texel. Returns the squared error.
+template<PtrSize kPaletteSize>
+static F32 findIndices(const BlockTexels& texels, const Array<Vec4, kPaletteSize>& palette, Vec4 mask, BlockIndices& indices)
+{
+	F32 totalError = 0.0f;
+	for(U32 i = 0; i < kTexelsPerBlock; ++i)
+	{
+		const Vec4 t = texels[i] * mask;
+		F32 bestError = kMaxF32;
+		for(U32 p = 0; p < U32(kPaletteSize); ++p)
+		{
+			const F32 error = t.distanceSquared(palette[p]);
+			if(error < bestError)
+			{
+				bestError = error;
+				indices[i] = U8(p);
+			}
+		}
+		totalError += bestError;
+	}
+
+	return totalError;
+}
+
+static U16 packRgb565(Vec4 c)
+{
+	const U32 r = U32(clamp(std::round(c.x * 31.0f / 255.0f), 0.0f, 31.0f));
+	const U32 g = U32(clamp(std::round(c.y * 63.0f / 255.0f), 0.0f, 63.0f));
+	const U32 b = U32(clamp(std::round(c.z * 31.0f / 255.0f), 0.0f, 31.0f));
+	return U16((r << 11) | (g << 5) | b);
+}
+
+static Vec4 unpackRgb565(U16 c)
+{
+	const U32 r = (c >> 11) & 31u;
+	const U32 g = (c >> 5) & 63u;
+	const U32 b = c & 31u;
+	return Vec4(F32((r << 3) | (r >> 2)), F32((g << 2) | (g >> 4)), F32((b << 3) | (b >> 2)), 0.0f);
+}
+
+static Array<Vec4, 4> computeBc1Palette(U16 c0, U16 c1)
+{
+	const Vec4 e0 = unpackRgb565(c0);
+	const Vec4 e1 = unpackRgb565(c1);
+	return {e0, e1, (e0 * 2.0f + e1) / 3.0f, (e0 + e1 * 2.0f) / 3.0f};
+}
+
+static void encodeBc1Block(const BlockTexels& texels, TextureEncoderQuality quality, U8* out)
+{
+	const Vec4 mask(1.0f, 1.0f, 1.0f, 0.0f);
+	static constexpr Array<F32, 4> kWeights = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+	Vec4 e0, e1;
+	computeEndpoints(texels, mask, quality, e0, e1);
+
+	U16 bestC0 = packRgb565(e0);
+	U16 bestC1 = packRgb565(e1);
+	BlockIndices bestIndices;
+	F32 bestError = findIndices(texels, computeBc1Palette(bestC0, bestC1), mask, bestIndices);
+
+	for(U32 pass = 0; pass < kRefinementPassCount[quality]; ++pass)
+	{
+		refineEndpoints(texels, bestIndices, kWeights, mask, e0, e1);
+		const U16 c0 = packRgb565(e0);
+		const U16 c1 = packRgb565(e1);
+		BlockIndices indices;
+		const F32 error = findIndices(texels, computeBc1Palette(c0, c1), mask, indices);
+		if(error >= bestError)
+		{
+			break;
+		}
+
+		bestError = error;
+		bestC0 = c0;
+		bestC1 = c1;
+		bestIndices = indices;
+	}
+
+	// The 4 color mode requires c0 > c1. If they are equal the 3 color mode is used but only the 1st index is used
+	if(bestC0 < bestC1)
+	{
+		std::swap(bestC0, bestC1);
+		for(U8& idx : bestIndices)
+		{
+			idx ^= 1;
+		}
+	}
+	else if(bestC0 == bestC1)
+	{
+		bestIndices.fill(0);
+	}
+
+	BitWriter writer(out, 8);
+	writer.write(bestC0, 16);
+	writer.write(bestC1, 16);
+	for(U8 idx : bestIndices)
+	{
+		writer.write(idx, 2);
+	}
+}
+
+static void decodeBc1Block(const U8* block, U8* out)
+{
+	BitReader reader(block);
+	const U16 c0 = U16(reader.read(16));
+	const U16 c1 = U16(reader.read(16));
+
+	Array<Vec4, 4> palette = computeBc1Palette(c0, c1);
+	palette[0].w = palette[1].w = palette[2].w = palette[3].w = 255.0f;
+	if(c0 <= c1)
+	{
+		palette[2] = (palette[0] + palette[1]) / 2.0f;
+		palette[3] = Vec4(0.0f);
+	}
+
+	for(U32 i = 0; i < kTexelsPerBlock; ++i)
+	{
+		const Vec4 c = palette[reader.read(2)];
+		for(U32 comp = 0; comp < 4; ++comp)
+		{
+			out[i * 4 + comp] = U8(std::round(c[comp]));
+		}
+	}
+}
+
+static Array<F32, 8> computeBc4Palette(U32 a0, U32 a1)
+{
+	Array<F32, 8> palette;
+	palette[0] = F32(a0);
+	palette[1] = F32(a1);
+	if(a0 > a1)
+	{
+		for(U32 i = 1; i < 7; ++i)
+		{
+			palette[i + 1] = (F32(a0) * F32(7 - i) + F32(a1) * F32(i)) / 7.0f;
+		}
+	}
+	else
+	{
+		for(U32 i = 1; i < 5; ++i)
+		{
+			palette[i + 1] = (F32(a0) * F32(5 - i) + F32(a1) * F32(i)) / 5.0f;
+		}
+		palette[6] = 0.0f;
+		palette[7] = 255.0f;
+	}
+
+	return palette;
+}
+
+static F32 findBc4Indices(const Array<F32, kTexelsPerBlock>& values, U32 a0, U32 a1, BlockIndices& indices)
+{
+	const Array<F32, 8> palette = computeBc4Palette(a0, a1);
+
+	F32 totalError = 0.0f;
+	for(U32 i = 0; i < kTexelsPerBlock; ++i)
+	{
+		F32 bestError = kMaxF32;
+		for(U32 p = 0; p < 8; ++p)
+		{
+			const F32 error = (values[i] - palette[p]) * (values[i] - palette[p]);
+			if(error < bestError)
+			{
+				bestError = error;
+				indices[i] = U8(p);
+			}
+		}
+		totalError += bestError;
+	}
+
+	return totalError;
+}
+
+static void encodeBc4Block(const BlockTexels& texels, U32 channel, TextureEncoderQuality quality, U8* out)
+{
+	Array<F32, kTexelsPerBlock> values;
+	F32 minv = 255.0f;
+	F32 maxv = 0.0f;
+	F32 minNonExtreme = 255.0f;
+	F32 maxNonExtreme = 0.0f;
+	for(U32 i = 0; i < kTexelsPerBlock; ++i)
+	{
+		values[i] = texels[i][channel];
+		minv = min(minv, values[i]);
+		maxv = max(maxv, values[i]);
+		if(values[i] > 0.0f && values[i] < 255.0f)
+		{
+			minNonExtreme = min(minNonExtreme, values[i]);
+			maxNonExtreme = max(maxNonExtreme, values[i]);
+		}
+	}
+
+	// 8 value mode needs a0 > a1
+	U32 bestA0 = U32(maxv);
+	U32 bestA1 = U32(minv);
+	BlockIndices bestIndices;
+	F32 bestError = findBc4Indices(values, bestA0, bestA1, bestIndices);
+
+	// Refine the 8 value mode
+	for(U32 pass = 0; pass < kRefinementPassCount[quality] && bestA0 > bestA1; ++pass)
+	{
+		F32 alpha2 = 0.0f, beta2 = 0.0f, alphaBeta = 0.0f, alphaX = 0.0f, betaX = 0.0f;
+		for(U32 i = 0; i < kTexelsPerBlock; ++i)
+		{
+			const U32 idx = bestIndices[i];
+			const F32 beta = (idx == 0) ? 0.0f : ((idx == 1) ? 1.0f : F32(idx - 1) / 7.0f);
+			const F32 alpha = 1.0f - beta;
+			alpha2 += alpha * alpha;
+			beta2 += beta * beta;
+			alphaBeta += alpha * beta;
+			alphaX += alpha * values[i];
+			betaX += beta * values[i];
+		}
+
+		const F32 det = alpha2 * beta2 - alphaBeta * alphaBeta;
+		if(absolute(det) < kEpsilonf)
+		{
+			break;
+		}
+
+		const U32 a0 = U32(clamp(std::round((alphaX * beta2 - betaX * alphaBeta) / det), 0.0f, 255.0f));
+		const U32 a1 = U32(clamp(std::round((betaX * alpha2 - alphaX * alphaBeta) / det), 0.0f, 255.0f));
+		if(a0 <= a1)
+		{
+			break;
+		}
+
+		BlockIndices indices;
+		const F32 error = findBc4Indices(values, a0, a1, indices);
+		if(error >= bestError)
+		{
+			break;
+		}
+
+		bestError = error;
+		bestA0 = a0;
+		bestA1 = a1;
+		bestIndices = indices;
+	}
+
+	// The 6 value mode has explicit 0 and 255 so it's good for blocks that have those values plus something in between
+	if(quality == TextureEncoderQuality::kHigh && minNonExtreme <= maxNonExtreme)
+	{
+		BlockIndices indices;
+		const F32 error = findBc4Indices(values, U32(minNonExtreme), U32(maxNonExtreme), indices);
+		if(error < bestError)
+		{
+			bestError = error;
+			bestA0 = U32(minNonExtreme);
+			bestA1 = U32(maxNonExtreme);
+			bestIndices = indices;
+		}
+	}
+
+	BitWriter writer(out, 8);
+	writer.write(bestA0, 8);
+	writer.write(bestA1, 8);
+	for(U8 idx : bestIndices)
+	{
+		writer.write(idx, 3);
+	}
+}
+
+static void decodeBc4Block(const U8* block, U32 channel, U8* out)
+{
+	BitReader reader(block);
+	const U32 a0 = reader.read(8);
+	const U32 a1 = reader.read(8);
+	const Array<F32, 8> palette = computeBc4Palette(a0, a1);
+
+	for(U32 i = 0; i < kTexelsPerBlock; ++i)
+	{
+		out[i * 4 + channel] = U8(std::round(palette[reader.read(3)]));
+	}
+}
+
+static Vec4 quantizeBc7Endpoint(Vec4 e, U32 pbit)
+{
+	Vec4 out;
+	for(U32 c = 0; c < 4; ++c)
+	{
+		const F32 q = clamp(std::round((e[c] - F32(pbit)) / 2.0f), 0.0f, 127.0f);
+		out[c] = q;
+	}
+	return out;
+}
+
+static Vec4 unquantizeBc7Endpoint(Vec4 q, U32 pbit)
+{
+	return q * 2.0f + F32(pbit);
+}
+
+static Array<Vec4, 16> computeBc7Palette(Vec4 e0, Vec4 e1)
+{
+	Array<Vec4, 16> palette;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const F32 w = F32(kBc7Weights4[i]);
+		const Vec4 c = (e0 * (64.0f - w) + e1 * w + 32.0f) / 64.0f;
+		palette[i] = Vec4(std::floor(c.x), std::floor(c.y), std::floor(c.z), std::floor(c.w));
+	}
+	return palette;
+}
+
+static void encodeBc7Block(const BlockTexels& texels, TextureEncoderQuality quality, U8* out)
+{
+	static constexpr Array<F32, 16> kWeights = {0.0f / 64.0f,  4.0f / 64.0f,  9.0f / 64.0f,  13.0f / 64.0f, 17.0f / 64.0f, 21.0f / 64.0f,
+												26.0f / 64.0f, 30.0f / 64.0f, 34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f,
+												51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 64.0f / 64.0f};
+	const Vec4 mask(1.0f);
+
+	Vec4 e0, e1;
+	computeEndpoints(texels, mask, quality, e0, e1);
+
+	Vec4 bestQ0, bestQ1;
+	U32 bestP0 = 0, bestP1 = 0;
+	BlockIndices bestIndices;
+	F32 bestError = kMaxF32;
+
+	for(U32 pass = 0; pass <= kRefinementPassCount[quality]; ++pass)
+	{
+		if(pass > 0)
+		{
+			refineEndpoints(texels, bestIndices, kWeights, mask, e0, e1);
+		}
+
+		// Try all the combinations of the P-bits
+		Bool improved = false;
+		for(U32 pbits = 0; pbits < 4; ++pbits)
+		{
+			const U32 p0 = pbits & 1u;
+			const U32 p1 = pbits >> 1u;
+			const Vec4 q0 = quantizeBc7Endpoint(e0, p0);
+			const Vec4 q1 = quantizeBc7Endpoint(e1, p1);
+
+			BlockIndices indices;
+			const F32 error = findIndices(texels, computeBc7Palette(unquantizeBc7Endpoint(q0, p0), unquantizeBc7Endpoint(q1, p1)), mask, indices);
+			if(error < bestError)
+			{
+				bestError = error;
+				bestQ0 = q0;
+				bestQ1 = q1;
+				bestP0 = p0;
+				bestP1 = p1;
+				bestIndices = indices;
+				improved = true;
+			}
+		}
+
+		if(!improved)
+		{
+			break;
+		}
+	}
+
+	// The MSB of the 1st index is implicitly zero
+	if(bestIndices[0] >= 8)
+	{
+		std::swap(bestQ0, bestQ1);
+		std::swap(bestP0, bestP1);
+		for(U8& idx : bestIndices)
+		{
+			idx = U8(15 - idx);
+		}
+	}
+
+	BitWriter writer(out, 16);
+	writer.write(1u << 6u, 7); // Mode 6
+	for(U32 c = 0; c < 4; ++c)
+	{
+		writer.write(U32(bestQ0[c]), 7);
+		writer.write(U32(bestQ1[c]), 7);
+	}
+	writer.write(bestP0, 1);
+	writer.write(bestP1, 1);
+	writer.write(bestIndices[0], 3);
+	for(U32 i = 1; i < kTexelsPerBlock; ++i)
+	{
+		writer.write(bestIndices[i], 4);
+	}
+}
+
+static void decodeBc7Block(const U8* block, U8* out)
+{
+	BitReader reader(block);
+	if(reader.read(7) != (1u << 6u))
+	{
+		ANKI_ASSERT(!"Only mode 6 is supported");
+		memset(out, 0, kTexelsPerBlock * 4);
+		return;
+	}
+
+	Vec4 q0, q1;
+	for(U32 c = 0; c < 4; ++c)
+	{
+		q0[c] = F32(reader.read(7));
+		q1[c] = F32(reader.read(7));
+	}
+	const U32 p0 = reader.read(1);
+	const U32 p1 = reader.read(1);
+	const Array<Vec4, 16> palette = computeBc7Palette(unquantizeBc7Endpoint(q0, p0), unquantizeBc7Endpoint(q1, p1));
+
+	for(U32 i = 0; i < kTexelsPerBlock; ++i)
+	{
+		const Vec4 c = palette[reader.read((i == 0) ? 3 : 4)];
+		for(U32 comp = 0; comp < 4; ++comp)
+		{
+			out[i * 4 + comp] = U8(c[comp]);
+		}
+	}
+}
+
+PtrSize computeTextureEncoderOutputSize(TextureEncoderFormat format, U32 width, U32 height)
+{
+	ANKI_ASSERT((width % 4) == 0 && (height % 4) == 0);
+	return PtrSize(getBlockSize(format)) * (width / 4) * (height / 4);
+}
+
+void encodeTextureBlocks(TextureEncoderFormat format, TextureEncoderQuality quality, ConstWeakArray<U8, PtrSize> pixels, U32 width, U32 height,
+						 U32 channelCount, U32 firstBlockRow, U32 blockRowCount, WeakArray<U8, PtrSize> out)
+{
+	ANKI_ASSERT(channelCount >= 1 && channelCount <= 4);
+	ANKI_ASSERT(pixels.getSizeInBytes() == PtrSize(width) * height * channelCount);
+	ANKI_ASSERT(out.getSizeInBytes() == computeTextureEncoderOutputSize(format, width, height));
+	ANKI_ASSERT(firstBlockRow + blockRowCount <= height / 4);
+
+	const U32 blockSize = getBlockSize(format);
+	const U32 blocksPerRow = width / 4;
+	BlockTexels texels;
+
+	for(U32 by = firstBlockRow; by < firstBlockRow + blockRowCount; ++by)
+	{
+		for(U32 bx = 0; bx < blocksPerRow; ++bx)
+		{
+			loadBlock(pixels, width, channelCount, bx, by, texels);
+			U8* block = &out[(PtrSize(by) * blocksPerRow + bx) * blockSize];
+
+			switch(format)
+			{
+			case TextureEncoderFormat::kBc1:
+				encodeBc1Block(texels, quality, block);
+				break;
+			case TextureEncoderFormat::kBc3:
+				encodeBc4Block(texels, 3, quality, block);
+				encodeBc1Block(texels, quality, block + 8);
+				break;
+			case TextureEncoderFormat::kBc4:
+				encodeBc4Block(texels, 0, quality, block);
+				break;
+			case TextureEncoderFormat::kBc5:
+				encodeBc4Block(texels, 0, quality, block);
+				encodeBc4Block(texels, 1, quality, block + 8);
+				break;
+			case TextureEncoderFormat::kBc7:
+				encodeBc7Block(texels, quality, block);
+				break;
+			default:
+				ANKI_ASSERT(0);
+			}
+		}
+	}
+}
+
+void decodeTextureBlock(TextureEncoderFormat format, const U8* block, U8* out)
+{
+	// Defaults for the channels the format doesn't have
+	for(U32 i = 0; i < kTexelsPerBlock; ++i)
+	{
+		out[i * 4 + 0] = out[i * 4 + 1] = out[i * 4 + 2] = 0;
+		out[i * 4 + 3] = 255;
+	}
+
+	switch(format)
+	{
+	case TextureEncoderFormat::kBc1:
+		decodeBc1Block(block, out);
+		break;
+	case TextureEncoderFormat::kBc3:
+		decodeBc1Block(block + 8, out);
+		decodeBc4Block(block, 3, out);
+		break;
+	case TextureEncoderFormat::kBc4:
+		decodeBc4Block(block, 0, out);
+		break;
+	case TextureEncoderFormat::kBc5:
+		decodeBc4Block(block, 0, out);
+		decodeBc4Block(block + 8, 1, out);
+		break;
+	case TextureEncoderFormat::kBc7:
+		decodeBc7Block(block, out);
+		break;
+	default:
+		ANKI_ASSERT(0);
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,55 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Importer/Common.h>
+#include <AnKi/Util/WeakArray.h>
+#include <AnKi/Util/Enum.h>
+
+namespace anki {
+
+// Block compressed formats the TextureEncoder can produce.
+enum class TextureEncoderFormat : U8
+{
+	kBc1, // RGB
+	kBc3, // RGBA
+	kBc4, // R
+	kBc5, // RG
+	kBc7, // RGBA. Only mode 6 is used
+
+	kCount,
+	kFirst = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(TextureEncoderFormat)
+
+// The more quality the more time the encoding takes.
+enum class TextureEncoderQuality : U8
+{
+	kFast, // Endpoints from the bounding box of the block
+	kNormal, // Endpoints from the principal axis of the block plus one refinement pass
+	kHigh, // Like kNormal but with more refinement passes and it tries more encoding modes
+
+	kCount,
+	kFirst = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(TextureEncoderQuality)
+
+// Get the size of the encoded data of a surface. The width and height should be multiples of 4.
+PtrSize computeTextureEncoderOutputSize(TextureEncoderFormat format, U32 width, U32 height);
+
+// Encode a range of block rows of an 8bit per channel surface. Different block rows can be encoded from different threads.
+// pixels: The whole surface. Tightly packed texels of channelCount components. Missing components are considered 0 and missing alpha is 255.
+// width, height: The size of the surface. Should be multiples of 4.
+// firstBlockRow, blockRowCount: The range of block rows to encode. A block row is 4 rows of texels.
+// out: The output of the whole surface. See computeTextureEncoderOutputSize().
+void encodeTextureBlocks(TextureEncoderFormat format, TextureEncoderQuality quality, ConstWeakArray<U8, PtrSize> pixels, U32 width, U32 height,
+						 U32 channelCount, U32 firstBlockRow, U32 blockRowCount, WeakArray<U8, PtrSize> out);
+
+// Decode a single block. Mainly used for testing.
+// out: 16 RGBA8 texels.
+void decodeTextureBlock(TextureEncoderFormat format, const U8* block, U8* out);
+
+} // end namespace anki
@@ -16,7 +16,8 @@ namespace anki {
 
 ANKI_SVAR(PhysicsBodiesCreated, StatCategory::kMisc, "Phys bodies created", StatFlag::kZeroEveryFrame)
 ANKI_SVAR(PhysicsJointsCreated, StatCategory::kMisc, "Phys joints created", StatFlag::kZeroEveryFrame)
-ANKI_SVAR(PhysicsUpdateTime, StatCategory::kTime, "Phys update", StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates)
+ANKI_SVAR(PhysicsUpdateTime, StatCategory::kTime, "Phys update",
+		  StatFlag::kMilisecond | StatFlag::kShowAverage) // Not main thread, see pipelined frames
 
 class BroadphaseLayer
 {
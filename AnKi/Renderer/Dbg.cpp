@@ -958,6 +958,7 @@ void Dbg::populateRenderGraphMain(InternalCtx& ictx)
 				}
 			} drawerInterface;
 
+			SceneGraph::getSingleton().waitPhysicsUpdate(); // The physics might be simulating the next frame
 			PhysicsWorld::getSingleton().debugDraw(drawerInterface);
 
 			const U32 vertCount = drawerInterface.m_positions.getSize();
@@ -0,0 +1,170 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// WARNING: This file is auto generated.
+
+#pragma once
+
+#include <AnKi/Resource/Common.h>
+#include <AnKi/Math.h>
+
+namespace anki {
+
+inline constexpr const char* kAnimationMagic = "ANKIANI2";
+
+// The keys of a track are split into time segments of that many keys. Key times are quantized to U16 over the time range of their segment so
+// the precision doesn't depend on the duration of the clip.
+inline constexpr U32 kAnimationKeysPerTimeSegment = 32;
+
+// The max length of a channel name including the null terminator.
+inline constexpr U32 kAnimationMaxChannelNameLength = 64;
+
+// A range of keys in one of the key streams.
+class AnimationBinaryTrack
+{
+public:
+	U32 m_firstKey;
+	U32 m_keyCount;
+
+	// The 1st time segment in the time segment stream. The track has ceil(m_keyCount / kAnimationKeysPerTimeSegment) segments.
+	U32 m_firstTimeSegment;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_firstKey", offsetof(AnimationBinaryTrack, m_firstKey), self.m_firstKey);
+		s.doValue("m_keyCount", offsetof(AnimationBinaryTrack, m_keyCount), self.m_keyCount);
+		s.doValue("m_firstTimeSegment", offsetof(AnimationBinaryTrack, m_firstTimeSegment), self.m_firstTimeSegment);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryTrack&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryTrack&>(serializer, *this);
+	}
+};
+
+// The time range of the keys of a segment.
+class AnimationBinaryTimeSegment
+{
+public:
+	// The time of the 1st key of the segment relative to the start of the clip.
+	F32 m_startTime;
+
+	// The time between the 1st and the last key of the segment.
+	F32 m_duration;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_startTime", offsetof(AnimationBinaryTimeSegment, m_startTime), self.m_startTime);
+		s.doValue("m_duration", offsetof(AnimationBinaryTimeSegment, m_duration), self.m_duration);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryTimeSegment&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryTimeSegment&>(serializer, *this);
+	}
+};
+
+// Animation channel. A channel animates a single bone or node.
+class AnimationBinaryChannel
+{
+public:
+	Array<Char, kAnimationMaxChannelNameLength> m_name;
+	AnimationBinaryTrack m_positions;
+	AnimationBinaryTrack m_rotations;
+	AnimationBinaryTrack m_scales;
+
+	// Positions are quantized to U16 in the [m_positionMin, m_positionMin + m_positionRange] range.
+	Vec3 m_positionMin;
+
+	Vec3 m_positionRange;
+
+	// Scales are quantized to U16 in the [m_scaleMin, m_scaleMin + m_scaleRange] range.
+	F32 m_scaleMin;
+
+	F32 m_scaleRange;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_name", offsetof(AnimationBinaryChannel, m_name), &self.m_name[0], self.m_name.getSize());
+		s.doValue("m_positions", offsetof(AnimationBinaryChannel, m_positions), self.m_positions);
+		s.doValue("m_rotations", offsetof(AnimationBinaryChannel, m_rotations), self.m_rotations);
+		s.doValue("m_scales", offsetof(AnimationBinaryChannel, m_scales), self.m_scales);
+		s.doValue("m_positionMin", offsetof(AnimationBinaryChannel, m_positionMin), self.m_positionMin);
+		s.doValue("m_positionRange", offsetof(AnimationBinaryChannel, m_positionRange), self.m_positionRange);
+		s.doValue("m_scaleMin", offsetof(AnimationBinaryChannel, m_scaleMin), self.m_scaleMin);
+		s.doValue("m_scaleRange", offsetof(AnimationBinaryChannel, m_scaleRange), self.m_scaleRange);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryChannel&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryChannel&>(serializer, *this);
+	}
+};
+
+// The 1st thing that appears in an animation binary. Then the channels, the time segments and then the key streams: position times (U16),
+// positions (3xU16), rotation times (U16), rotations (4xI16 normalized), scale times (U16) and scales (U16).
+class AnimationBinaryHeader
+{
+public:
+	Array<U8, 8> m_magic;
+	U32 m_channelCount;
+	U32 m_positionKeyCount;
+	U32 m_rotationKeyCount;
+	U32 m_scaleKeyCount;
+	U32 m_timeSegmentCount;
+	F32 m_startTime;
+	F32 m_duration;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(AnimationBinaryHeader, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_channelCount", offsetof(AnimationBinaryHeader, m_channelCount), self.m_channelCount);
+		s.doValue("m_positionKeyCount", offsetof(AnimationBinaryHeader, m_positionKeyCount), self.m_positionKeyCount);
+		s.doValue("m_rotationKeyCount", offsetof(AnimationBinaryHeader, m_rotationKeyCount), self.m_rotationKeyCount);
+		s.doValue("m_scaleKeyCount", offsetof(AnimationBinaryHeader, m_scaleKeyCount), self.m_scaleKeyCount);
+		s.doValue("m_timeSegmentCount", offsetof(AnimationBinaryHeader, m_timeSegmentCount), self.m_timeSegmentCount);
+		s.doValue("m_startTime", offsetof(AnimationBinaryHeader, m_startTime), self.m_startTime);
+		s.doValue("m_duration", offsetof(AnimationBinaryHeader, m_duration), self.m_duration);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryHeader&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryHeader&>(serializer, *this);
+	}
+};
+
+} // end namespace anki
@@ -5,13 +5,238 @@
 
 #include <AnKi/Resource/AnimationResource.h>
 #include <AnKi/Util/Xml.h>
+#include <algorithm>
 
 namespace anki {
 
+static constexpr PtrSize kPositionKeySize = sizeof(U16) + sizeof(Array<U16, 3>);
+static constexpr PtrSize kRotationKeySize = sizeof(U16) + sizeof(Array<I16, 4>);
+static constexpr PtrSize kScaleKeySize = sizeof(U16) + sizeof(U16);
+
+static U32 computeTimeSegmentCount(U32 keyCount)
+{
+	return (keyCount + kAnimationKeysPerTimeSegment - 1) / kAnimationKeysPerTimeSegment;
+}
+
+static U16 quantizeUnorm16(F64 value)
+{
+	return U16(clamp(value, 0.0, 1.0) * F64(kMaxU16) + 0.5);
+}
+
+static I16 quantizeSnorm16(F32 value)
+{
+	value = clamp(value, -1.0f, 1.0f) * F32(kMaxI16);
+	return I16(value + ((value >= 0.0f) ? 0.5f : -0.5f));
+}
+
+static Vec4 toVec4(const Array<U16, 3>& q)
+{
+	return Vec4(F32(q[0]), F32(q[1]), F32(q[2]), 0.0f);
+}
+
+static Vec4 toVec4(const Array<I16, 4>& q)
+{
+	return Vec4(F32(q[0]), F32(q[1]), F32(q[2]), F32(q[3]));
+}
+
+// Find the key that is on the left of the time and return the interpolation factor between that key and the next one.
+// segments: The time segments of the track
+// cursor: The key that was found last time. It will be updated
+static F32 findKey(const U16* times, const AnimationTimeSegment* segments, U32 keyCount, F32 keyTime, U32& cursor)
+{
+	ANKI_ASSERT(keyCount > 1);
+
+	auto getKeyTime = [&](U32 k) {
+		const AnimationTimeSegment& segment = segments[k / kAnimationKeysPerTimeSegment];
+		return segment.m_startTime + F32(times[k]) * segment.m_timeScale;
+	};
+
+	U32 k = cursor;
+	if(k >= keyCount - 1 || getKeyTime(k) > keyTime) [[unlikely]]
+	{
+		// Went back in time (eg the animation looped) or the cursor is new, do a binary search for the 1st key that is after the time
+		U32 begin = 0;
+		U32 end = keyCount;
+		while(begin < end)
+		{
+			const U32 middle = (begin + end) / 2;
+			if(keyTime < getKeyTime(middle))
+			{
+				end = middle;
+			}
+			else
+			{
+				begin = middle + 1;
+			}
+		}
+
+		k = min(max(begin, 1u) - 1, keyCount - 2);
+	}
+
+	while(k + 2 < keyCount && getKeyTime(k + 1) <= keyTime)
+	{
+		++k;
+	}
+
+	cursor = k;
+
+	const F32 left = getKeyTime(k);
+	const F32 right = getKeyTime(k + 1);
+	return (right > left) ? clamp((keyTime - left) / (right - left), 0.0f, 1.0f) : 0.0f;
+}
+
 Error AnimationResource::load(const ResourceFilename& filename, [[maybe_unused]] Bool async)
 {
-	m_startTime = kMaxSecond;
-	Second maxTime = kMinSecond;
+	ResourceFilePtr file;
+	ANKI_CHECK(openFile(filename, file));
+
+	// Check the magic to see if it's a binary or the old XML format
+	Array<U8, 8> magic = {};
+	if(file->getSize() >= sizeof(magic))
+	{
+		ANKI_CHECK(file->read(&magic[0], sizeof(magic)));
+	}
+
+	if(memcmp(&magic[0], kAnimationMagic, sizeof(magic)) != 0)
+	{
+		file.reset(nullptr);
+		return loadXml(filename);
+	}
+
+	ConstWeakArray<U8> inMemory = file->getContentsInMemory();
+	if(inMemory.getSize())
+	{
+		return loadBinary(ConstWeakArray<U8, PtrSize>(inMemory.getBegin(), inMemory.getSize()));
+	}
+
+	ResourceDynamicArrayLarge<U8> data;
+	data.resize(file->getSize());
+	ANKI_CHECK(file->seek(0, FileSeekOrigin::kBeginning));
+	ANKI_CHECK(file->read(&data[0], data.getSize()));
+
+	return loadBinary(data);
+}
+
+Error AnimationResource::loadBinary(ConstWeakArray<U8, PtrSize> data)
+{
+	AnimationBinaryHeader header;
+	if(data.getSize() < sizeof(header))
+	{
+		ANKI_RESOURCE_LOGE("Animation binary is too small");
+		return Error::kUserData;
+	}
+
+	memcpy(&header, &data[0], sizeof(header));
+	if(memcmp(&header.m_magic[0], kAnimationMagic, header.m_magic.getSize()) != 0)
+	{
+		ANKI_RESOURCE_LOGE("Wrong animation magic");
+		return Error::kUserData;
+	}
+
+	if(header.m_channelCount == 0)
+	{
+		ANKI_RESOURCE_LOGE("Didn't found any channels");
+		return Error::kUserData;
+	}
+
+	const PtrSize expectedSize = sizeof(AnimationBinaryHeader) + sizeof(AnimationBinaryChannel) * header.m_channelCount
+								 + sizeof(AnimationBinaryTimeSegment) * header.m_timeSegmentCount + kPositionKeySize * header.m_positionKeyCount
+								 + kRotationKeySize * header.m_rotationKeyCount + kScaleKeySize * header.m_scaleKeyCount;
+	if(data.getSize() != expectedSize)
+	{
+		ANKI_RESOURCE_LOGE("Animation binary has wrong size");
+		return Error::kUserData;
+	}
+
+	m_startTime = header.m_startTime;
+	m_duration = max(0.0f, header.m_duration);
+
+	// Channels
+	const U8* ptr = &data[sizeof(header)];
+	m_channels.resize(header.m_channelCount);
+	for(AnimationChannel& ch : m_channels)
+	{
+		AnimationBinaryChannel inCh;
+		memcpy(&inCh, ptr, sizeof(inCh));
+		ptr += sizeof(inCh);
+
+		if(inCh.m_name.getBack() != '\0')
+		{
+			ANKI_RESOURCE_LOGE("Channel name is not terminated");
+			return Error::kUserData;
+		}
+
+		const Array<AnimationBinaryTrack, 3> tracks = {inCh.m_positions, inCh.m_rotations, inCh.m_scales};
+		const Array<U32, 3> keyCounts = {header.m_positionKeyCount, header.m_rotationKeyCount, header.m_scaleKeyCount};
+		for(U32 i = 0; i < 3; ++i)
+		{
+			if(tracks[i].m_firstKey > keyCounts[i] || tracks[i].m_keyCount > keyCounts[i] - tracks[i].m_firstKey)
+			{
+				ANKI_RESOURCE_LOGE("Channel keys are out of bounds");
+				return Error::kUserData;
+			}
+
+			if(tracks[i].m_firstTimeSegment > header.m_timeSegmentCount
+			   || computeTimeSegmentCount(tracks[i].m_keyCount) > header.m_timeSegmentCount - tracks[i].m_firstTimeSegment)
+			{
+				ANKI_RESOURCE_LOGE("Channel time segments are out of bounds");
+				return Error::kUserData;
+			}
+		}
+
+		ch.m_name = &inCh.m_name[0];
+		ch.m_positions = inCh.m_positions;
+		ch.m_rotations = inCh.m_rotations;
+		ch.m_scales = inCh.m_scales;
+		ch.m_positionMin = Vec4(inCh.m_positionMin, 0.0f);
+		ch.m_positionScale = Vec4(inCh.m_positionRange / F32(kMaxU16), 0.0f);
+		ch.m_scaleMin = inCh.m_scaleMin;
+		ch.m_scaleScale = inCh.m_scaleRange / F32(kMaxU16);
+	}
+
+	// Time segments
+	m_timeSegments.resize(header.m_timeSegmentCount);
+	for(AnimationTimeSegment& segment : m_timeSegments)
+	{
+		AnimationBinaryTimeSegment inSegment;
+		memcpy(&inSegment, ptr, sizeof(inSegment));
+		ptr += sizeof(inSegment);
+
+		segment.m_startTime = inSegment.m_startTime;
+		segment.m_timeScale = inSegment.m_duration / F32(kMaxU16);
+	}
+
+	// Key streams
+	auto readStream = [&](auto& arr, U32 count) {
+		arr.resize(count);
+		if(count)
+		{
+			memcpy(&arr[0], ptr, arr.getSizeInBytes());
+			ptr += arr.getSizeInBytes();
+		}
+	};
+
+	readStream(m_positionTimes, header.m_positionKeyCount);
+	readStream(m_positions, header.m_positionKeyCount);
+	readStream(m_rotationTimes, header.m_rotationKeyCount);
+	readStream(m_rotations, header.m_rotationKeyCount);
+	readStream(m_scaleTimes, header.m_scaleKeyCount);
+	readStream(m_scales, header.m_scaleKeyCount);
+	ANKI_ASSERT(ptr == data.getBegin() + data.getSize());
+
+	return Error::kNone;
+}
+
+Error AnimationResource::loadXml(const ResourceFilename& filename)
+{
+	class Channel
+	{
+	public:
+		ResourceString m_name;
+		ResourceDynamicArray<AnimationKeyframe<Vec3>> m_positions;
+		ResourceDynamicArray<AnimationKeyframe<Quat>> m_rotations;
+		ResourceDynamicArray<AnimationKeyframe<F32>> m_scales;
+	};
 
 	// Document
 	ResourceXmlDocument doc;
@@ -19,11 +244,6 @@ Error AnimationResource::load(const ResourceFilename& filename, [[maybe_unused]]
 	XmlElement rootel;
 	ANKI_CHECK(doc.getChildElement("animation", rootel));
 
-	// Count the number of identity keys. If all of the keys are identities drop a vector
-	U identPosCount = 0;
-	U identRotCount = 0;
-	U identScaleCount = 0;
-
 	// <channels>
 	XmlElement channelsEl;
 	ANKI_CHECK(rootel.getChildElement("channels", channelsEl));
@@ -38,13 +258,19 @@ Error AnimationResource::load(const ResourceFilename& filename, [[maybe_unused]]
 		ANKI_RESOURCE_LOGE("Didn't found any channels");
 		return Error::kUserData;
 	}
-	m_channels.resize(channelCount);
+	ResourceDynamicArray<Channel> channels;
+	channels.resize(channelCount);
 
 	// For all channels
 	channelCount = 0;
 	do
 	{
-		AnimationChannel& ch = m_channels[channelCount];
+		Channel& ch = channels[channelCount];
+
+		// Count the number of identity keys. If all of the keys are identities drop a vector
+		U32 identPosCount = 0;
+		U32 identRotCount = 0;
+		U32 identScaleCount = 0;
 
 		// <name>
 		CString strtmp;
@@ -71,8 +297,6 @@ Error AnimationResource::load(const ResourceFilename& filename, [[maybe_unused]]
 
 				// time
 				ANKI_CHECK(keyEl.getAttributeNumber("time", key.m_time));
-				m_startTime = min(m_startTime, key.m_time);
-				maxTime = max(maxTime, key.m_time);
 
 				// value
 				ANKI_CHECK(keyEl.getNumbers(key.m_value));
@@ -106,8 +330,6 @@ Error AnimationResource::load(const ResourceFilename& filename, [[maybe_unused]]
 
 				// time
 				ANKI_CHECK(keyEl.getAttributeNumber("time", key.m_time));
-				m_startTime = min(m_startTime, key.m_time);
-				maxTime = max(maxTime, key.m_time);
 
 				// value
 				ANKI_CHECK(keyEl.getNumbers(key.m_value));
@@ -141,8 +363,6 @@ Error AnimationResource::load(const ResourceFilename& filename, [[maybe_unused]]
 
 				// time
 				ANKI_CHECK(keyEl.getAttributeNumber("time", key.m_time));
-				m_startTime = std::min(m_startTime, key.m_time);
-				maxTime = std::max(maxTime, key.m_time);
 
 				// value
 				ANKI_CHECK(keyEl.getNumber(key.m_value));
@@ -179,79 +399,338 @@ Error AnimationResource::load(const ResourceFilename& filename, [[maybe_unused]]
 		ANKI_CHECK(chEl.getNextSiblingElement("channel", chEl));
 	} while(chEl);
 
-	m_duration = maxTime - m_startTime;
+	// Compress the keys the same way the importer does
+	ResourceDynamicArray<AnimationChannelKeyframes> keyframes;
+	keyframes.resize(channels.getSize());
+	for(U32 i = 0; i < channels.getSize(); ++i)
+	{
+		keyframes[i].m_name = channels[i].m_name;
+		keyframes[i].m_positions = channels[i].m_positions;
+		keyframes[i].m_rotations = channels[i].m_rotations;
+		keyframes[i].m_scales = channels[i].m_scales;
+	}
 
-	return Error::kNone;
+	ResourceDynamicArrayLarge<U8> binary;
+	binary.resize(computeBinarySize(keyframes));
+	ANKI_CHECK(encodeBinary(keyframes, WeakArray<U8, PtrSize>(binary)));
+
+	return loadBinary(binary);
 }
 
-void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Quat& rot, F32& scale) const
+PtrSize AnimationResource::computeBinarySize(ConstWeakArray<AnimationChannelKeyframes> channels)
 {
-	pos = Vec3(0.0f);
-	rot = Quat::getIdentity();
-	scale = 1.0f;
+	PtrSize size = sizeof(AnimationBinaryHeader) + sizeof(AnimationBinaryChannel) * channels.getSize();
+	for(const AnimationChannelKeyframes& ch : channels)
+	{
+		size += kPositionKeySize * ch.m_positions.getSize() + kRotationKeySize * ch.m_rotations.getSize() + kScaleKeySize * ch.m_scales.getSize();
+		size += sizeof(AnimationBinaryTimeSegment)
+				* (computeTimeSegmentCount(ch.m_positions.getSize()) + computeTimeSegmentCount(ch.m_rotations.getSize())
+				   + computeTimeSegmentCount(ch.m_scales.getSize()));
+	}
 
-	if(time < m_startTime) [[unlikely]]
+	return size;
+}
+
+Error AnimationResource::encodeBinary(ConstWeakArray<AnimationChannelKeyframes> channels, WeakArray<U8, PtrSize> out)
+{
+	ANKI_ASSERT(out.getSize() == computeBinarySize(channels));
+
+	AnimationBinaryHeader header = {};
+	memcpy(&header.m_magic[0], kAnimationMagic, header.m_magic.getSize());
+	header.m_channelCount = channels.getSize();
+
+	// Find the time range and the key counts
+	Second startTime = kMaxSecond;
+	Second endTime = kMinSecond;
+	auto updateTimeRange = [&](auto keys) {
+		for(const auto& key : keys)
+		{
+			startTime = min(startTime, key.getTime());
+			endTime = max(endTime, key.getTime());
+		}
+	};
+
+	for(const AnimationChannelKeyframes& ch : channels)
 	{
-		return;
+		updateTimeRange(ch.m_positions);
+		updateTimeRange(ch.m_rotations);
+		updateTimeRange(ch.m_scales);
+
+		header.m_positionKeyCount += ch.m_positions.getSize();
+		header.m_rotationKeyCount += ch.m_rotations.getSize();
+		header.m_scaleKeyCount += ch.m_scales.getSize();
+
+		header.m_timeSegmentCount += computeTimeSegmentCount(ch.m_positions.getSize()) + computeTimeSegmentCount(ch.m_rotations.getSize())
+									 + computeTimeSegmentCount(ch.m_scales.getSize());
 	}
 
-	// Audjust time
-	if(time > m_startTime + m_duration)
+	if(startTime > endTime)
 	{
-		time = mod(time - m_startTime, m_duration) + m_startTime;
+		// No keys
+		startTime = endTime = 0.0;
 	}
 
-	ANKI_ASSERT(time >= m_startTime && time <= m_startTime + m_duration);
-	ANKI_ASSERT(channelIndex < m_channels.getSize());
+	const Second duration = endTime - startTime;
+	header.m_startTime = F32(startTime);
+	header.m_duration = F32(duration);
+
+	// Compute where everything goes
+	U8* channelsOut = &out[sizeof(header)];
+	U8* timeSegmentsOut = channelsOut + sizeof(AnimationBinaryChannel) * header.m_channelCount;
+	U8* positionTimesOut = timeSegmentsOut + sizeof(AnimationBinaryTimeSegment) * header.m_timeSegmentCount;
+	U8* positionsOut = positionTimesOut + sizeof(U16) * header.m_positionKeyCount;
+	U8* rotationTimesOut = positionsOut + sizeof(Array<U16, 3>) * header.m_positionKeyCount;
+	U8* rotationsOut = rotationTimesOut + sizeof(U16) * header.m_rotationKeyCount;
+	U8* scaleTimesOut = rotationsOut + sizeof(Array<I16, 4>) * header.m_rotationKeyCount;
+	U8* scalesOut = scaleTimesOut + sizeof(U16) * header.m_scaleKeyCount;
+
+	auto write = [](U8*& ptr, const auto& value) {
+		memcpy(ptr, &value, sizeof(value));
+		ptr += sizeof(value);
+	};
+
+	memcpy(&out[0], &header, sizeof(header));
+
+	// Write the time segments of a track and its quantized key times
+	U32 timeSegmentCount = 0;
+	auto writeTimes = [&](auto keys, U8*& timesOut) -> U32 {
+		const U32 firstTimeSegment = timeSegmentCount;
+		for(U32 segmentFirstKey = 0; segmentFirstKey < keys.getSize(); segmentFirstKey += kAnimationKeysPerTimeSegment)
+		{
+			const U32 segmentEndKey = min(segmentFirstKey + kAnimationKeysPerTimeSegment, keys.getSize());
+			const Second segmentStartTime = keys[segmentFirstKey].getTime();
+			const Second segmentDuration = keys[segmentEndKey - 1].getTime() - segmentStartTime;
 
-	const AnimationChannel& channel = m_channels[channelIndex];
+			AnimationBinaryTimeSegment segment;
+			segment.m_startTime = F32(segmentStartTime - startTime);
+			segment.m_duration = F32(segmentDuration);
+			write(timeSegmentsOut, segment);
+			++timeSegmentCount;
 
-	// Position
-	if(channel.m_positions.getSize() > 1)
+			for(U32 k = segmentFirstKey; k < segmentEndKey; ++k)
+			{
+				const U16 q = (segmentDuration > 0.0) ? quantizeUnorm16((keys[k].getTime() - segmentStartTime) / segmentDuration) : 0;
+				write(timesOut, q);
+			}
+		}
+
+		return firstTimeSegment;
+	};
+
+	U32 positionKeyCount = 0;
+	U32 rotationKeyCount = 0;
+	U32 scaleKeyCount = 0;
+	for(const AnimationChannelKeyframes& ch : channels)
 	{
-		for(U32 i = 0; i < channel.m_positions.getSize() - 1; ++i)
+		AnimationBinaryChannel outCh = {};
+
+		if(ch.m_name.getLength() >= kAnimationMaxChannelNameLength)
 		{
-			const AnimationKeyframe<Vec3>& left = channel.m_positions[i];
-			const AnimationKeyframe<Vec3>& right = channel.m_positions[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
+			ANKI_RESOURCE_LOGE("Channel name is too long: %s", ch.m_name.cstr());
+			return Error::kUserData;
+		}
+		memcpy(&outCh.m_name[0], ch.m_name.cstr(), ch.m_name.getLength());
+
+		// Positions. Quantize them to the bounding box of the channel
+		outCh.m_positions = {positionKeyCount, ch.m_positions.getSize(), writeTimes(ch.m_positions, positionTimesOut)};
+		positionKeyCount += ch.m_positions.getSize();
+
+		Vec3 posMin(kMaxF32);
+		Vec3 posMax(kMinF32);
+		for(const AnimationKeyframe<Vec3>& key : ch.m_positions)
+		{
+			posMin = posMin.min(key.getValue());
+			posMax = posMax.max(key.getValue());
+		}
+
+		if(ch.m_positions.getSize())
+		{
+			outCh.m_positionMin = posMin;
+			outCh.m_positionRange = posMax - posMin;
+		}
+
+		for(const AnimationKeyframe<Vec3>& key : ch.m_positions)
+		{
+			Array<U16, 3> q;
+			for(U32 c = 0; c < 3; ++c)
 			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				pos = linearInterpolate(left.m_value, right.m_value, F32(u));
-				break;
+				const F32 range = outCh.m_positionRange[c];
+				q[c] = (range > 0.0f) ? quantizeUnorm16((key.getValue()[c] - posMin[c]) / range) : 0;
 			}
+			write(positionsOut, q);
 		}
-	}
 
-	// Rotation
-	if(channel.m_rotations.getSize() > 1)
-	{
-		for(U32 i = 0; i < channel.m_rotations.getSize() - 1; ++i)
+		// Rotations. Keep consecutive keys in the same hemisphere so a normalized lerp takes the shortest path
+		outCh.m_rotations = {rotationKeyCount, ch.m_rotations.getSize(), writeTimes(ch.m_rotations, rotationTimesOut)};
+		rotationKeyCount += ch.m_rotations.getSize();
+
+		Vec4 prevRot(0.0f, 0.0f, 0.0f, 1.0f);
+		for(const AnimationKeyframe<Quat>& key : ch.m_rotations)
 		{
-			const AnimationKeyframe<Quat>& left = channel.m_rotations[i];
-			const AnimationKeyframe<Quat>& right = channel.m_rotations[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
+			Vec4 rot = Vec4(key.getValue()).normalize();
+			if(rot.dot(prevRot) < 0.0f)
 			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				rot = left.m_value.slerp(right.m_value, F32(u));
-				break;
+				rot = -rot;
 			}
+			prevRot = rot;
+
+			const Array<I16, 4> q = {quantizeSnorm16(rot.x), quantizeSnorm16(rot.y), quantizeSnorm16(rot.z), quantizeSnorm16(rot.w)};
+			write(rotationsOut, q);
+		}
+
+		// Scales
+		outCh.m_scales = {scaleKeyCount, ch.m_scales.getSize(), writeTimes(ch.m_scales, scaleTimesOut)};
+		scaleKeyCount += ch.m_scales.getSize();
+
+		F32 scaleMin = kMaxF32;
+		F32 scaleMax = kMinF32;
+		for(const AnimationKeyframe<F32>& key : ch.m_scales)
+		{
+			scaleMin = min(scaleMin, key.getValue());
+			scaleMax = max(scaleMax, key.getValue());
+		}
+
+		outCh.m_scaleMin = (ch.m_scales.getSize()) ? scaleMin : 1.0f;
+		outCh.m_scaleRange = (ch.m_scales.getSize()) ? scaleMax - scaleMin : 0.0f;
+
+		for(const AnimationKeyframe<F32>& key : ch.m_scales)
+		{
+			const U16 q = (outCh.m_scaleRange > 0.0f) ? quantizeUnorm16((key.getValue() - scaleMin) / outCh.m_scaleRange) : 0;
+			write(scalesOut, q);
 		}
+
+		write(channelsOut, outCh);
+	}
+
+	ANKI_ASSERT(timeSegmentCount == header.m_timeSegmentCount);
+	ANKI_ASSERT(scalesOut == out.getBegin() + out.getSize());
+
+	return Error::kNone;
+}
+
+Bool AnimationResource::computeKeyTime(Second time, F32& keyTime) const
+{
+	if(time < m_startTime) [[unlikely]]
+	{
+		return false;
+	}
+
+	// Audjust time
+	if(time > m_startTime + m_duration)
+	{
+		time = (m_duration > 0.0) ? mod(time - m_startTime, m_duration) + m_startTime : m_startTime;
+	}
+
+	ANKI_ASSERT(time >= m_startTime && time <= m_startTime + m_duration);
+	keyTime = F32(time - m_startTime);
+	return true;
+}
+
+void AnimationResource::sampleChannel(const AnimationChannel& channel, F32 keyTime, AnimationCursor& cursor, AnimationSample& sample) const
+{
+	// Position. Interpolate in the quantized space and then dequantize
+	const AnimationBinaryTrack& positions = channel.m_positions;
+	if(positions.m_keyCount > 1)
+	{
+		const U32 first = positions.m_firstKey;
+		const F32 u =
+			findKey(&m_positionTimes[first], &m_timeSegments[positions.m_firstTimeSegment], positions.m_keyCount, keyTime, cursor.m_positionKey);
+		const U32 k = first + cursor.m_positionKey;
+		const Vec4 pos = toVec4(m_positions[k]).lerp(toVec4(m_positions[k + 1]), u);
+		sample.m_position = (channel.m_positionMin + pos * channel.m_positionScale).xyz;
+	}
+	else if(positions.m_keyCount == 1)
+	{
+		sample.m_position = (channel.m_positionMin + toVec4(m_positions[positions.m_firstKey]) * channel.m_positionScale).xyz;
+	}
+	else
+	{
+		sample.m_position = Vec3(0.0f);
+	}
+
+	// Rotation. The keys are in the same hemisphere so use normalized lerp. The normalization removes the quantization scale as well
+	const AnimationBinaryTrack& rotations = channel.m_rotations;
+	if(rotations.m_keyCount > 1)
+	{
+		const U32 first = rotations.m_firstKey;
+		const F32 u =
+			findKey(&m_rotationTimes[first], &m_timeSegments[rotations.m_firstTimeSegment], rotations.m_keyCount, keyTime, cursor.m_rotationKey);
+		const U32 k = first + cursor.m_rotationKey;
+		sample.m_rotation = Quat(toVec4(m_rotations[k]).lerp(toVec4(m_rotations[k + 1]), u).normalize());
+	}
+	else if(rotations.m_keyCount == 1)
+	{
+		sample.m_rotation = Quat(toVec4(m_rotations[rotations.m_firstKey]).normalize());
+	}
+	else
+	{
+		sample.m_rotation = Quat::getIdentity();
 	}
 
 	// Scale
-	if(channel.m_scales.getSize() > 1)
+	const AnimationBinaryTrack& scales = channel.m_scales;
+	if(scales.m_keyCount > 1)
+	{
+		const U32 first = scales.m_firstKey;
+		const F32 u = findKey(&m_scaleTimes[first], &m_timeSegments[scales.m_firstTimeSegment], scales.m_keyCount, keyTime, cursor.m_scaleKey);
+		const U32 k = first + cursor.m_scaleKey;
+		sample.m_scale = channel.m_scaleMin + linearInterpolate(F32(m_scales[k]), F32(m_scales[k + 1]), u) * channel.m_scaleScale;
+	}
+	else if(scales.m_keyCount == 1)
+	{
+		sample.m_scale = channel.m_scaleMin + F32(m_scales[scales.m_firstKey]) * channel.m_scaleScale;
+	}
+	else
+	{
+		sample.m_scale = 1.0f;
+	}
+}
+
+void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Quat& rot, F32& scale) const
+{
+	// A cursor that is out of bounds forces a search
+	AnimationCursor cursor;
+	cursor.m_positionKey = cursor.m_rotationKey = cursor.m_scaleKey = kMaxU32;
+	interpolate(channelIndex, time, cursor, pos, rot, scale);
+}
+
+void AnimationResource::interpolate(U32 channelIndex, Second time, AnimationCursor& cursor, Vec3& pos, Quat& rot, F32& scale) const
+{
+	ANKI_ASSERT(channelIndex < m_channels.getSize());
+
+	F32 keyTime;
+	if(!computeKeyTime(time, keyTime)) [[unlikely]]
+	{
+		pos = Vec3(0.0f);
+		rot = Quat::getIdentity();
+		scale = 1.0f;
+		return;
+	}
+
+	AnimationSample sample;
+	sampleChannel(m_channels[channelIndex], keyTime, cursor, sample);
+	pos = sample.m_position;
+	rot = sample.m_rotation;
+	scale = sample.m_scale;
+}
+
+void AnimationResource::sampleChannels(Second time, WeakArray<AnimationCursor> cursors, WeakArray<AnimationSample> samples) const
+{
+	ANKI_ASSERT(cursors.getSize() == m_channels.getSize() && samples.getSize() == m_channels.getSize());
+
+	F32 keyTime;
+	if(!computeKeyTime(time, keyTime)) [[unlikely]]
 	{
-		for(U32 i = 0; i < channel.m_scales.getSize() - 1; ++i)
+		for(AnimationSample& sample : samples)
 		{
-			const AnimationKeyframe<F32>& left = channel.m_scales[i];
-			const AnimationKeyframe<F32>& right = channel.m_scales[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
-			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				scale = linearInterpolate(left.m_value, right.m_value, F32(u));
-				break;
-			}
+			sample = {Vec3(0.0f), Quat::getIdentity(), 1.0f};
 		}
+		return;
+	}
+
+	for(U32 i = 0; i < m_channels.getSize(); ++i)
+	{
+		sampleChannel(m_channels[i], keyTime, cursors[i], samples[i]);
 	}
 }
 
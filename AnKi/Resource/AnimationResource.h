@@ -6,6 +6,7 @@
 #pragma once
 
 #include <AnKi/Resource/ResourceObject.h>
+#include <AnKi/Resource/AnimationBinary.h>
 #include <AnKi/Math.h>
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/WeakArray.h>
@@ -22,6 +23,14 @@ class AnimationKeyframe
 	friend class AnimationResource;
 
 public:
+	AnimationKeyframe() = default;
+
+	AnimationKeyframe(Second time, const T& value)
+		: m_time(time)
+		, m_value(value)
+	{
+	}
+
 	Second getTime() const
 	{
 		return m_time;
@@ -37,7 +46,17 @@ private:
 	T m_value;
 };
 
-// Animation channel
+// The uncompressed keyframes of a channel. It's the input of AnimationResource::encodeBinary().
+class AnimationChannelKeyframes
+{
+public:
+	CString m_name;
+	ConstWeakArray<AnimationKeyframe<Vec3>> m_positions;
+	ConstWeakArray<AnimationKeyframe<Quat>> m_rotations;
+	ConstWeakArray<AnimationKeyframe<F32>> m_scales;
+};
+
+// Animation channel. The keys live in the key streams of the AnimationResource.
 class AnimationChannel
 {
 public:
@@ -45,13 +64,46 @@ public:
 
 	I32 m_boneIndex = -1; // For skeletal animations
 
-	ResourceDynamicArray<AnimationKeyframe<Vec3>> m_positions;
-	ResourceDynamicArray<AnimationKeyframe<Quat>> m_rotations;
-	ResourceDynamicArray<AnimationKeyframe<F32>> m_scales;
-	ResourceDynamicArray<AnimationKeyframe<F32>> m_cameraFovs;
+	AnimationBinaryTrack m_positions = {};
+	AnimationBinaryTrack m_rotations = {};
+	AnimationBinaryTrack m_scales = {};
+
+	// Dequantization: value = min + quantizedValue * scale
+	Vec4 m_positionMin = Vec4(0.0f);
+	Vec4 m_positionScale = Vec4(0.0f);
+	F32 m_scaleMin = 1.0f;
+	F32 m_scaleScale = 0.0f;
+};
+
+// The time range of a segment of keys. The time of a key relative to the start of the clip is m_startTime + quantizedTime * m_timeScale.
+class AnimationTimeSegment
+{
+public:
+	F32 m_startTime;
+	F32 m_timeScale;
+};
+
+// Remembers the keys a channel was last sampled at. Time usually moves forward so the next sample will start searching from there and the lookup
+// is amortized O(1). Every instance that plays an animation needs its own cursors.
+class AnimationCursor
+{
+public:
+	U32 m_positionKey = 0;
+	U32 m_rotationKey = 0;
+	U32 m_scaleKey = 0;
+};
+
+// The interpolated transform of a channel.
+class AnimationSample
+{
+public:
+	Vec3 m_position;
+	Quat m_rotation;
+	F32 m_scale;
 };
 
-// Animation consists of keyframe data.
+// Animation consists of keyframe data. The keys are quantized and stored in SoA streams. The resource can be loaded from the binary format the
+// importer produces or from the old XML format.
 class AnimationResource : public ResourceObject
 {
 public:
@@ -82,13 +134,55 @@ public:
 		return m_startTime;
 	}
 
-	// Get the interpolated data
+	// The memory of the keys in bytes
+	PtrSize getKeyMemorySize() const
+	{
+		return m_positionTimes.getSizeInBytes() + m_positions.getSizeInBytes() + m_rotationTimes.getSizeInBytes() + m_rotations.getSizeInBytes()
+			   + m_scaleTimes.getSizeInBytes() + m_scales.getSizeInBytes() + m_timeSegments.getSizeInBytes();
+	}
+
+	// Get the interpolated data. It searches for the keys from scratch. Prefer the variant with the cursor when playing an animation
 	void interpolate(U32 channelIndex, Second time, Vec3& position, Quat& rotation, F32& scale) const;
 
+	// Get the interpolated data
+	void interpolate(U32 channelIndex, Second time, AnimationCursor& cursor, Vec3& position, Quat& rotation, F32& scale) const;
+
+	// Interpolate all the channels (eg the whole skeleton) at once.
+	// cursors: One cursor per channel
+	// samples: One sample per channel
+	void sampleChannels(Second time, WeakArray<AnimationCursor> cursors, WeakArray<AnimationSample> samples) const;
+
+	// Load the animation from the contents of a binary file
+	ANKI_INTERNAL Error loadBinary(ConstWeakArray<U8, PtrSize> data);
+
+	// Compute the size of the binary that encodeBinary() will produce
+	static PtrSize computeBinarySize(ConstWeakArray<AnimationChannelKeyframes> channels);
+
+	// Quantize the keys and write the binary format
+	// out: The output. Its size should be computeBinarySize()
+	static Error encodeBinary(ConstWeakArray<AnimationChannelKeyframes> channels, WeakArray<U8, PtrSize> out);
+
 private:
 	ResourceDynamicArray<AnimationChannel> m_channels;
-	Second m_duration;
-	Second m_startTime;
+
+	// The key streams
+	ResourceDynamicArray<U16> m_positionTimes;
+	ResourceDynamicArray<Array<U16, 3>> m_positions;
+	ResourceDynamicArray<U16> m_rotationTimes;
+	ResourceDynamicArray<Array<I16, 4>> m_rotations;
+	ResourceDynamicArray<U16> m_scaleTimes;
+	ResourceDynamicArray<U16> m_scales;
+	ResourceDynamicArray<AnimationTimeSegment> m_timeSegments;
+
+	Second m_duration = 0.0;
+	Second m_startTime = 0.0;
+
+	Error loadXml(const ResourceFilename& filename);
+
+	// Convert the time to a time relative to the start of the clip and loop it. Returns false if it's before the start of the animation
+	Bool computeKeyTime(Second time, F32& keyTime) const;
+
+	void sampleChannel(const AnimationChannel& channel, F32 keyTime, AnimationCursor& cursor, AnimationSample& sample) const;
 };
 
 } // end namespace anki
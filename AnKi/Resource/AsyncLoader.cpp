@@ -12,27 +12,65 @@
 namespace anki {
 
 ANKI_SVAR(AsyncTasksInFlight, StatCategory::kMisc, "Async loader tasks", StatFlag::kNone)
+ANKI_SVAR(AsyncLoaderIoQueueDepth, StatCategory::kMisc, "Async loader I/O queue", StatFlag::kNone)
+ANKI_SVAR(AsyncLoaderDecodeQueueDepth, StatCategory::kMisc, "Async loader decode queue", StatFlag::kNone)
+ANKI_SVAR(AsyncLoaderIoLatency, StatCategory::kTime, "Async loader I/O wait", StatFlag::kMilisecond | StatFlag::kShowAverage)
+ANKI_SVAR(AsyncLoaderDecodeLatency, StatCategory::kTime, "Async loader decode wait", StatFlag::kMilisecond | StatFlag::kShowAverage)
 
 AsyncLoader::AsyncLoader()
-	: m_thread("AsyncLoad")
+	: AsyncLoader(g_cvarRsrcAsyncLoaderIoThreadCount, g_cvarRsrcAsyncLoaderDecodeThreadCount)
 {
-	m_thread.start(this, threadCallback);
+}
+
+AsyncLoader::AsyncLoader(U32 ioThreadCount, U32 decodeThreadCount)
+{
+	ANKI_ASSERT(ioThreadCount > 0 && decodeThreadCount > 0);
+
+	m_threads.resize(ioThreadCount + decodeThreadCount);
+	for(U32 i = 0; i < m_threads.getSize(); ++i)
+	{
+		const U32 stage = (i < ioThreadCount) ? kIoStage : kDecodeStage;
+		Array<Char, Thread::kThreadNameMaxLength + 1> name;
+		if(stage == kIoStage)
+		{
+			snprintf(name.getBegin(), name.getSize(), "AsyncIo#%u", i);
+		}
+		else
+		{
+			snprintf(name.getBegin(), name.getSize(), "AsyncDecode#%u", i - ioThreadCount);
+		}
+
+		m_threads[i] = newInstance<WorkerThread>(ResourceMemoryPool::getSingleton(), name.getBegin(), this, stage);
+	}
+
+	for(WorkerThread* thread : m_threads)
+	{
+		thread->m_thread.start(thread, threadCallback);
+	}
 }
 
 AsyncLoader::~AsyncLoader()
 {
 	stop();
 
-	for(auto& queue : m_taskQueues)
+	for(WorkerThread* thread : m_threads)
 	{
-		if(!queue.isEmpty())
-		{
-			ANKI_RESOURCE_LOGW("Stoping loading thread while there is work to do");
+		deleteInstance(ResourceMemoryPool::getSingleton(), thread);
+	}
 
-			while(!queue.isEmpty())
+	for(Stage& stage : m_stages)
+	{
+		for(auto& queue : stage.m_taskQueues)
+		{
+			if(!queue.isEmpty())
 			{
-				AsyncLoaderTask* task = queue.popFront();
-				deleteInstance(ResourceMemoryPool::getSingleton(), task);
+				ANKI_RESOURCE_LOGW("Stoping loading thread while there is work to do");
+
+				while(!queue.isEmpty())
+				{
+					AsyncLoaderTask* task = queue.popFront();
+					deleteInstance(ResourceMemoryPool::getSingleton(), task);
+				}
 			}
 		}
 	}
@@ -43,21 +81,38 @@ void AsyncLoader::stop()
 	{
 		LockGuard<Mutex> lock(m_mtx);
 		m_quit = true;
-		m_condVar.notifyOne();
+		for(Stage& stage : m_stages)
+		{
+			stage.m_condVar.notifyAll();
+		}
 	}
 
-	[[maybe_unused]] Error err = m_thread.join();
+	for(WorkerThread* thread : m_threads)
+	{
+		[[maybe_unused]] Error err = thread->m_thread.join();
+	}
 }
 
 Error AsyncLoader::threadCallback(ThreadCallbackInfo& info)
 {
-	AsyncLoader& self = *reinterpret_cast<AsyncLoader*>(info.m_userData);
-	return self.threadWorker();
+	WorkerThread& thread = *reinterpret_cast<WorkerThread*>(info.m_userData);
+	return thread.m_loader->threadWorker(thread.m_stage);
+}
+
+void AsyncLoader::pushTask(AsyncLoaderTask* task, AsyncLoaderPriority priority, U32 stageIdx)
+{
+	Stage& stage = m_stages[stageIdx];
+	task->m_enqueueTime = HighRezTimer::getCurrentTime();
+	stage.m_taskQueues[priority].pushBack(task);
+	++stage.m_taskCount;
+	((stageIdx == kIoStage) ? g_svarAsyncLoaderIoQueueDepth : g_svarAsyncLoaderDecodeQueueDepth).set(stage.m_taskCount);
+	stage.m_condVar.notifyOne();
 }
 
-Error AsyncLoader::threadWorker()
+Error AsyncLoader::threadWorker(U32 stageIdx)
 {
 	Error err = Error::kNone;
+	Stage& stage = m_stages[stageIdx];
 
 	while(!err)
 	{
@@ -68,10 +123,9 @@ Error AsyncLoader::threadWorker()
 		// Block until there is work to do
 		{
 			LockGuard<Mutex> lock(m_mtx);
-			while(m_taskQueues[AsyncLoaderPriority::kHigh].isEmpty() && m_taskQueues[AsyncLoaderPriority::kMedium].isEmpty()
-				  && m_taskQueues[AsyncLoaderPriority::kLow].isEmpty() && !m_quit)
+			while(stage.m_taskCount == 0 && !m_quit)
 			{
-				m_condVar.wait(m_mtx);
+				stage.m_condVar.wait(m_mtx);
 			}
 
 			if(m_quit)
@@ -82,13 +136,17 @@ Error AsyncLoader::threadWorker()
 			{
 				for(AsyncLoaderPriority priority : EnumIterable<AsyncLoaderPriority>())
 				{
-					if(!m_taskQueues[priority].isEmpty())
+					if(!stage.m_taskQueues[priority].isEmpty())
 					{
-						task = m_taskQueues[priority].popFront();
+						task = stage.m_taskQueues[priority].popFront();
 						taskPriority = priority;
 						break;
 					}
 				}
+
+				ANKI_ASSERT(task);
+				--stage.m_taskCount;
+				((stageIdx == kIoStage) ? g_svarAsyncLoaderIoQueueDepth : g_svarAsyncLoaderDecodeQueueDepth).set(stage.m_taskCount);
 			}
 		}
 
@@ -96,40 +154,67 @@ Error AsyncLoader::threadWorker()
 		{
 			break;
 		}
-		else
-		{
-			// Exec the task
-			ANKI_ASSERT(task);
-			AsyncLoaderTaskContext ctx;
-			ctx.m_priority = taskPriority;
 
-			{
-				// HighRezTimer::sleep(250.0_ms);
-				ANKI_TRACE_SCOPED_EVENT(RsrcAsyncTask);
-				err = (*task)(ctx);
-				g_svarAsyncTasksInFlight.decrement(1u);
-			}
+		const Second latency = HighRezTimer::getCurrentTime() - task->m_enqueueTime;
+		((stageIdx == kIoStage) ? g_svarAsyncLoaderIoLatency : g_svarAsyncLoaderDecodeLatency).set(latency * 1000.0);
 
-			if(!err)
-			{
-				m_tasksInFlightCount.fetchSub(1);
-			}
-			else
+		AsyncLoaderTaskContext ctx;
+		ctx.m_priority = taskPriority;
+
+		if(stageIdx == kIoStage)
+		{
 			{
-				ANKI_RESOURCE_LOGE("Async loader task failed");
+				ANKI_TRACE_SCOPED_EVENT(RsrcAsyncTaskIo);
+				err = task->io(ctx);
 			}
 
-			// Do other stuff
-			if(ctx.m_resubmitTask)
+			if(!err)
 			{
+				// Move to the next stage
 				LockGuard<Mutex> lock(m_mtx);
-				m_taskQueues[ctx.m_priority].pushBack(task);
+				pushTask(task, taskPriority, kDecodeStage);
 			}
 			else
 			{
-				// Delete the task
+				ANKI_RESOURCE_LOGE("Async loader task failed");
+				g_svarAsyncTasksInFlight.decrement(1u);
 				deleteInstance(ResourceMemoryPool::getSingleton(), task);
 			}
+
+			continue;
+		}
+
+		// Exec the task
+		{
+			ANKI_TRACE_SCOPED_EVENT(RsrcAsyncTask);
+			err = (*task)(ctx);
+		}
+
+		// A resubmitted task is still in flight
+		if(!ctx.m_resubmitTask)
+		{
+			g_svarAsyncTasksInFlight.decrement(1u);
+		}
+
+		if(!err && !ctx.m_resubmitTask)
+		{
+			m_tasksInFlightCount.fetchSub(1);
+		}
+		else if(err)
+		{
+			ANKI_RESOURCE_LOGE("Async loader task failed");
+		}
+
+		// Do other stuff
+		if(ctx.m_resubmitTask)
+		{
+			LockGuard<Mutex> lock(m_mtx);
+			pushTask(task, ctx.m_priority, kDecodeStage);
+		}
+		else
+		{
+			// Delete the task
+			deleteInstance(ResourceMemoryPool::getSingleton(), task);
 		}
 	}
 
@@ -144,8 +229,7 @@ void AsyncLoader::submitTask(AsyncLoaderTask* task, AsyncLoaderPriority priority
 	g_svarAsyncTasksInFlight.increment(1);
 
 	LockGuard<Mutex> lock(m_mtx);
-	m_taskQueues[priority].pushBack(task);
-	m_condVar.notifyOne();
+	pushTask(task, priority, kIoStage);
 }
 
 } // end namespace anki
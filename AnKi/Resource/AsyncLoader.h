@@ -8,12 +8,18 @@
 #include <AnKi/Resource/Common.h>
 #include <AnKi/Util/Thread.h>
 #include <AnKi/Util/List.h>
+#include <AnKi/Util/CVarSet.h>
+#include <AnKi/Util/System.h>
 
 namespace anki {
 
 // Forward
 class AsyncLoader;
 
+ANKI_CVAR(NumericCVar<U32>, Rsrc, AsyncLoaderIoThreadCount, 1u, 1u, 16u, "Number of threads that do the I/O part of the async loading tasks")
+ANKI_CVAR(NumericCVar<U32>, Rsrc, AsyncLoaderDecodeThreadCount, clamp(getCpuCoresCount() / 2u, 1u, 8u), 1u, 64u,
+		  "Number of threads that do the CPU part (decoding, uploading) of the async loading tasks")
+
 /// @addtogroup resource
 /// @{
 
@@ -33,28 +39,44 @@ ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(AsyncLoaderPriority)
 class AsyncLoaderTaskContext
 {
 public:
-	Bool m_resubmitTask = false; ///< Resubmit the same task at the end of the queue.
+	Bool m_resubmitTask = false; ///< Resubmit the same task at the end of the decode queue. The I/O part will not run again.
 	AsyncLoaderPriority m_priority = AsyncLoaderPriority::kCount;
 };
 
-/// Interface for tasks for the AsyncLoader.
+/// Interface for tasks for the AsyncLoader. A task runs in 2 stages. First the I/O stage calls io() and then the decode stage calls operator().
 /// @memberof AsyncLoader
 class AsyncLoaderTask : public IntrusiveListEnabled<AsyncLoaderTask>
 {
+	friend class AsyncLoader;
+
 public:
 	virtual ~AsyncLoaderTask()
 	{
 	}
 
+	/// Optional part of the task that reads data. There are only a few I/O threads so keep it light on CPU work.
+	virtual Error io([[maybe_unused]] AsyncLoaderTaskContext& ctx)
+	{
+		return Error::kNone;
+	}
+
+	/// The CPU heavy part of the task (decoding, uploading etc). Many of those can run in parallel.
 	virtual Error operator()(AsyncLoaderTaskContext& ctx) = 0;
+
+private:
+	Second m_enqueueTime = 0.0;
 };
 
-/// Asynchronous resource loader.
+/// Asynchronous resource loader. It has a pool of I/O threads and a pool of decode threads. Tasks go through the I/O stage first and then through
+/// the decode stage. Every stage picks the tasks with the highest priority first.
 class AsyncLoader : public MakeSingleton<AsyncLoader>
 {
 public:
+	/// Create the loader using the thread counts of the CVars.
 	AsyncLoader();
 
+	AsyncLoader(U32 ioThreadCount, U32 decodeThreadCount);
+
 	~AsyncLoader();
 
 	/// Create a new asynchronous loading task.
@@ -74,11 +96,37 @@ public:
 	}
 
 private:
-	Thread m_thread;
+	static constexpr U32 kIoStage = 0;
+	static constexpr U32 kDecodeStage = 1;
+	static constexpr U32 kStageCount = 2;
+
+	class WorkerThread
+	{
+	public:
+		Thread m_thread;
+		AsyncLoader* m_loader;
+		U32 m_stage;
+
+		WorkerThread(const Char* name, AsyncLoader* loader, U32 stage)
+			: m_thread(name)
+			, m_loader(loader)
+			, m_stage(stage)
+		{
+		}
+	};
+
+	class Stage
+	{
+	public:
+		Array<IntrusiveList<AsyncLoaderTask>, U32(AsyncLoaderPriority::kCount)> m_taskQueues;
+		ConditionVariable m_condVar;
+		U32 m_taskCount = 0;
+	};
+
+	ResourceDynamicArray<WorkerThread*> m_threads;
 
 	Mutex m_mtx;
-	ConditionVariable m_condVar;
-	Array<IntrusiveList<AsyncLoaderTask>, U32(AsyncLoaderPriority::kCount)> m_taskQueues;
+	Array<Stage, kStageCount> m_stages;
 	Bool m_quit = false;
 
 	Atomic<U32> m_tasksInFlightCount = {0};
@@ -86,7 +134,10 @@ private:
 	/// Thread callback
 	static Error threadCallback(ThreadCallbackInfo& info);
 
-	Error threadWorker();
+	Error threadWorker(U32 stage);
+
+	/// Add a task to the queue of a stage. Needs to be called with m_mtx locked.
+	void pushTask(AsyncLoaderTask* task, AsyncLoaderPriority priority, U32 stage);
 
 	void stop();
 };
@@ -229,16 +229,12 @@ public:
 	}
 };
 
-Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBinaryDataCompression& preferredCompression,
-								 DynamicArray<ImageLoaderSurface, MemoryPoolPtrWrapper<BaseMemoryPool>>& surfaces,
-								 DynamicArray<ImageLoaderVolume, MemoryPoolPtrWrapper<BaseMemoryPool>>& volumes, U32& width, U32& height, U32& depth,
-								 U32& layerCount, U32& mipCount, ImageBinaryType& imageType, ImageBinaryColorFormat& colorFormat,
-								 UVec2& astcBlockSize, Vec4& avgColor)
+Error ImageLoader::loadAnkiImageHeader(FileInterface& file, U32 maxImageSize)
 {
 	//
 	// Read and check the header
 	//
-	ImageBinaryHeader header;
+	ImageBinaryHeader& header = m_ankiHeader;
 	ANKI_CHECK(file.read(&header, sizeof(ImageBinaryHeader)));
 
 	if(std::memcmp(&header.m_magic[0], kImageMagic, sizeof(kImageMagic) - 1) != 0)
@@ -280,12 +276,12 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 		}
 	}
 
-	if(!(header.m_compressionMask & preferredCompression))
+	if(!(header.m_compressionMask & m_compression))
 	{
 		// Fallback
-		preferredCompression = ImageBinaryDataCompression::kRaw;
+		m_compression = ImageBinaryDataCompression::kRaw;
 
-		if(!(header.m_compressionMask & preferredCompression))
+		if(!(header.m_compressionMask & m_compression))
 		{
 			ANKI_RESOURCE_LOGE("File does not contain raw compression");
 			return Error::kUserData;
@@ -298,47 +294,37 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 		return Error::kUserData;
 	}
 
-	avgColor = Vec4(header.m_averageColor);
+	m_avgColor = Vec4(header.m_averageColor);
 
 	// Set a few things
-	colorFormat = header.m_colorFormat;
-	imageType = header.m_type;
-	astcBlockSize = UVec2(header.m_astcBlockSizeX, header.m_astcBlockSizeY);
+	m_colorFormat = header.m_colorFormat;
+	m_imageType = header.m_type;
+	m_astcBlockSize = UVec2(header.m_astcBlockSizeX, header.m_astcBlockSizeY);
+	m_layerCount = (header.m_type == ImageBinaryType::k2DArray) ? header.m_depthOrLayerCount : 1;
 
-	U32 faceCount = 1;
-	switch(header.m_type)
+	// Find the first mip that will be loaded. The last one is always loaded
+	const U32 depth = (header.m_type == ImageBinaryType::k3D) ? header.m_depthOrLayerCount : 1;
+	m_firstMip = 0;
+	while(m_firstMip < header.m_mipmapCount - 1 && max(max(header.m_width, header.m_height), depth) >> m_firstMip > maxImageSize)
 	{
-	case ImageBinaryType::k2D:
-		depth = 1;
-		layerCount = 1;
-		break;
-	case ImageBinaryType::kCube:
-		depth = 1;
-		layerCount = 1;
-		faceCount = 6;
-		break;
-	case ImageBinaryType::k3D:
-		depth = header.m_depthOrLayerCount;
-		layerCount = 1;
-		break;
-	case ImageBinaryType::k2DArray:
-		depth = 1;
-		layerCount = header.m_depthOrLayerCount;
-		break;
-	default:
-		ANKI_ASSERT(0);
+		++m_firstMip;
 	}
 
+	m_mipmapCount = header.m_mipmapCount - m_firstMip;
+	m_width = header.m_width >> m_firstMip;
+	m_height = header.m_height >> m_firstMip;
+	m_depth = (header.m_type == ImageBinaryType::k3D) ? depth >> m_firstMip : kMaxU32;
+
 	//
 	// Move file pointer
 	//
 	PtrSize skipSize = 0;
 
-	if(preferredCompression == ImageBinaryDataCompression::kRaw)
+	if(m_compression == ImageBinaryDataCompression::kRaw)
 	{
 		// Do nothing
 	}
-	else if(preferredCompression == ImageBinaryDataCompression::kS3tc)
+	else if(m_compression == ImageBinaryDataCompression::kS3tc)
 	{
 		if(!!(header.m_compressionMask & ImageBinaryDataCompression::kRaw))
 		{
@@ -346,7 +332,7 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 			skipSize += calcSizeOfSegment(header, ImageBinaryDataCompression::kRaw);
 		}
 	}
-	else if(preferredCompression == ImageBinaryDataCompression::kEtc)
+	else if(m_compression == ImageBinaryDataCompression::kEtc)
 	{
 		if(!!(header.m_compressionMask & ImageBinaryDataCompression::kRaw))
 		{
@@ -360,7 +346,7 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 			skipSize += calcSizeOfSegment(header, ImageBinaryDataCompression::kS3tc);
 		}
 	}
-	else if(preferredCompression == ImageBinaryDataCompression::kAstc)
+	else if(m_compression == ImageBinaryDataCompression::kAstc)
 	{
 		if(!!(header.m_compressionMask & ImageBinaryDataCompression::kRaw))
 		{
@@ -386,12 +372,14 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 		ANKI_CHECK(file.seek(skipSize, FileSeekOrigin::kCurrent));
 	}
 
-	//
-	// It's time to read
-	//
+	return Error::kNone;
+}
+
+Error ImageLoader::loadAnkiImageData(FileInterface& file)
+{
+	const ImageBinaryHeader& header = m_ankiHeader;
+	const U32 faceCount = (header.m_type == ImageBinaryType::kCube) ? 6 : 1;
 
-	// Allocate the surfaces
-	mipCount = 0;
 	if(header.m_type != ImageBinaryType::k3D)
 	{
 		// Read all surfaces
@@ -399,24 +387,22 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 		U32 mipHeight = header.m_height;
 		for(U32 mip = 0; mip < header.m_mipmapCount; mip++)
 		{
-			for(U32 l = 0; l < layerCount; l++)
+			for(U32 l = 0; l < m_layerCount; l++)
 			{
 				for(U32 f = 0; f < faceCount; ++f)
 				{
-					const PtrSize dataSize = calcSurfaceSize(mipWidth, mipHeight, preferredCompression, header.m_colorFormat,
+					const PtrSize dataSize = calcSurfaceSize(mipWidth, mipHeight, m_compression, header.m_colorFormat,
 															 UVec2(header.m_astcBlockSizeX, header.m_astcBlockSizeY));
 
 					// Check if this mipmap can be skipped because of size
-					if(max(mipWidth, mipHeight) <= maxImageSize || mip == header.m_mipmapCount - 1)
+					if(mip >= m_firstMip)
 					{
-						ImageLoaderSurface& surf = *surfaces.emplaceBack(surfaces.getMemoryPool());
+						ImageLoaderSurface& surf = *m_surfaces.emplaceBack(m_surfaces.getMemoryPool());
 						surf.m_width = mipWidth;
 						surf.m_height = mipHeight;
 
 						surf.m_data.resize(dataSize);
 						ANKI_CHECK(file.read(&surf.m_data[0], dataSize));
-
-						mipCount = max(header.m_mipmapCount - mip, mipCount);
 					}
 					else
 					{
@@ -428,10 +414,6 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 			mipWidth /= 2;
 			mipHeight /= 2;
 		}
-
-		width = surfaces[0].m_width;
-		height = surfaces[0].m_height;
-		depth = kMaxU32;
 	}
 	else
 	{
@@ -440,20 +422,18 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 		U32 mipDepth = header.m_depthOrLayerCount;
 		for(U32 mip = 0; mip < header.m_mipmapCount; mip++)
 		{
-			const U32 dataSize = U32(calcVolumeSize(mipWidth, mipHeight, mipDepth, preferredCompression, header.m_colorFormat));
+			const U32 dataSize = U32(calcVolumeSize(mipWidth, mipHeight, mipDepth, m_compression, header.m_colorFormat));
 
 			// Check if this mipmap can be skipped because of size
-			if(max(max(mipWidth, mipHeight), mipDepth) <= maxImageSize || mip == header.m_mipmapCount - 1)
+			if(mip >= m_firstMip)
 			{
-				ImageLoaderVolume& vol = *volumes.emplaceBack(surfaces.getMemoryPool());
+				ImageLoaderVolume& vol = *m_volumes.emplaceBack(m_surfaces.getMemoryPool());
 				vol.m_width = mipWidth;
 				vol.m_height = mipHeight;
 				vol.m_depth = mipDepth;
 
 				vol.m_data.resize(dataSize);
 				ANKI_CHECK(file.read(&vol.m_data[0], dataSize));
-
-				mipCount = max(header.m_mipmapCount - mip, mipCount);
 			}
 			else
 			{
@@ -464,10 +444,6 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 			mipHeight /= 2;
 			mipDepth /= 2;
 		}
-
-		width = volumes[0].m_width;
-		height = volumes[0].m_height;
-		depth = volumes[0].m_depth;
 	}
 
 	return Error::kNone;
@@ -515,15 +491,46 @@ Error ImageLoader::loadStb(Bool isFloat, FileInterface& fs, U32& width, U32& hei
 }
 
 Error ImageLoader::load(ResourceFilePtr rfile, const CString& filename, U32 maxImageSize)
+{
+	ANKI_CHECK(loadHeader(std::move(rfile), filename, maxImageSize));
+	return loadData();
+}
+
+Error ImageLoader::loadHeader(ResourceFilePtr rfile, const CString& filename, U32 maxImageSize)
 {
 	RsrcFile file;
 	file.m_rfile = std::move(rfile);
 
-	const Error err = loadInternal(file, filename, maxImageSize);
+	Bool dataPending;
+	const Error err = loadInternal(file, filename, maxImageSize, dataPending);
 	if(err)
 	{
 		ANKI_RESOURCE_LOGE("Failed to read image: %s", filename.cstr());
 	}
+	else if(dataPending)
+	{
+		m_pendingDataFile = std::move(file.m_rfile);
+	}
+
+	return err;
+}
+
+Error ImageLoader::loadData()
+{
+	if(!m_pendingDataFile)
+	{
+		// Nothing to read or everything was read by loadHeader()
+		return Error::kNone;
+	}
+
+	RsrcFile file;
+	file.m_rfile = std::move(m_pendingDataFile);
+
+	const Error err = loadAnkiImageData(file);
+	if(err)
+	{
+		ANKI_RESOURCE_LOGE("Failed to read image data");
+	}
 
 	return err;
 }
@@ -533,7 +540,13 @@ Error ImageLoader::load(const CString& filename, U32 maxImageSize)
 	SystemFile file;
 	ANKI_CHECK(file.m_file.open(filename, FileOpenFlag::kRead | FileOpenFlag::kBinary));
 
-	const Error err = loadInternal(file, filename, maxImageSize);
+	Bool dataPending;
+	Error err = loadInternal(file, filename, maxImageSize, dataPending);
+	if(!err && dataPending)
+	{
+		err = loadAnkiImageData(file);
+	}
+
 	if(err)
 	{
 		ANKI_RESOURCE_LOGE("Failed to read image: %s", filename.cstr());
@@ -542,8 +555,10 @@ Error ImageLoader::load(const CString& filename, U32 maxImageSize)
 	return err;
 }
 
-Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U32 maxImageSize)
+Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U32 maxImageSize, Bool& dataPending)
 {
+	dataPending = false;
+
 	// get the extension
 	const String ext = getFileExtension(filename);
 
@@ -567,8 +582,8 @@ Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U3
 		m_compression = ImageBinaryDataCompression::kS3tc;
 #endif
 
-		ANKI_CHECK(loadAnkiImage(file, maxImageSize, m_compression, m_surfaces, m_volumes, m_width, m_height, m_depth, m_layerCount, m_mipmapCount,
-								 m_imageType, m_colorFormat, m_astcBlockSize, m_avgColor));
+		ANKI_CHECK(loadAnkiImageHeader(file, maxImageSize));
+		dataPending = true;
 	}
 	else if(ext == "png" || ext == "jpg" || ext == "tga")
 	{
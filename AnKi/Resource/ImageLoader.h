@@ -120,6 +120,13 @@ public:
 	/// Load a resource image file.
 	Error load(ResourceFilePtr file, const CString& filename, U32 maxImageSize = kMaxU32);
 
+	/// Load only the properties of a resource image file (size, format, mip count etc). The surfaces of AnKi images are read later by loadData().
+	/// Other formats are decoded whole by this call.
+	Error loadHeader(ResourceFilePtr file, const CString& filename, U32 maxImageSize = kMaxU32);
+
+	/// Read the surfaces after a call to loadHeader(). It can be called from another thread.
+	Error loadData();
+
 	/// Load a system image file.
 	Error load(const CString& filename, U32 maxImageSize = kMaxU32);
 
@@ -146,18 +153,21 @@ private:
 	ImageBinaryColorFormat m_colorFormat = ImageBinaryColorFormat::kNone;
 	ImageBinaryType m_imageType = ImageBinaryType::kNone;
 
+	ImageBinaryHeader m_ankiHeader = {};
+	U32 m_firstMip = 0; ///< The first mip of the file that will be loaded. The bigger ones are skipped because of maxImageSize.
+	ResourceFilePtr m_pendingDataFile; ///< Set by loadHeader() if the surfaces are still to be read.
+
 	void destroy();
 
 	static Error loadStb(Bool isFloat, FileInterface& fs, U32& width, U32& height,
 						 DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>, PtrSize>& data);
 
-	static Error loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBinaryDataCompression& preferredCompression,
-							   DynamicArray<ImageLoaderSurface, MemoryPoolPtrWrapper<BaseMemoryPool>>& surfaces,
-							   DynamicArray<ImageLoaderVolume, MemoryPoolPtrWrapper<BaseMemoryPool>>& volumes, U32& width, U32& height, U32& depth,
-							   U32& layerCount, U32& mipCount, ImageBinaryType& imageType, ImageBinaryColorFormat& colorFormat, UVec2& astcBlockSize,
-							   Vec4& avgColor);
+	/// Read the header and move the file pointer to the surfaces of m_compression.
+	Error loadAnkiImageHeader(FileInterface& file, U32 maxImageSize);
+
+	Error loadAnkiImageData(FileInterface& file);
 
-	Error loadInternal(FileInterface& file, const CString& filename, U32 maxImageSize);
+	Error loadInternal(FileInterface& file, const CString& filename, U32 maxImageSize, Bool& dataPending);
 };
 
 } // end namespace anki
@@ -26,6 +26,11 @@ class ImageResource::TexUploadTask : public AsyncLoaderTask
 public:
 	ImageResource::LoadingContext m_ctx;
 
+	Error io([[maybe_unused]] AsyncLoaderTaskContext& ctx) final
+	{
+		return m_ctx.m_loader.loadData();
+	}
+
 	Error operator()([[maybe_unused]] AsyncLoaderTaskContext& ctx) final
 	{
 		return m_ctx.m_image->loadAsync(m_ctx);
@@ -69,7 +74,8 @@ Error ImageResource::load(const ResourceFilename& filename, Bool async)
 	ResourceFilePtr file;
 	ANKI_CHECK(openFile(filename, file));
 
-	ANKI_CHECK(loader.load(file, filename, g_cvarRsrcMaxImageSize));
+	// Only read the properties of the image here. The surfaces are read by the I/O stage of the async loader
+	ANKI_CHECK(loader.loadHeader(file, filename, g_cvarRsrcMaxImageSize));
 
 	m_avgColor = loader.getAverageColor();
 
@@ -258,6 +264,7 @@ Error ImageResource::load(const ResourceFilename& filename, Bool async)
 	}
 	else
 	{
+		ANKI_CHECK(loader.loadData());
 		ANKI_CHECK(loadAsync(*ctx));
 	}
 
@@ -42,6 +42,35 @@ Error MeshBinaryLoader::load(const ResourceFilename& filename)
 	return Error::kNone;
 }
 
+Error MeshBinaryLoader::loadBuffers()
+{
+	ANKI_ASSERT(isLoaded());
+
+	const PtrSize buffersOffset = sizeof(m_header) + m_subMeshes.getSizeInBytes();
+	m_buffersData.resize(m_file->getSize() - buffersOffset);
+	ANKI_CHECK(m_file->seek(buffersOffset, FileSeekOrigin::kBeginning));
+	ANKI_CHECK(m_file->read(&m_buffersData[0], m_buffersData.getSizeInBytes()));
+
+	return Error::kNone;
+}
+
+Error MeshBinaryLoader::readBufferData(PtrSize offset, void* ptr, PtrSize size)
+{
+	if(m_buffersData.getSize())
+	{
+		const PtrSize buffersOffset = sizeof(m_header) + m_subMeshes.getSizeInBytes();
+		ANKI_ASSERT(offset >= buffersOffset && offset - buffersOffset + size <= m_buffersData.getSizeInBytes());
+		memcpy(ptr, &m_buffersData[offset - buffersOffset], size);
+	}
+	else
+	{
+		ANKI_CHECK(m_file->seek(offset, FileSeekOrigin::kBeginning));
+		ANKI_CHECK(m_file->read(ptr, size));
+	}
+
+	return Error::kNone;
+}
+
 Error MeshBinaryLoader::loadSubmeshes()
 {
 	m_subMeshes.resize(m_header.m_subMeshCount);
@@ -283,8 +312,7 @@ Error MeshBinaryLoader::storeIndexBuffer(U32 lod, void* ptr, PtrSize size)
 		seek += getLodBuffersSize(l);
 	}
 
-	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::kBeginning));
-	ANKI_CHECK(m_file->read(ptr, size));
+	ANKI_CHECK(readBufferData(seek, ptr, size));
 
 	return Error::kNone;
 }
@@ -310,8 +338,7 @@ Error MeshBinaryLoader::storeVertexBuffer(U32 lod, U32 bufferIdx, void* ptr, Ptr
 		seek += getVertexBufferSize(lod, i);
 	}
 
-	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::kBeginning));
-	ANKI_CHECK(m_file->read(ptr, size));
+	ANKI_CHECK(readBufferData(seek, ptr, size));
 
 	return Error::kNone;
 }
@@ -339,8 +366,7 @@ Error MeshBinaryLoader::storeMeshletIndicesBuffer(U32 lod, void* ptr, PtrSize si
 
 	seek += getMeshletsBufferSize(lod);
 
-	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::kBeginning));
-	ANKI_CHECK(m_file->read(ptr, size));
+	ANKI_CHECK(readBufferData(seek, ptr, size));
 
 	return Error::kNone;
 }
@@ -365,8 +391,7 @@ Error MeshBinaryLoader::storeMeshletBuffer(U32 lod, WeakArray<MeshBinaryMeshlet>
 		seek += getVertexBufferSize(lod, i);
 	}
 
-	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::kBeginning));
-	ANKI_CHECK(m_file->read(&out[0], out.getSizeInBytes()));
+	ANKI_CHECK(readBufferData(seek, &out[0], out.getSizeInBytes()));
 
 	return Error::kNone;
 }
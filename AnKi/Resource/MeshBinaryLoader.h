@@ -33,6 +33,7 @@ class MeshBinaryLoader
 public:
 	MeshBinaryLoader(BaseMemoryPool* pool)
 		: m_subMeshes(pool)
+		, m_buffersData(pool)
 	{
 		ANKI_ASSERT(pool);
 	}
@@ -41,6 +42,9 @@ public:
 
 	Error load(const ResourceFilename& filename);
 
+	/// Read the buffers of all LODs in memory. After that the store methods copy from memory instead of touching the file. Call it after load().
+	Error loadBuffers();
+
 	Error storeIndexBuffer(U32 lod, void* ptr, PtrSize size);
 
 	Error storeVertexBuffer(U32 lod, U32 bufferIdx, void* ptr, PtrSize size);
@@ -70,6 +74,9 @@ private:
 
 	DynamicArray<MeshBinarySubMesh, MemoryPoolPtrWrapper<BaseMemoryPool>> m_subMeshes;
 
+	/// The file contents after the submeshes. Populated by loadBuffers().
+	DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>, PtrSize> m_buffersData;
+
 	Bool isLoaded() const
 	{
 		return m_file.get() != nullptr;
@@ -108,6 +115,7 @@ private:
 	Error checkHeader() const;
 	Error checkFormat(VertexStreamId stream, Bool isOptional, Bool canBeTransformed) const;
 	Error loadSubmeshes();
+	Error readBufferData(PtrSize offset, void* ptr, PtrSize size);
 };
 /// @}
 
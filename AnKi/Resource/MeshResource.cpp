@@ -39,6 +39,11 @@ public:
 	{
 	}
 
+	Error io([[maybe_unused]] AsyncLoaderTaskContext& ctx) final
+	{
+		return m_ctx.m_loader.loadBuffers();
+	}
+
 	Error operator()([[maybe_unused]] AsyncLoaderTaskContext& ctx) final
 	{
 		return m_ctx.m_mesh->loadAsync(m_ctx.m_loader);
@@ -0,0 +1,387 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Resource/ResourceArchive.h>
+#include <AnKi/Resource/ResourceFilesystem.h>
+#include <AnKi/Util/Tracer.h>
+#include <ZLib/zlib.h>
+
+namespace anki {
+
+static constexpr U32 kLocalHeaderSignature = 0x04034b50;
+static constexpr U32 kCentralDirHeaderSignature = 0x02014b50;
+static constexpr U32 kEndOfCentralDirSignature = 0x06054b50;
+static constexpr U32 kLocalHeaderSize = 30;
+static constexpr U32 kCentralDirHeaderSize = 46;
+static constexpr U32 kEndOfCentralDirSize = 22;
+
+// Zip is little endian and so are all the platforms we support. Values are not aligned though
+template<typename T>
+static T readLittleEndian(const U8* p)
+{
+	T out;
+	memcpy(&out, p, sizeof(T));
+	return out;
+}
+
+// A file inside an archive
+class ArchiveResourceFile final : public ResourceFile
+{
+public:
+	ResourceArchivePtr m_archive;
+	const ResourceArchive::Entry* m_entry = nullptr;
+	const U8* m_data = nullptr;
+	PtrSize m_pos = 0; // Position in the uncompressed data
+
+	z_stream m_zstream = {};
+	Bool m_zstreamInitialized = false;
+
+	~ArchiveResourceFile()
+	{
+		if(m_zstreamInitialized)
+		{
+			inflateEnd(&m_zstream);
+		}
+	}
+
+	Error open(const ResourceArchive& archive, const ResourceArchive::Entry& entry)
+	{
+		m_archive.reset(const_cast<ResourceArchive*>(&archive));
+		m_entry = &entry;
+		ANKI_CHECK(archive.getEntryData(entry, m_data));
+
+		if(entry.m_compressed)
+		{
+			// Raw deflate stream, zip doesn't have the zlib header
+			if(inflateInit2(&m_zstream, -MAX_WBITS) != Z_OK)
+			{
+				ANKI_RESOURCE_LOGE("inflateInit2() failed");
+				return Error::kFunctionFailed;
+			}
+
+			m_zstreamInitialized = true;
+			restartDecompression(0);
+		}
+
+		return Error::kNone;
+	}
+
+	Error read(void* buff, PtrSize size) override
+	{
+		ANKI_TRACE_SCOPED_EVENT(RsrcFileRead);
+
+		if(m_pos + size > m_entry->m_uncompressedSize)
+		{
+			ANKI_RESOURCE_LOGE("Reading past the end of the file: %s", m_entry->m_filename.cstr());
+			return Error::kFileAccess;
+		}
+
+		if(m_entry->m_compressed)
+		{
+			ANKI_CHECK(decompress(buff, size));
+		}
+		else
+		{
+			memcpy(buff, m_data + m_pos, size);
+			m_pos += size;
+		}
+
+		return Error::kNone;
+	}
+
+	Error readAllText(ResourceString& out) override
+	{
+		const PtrSize size = m_entry->m_uncompressedSize;
+		ANKI_ASSERT(size);
+		out = ResourceString('?', size);
+		return read(&out[0], size);
+	}
+
+	Error readU32(U32& u) override
+	{
+		// Assume machine and file have same endianness
+		ANKI_CHECK(read(&u, sizeof(u)));
+		return Error::kNone;
+	}
+
+	Error readF32(F32& u) override
+	{
+		// Assume machine and file have same endianness
+		ANKI_CHECK(read(&u, sizeof(u)));
+		return Error::kNone;
+	}
+
+	Error seek(PtrSize offset, FileSeekOrigin origin) override
+	{
+		PtrSize target;
+		switch(origin)
+		{
+		case FileSeekOrigin::kBeginning:
+			target = offset;
+			break;
+		case FileSeekOrigin::kCurrent:
+			target = m_pos + offset;
+			break;
+		default:
+			ANKI_ASSERT(origin == FileSeekOrigin::kEnd);
+			target = m_entry->m_uncompressedSize + offset;
+		}
+
+		if(target > m_entry->m_uncompressedSize)
+		{
+			ANKI_RESOURCE_LOGE("Seeking past the end of the file: %s", m_entry->m_filename.cstr());
+			return Error::kFileAccess;
+		}
+
+		if(!m_entry->m_compressed)
+		{
+			m_pos = target;
+			return Error::kNone;
+		}
+
+		if(m_entry->m_seekBlockSize)
+		{
+			// Jump to the block that contains the target if we have to go back or if it saves some decompression
+			const U32 targetBlock = min(U32(target / m_entry->m_seekBlockSize), m_entry->m_seekBlockCount - 1);
+			const U32 crntBlock = U32(m_pos / m_entry->m_seekBlockSize);
+			if(target < m_pos || targetBlock > crntBlock)
+			{
+				restartDecompression(targetBlock);
+			}
+		}
+		else if(target < m_pos)
+		{
+			restartDecompression(0);
+		}
+
+		// Decompress until the target
+		Array<U8, 4_KB> scratch;
+		while(m_pos < target)
+		{
+			const PtrSize toSkip = min<PtrSize>(target - m_pos, scratch.getSize());
+			ANKI_CHECK(decompress(scratch.getBegin(), toSkip));
+		}
+
+		return Error::kNone;
+	}
+
+	PtrSize getSize() const override
+	{
+		return m_entry->m_uncompressedSize;
+	}
+
+	ConstWeakArray<U8> getContentsInMemory() const override
+	{
+		if(m_entry->m_compressed)
+		{
+			return {};
+		}
+
+		return ConstWeakArray<U8>(m_data, m_entry->m_uncompressedSize);
+	}
+
+	void restartDecompression(U32 block)
+	{
+		ANKI_ASSERT(m_zstreamInitialized);
+		const U32 compressedOffset = (block > 0) ? m_archive->m_seekBlockOffsets[m_entry->m_firstSeekBlock + block] : 0;
+
+		inflateReset(&m_zstream);
+		m_zstream.next_in = const_cast<U8*>(m_data + compressedOffset);
+		m_zstream.avail_in = m_entry->m_compressedSize - compressedOffset;
+		m_pos = PtrSize(block) * m_entry->m_seekBlockSize;
+	}
+
+	Error decompress(void* buff, PtrSize size)
+	{
+		m_zstream.next_out = static_cast<U8*>(buff);
+		m_zstream.avail_out = uInt(size);
+		ANKI_ASSERT(m_zstream.avail_out == size);
+
+		while(m_zstream.avail_out > 0)
+		{
+			const int ret = inflate(&m_zstream, Z_NO_FLUSH);
+			if((ret != Z_OK && ret != Z_STREAM_END) || (ret == Z_STREAM_END && m_zstream.avail_out > 0))
+			{
+				ANKI_RESOURCE_LOGE("Decompression failed: %s", m_entry->m_filename.cstr());
+				return Error::kFileAccess;
+			}
+		}
+
+		m_pos += size;
+		return Error::kNone;
+	}
+};
+
+Error ResourceArchive::open(CString filename)
+{
+	ANKI_TRACE_FUNCTION();
+
+	m_filename = filename;
+	ANKI_CHECK(m_file.map(filename));
+
+	const U8* data = m_file.getData();
+	const PtrSize size = m_file.getSize();
+
+	// Find the end of central directory record. It's at the end of the file followed by a comment of up to 64K
+	const U8* eocd = nullptr;
+	if(size >= kEndOfCentralDirSize)
+	{
+		const PtrSize lowestOffset = (size > kEndOfCentralDirSize + kMaxU16) ? size - kEndOfCentralDirSize - kMaxU16 : 0;
+		for(PtrSize offset = size - kEndOfCentralDirSize + 1; offset-- > lowestOffset;)
+		{
+			if(readLittleEndian<U32>(data + offset) == kEndOfCentralDirSignature)
+			{
+				eocd = data + offset;
+				break;
+			}
+		}
+	}
+
+	if(!eocd)
+	{
+		ANKI_RESOURCE_LOGE("Not a zip archive: %s", filename.cstr());
+		return Error::kUserData;
+	}
+
+	const U16 entryCount = readLittleEndian<U16>(eocd + 10);
+	const U32 centralDirSize = readLittleEndian<U32>(eocd + 12);
+	const U32 centralDirOffset = readLittleEndian<U32>(eocd + 16);
+	if(entryCount == kMaxU16 || centralDirOffset == kMaxU32)
+	{
+		ANKI_RESOURCE_LOGE("Zip64 archives are not supported: %s", filename.cstr());
+		return Error::kUserData;
+	}
+
+	if(PtrSize(centralDirOffset) + centralDirSize > size)
+	{
+		ANKI_RESOURCE_LOGE("Corrupted archive: %s", filename.cstr());
+		return Error::kUserData;
+	}
+
+	// Parse the central directory
+	m_entries.resize(entryCount);
+	const U8* it = data + centralDirOffset;
+	const U8* end = it + centralDirSize;
+	for(Entry& entry : m_entries)
+	{
+		if(it + kCentralDirHeaderSize > end || readLittleEndian<U32>(it) != kCentralDirHeaderSignature)
+		{
+			ANKI_RESOURCE_LOGE("Corrupted archive: %s", filename.cstr());
+			return Error::kUserData;
+		}
+
+		const U16 flags = readLittleEndian<U16>(it + 8);
+		const U16 method = readLittleEndian<U16>(it + 10);
+		const U16 filenameLen = readLittleEndian<U16>(it + 28);
+		const U16 extraLen = readLittleEndian<U16>(it + 30);
+		const U16 commentLen = readLittleEndian<U16>(it + 32);
+		entry.m_compressedSize = readLittleEndian<U32>(it + 20);
+		entry.m_uncompressedSize = readLittleEndian<U32>(it + 24);
+		entry.m_localHeaderOffset = readLittleEndian<U32>(it + 42);
+
+		const U8* filenameBegin = it + kCentralDirHeaderSize;
+		const U8* extra = filenameBegin + filenameLen;
+		const U8* next = extra + extraLen + commentLen;
+		if(next > end)
+		{
+			ANKI_RESOURCE_LOGE("Corrupted archive: %s", filename.cstr());
+			return Error::kUserData;
+		}
+
+		entry.m_filename = ResourceString(reinterpret_cast<const Char*>(filenameBegin), reinterpret_cast<const Char*>(extra));
+
+		if(flags & 1)
+		{
+			ANKI_RESOURCE_LOGE("Encrypted entries are not supported: %s", entry.m_filename.cstr());
+			return Error::kUserData;
+		}
+
+		if(method != 0 && method != Z_DEFLATED)
+		{
+			ANKI_RESOURCE_LOGE("Unsupported compression method %u: %s", method, entry.m_filename.cstr());
+			return Error::kUserData;
+		}
+		entry.m_compressed = method == Z_DEFLATED;
+
+		// Search the extra fields for the seek table
+		const U8* extraEnd = extra + extraLen;
+		while(entry.m_compressed && extra + 4 <= extraEnd)
+		{
+			const U16 id = readLittleEndian<U16>(extra);
+			const U16 fieldSize = readLittleEndian<U16>(extra + 2);
+			const U8* fieldData = extra + 4;
+			extra = fieldData + fieldSize;
+			if(id != kResourceArchiveSeekTableExtraFieldId || extra > extraEnd || fieldSize < 8)
+			{
+				continue;
+			}
+
+			const U32 blockSize = readLittleEndian<U32>(fieldData);
+			const U32 blockCount = readLittleEndian<U32>(fieldData + 4);
+			if(blockSize == 0 || blockCount == 0 || fieldSize != 8 + blockCount * sizeof(U32))
+			{
+				ANKI_RESOURCE_LOGE("Ignoring corrupted seek table: %s", entry.m_filename.cstr());
+				continue;
+			}
+
+			entry.m_seekBlockSize = blockSize;
+			entry.m_seekBlockCount = blockCount;
+			entry.m_firstSeekBlock = m_seekBlockOffsets.getSize();
+			for(U32 i = 0; i < blockCount; ++i)
+			{
+				m_seekBlockOffsets.emplaceBack(readLittleEndian<U32>(fieldData + 8 + i * sizeof(U32)));
+			}
+		}
+
+		it = next;
+	}
+
+	ANKI_RESOURCE_LOGV("Archive %s has %u entries", filename.cstr(), entryCount);
+	return Error::kNone;
+}
+
+Error ResourceArchive::getEntryData(const Entry& entry, const U8*& out) const
+{
+	const U8* data = m_file.getData();
+	const PtrSize size = m_file.getSize();
+
+	if(PtrSize(entry.m_localHeaderOffset) + kLocalHeaderSize > size
+	   || readLittleEndian<U32>(data + entry.m_localHeaderOffset) != kLocalHeaderSignature)
+	{
+		ANKI_RESOURCE_LOGE("Corrupted archive %s. Entry: %s", m_filename.cstr(), entry.m_filename.cstr());
+		return Error::kUserData;
+	}
+
+	// The local header has its own filename and extra field that may differ from the central directory's
+	const U16 filenameLen = readLittleEndian<U16>(data + entry.m_localHeaderOffset + 26);
+	const U16 extraLen = readLittleEndian<U16>(data + entry.m_localHeaderOffset + 28);
+	const PtrSize dataOffset = PtrSize(entry.m_localHeaderOffset) + kLocalHeaderSize + filenameLen + extraLen;
+	if(dataOffset + entry.m_compressedSize > size)
+	{
+		ANKI_RESOURCE_LOGE("Corrupted archive %s. Entry: %s", m_filename.cstr(), entry.m_filename.cstr());
+		return Error::kUserData;
+	}
+
+	for(U32 i = 0; i < entry.m_seekBlockCount; ++i)
+	{
+		if(m_seekBlockOffsets[entry.m_firstSeekBlock + i] >= entry.m_compressedSize)
+		{
+			ANKI_RESOURCE_LOGE("Corrupted seek table in archive %s. Entry: %s", m_filename.cstr(), entry.m_filename.cstr());
+			return Error::kUserData;
+		}
+	}
+
+	out = data + dataOffset;
+	return Error::kNone;
+}
+
+Error ResourceArchive::openFile(U32 entryIdx, ResourceFile*& file) const
+{
+	ArchiveResourceFile* afile = newInstance<ArchiveResourceFile>(ResourceMemoryPool::getSingleton());
+	file = afile;
+	return afile->open(*this, m_entries[entryIdx]);
+}
+
+} // end namespace anki
@@ -0,0 +1,94 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Resource/Common.h>
+#include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/Ptr.h>
+
+namespace anki {
+
+// Forward
+class ResourceFile;
+
+// The ID of a custom zip extra field that holds a seek table for deflated entries. Entries with a seek table are compressed in blocks and the
+// compressor does a full flush at the end of every block so decompression can start from the beginning of any block. Layout (little endian):
+// U16 ID, U16 data size, U32 uncompressed block size, U32 block count, U32 compressed offset of every block (relative to the entry's data)
+constexpr U16 kResourceArchiveSeekTableExtraFieldId = 0x4B41; // "AK"
+
+// A zip archive that is memory mapped once and its central directory is parsed once. Files are served straight from the mapped memory. Only
+// stored and deflated entries are supported, without encryption and without zip64.
+class ResourceArchive
+{
+	friend class ArchiveResourceFile;
+
+public:
+	class Entry
+	{
+	public:
+		ResourceString m_filename;
+		U32 m_localHeaderOffset = 0;
+		U32 m_compressedSize = 0;
+		U32 m_uncompressedSize = 0;
+		U32 m_seekBlockSize = 0; // Zero if there is no seek table
+		U32 m_firstSeekBlock = 0; // Index to ResourceArchive::m_seekBlockOffsets
+		U32 m_seekBlockCount = 0;
+		Bool m_compressed = false;
+	};
+
+	ResourceArchive() = default;
+
+	ResourceArchive(const ResourceArchive&) = delete; // Non-copyable
+
+	~ResourceArchive() = default;
+
+	ResourceArchive& operator=(const ResourceArchive&) = delete; // Non-copyable
+
+	// Map the archive and parse its central directory.
+	Error open(CString filename);
+
+	ConstWeakArray<Entry> getEntries() const
+	{
+		return m_entries;
+	}
+
+	// Open an entry for reading. The returned file holds a reference to the archive. The file is always returned (even on error) and the caller
+	// needs to delete it.
+	Error openFile(U32 entryIdx, ResourceFile*& file) const;
+
+	void retain() const
+	{
+		m_refcount.fetchAdd(1);
+	}
+
+	I32 release() const
+	{
+		return m_refcount.fetchSub(1);
+	}
+
+private:
+	MemoryMappedFile m_file;
+	ResourceString m_filename;
+	ResourceDynamicArray<Entry> m_entries;
+	ResourceDynamicArray<U32> m_seekBlockOffsets;
+	mutable Atomic<I32> m_refcount = {0};
+
+	// Get the raw (maybe compressed) data of an entry.
+	Error getEntryData(const Entry& entry, const U8*& data) const;
+};
+
+class ResourceArchiveDeleter
+{
+public:
+	void operator()(ResourceArchive* x)
+	{
+		deleteInstance(ResourceMemoryPool::getSingleton(), x);
+	}
+};
+
+using ResourceArchivePtr = IntrusivePtr<ResourceArchive, ResourceArchiveDeleter>;
+
+} // end namespace anki
@@ -0,0 +1,200 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Resource/ResourceArchivePacker.h>
+#include <AnKi/Resource/ResourceArchive.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Filesystem.h>
+#include <ZLib/zlib.h>
+#include <ZLib/contrib/minizip/zip.h>
+
+namespace anki {
+
+// Deflate the data in blocks. Every block ends with a full flush so it can be decompressed without the previous blocks.
+static Error compressBlocks(ConstWeakArray<U8> in, const ResourceArchivePackerConfig& config, DynamicArray<U8>& out, DynamicArray<U32>& blockOffsets)
+{
+	z_stream zstream = {};
+	if(deflateInit2(&zstream, config.m_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		ANKI_RESOURCE_LOGE("deflateInit2() failed");
+		return Error::kFunctionFailed;
+	}
+
+	out.resize(U32(deflateBound(&zstream, uLong(in.getSize()))) + 64_KB);
+
+	const U32 blockCount = (in.getSize() + config.m_blockSize - 1) / config.m_blockSize;
+	Error err = Error::kNone;
+	for(U32 block = 0; block < blockCount && !err; ++block)
+	{
+		blockOffsets.emplaceBack(U32(zstream.total_out));
+
+		const U32 offset = block * config.m_blockSize;
+		zstream.next_in = const_cast<U8*>(&in[offset]);
+		zstream.avail_in = min(config.m_blockSize, in.getSize() - offset);
+
+		const Bool lastBlock = block == blockCount - 1;
+		const int flush = (lastBlock) ? Z_FINISH : Z_FULL_FLUSH;
+		do
+		{
+			// Make room if needed. Full flushes add a few bytes on top of the deflateBound()
+			if(out.getSize() - zstream.total_out < 1_KB)
+			{
+				out.resize(out.getSize() * 2);
+			}
+
+			zstream.next_out = &out[U32(zstream.total_out)];
+			zstream.avail_out = out.getSize() - U32(zstream.total_out);
+
+			const int ret = deflate(&zstream, flush);
+			if(ret == Z_STREAM_ERROR)
+			{
+				ANKI_RESOURCE_LOGE("deflate() failed");
+				err = Error::kFunctionFailed;
+				break;
+			}
+
+			if(lastBlock ? ret == Z_STREAM_END : (zstream.avail_in == 0 && zstream.avail_out > 0))
+			{
+				break;
+			}
+		} while(true);
+	}
+
+	out.resize(U32(zstream.total_out));
+	deflateEnd(&zstream);
+	return err;
+}
+
+static Error addFile(zipFile zip, CString filename, const ResourceArchivePackerConfig& config, PtrSize& totalIn, PtrSize& totalOut)
+{
+	String fullFilename;
+	fullFilename.sprintf("%s/%s", config.m_inputDirectory.cstr(), filename.cstr());
+
+	DynamicArray<U8> data;
+	File file;
+	ANKI_CHECK(file.open(fullFilename, FileOpenFlag::kRead | FileOpenFlag::kBinary));
+	data.resize(U32(file.getSize()));
+	if(data.getSize())
+	{
+		ANKI_CHECK(file.read(&data[0], data.getSize()));
+	}
+
+	DynamicArray<U8> compressed;
+	DynamicArray<U32> blockOffsets;
+	if(data.getSize())
+	{
+		ANKI_CHECK(compressBlocks(data, config, compressed, blockOffsets));
+	}
+
+	const Bool store = data.getSize() == 0 || U64(compressed.getSize()) * 100 > U64(data.getSize()) * (100 - config.m_minSavingPercent);
+
+	// Write the seek table in an extra field of the central directory
+	DynamicArray<U8> extraField;
+	if(!store && blockOffsets.getSize() > 1)
+	{
+		const U32 fieldSize = 8 + blockOffsets.getSize() * U32(sizeof(U32));
+		if(fieldSize > kMaxU16)
+		{
+			ANKI_RESOURCE_LOGE("Too many blocks. Increase the block size: %s", filename.cstr());
+			return Error::kUserData;
+		}
+
+		auto append = [&](auto value) {
+			const U32 offset = extraField.getSize();
+			extraField.resize(offset + sizeof(value));
+			memcpy(&extraField[offset], &value, sizeof(value));
+		};
+
+		append(kResourceArchiveSeekTableExtraFieldId);
+		append(U16(fieldSize));
+		append(config.m_blockSize);
+		append(blockOffsets.getSize());
+		for(U32 offset : blockOffsets)
+		{
+			append(offset);
+		}
+	}
+
+	zip_fileinfo info = {};
+	if(zipOpenNewFileInZip2(zip, filename.cstr(), &info, nullptr, 0, (extraField.getSize()) ? &extraField[0] : nullptr, extraField.getSize(), nullptr,
+							(store) ? 0 : Z_DEFLATED, config.m_level, 1)
+	   != ZIP_OK)
+	{
+		ANKI_RESOURCE_LOGE("zipOpenNewFileInZip2() failed: %s", filename.cstr());
+		return Error::kFunctionFailed;
+	}
+
+	const DynamicArray<U8>& toWrite = (store) ? data : compressed;
+	if(toWrite.getSize() && zipWriteInFileInZip(zip, &toWrite[0], toWrite.getSize()) != ZIP_OK)
+	{
+		ANKI_RESOURCE_LOGE("zipWriteInFileInZip() failed: %s", filename.cstr());
+		return Error::kFunctionFailed;
+	}
+
+	const uLong crc = (data.getSize()) ? crc32(0, &data[0], data.getSize()) : 0;
+	if(zipCloseFileInZipRaw(zip, data.getSize(), crc) != ZIP_OK)
+	{
+		ANKI_RESOURCE_LOGE("zipCloseFileInZipRaw() failed: %s", filename.cstr());
+		return Error::kFunctionFailed;
+	}
+
+	ANKI_RESOURCE_LOGV("Packed %s: %u -> %u bytes%s", filename.cstr(), data.getSize(), toWrite.getSize(), (store) ? " (stored)" : "");
+	totalIn += data.getSize();
+	totalOut += toWrite.getSize();
+	return Error::kNone;
+}
+
+Error packResourceArchive(const ResourceArchivePackerConfig& config)
+{
+	DynamicArray<String> filenames;
+	ANKI_CHECK(walkDirectoryTree(config.m_inputDirectory, [&](WalkDirectoryArgs& args) -> Error {
+		if(!args.m_isDirectory)
+		{
+			String& fname = *filenames.emplaceBack(args.m_path);
+			fname.replaceAll("\\", "/");
+		}
+		return Error::kNone;
+	}));
+
+	if(filenames.getSize() >= kMaxU16)
+	{
+		ANKI_RESOURCE_LOGE("Too many files. Zip64 is not supported");
+		return Error::kUserData;
+	}
+
+	zipFile zip = zipOpen(config.m_outputFilename.cstr(), APPEND_STATUS_CREATE);
+	if(!zip)
+	{
+		ANKI_RESOURCE_LOGE("zipOpen() failed: %s", config.m_outputFilename.cstr());
+		return Error::kFileAccess;
+	}
+
+	PtrSize totalIn = 0;
+	PtrSize totalOut = 0;
+	Error err = Error::kNone;
+	for(const String& fname : filenames)
+	{
+		err = addFile(zip, fname, config, totalIn, totalOut);
+		if(err)
+		{
+			break;
+		}
+	}
+
+	if(zipClose(zip, nullptr) != ZIP_OK && !err)
+	{
+		ANKI_RESOURCE_LOGE("zipClose() failed: %s", config.m_outputFilename.cstr());
+		err = Error::kFileAccess;
+	}
+
+	if(!err)
+	{
+		ANKI_RESOURCE_LOGI("Packed %u files: %zu -> %zu bytes", filenames.getSize(), totalIn, totalOut);
+	}
+
+	return err;
+}
+
+} // end namespace anki
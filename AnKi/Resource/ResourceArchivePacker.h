@@ -0,0 +1,27 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Resource/Common.h>
+#include <AnKi/Util/String.h>
+
+namespace anki {
+
+class ResourceArchivePackerConfig
+{
+public:
+	CString m_inputDirectory;
+	CString m_outputFilename;
+	U32 m_blockSize = 64_KB; // Compress in blocks of that many bytes so ResourceArchive can seek fast
+	I32 m_level = 6; // Compression level
+	U32 m_minSavingPercent = 5; // Store a file uncompressed if compression saves less than that percent
+};
+
+// Pack a directory into an archive that ResourceArchive can open. Deflated entries get a seek table (see
+// kResourceArchiveSeekTableExtraFieldId). It uses the DefaultMemoryPool so it can run outside the engine.
+Error packResourceArchive(const ResourceArchivePackerConfig& config);
+
+} // end namespace anki
@@ -6,7 +6,6 @@
 #include <AnKi/Resource/ResourceFilesystem.h>
 #include <AnKi/Util/Filesystem.h>
 #include <AnKi/Util/Tracer.h>
-#include <ZLib/contrib/minizip/unzip.h>
 #if ANKI_OS_ANDROID
 #	include <android_native_app_glue.h>
 #endif
@@ -94,136 +93,6 @@ public:
 	}
 };
 
-/// ZIP file
-class ZipResourceFile final : public ResourceFile
-{
-public:
-	unzFile m_archive = nullptr;
-	PtrSize m_size = 0;
-
-	~ZipResourceFile()
-	{
-		if(m_archive)
-		{
-			// It's open
-			unzClose(m_archive);
-			m_archive = nullptr;
-			m_size = 0;
-		}
-	}
-
-	Error open(const CString& archive, const CString& archivedFname)
-	{
-		// Open archive
-		m_archive = unzOpen(&archive[0]);
-		if(m_archive == nullptr)
-		{
-			ANKI_RESOURCE_LOGE("Failed to open archive");
-			return Error::kFileAccess;
-		}
-
-		// Locate archived
-		const int caseSensitive = 1;
-		if(unzLocateFile(m_archive, &archivedFname[0], caseSensitive) != UNZ_OK)
-		{
-			ANKI_RESOURCE_LOGE("Failed to locate file in archive");
-			return Error::kFileAccess;
-		}
-
-		// Open file
-		if(unzOpenCurrentFile(m_archive) != UNZ_OK)
-		{
-			ANKI_RESOURCE_LOGE("unzOpenCurrentFile() failed");
-			return Error::kFileAccess;
-		}
-
-		// Get size just in case
-		unz_file_info zinfo;
-		zinfo.uncompressed_size = 0;
-		unzGetCurrentFileInfo(m_archive, &zinfo, nullptr, 0, nullptr, 0, nullptr, 0);
-		m_size = zinfo.uncompressed_size;
-		ANKI_ASSERT(m_size != 0);
-
-		return Error::kNone;
-	}
-
-	void close()
-	{
-		if(m_archive)
-		{
-			unzClose(m_archive);
-			m_archive = nullptr;
-			m_size = 0;
-		}
-	}
-
-	Error read(void* buff, PtrSize size) override
-	{
-		ANKI_TRACE_SCOPED_EVENT(RsrcFileRead);
-
-		I64 readSize = unzReadCurrentFile(m_archive, buff, U32(size));
-
-		if(I64(size) != readSize)
-		{
-			ANKI_RESOURCE_LOGE("File read failed");
-			return Error::kFileAccess;
-		}
-
-		return Error::kNone;
-	}
-
-	Error readAllText(ResourceString& out) override
-	{
-		ANKI_ASSERT(m_size);
-		out = ResourceString('?', m_size);
-		return read(&out[0], m_size);
-	}
-
-	Error readU32(U32& u) override
-	{
-		// Assume machine and file have same endianness
-		ANKI_CHECK(read(&u, sizeof(u)));
-		return Error::kNone;
-	}
-
-	Error readF32(F32& u) override
-	{
-		// Assume machine and file have same endianness
-		ANKI_CHECK(read(&u, sizeof(u)));
-		return Error::kNone;
-	}
-
-	Error seek(PtrSize offset, FileSeekOrigin origin) override
-	{
-		// Rewind if needed
-		if(origin == FileSeekOrigin::kBeginning)
-		{
-			if(unzCloseCurrentFile(m_archive) || unzOpenCurrentFile(m_archive))
-			{
-				ANKI_RESOURCE_LOGE("Rewind failed");
-				return Error::kFunctionFailed;
-			}
-		}
-
-		// Move forward by reading dummy data
-		Array<char, 128> buff;
-		while(offset != 0)
-		{
-			PtrSize toRead = min<PtrSize>(offset, sizeof(buff));
-			ANKI_CHECK(read(&buff[0], toRead));
-			offset -= toRead;
-		}
-
-		return Error::kNone;
-	}
-
-	PtrSize getSize() const override
-	{
-		ANKI_ASSERT(m_size > 0);
-		return m_size;
-	}
-};
-
 ResourceFilesystem::~ResourceFilesystem()
 {
 }
@@ -258,6 +127,7 @@ Error ResourceFilesystem::addNewPath(CString filepath_, const ResourceStringList
 
 	U32 fileCount = 0; // Count files manually because it's slower to get that number from the list
 	ResourceStringList filenameList;
+	ResourceDynamicArray<U32> archiveEntryIndices;
 	constexpr CString archiveExtension(".ankizip");
 	constexpr CString allowedExtensions[] = {".ankiprog", ".ankiprogbin", ".ankitex", ".ankimtl", ".ankimesh", ".ankiskel", ".ankianim", ".ankiscene",
 											 ".ankipart", ".png",         ".jpg",     ".jpeg",    ".tga",      ".lua",      ".ttf"};
@@ -310,43 +180,23 @@ Error ResourceFilesystem::addNewPath(CString filepath_, const ResourceStringList
 	{
 		// It's an archive
 
-		// Open
-		unzFile zfile = unzOpen(&filepath[0]);
-		if(!zfile)
-		{
-			ANKI_RESOURCE_LOGE("Failed to open archive");
-			return Error::kFileAccess;
-		}
+		ResourceArchive* archive = newInstance<ResourceArchive>(ResourceMemoryPool::getSingleton());
+		path.m_archive.reset(archive);
+		ANKI_CHECK(archive->open(filepath));
 
 		// List files
-		if(unzGoToFirstFile(zfile) != UNZ_OK)
-		{
-			unzClose(zfile);
-			ANKI_RESOURCE_LOGE("unzGoToFirstFile() failed. Empty archive?");
-			return Error::kFileAccess;
-		}
-
-		do
+		const ConstWeakArray<ResourceArchive::Entry> entries = archive->getEntries();
+		for(U32 i = 0; i < entries.getSize(); ++i)
 		{
-			Array<Char, 1024> filename;
-
-			unz_file_info info;
-			if(unzGetCurrentFileInfo(zfile, &info, &filename[0], filename.getSize(), nullptr, 0, nullptr, 0) != UNZ_OK)
+			const ResourceArchive::Entry& entry = entries[i];
+			const Bool itsADir = entry.m_uncompressedSize == 0;
+			if(!itsADir && includePath(entry.m_filename.toCString()))
 			{
-				unzClose(zfile);
-				ANKI_RESOURCE_LOGE("unzGetCurrentFileInfo() failed");
-				return Error::kFileAccess;
-			}
-
-			const Bool itsADir = info.uncompressed_size == 0;
-			if(!itsADir && includePath(&filename[0]))
-			{
-				filenameList.pushBack(filename.getBegin());
+				filenameList.pushBack(entry.m_filename);
+				archiveEntryIndices.emplaceBack(i);
 				++fileCount;
 			}
-		} while(unzGoToNextFile(zfile) == UNZ_OK);
-
-		unzClose(zfile);
+		}
 
 		path.m_isArchive = true;
 	}
@@ -404,10 +254,15 @@ Error ResourceFilesystem::addNewPath(CString filepath_, const ResourceStringList
 		{
 			path.m_files[count].m_filename = str;
 			path.m_files[count].m_filenameHash = str.computeHash();
+			if(path.m_isArchive)
+			{
+				path.m_files[count].m_archiveEntryIdx = archiveEntryIndices[count];
+			}
 			++count;
 		}
 
 		m_dataPaths.emplaceFront(std::move(path));
+		addToFileIndex(m_dataPaths.getFront());
 
 		ANKI_RESOURCE_LOGI("Added new data path \"%s\" that contains %u files", &filepath[0], fileCount);
 	}
@@ -449,61 +304,44 @@ Error ResourceFilesystem::openFileInternal(const ResourceFilename& filename, Res
 
 	const U64 filenameHash = filename.computeHash();
 
-	// Search for the fname in reverse order
-	for(const DataPath& p : m_dataPaths)
+	const DataPath* pp;
+	const FileInfo* fsfile = findFile(filenameHash, pp);
+	if(fsfile)
 	{
-		for(const FileInfo& fsfile : p.m_files)
-		{
-			if(filenameHash != fsfile.m_filenameHash)
-			{
-				continue;
-			}
+		const DataPath& p = *pp;
 
-			[[maybe_unused]] CString pfname = fsfile.m_filename;
-			ANKI_ASSERT(pfname == filename);
+		[[maybe_unused]] CString pfname = fsfile->m_filename;
+		ANKI_ASSERT(pfname == filename);
 
-			// Found
-			if(p.m_isArchive)
+		// Found
+		if(p.m_isArchive)
+		{
+			ANKI_CHECK(p.m_archive->openFile(fsfile->m_archiveEntryIdx, rfile));
+		}
+		else
+		{
+			ResourceString newFname;
+			if(!p.m_isSpecial)
 			{
-				ZipResourceFile* file = newInstance<ZipResourceFile>(ResourceMemoryPool::getSingleton());
-				rfile = file;
-
-				ANKI_CHECK(file->open(p.m_path.toCString(), filename));
+				newFname.sprintf("%s/%s", p.m_path.cstr(), filename.cstr());
 			}
 			else
 			{
-				ResourceString newFname;
-				if(!p.m_isSpecial)
-				{
-					newFname.sprintf("%s/%s", p.m_path.cstr(), filename.cstr());
-				}
-				else
-				{
-					newFname = filename;
-				}
-
-				CResourceFile* file = newInstance<CResourceFile>(ResourceMemoryPool::getSingleton());
-				rfile = file;
-
-				FileOpenFlag openFlags = FileOpenFlag::kRead;
-				if(p.m_isSpecial)
-				{
-					openFlags |= FileOpenFlag::kSpecial;
-				}
+				newFname = filename;
+			}
 
-				ANKI_CHECK(file->m_file.open(newFname, openFlags));
+			CResourceFile* file = newInstance<CResourceFile>(ResourceMemoryPool::getSingleton());
+			rfile = file;
 
-#if 0
-				printf("Opening asset %s, update time %llu\n", newFname.cstr(), fsfile.m_fileUpdateTime);
-#endif
+			FileOpenFlag openFlags = FileOpenFlag::kRead;
+			if(p.m_isSpecial)
+			{
+				openFlags |= FileOpenFlag::kSpecial;
 			}
-		}
 
-		if(rfile)
-		{
-			break;
+			ANKI_CHECK(file->m_file.open(newFname, openFlags));
 		}
-	} // end for all paths
+	}
 
 #if !ANKI_OS_ANDROID
 
@@ -533,29 +371,44 @@ ResourceString ResourceFilesystem::getDiskFilepath(ResourceFilename filename) co
 	ResourceString out;
 	const U64 filenameHash = filename.computeHash();
 	Bool found = false;
-	for(const DataPath& p : m_dataPaths)
+
+	// Fast path: The data path that overrides all others is a directory
+	const DataPath* indexedPath;
+	const FileInfo* indexedFile = findFile(filenameHash, indexedPath);
+	if(indexedFile && !indexedPath->m_isArchive && !indexedPath->m_isSpecial)
 	{
-		for(const FileInfo& fsfile : p.m_files)
+		ANKI_ASSERT(indexedFile->m_filename == filename);
+		out.sprintf("%s/%s", indexedPath->m_path.cstr(), indexedFile->m_filename.cstr());
+		found = true;
+	}
+
+	// Slow path: The file is in an archive. Search the directories that got overriden by it
+	if(indexedFile && !found)
+	{
+		for(const DataPath& p : m_dataPaths)
 		{
-			if(filenameHash != fsfile.m_filenameHash)
+			for(const FileInfo& fsfile : p.m_files)
 			{
-				continue;
-			}
+				if(filenameHash != fsfile.m_filenameHash)
+				{
+					continue;
+				}
 
-			ANKI_ASSERT(fsfile.m_filename == filename);
+				ANKI_ASSERT(fsfile.m_filename == filename);
 
-			if(!p.m_isArchive && !p.m_isSpecial)
+				if(!p.m_isArchive && !p.m_isSpecial)
+				{
+					out.sprintf("%s/%s", p.m_path.cstr(), fsfile.m_filename.cstr());
+					found = true;
+					break;
+				}
+			}
+
+			if(found)
 			{
-				out.sprintf("%s/%s", p.m_path.cstr(), fsfile.m_filename.cstr());
-				found = true;
 				break;
 			}
 		}
-
-		if(found)
-		{
-			break;
-		}
 	}
 
 #if ANKI_WITH_EDITOR
@@ -586,6 +439,16 @@ U64 ResourceFilesystem::getFileUpdateTime(ResourceFilename filename) const
 
 Error ResourceFilesystem::refreshAll()
 {
+#if ANKI_WITH_EDITOR
+	{
+		// The watchers point to the data paths
+		LockGuard lock(m_watchersMtx);
+		m_watchers.destroy();
+		m_watchersValid = false;
+	}
+#endif
+
+	m_fileIndex.destroy();
 	m_dataPaths.destroy();
 
 	ResourceStringList paths;
@@ -642,9 +505,82 @@ Error ResourceFilesystem::refreshAll()
 	ANKI_CHECK(addNewPath(".apk assets", {}, {}));
 #endif
 
+#if ANKI_WITH_EDITOR
+	if(m_watchDataPaths)
+	{
+		watchDataPaths();
+	}
+#endif
+
+	return Error::kNone;
+}
+
+#if ANKI_WITH_EDITOR
+void ResourceFilesystem::watchDataPaths()
+{
+	LockGuard lock(m_watchersMtx);
+
+	m_watchers.destroy();
+	m_watchDataPaths = true;
+	m_watchersValid = true;
+
+	for(const DataPath& path : m_dataPaths)
+	{
+		if(path.m_isArchive || path.m_isSpecial)
+		{
+			// Can't change
+			continue;
+		}
+
+		DataPathWatcher& watcher = *m_watchers.emplaceBack();
+		watcher.m_path = &path;
+		if(watcher.m_inotify.initRecursive(path.m_path))
+		{
+			ANKI_RESOURCE_LOGW("Can't watch data path for changes. Will check all files instead: %s", path.m_path.cstr());
+			m_watchers.destroy();
+			m_watchersValid = false;
+			break;
+		}
+	}
+}
+
+Error ResourceFilesystem::pollModifiedFiles(ResourceDynamicArray<ResourceString>& filenames, Bool& allChanged)
+{
+	ANKI_TRACE_FUNCTION();
+
+	LockGuard lock(m_watchersMtx);
+
+	allChanged = !m_watchersValid;
+
+	for(DataPathWatcher& watcher : m_watchers)
+	{
+		Bool overflow = false;
+		ANKI_CHECK(watcher.m_inotify.pollModifiedFiles(
+			[&](CString filename) {
+				// Skip the files that are not in the index or that are overridden by other data paths
+				const DataPath* path;
+				if(findFile(filename.computeHash(), path) && path == watcher.m_path)
+				{
+					filenames.emplaceBack(filename);
+				}
+			},
+			overflow));
+
+		allChanged = allChanged || overflow;
+	}
+
 	return Error::kNone;
 }
 
+Bool ResourceFilesystem::isFileWatched(ResourceFilename filename) const
+{
+	LockGuard lock(m_watchersMtx);
+
+	const DataPath* path;
+	return m_watchersValid && findFile(filename.computeHash(), path) && !path->m_isArchive && !path->m_isSpecial;
+}
+#endif // ANKI_WITH_EDITOR
+
 ResourceString ResourceFilesystem::printTree() const
 {
 	ResourceStringList list;
@@ -666,21 +602,36 @@ ResourceString ResourceFilesystem::printTree() const
 
 Bool ResourceFilesystem::fileExists(ResourceFilename filename) const
 {
-	const U64 filenameHash = filename.computeHash();
+	const DataPath* path;
+	return findFile(filename.computeHash(), path) != nullptr;
+}
+
+void ResourceFilesystem::addToFileIndex(const DataPath& path)
+{
+	ANKI_ASSERT(&m_dataPaths.getFront() == &path);
 
-	// Search for the fname in reverse order
-	for(const DataPath& p : m_dataPaths)
+	for(U32 i = 0; i < path.m_files.getSize(); ++i)
 	{
-		for(const FileInfo& fsfile : p.m_files)
-		{
-			if(filenameHash == fsfile.m_filenameHash)
-			{
-				return true;
-			}
-		}
+		FileLocation location;
+		location.m_path = &path;
+		location.m_fileIdx = i;
+
+		// The newest data path overrides the older ones, emplace() will replace any existing entry
+		m_fileIndex.emplace(path.m_files[i].m_filenameHash, location);
+	}
+}
+
+const ResourceFilesystem::FileInfo* ResourceFilesystem::findFile(U64 filenameHash, const DataPath*& path) const
+{
+	auto it = m_fileIndex.find(filenameHash);
+	if(it == m_fileIndex.getEnd())
+	{
+		path = nullptr;
+		return nullptr;
 	}
 
-	return false;
+	path = it->m_path;
+	return &path->m_files[it->m_fileIdx];
 }
 
 } // end namespace anki
@@ -6,11 +6,16 @@
 #pragma once
 
 #include <AnKi/Resource/Common.h>
+#include <AnKi/Resource/ResourceArchive.h>
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/StringList.h>
 #include <AnKi/Util/File.h>
 #include <AnKi/Util/Ptr.h>
 #include <AnKi/Util/CVarSet.h>
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/WeakArray.h>
+#include <AnKi/Util/INotify.h>
+#include <AnKi/Util/Thread.h>
 
 namespace anki {
 
@@ -53,6 +58,13 @@ public:
 	// Get the size of the file.
 	virtual PtrSize getSize() const = 0;
 
+	// If the whole file is already in memory (eg. a stored file in a memory mapped archive) return its contents to avoid a copy. Otherwise return
+	// an empty array.
+	virtual ConstWeakArray<U8> getContentsInMemory() const
+	{
+		return {};
+	}
+
 	void retain() const
 	{
 		m_refcount.fetchAdd(1);
@@ -100,6 +112,20 @@ public:
 	// Return some sort of time a file was last updated. This time is opaque and it's increasing with every update. Only works for filesystem files
 	U64 getFileUpdateTime(ResourceFilename filename) const;
 
+#if ANKI_WITH_EDITOR
+	// Start watching the directories of the data paths for changes. If watching is not possible pollModifiedFiles() will report that everything
+	// changed
+	void watchDataPaths();
+
+	// Get the files that were written since the last call. Only the files of the data path directories are reported. If the changes are not
+	// tracked (eg. watchDataPaths() failed or too many files changed at once) allChanged is true and the caller should assume that all files
+	// changed. Thread-safe
+	Error pollModifiedFiles(ResourceDynamicArray<ResourceString>& filenames, Bool& allChanged);
+
+	// Return true if pollModifiedFiles() will report the changes of that file
+	Bool isFileWatched(ResourceFilename filename) const;
+#endif
+
 	// Take the filename (which is relative) and return the full path of the file. Only works for filesystem files
 	ResourceString getDiskFilepath(ResourceFilename filename) const;
 
@@ -188,6 +214,7 @@ private:
 	public:
 		ResourceString m_filename;
 		U64 m_filenameHash = 0;
+		U32 m_archiveEntryIdx = kMaxU32; // Index to ResourceArchive::getEntries() if the data path is an archive.
 	};
 
 	class DataPath
@@ -195,6 +222,7 @@ private:
 	public:
 		ResourceDynamicArray<FileInfo> m_files; // Files inside the directory.
 		ResourceString m_path; // A directory or an archive.
+		ResourceArchivePtr m_archive; // Valid if it's an archive.
 		Bool m_isArchive = false;
 		Bool m_isSpecial = false;
 
@@ -213,17 +241,60 @@ private:
 		{
 			m_files = std::move(b.m_files);
 			m_path = std::move(b.m_path);
+			m_archive = std::move(b.m_archive);
 			m_isArchive = b.m_isArchive;
 			m_isSpecial = b.m_isSpecial;
 			return *this;
 		}
 	};
 
+	// Where a file lives.
+	class FileLocation
+	{
+	public:
+		const DataPath* m_path = nullptr;
+		U32 m_fileIdx = kMaxU32;
+	};
+
+	// The keys of the file index are already hashes.
+	class FilenameHashHasher
+	{
+	public:
+		U64 operator()(U64 filenameHash) const
+		{
+			return filenameHash;
+		}
+	};
+
 	ResourceList<DataPath> m_dataPaths;
 
+#if ANKI_WITH_EDITOR
+	class DataPathWatcher
+	{
+	public:
+		const DataPath* m_path = nullptr;
+		INotify m_inotify;
+	};
+
+	ResourceList<DataPathWatcher> m_watchers;
+	Bool m_watchDataPaths = false; // watchDataPaths() was called
+	Bool m_watchersValid = false; // If false the file changes are not tracked
+	mutable Mutex m_watchersMtx;
+#endif
+
+	// Maps the filename hash to the data path that should be used to open the file. If multiple data paths contain the same file the most recently
+	// added data path wins. It's the same order the m_dataPaths have.
+	ResourceHashMap<U64, FileLocation, FilenameHashHasher> m_fileIndex;
+
 	// Add a filesystem path or an archive. The path is read-only.
 	Error addNewPath(CString path, const ResourceStringList& includeStrings, const ResourceStringList& excludedStrings);
 
+	// Add the files of a data path to the index. The data path should be the most recently added.
+	void addToFileIndex(const DataPath& path);
+
+	// Find the data path that contains a file. Returns nullptr if not found.
+	const FileInfo* findFile(U64 filenameHash, const DataPath*& path) const;
+
 	Error openFileInternal(const ResourceFilename& filename, ResourceFile*& rfile) const;
 };
 
@@ -9,6 +9,7 @@
 #include <AnKi/Resource/AnimationResource.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Util/CVarSet.h>
+#include <AnKi/Util/Tracer.h>
 
 #include <AnKi/Resource/MaterialResource.h>
 #include <AnKi/Resource/MeshResource.h>
@@ -24,7 +25,173 @@
 
 namespace anki {
 
+static Atomic<U32> g_resourceManagerGeneration = {0};
+
+class ReaderEpochTls
+{
+public:
+	U32 m_generation = kMaxU32;
+	U32 m_slot = kMaxU32;
+};
+
+thread_local static ReaderEpochTls g_readerEpochTls;
+
+template<typename Type>
+typename ResourceManager::TypeData<Type>::Resource* ResourceManager::TypeData<Type>::find(CString filename, U64 hash)
+{
+	const Shard& shard = m_shards[hash >> (64 - kMapShardBits)];
+
+	const Table* table = shard.m_table.load(AtomicMemoryOrder::kAcquire);
+	if(!table)
+	{
+		return nullptr;
+	}
+
+	// The load factor is kept under 50% so there is always an empty slot to stop the probing
+	const U32 mask = table->m_capacity - 1;
+	for(U32 i = U32(hash) & mask;; i = (i + 1) & mask)
+	{
+		Resource* rsrc = table->m_slots[i].load(AtomicMemoryOrder::kAcquire);
+		if(!rsrc)
+		{
+			return nullptr;
+		}
+
+		if(rsrc->m_filenameHash == hash && rsrc->m_filename == filename)
+		{
+			return rsrc;
+		}
+	}
+}
+
+template<typename Type>
+typename ResourceManager::TypeData<Type>::Resource* ResourceManager::TypeData<Type>::findOrCreate(CString filename, U64 hash, Bool& created)
+{
+	created = false;
+
+	Resource* rsrc = find(filename, hash);
+	if(rsrc)
+	{
+		return rsrc;
+	}
+
+	const U32 shardIdx = U32(hash >> (64 - kMapShardBits));
+	Shard& shard = m_shards[shardIdx];
+	LockGuard lock(shard.m_mtx);
+
+	// Check again, someone might have inserted it while we were waiting for the lock
+	rsrc = find(filename, hash);
+	if(rsrc)
+	{
+		return rsrc;
+	}
+
+	auto it = shard.m_resources.emplace();
+	rsrc = &(*it);
+	rsrc->m_filename = filename;
+	rsrc->m_filenameHash = hash;
+	rsrc->m_index = encodeResourceIndex(shardIdx, it.getArrayIndex());
+	created = true;
+
+	// Grow the table. Never modify the old one in place because readers might still be probing it
+	Table* table = shard.m_table.load(AtomicMemoryOrder::kRelaxed);
+	if(!table || (table->m_count + 1) * 2 > table->m_capacity)
+	{
+		Table* newTable = newInstance<Table>(ResourceMemoryPool::getSingleton());
+		newTable->m_capacity = (table) ? table->m_capacity * 2 : 64;
+		newTable->m_slots = static_cast<Atomic<Resource*>*>(
+			ResourceMemoryPool::getSingleton().allocate(sizeof(Atomic<Resource*>) * newTable->m_capacity, alignof(Atomic<Resource*>)));
+		for(U32 i = 0; i < newTable->m_capacity; ++i)
+		{
+			callConstructor(newTable->m_slots[i], nullptr);
+		}
+
+		if(table)
+		{
+			const U32 newMask = newTable->m_capacity - 1;
+			for(U32 i = 0; i < table->m_capacity; ++i)
+			{
+				Resource* other = table->m_slots[i].load(AtomicMemoryOrder::kRelaxed);
+				if(other)
+				{
+					U32 j = U32(other->m_filenameHash) & newMask;
+					while(newTable->m_slots[j].getNonAtomically())
+					{
+						j = (j + 1) & newMask;
+					}
+
+					newTable->m_slots[j].setNonAtomically(other);
+				}
+			}
+
+			newTable->m_count = table->m_count;
+			shard.m_oldTables.emplaceBack(table);
+		}
+
+		shard.m_table.store(newTable, AtomicMemoryOrder::kRelease);
+		table = newTable;
+	}
+
+	const U32 mask = table->m_capacity - 1;
+	U32 i = U32(hash) & mask;
+	while(table->m_slots[i].load(AtomicMemoryOrder::kRelaxed))
+	{
+		i = (i + 1) & mask;
+	}
+
+	table->m_slots[i].store(rsrc, AtomicMemoryOrder::kRelease);
+	++table->m_count;
+
+	return rsrc;
+}
+
+template<typename Type>
+typename ResourceManager::TypeData<Type>::Resource& ResourceManager::TypeData<Type>::getResource(U32 index)
+{
+	Shard& shard = m_shards[index & (kMapShardCount - 1)];
+
+	// Lock because a concurrent insert might re-allocate the storage of the block array
+	LockGuard lock(shard.m_mtx);
+	return shard.m_resources[index >> kMapShardBits];
+}
+
+template<typename Type>
+void ResourceManager::TypeData<Type>::destroy()
+{
+	for(Shard& shard : m_shards)
+	{
+		auto deleteTable = [](Table* table) {
+			for(U32 i = 0; i < table->m_capacity; ++i)
+			{
+				callDestructor(table->m_slots[i]);
+			}
+			ResourceMemoryPool::getSingleton().free(table->m_slots);
+			deleteInstance(ResourceMemoryPool::getSingleton(), table);
+		};
+
+		for(Table* table : shard.m_oldTables)
+		{
+			deleteTable(table);
+		}
+		shard.m_oldTables.destroy();
+
+		Table* table = shard.m_table.load();
+		if(table)
+		{
+			deleteTable(table);
+			shard.m_table.store(nullptr);
+		}
+
+		shard.m_resources.destroy();
+
+#if ANKI_WITH_EDITOR
+		shard.m_unwatchedResources.destroy();
+#endif
+	}
+}
+
 ResourceManager::ResourceManager()
+	: m_generation(g_resourceManagerGeneration.fetchAdd(1))
 {
 }
 
@@ -32,13 +199,16 @@ ResourceManager::~ResourceManager()
 {
 	ANKI_RESOURCE_LOGI("Destroying resource manager");
 
+	// No one is reading at that point, delete what is left
+	reclaimRetiredResources();
+	ANKI_ASSERT(m_retiredResources.getSize() == 0);
+	m_retiredResources.destroy();
+
 	AsyncLoader::freeSingleton();
 	ShaderProgramResourceSystem::freeSingleton();
 	ResourceFilesystem::freeSingleton();
 
-#define ANKI_INSTANTIATE_RESOURCE(className) \
-	static_cast<TypeData<className>&>(m_allTypes).m_resources.destroy(); \
-	static_cast<TypeData<className>&>(m_allTypes).m_map.destroy();
+#define ANKI_INSTANTIATE_RESOURCE(className) static_cast<TypeData<className>&>(m_allTypes).destroy();
 #include <AnKi/Resource/Resources.def.h>
 
 	ResourceMemoryPool::freeSingleton();
@@ -62,57 +232,152 @@ Error ResourceManager::init(AllocAlignedCallback allocCallback, void* allocCallb
 
 #if ANKI_WITH_EDITOR
 	m_trackFileUpdateTimes = g_cvarRsrcTrackFileUpdates;
+	if(m_trackFileUpdateTimes)
+	{
+		ResourceFilesystem::getSingleton().watchDataPaths();
+	}
 #endif
 
 	return Error::kNone;
 }
 
-template<typename T>
-Error ResourceManager::loadResource(CString filename, IntrusiveNoDelPtr<T>& out, Bool async)
+U32 ResourceManager::enterReadEpoch()
 {
-	TypeData<T>& type = static_cast<TypeData<T>&>(m_allTypes);
-
-	// Try to find the resource
-	using Rsrc = typename TypeData<T>::Resource;
-	Rsrc* rsrc = nullptr;
-	U32 resourceArrayIdx = kMaxU32;
+	ReaderEpochTls& tls = g_readerEpochTls;
+	if(tls.m_generation != m_generation)
 	{
-		RLockGuard lock(type.m_mtx);
-
-		auto it = type.m_map.find(filename);
-
-		if(it != type.m_map.getEnd())
+		tls.m_generation = m_generation;
+		tls.m_slot = m_readerEpochCount.fetchAdd(1);
+		if(tls.m_slot >= kMaxReaderThreads)
 		{
-			rsrc = &type.m_resources[*it];
-			resourceArrayIdx = *it;
+			tls.m_slot = kMaxU32;
 		}
 	}
 
-	// Resource not found, create it
-	if(!rsrc)
+	if(tls.m_slot != kMaxU32)
+	{
+		// Sequentially consistent to order the store before the reads that follow and against the epoch increment of retireResource()
+		m_readerEpochs[tls.m_slot].m_epoch.store(m_globalEpoch.load(AtomicMemoryOrder::kSeqCst), AtomicMemoryOrder::kSeqCst);
+	}
+
+	return tls.m_slot;
+}
+
+void ResourceManager::retireResource(ResourceObject* rsrc, void (*deleteCallback)(ResourceObject*))
+{
+	ANKI_ASSERT(rsrc && deleteCallback);
+
+	// The resource is not reachable from the newest version pointers any more. Readers that started after the increment can't see it
+	const U64 epoch = m_globalEpoch.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+
 	{
-		WLockGuard lock(type.m_mtx);
+		LockGuard lock(m_retiredResourcesMtx);
+		m_retiredResources.emplaceBack(RetiredResource{rsrc, deleteCallback, epoch});
+	}
 
-		// Check again...
-		auto it = type.m_map.find(filename);
+	reclaimRetiredResources();
+}
+
+void ResourceManager::reclaimRetiredResources()
+{
+	ResourceDynamicArray<RetiredResource> toDelete;
+
+	{
+		LockGuard lock(m_retiredResourcesMtx);
 
-		// ... and create
-		if(it != type.m_map.getEnd())
+		if(m_retiredResources.getSize() == 0)
 		{
-			rsrc = &type.m_resources[*it];
-			resourceArrayIdx = *it;
+			return;
 		}
-		else
+
+		U64 minReaderEpoch = kMaxU64;
+		const U32 readerCount = min(m_readerEpochCount.load(), kMaxReaderThreads);
+		for(U32 i = 0; i < readerCount; ++i)
 		{
-			auto it = type.m_resources.emplace();
-			resourceArrayIdx = it.getArrayIndex();
-			rsrc = &(*it);
+			const U64 epoch = m_readerEpochs[i].m_epoch.load(AtomicMemoryOrder::kSeqCst);
+			if(epoch)
+			{
+				minReaderEpoch = min(minReaderEpoch, epoch);
+			}
+		}
 
-			type.m_map.emplace(filename, resourceArrayIdx);
+		for(U32 i = 0; i < m_retiredResources.getSize();)
+		{
+			if(m_retiredResources[i].m_epoch < minReaderEpoch)
+			{
+				toDelete.emplaceBack(m_retiredResources[i]);
+				m_retiredResources[i] = m_retiredResources.getBack();
+				m_retiredResources.popBack();
+			}
+			else
+			{
+				++i;
+			}
 		}
 	}
 
-	ANKI_ASSERT(rsrc && resourceArrayIdx < kMaxU32);
+	// Delete outside the lock because a resource might release other resources in its destructor
+	for(const RetiredResource& retired : toDelete)
+	{
+		retired.m_deleteCallback(retired.m_resource);
+	}
+}
+
+template<typename T>
+Error ResourceManager::loadResource(CString filename, IntrusiveNoDelPtr<T>& out, Bool async)
+{
+	TypeData<T>& type = static_cast<TypeData<T>&>(m_allTypes);
+	using Rsrc = typename TypeData<T>::Resource;
+
+	const U64 hash = computeHash(filename.cstr(), filename.getLength());
+	Bool created;
+	Rsrc* rsrc = type.findOrCreate(filename, hash, created);
+	ANKI_ASSERT(rsrc);
+
+#if ANKI_WITH_EDITOR
+	if(created && m_trackFileUpdateTimes && !ResourceFilesystem::getSingleton().isFileWatched(filename))
+	{
+		typename TypeData<T>::Shard& shard = type.m_shards[rsrc->m_index & (kMapShardCount - 1)];
+		LockGuard lock(shard.m_mtx);
+		shard.m_unwatchedResources.emplaceBack(rsrc->m_index >> kMapShardBits);
+	}
+#endif
+
+	// Fast path, try to grab a reference to the newest version without locking
+	if(!created)
+	{
+		const U32 readerSlot = enterReadEpoch();
+		if(readerSlot != kMaxU32)
+		{
+			T* ver = rsrc->m_newestVersion.load(AtomicMemoryOrder::kSeqCst);
+			Bool hit = false;
+			if(ver
+#if ANKI_WITH_EDITOR
+			   && !ver->isObsolete()
+#endif
+			)
+			{
+				// Never resurrect a version whose refcount reached zero. freeResource() might have decided to delete it already
+				I32 refcount = ver->m_refcount.load();
+				while(refcount > 0 && !ver->m_refcount.compareExchange(refcount, refcount + 1))
+				{
+				}
+
+				hit = refcount > 0;
+			}
+
+			leaveReadEpoch(readerSlot);
+
+			if(hit)
+			{
+				out.reset(ver);
+
+				// Decrement because of the increment happened a few lines above
+				ver->release();
+				return Error::kNone;
+			}
+		}
+	}
 
 	LockGuard lock(rsrc->m_mtx);
 
@@ -132,7 +397,7 @@ Error ResourceManager::loadResource(CString filename, IntrusiveNoDelPtr<T>& out,
 	// Versioned resource hasn't been loaded or it needs update, load it
 
 	ver = newInstance<T>(ResourceMemoryPool::getSingleton(), filename, m_uuid.fetchAdd(1));
-	ver->m_versionResourceIdx = resourceArrayIdx;
+	ver->m_versionResourceIdx = rsrc->m_index;
 
 	// Increment the refcount in that case where async jobs increment it and decrement it in the scope of a load()
 	ver->retain();
@@ -147,6 +412,7 @@ Error ResourceManager::loadResource(CString filename, IntrusiveNoDelPtr<T>& out,
 	else
 	{
 		rsrc->m_versions.emplaceBack(ver);
+		rsrc->m_newestVersion.store(ver, AtomicMemoryOrder::kSeqCst);
 
 #if ANKI_WITH_EDITOR
 		if(m_trackFileUpdateTimes)
@@ -170,19 +436,14 @@ void ResourceManager::freeResource(U32 uuid, U32 versionedResourceIdx)
 	TypeData<T>& type = static_cast<TypeData<T>&>(m_allTypes);
 
 	using Rsrc = typename TypeData<T>::Resource;
-
-	Rsrc* rsrc;
-	{
-		RLockGuard lock(type.m_mtx);
-		rsrc = &type.m_resources[versionedResourceIdx];
-	}
+	Rsrc& rsrc = type.getResource(versionedResourceIdx);
 
 	T* toDelete = nullptr;
 	{
-		LockGuard lock(rsrc->m_mtx);
+		LockGuard lock(rsrc.m_mtx);
 
-		auto it = rsrc->m_versions.getBegin();
-		for(; it != rsrc->m_versions.getEnd(); ++it)
+		auto it = rsrc.m_versions.getBegin();
+		for(; it != rsrc.m_versions.getEnd(); ++it)
 		{
 			if((*it)->m_uuid == uuid)
 			{
@@ -196,15 +457,21 @@ void ResourceManager::freeResource(U32 uuid, U32 versionedResourceIdx)
 		// - loadResource is called and the resource is found. Refcount goes to 1
 		// - ResourceObject::release() is called, refcount reaches 0, objects delets
 		// - Then this function finaly gets the lock, the object is already deleted... boom
-		if(it != rsrc->m_versions.getEnd() && (*it)->m_refcount.load() == 0)
+		if(it != rsrc.m_versions.getEnd() && (*it)->m_refcount.load() == 0)
 		{
 			toDelete = *it;
-			rsrc->m_versions.erase(it);
+			rsrc.m_versions.erase(it);
+			rsrc.m_newestVersion.store((rsrc.m_versions.getSize()) ? rsrc.m_versions.getBack() : nullptr, AtomicMemoryOrder::kSeqCst);
 		}
 	}
 
-	// Now you can delete outside any locks
-	deleteInstance(ResourceMemoryPool::getSingleton(), toDelete);
+	// Lock-free readers of loadResource() might still be looking at it. Retire it and let the reclamation delete it outside any locks
+	if(toDelete)
+	{
+		retireResource(toDelete, [](ResourceObject* rsrc) {
+			deleteInstance(ResourceMemoryPool::getSingleton(), static_cast<T*>(rsrc));
+		});
+	}
 }
 
 // Instansiate
@@ -215,19 +482,16 @@ void ResourceManager::freeResource(U32 uuid, U32 versionedResourceIdx)
 
 #if ANKI_WITH_EDITOR
 template<typename T>
-void ResourceManager::refreshFileUpdateTimesInternal()
+void ResourceManager::refreshFileUpdateTimesInternal(ConstWeakArray<ResourceString> modifiedFiles, Bool allChanged)
 {
 	TypeData<T>& type = static_cast<TypeData<T>&>(m_allTypes);
 
-	WLockGuard lock(type.m_mtx);
-
-	for(auto& entry : type.m_resources)
-	{
+	auto refresh = [](typename TypeData<T>::Resource& entry) {
 		LockGuard lock(entry.m_mtx);
 
 		if(entry.m_versions.getSize() == 0)
 		{
-			continue;
+			return;
 		}
 
 		const U64 newTime = ResourceFilesystem::getSingleton().getFileUpdateTime(entry.m_versions[0]->getFilename());
@@ -241,6 +505,39 @@ void ResourceManager::refreshFileUpdateTimesInternal()
 				rsrc->m_isObsolete.store(1);
 			}
 		}
+	};
+
+	for(typename TypeData<T>::Shard& shard : type.m_shards)
+	{
+		LockGuard lock(shard.m_mtx);
+
+		if(allChanged)
+		{
+			for(auto& entry : shard.m_resources)
+			{
+				refresh(entry);
+			}
+		}
+		else
+		{
+			for(U32 idx : shard.m_unwatchedResources)
+			{
+				refresh(shard.m_resources[idx]);
+			}
+		}
+	}
+
+	if(!allChanged)
+	{
+		for(const ResourceString& filename : modifiedFiles)
+		{
+			const CString fname = filename.toCString();
+			typename TypeData<T>::Resource* entry = type.find(fname, computeHash(fname.cstr(), fname.getLength()));
+			if(entry)
+			{
+				refresh(*entry);
+			}
+		}
 	}
 }
 
@@ -251,7 +548,16 @@ void ResourceManager::refreshFileUpdateTimes()
 		return;
 	}
 
-#	define ANKI_INSTANTIATE_RESOURCE(className) refreshFileUpdateTimesInternal<className>();
+	ANKI_TRACE_FUNCTION();
+
+	ResourceDynamicArray<ResourceString> modifiedFiles;
+	Bool allChanged = false;
+	if(ResourceFilesystem::getSingleton().pollModifiedFiles(modifiedFiles, allChanged))
+	{
+		allChanged = true;
+	}
+
+#	define ANKI_INSTANTIATE_RESOURCE(className) refreshFileUpdateTimesInternal<className>(modifiedFiles, allChanged);
 #	include <AnKi/Resource/Resources.def.h>
 }
 #endif // #if ANKI_WITH_EDITOR
@@ -11,6 +11,7 @@
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/HashMap.h>
 #include <AnKi/Util/BlockArray.h>
+#include <AnKi/Util/Thread.h>
 
 namespace anki {
 
@@ -45,12 +46,17 @@ public:
 	Error loadResource(CString filename, IntrusiveNoDelPtr<T>& out, Bool async = true);
 
 #if ANKI_WITH_EDITOR
-	// Iterate all loaded resource and check if the files have been updated since they were loaded.
+	// Check if the files of the loaded resources have been updated since they were loaded. Only the files that the filesystem reported as modified
+	// are checked.
 	// Note: Thread-safe against itself, loadResource() and freeResource()
 	void refreshFileUpdateTimes();
 #endif
 
 private:
+	static constexpr U32 kMapShardBits = 4;
+	static constexpr U32 kMapShardCount = 1u << kMapShardBits;
+	static constexpr U32 kMaxReaderThreads = 128; // Threads past that count use the locked path in loadResource()
+
 	template<typename Type>
 	class TypeData
 	{
@@ -59,27 +65,66 @@ private:
 		{
 		public:
 			DynamicArray<Type*> m_versions; // Hosts multiple versions of a resource. The last element is the newest
+			Atomic<Type*> m_newestVersion = {nullptr}; // Same as m_versions.getBack(). loadResource() hits read it without locking
 			SpinLock m_mtx;
+			ResourceString m_filename;
+			U64 m_filenameHash = 0;
+			U32 m_index = kMaxU32; // The index in m_resources of the shard and the shard index. See encodeResourceIndex()
 #if ANKI_WITH_EDITOR
 			U64 m_fileUpdateTime = 0;
 #endif
 		};
 
-		ResourceHashMap<CString, U32> m_map; // Filename to index in the m_resources
+		// Insert-only open addressing table. Readers probe it without locks. Writers hold the shard lock and publish new entries and new tables
+		// with release stores
+		class Table
+		{
+		public:
+			Atomic<Resource*>* m_slots = nullptr;
+			U32 m_capacity = 0; // Power of 2
+			U32 m_count = 0;
+		};
 
-		// Once a Resource is created in that array it will never be destroyed until shutdown. That is fine because it's the Resource::m_versions
-		// that holds the actual resource
-		ResourceBlockArray<Resource> m_resources;
+		class alignas(ANKI_CACHE_LINE_SIZE) Shard
+		{
+		public:
+			Atomic<Table*> m_table = {nullptr};
+
+			Mutex m_mtx; // Serializes the inserts. Guards m_resources and m_oldTables
 
-		RWMutex m_mtx;
+			// Once a Resource is created in that array it will never be destroyed until shutdown. That is fine because it's the
+			// Resource::m_versions that holds the actual resource
+			ResourceBlockArray<Resource> m_resources;
+
+			ResourceDynamicArray<Table*> m_oldTables; // Tables replaced by bigger ones. Readers might still probe them so free them at shutdown
+
+#if ANKI_WITH_EDITOR
+			ResourceDynamicArray<U32> m_unwatchedResources; // Indices to m_resources whose files are not watched by the filesystem
+#endif
+		};
+
+		Array<Shard, kMapShardCount> m_shards; // Filename to Resource. Sharded by the high bits of the filename hash
 
 		~TypeData()
 		{
-			for([[maybe_unused]] const Resource& v : m_resources)
+			for([[maybe_unused]] const Shard& shard : m_shards)
 			{
-				ANKI_ASSERT(v.m_versions.getSize() == 0 && "Forgot to release some resource");
+				for([[maybe_unused]] const Resource& v : shard.m_resources)
+				{
+					ANKI_ASSERT(v.m_versions.getSize() == 0 && "Forgot to release some resource");
+				}
 			}
 		}
+
+		// Lock-free and wait-free.
+		Resource* find(CString filename, U64 hash);
+
+		// Lock-free if the resource entry exists, takes the shard lock if it doesn't.
+		Resource* findOrCreate(CString filename, U64 hash, Bool& created);
+
+		Resource& getResource(U32 index);
+
+		void destroy();
 	};
 
 	class AllTypeData:
@@ -95,6 +140,30 @@ public \
 
 	Atomic<U32> m_uuid = {1};
 
+	// Epoch based reclamation. A thread that reads a resource version without holding its lock publishes the global epoch in its slot. Freed
+	// versions are retired with the epoch they were unlinked in and deleted only when all the readers that can see them are done
+	class alignas(ANKI_CACHE_LINE_SIZE) ReaderEpoch
+	{
+	public:
+		Atomic<U64> m_epoch = {0}; // Zero if the thread is not reading
+	};
+
+	class RetiredResource
+	{
+	public:
+		ResourceObject* m_resource;
+		void (*m_deleteCallback)(ResourceObject*);
+		U64 m_epoch;
+	};
+
+	Array<ReaderEpoch, kMaxReaderThreads> m_readerEpochs;
+	Atomic<U32> m_readerEpochCount = {0};
+	Atomic<U64> m_globalEpoch = {1};
+	U32 m_generation; // Distinguishes this manager from previous ones in the thread local reader slot indices
+
+	ResourceDynamicArray<RetiredResource> m_retiredResources;
+	Mutex m_retiredResourcesMtx;
+
 #if ANKI_WITH_EDITOR
 	Bool m_trackFileUpdateTimes = false;
 #endif
@@ -105,12 +174,32 @@ public \
 
 #if ANKI_WITH_EDITOR
 	template<typename T>
-	void refreshFileUpdateTimesInternal();
+	void refreshFileUpdateTimesInternal(ConstWeakArray<ResourceString> modifiedFiles, Bool allChanged);
 #endif
 
 	// Note: Thread-safe against itself, loadResource() and refreshFileUpdateTimes()
 	template<typename T>
 	void freeResource(U32 uuid, U32 versionedResourceIdx);
+
+	static U32 encodeResourceIndex(U32 shardIdx, U32 idxInShard)
+	{
+		ANKI_ASSERT(shardIdx < kMapShardCount && idxInShard < (kMaxU32 >> kMapShardBits));
+		return (idxInShard << kMapShardBits) | shardIdx;
+	}
+
+	// Returns the reader slot of the current thread or kMaxU32 if all the slots are taken.
+	U32 enterReadEpoch();
+
+	void leaveReadEpoch(U32 slot)
+	{
+		ANKI_ASSERT(slot < kMaxReaderThreads);
+		m_readerEpochs[slot].m_epoch.store(0, AtomicMemoryOrder::kRelease);
+	}
+
+	void retireResource(ResourceObject* rsrc, void (*deleteCallback)(ResourceObject*));
+
+	// Delete the retired resources that no reader can see any more.
+	void reclaimRetiredResources();
 };
 
 } // end namespace anki
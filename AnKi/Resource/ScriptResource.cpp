@@ -8,14 +8,35 @@
 
 namespace anki {
 
+// Same as LUA_SIGNATURE. Don't want to include LUA here
+static constexpr Array<U8, 4> kLuaBytecodeSignature = {0x1B, 'L', 'u', 'a'};
+
 Error ScriptResource::load(const ResourceFilename& filename, [[maybe_unused]] Bool async)
 {
 	ResourceFilePtr file;
 	ANKI_CHECK(openFile(filename, file));
 
-	ResourceString src;
-	ANKI_CHECK(file->readAllText(src));
-	m_source = std::move(src);
+	// Check if it's precompiled
+	Array<U8, kLuaBytecodeSignature.getSize()> signature = {};
+	Bool isBytecode = false;
+	if(file->getSize() >= signature.getSize())
+	{
+		ANKI_CHECK(file->read(signature.getBegin(), signature.getSizeInBytes()));
+		isBytecode = signature == kLuaBytecodeSignature;
+		ANKI_CHECK(file->seek(0, FileSeekOrigin::kBeginning));
+	}
+
+	if(isBytecode)
+	{
+		m_bytecode.resize(U32(file->getSize()));
+		ANKI_CHECK(file->read(m_bytecode.getBegin(), m_bytecode.getSizeInBytes()));
+	}
+	else
+	{
+		ResourceString src;
+		ANKI_CHECK(file->readAllText(src));
+		m_source = std::move(src);
+	}
 
 	return Error::kNone;
 }
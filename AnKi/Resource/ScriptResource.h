@@ -9,7 +9,7 @@
 
 namespace anki {
 
-// Script resource.
+// Script resource. The file is either LUA text or LUA bytecode. Use ScriptManager::getOrCompileBytecode() to get the bytecode in both cases.
 class ScriptResource : public ResourceObject
 {
 public:
@@ -22,13 +22,21 @@ public:
 
 	Error load(const ResourceFilename& filename, Bool async);
 
+	// The LUA text. It's empty if the file was bytecode
 	CString getSource() const
 	{
 		return m_source.toCString();
 	}
 
+	// The LUA bytecode. It's empty if the file was text
+	ConstWeakArray<U8, PtrSize> getBytecode() const
+	{
+		return ConstWeakArray<U8, PtrSize>(m_bytecode.getBegin(), m_bytecode.getSize());
+	}
+
 private:
 	ResourceString m_source;
+	ResourceDynamicArray<U8> m_bytecode;
 };
 
 } // namespace anki
@@ -6,6 +6,7 @@
 #include <AnKi/Resource/ShaderProgramResource.h>
 #include <AnKi/Resource/ResourceManager.h>
 #include <AnKi/Resource/ShaderProgramResourceSystem.h>
+#include <AnKi/Resource/ShaderVariantWarmup.h>
 #include <AnKi/Gr/ShaderProgram.h>
 #include <AnKi/Gr/GrManager.h>
 #include <AnKi/Util/Filesystem.h>
@@ -111,24 +112,65 @@ void ShaderProgramResource::getOrCreateVariant(const ShaderProgramResourceVarian
 		}
 	}
 
-	// Create the variant
-	WLockGuard lock(m_mtx);
-
-	// Check again
-	auto it = m_variants.find(hash);
-	if(it != m_variants.getEnd())
+	// Mark the variant as in flight or wait for the thread that creates it
 	{
-		// Done
-		variant = *it;
-		return;
+		LockGuard lock(m_variantsInFlightMtx);
+		while(true)
+		{
+			{
+				RLockGuard lock2(m_mtx);
+				auto it = m_variants.find(hash);
+				if(it != m_variants.getEnd())
+				{
+					variant = *it;
+					return;
+				}
+			}
+
+			Bool inFlight = false;
+			for(U64 h : m_variantsInFlight)
+			{
+				inFlight = inFlight || h == hash;
+			}
+
+			if(!inFlight)
+			{
+				m_variantsInFlight.emplaceBack(hash);
+				break;
+			}
+
+			m_variantsInFlightCond.wait(m_variantsInFlightMtx);
+		}
 	}
 
-	// Create
+	// Create the variant outside the locks so different variants of the same program can be created in parallel
 	ShaderProgramResourceVariant* v = createNewVariant(info);
+
 	if(v)
 	{
+		WLockGuard lock(m_mtx);
 		m_variants.emplace(hash, v);
 	}
+
+	{
+		LockGuard lock(m_variantsInFlightMtx);
+		for(auto it = m_variantsInFlight.getBegin(); it != m_variantsInFlight.getEnd(); ++it)
+		{
+			if(*it == hash)
+			{
+				m_variantsInFlight.erase(it);
+				break;
+			}
+		}
+	}
+
+	m_variantsInFlightCond.notifyAll();
+
+	if(v && !!(info.m_shaderTypes & (ShaderTypeBit::kAllGraphics | ShaderTypeBit::kCompute)) && ShaderVariantWarmup::isAllocated())
+	{
+		ShaderVariantWarmup::getSingleton().recordVariant(*this, info);
+	}
+
 	variant = v;
 	if(!!(info.m_shaderTypes & ShaderTypeBit::kAllGraphics))
 	{
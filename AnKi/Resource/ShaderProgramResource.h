@@ -59,6 +59,7 @@ private:
 class ShaderProgramResourceVariantInitInfo
 {
 	friend class ShaderProgramResource;
+	friend class ShaderVariantWarmup;
 
 public:
 	ShaderProgramResourceVariantInitInfo()
@@ -146,6 +147,10 @@ private:
 	mutable ResourceHashMap<U64, ShaderProgramResourceVariant*> m_variants;
 	mutable RWMutex m_mtx;
 
+	mutable ResourceDynamicArray<U64> m_variantsInFlight; // Hashes of the variants that some thread is creating
+	mutable Mutex m_variantsInFlightMtx;
+	mutable ConditionVariable m_variantsInFlightCond;
+
 	ShaderProgramResourceVariant* createNewVariant(const ShaderProgramResourceVariantInitInfo& info) const;
 
 	U32 findTechnique(CString name) const;
@@ -0,0 +1,322 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Resource/ShaderVariantWarmup.h>
+#include <AnKi/Resource/ShaderProgramResource.h>
+#include <AnKi/Resource/ResourceManager.h>
+#include <AnKi/Core/StatsSet.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/StringList.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Util/Tracer.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/System.h>
+
+namespace anki {
+
+ANKI_SVAR(ShaderVariantsCreatedOnDemand, StatCategory::kMisc, "Shader variants created in gameplay", StatFlag::kNone)
+
+// Every line of the manifest is a variant: <program filename>;<shader type>:<technique>,...;<mutator>=<value>,...
+static constexpr CString kManifestFilename = "ShaderVariantManifest.txt";
+
+// The variants that the warmup creates don't count as created on demand
+static thread_local Bool g_warmupThread = false;
+
+// Split "left<separator>right". Both sides need to be non-empty.
+static Bool splitPair(CString str, Char separator, ResourceString& left, ResourceString& right)
+{
+	const Char* sep = strchr(str.cstr(), separator);
+	if(!sep || sep == str.cstr() || sep[1] == '\0')
+	{
+		return false;
+	}
+
+	left = ResourceString(str.cstr(), sep);
+	right = ResourceString(sep + 1);
+	return true;
+}
+
+ShaderVariantWarmup::~ShaderVariantWarmup()
+{
+	stopWarmup();
+	m_programs.destroy();
+	m_warmupLines.destroy();
+	m_variants.destroy();
+}
+
+Error ShaderVariantWarmup::init(CString cacheDir)
+{
+	m_manifestFilename.sprintf("%s/%s", cacheDir.cstr(), kManifestFilename.cstr());
+
+	if(!fileExists(m_manifestFilename))
+	{
+		ANKI_RESOURCE_LOGI("No shader variant manifest found. Will create one: %s", m_manifestFilename.cstr());
+		return Error::kNone;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_manifestFilename, FileOpenFlag::kRead));
+	ResourceString txt;
+	ANKI_CHECK(file.readAllText(txt));
+
+	ResourceStringList lines;
+	lines.splitString(txt, '\n');
+	for(const ResourceString& line : lines)
+	{
+		const U64 hash = computeHash(line.cstr(), line.getLength());
+		if(m_variants.find(hash) == m_variants.getEnd())
+		{
+			m_variants.emplace(hash, line);
+		}
+	}
+
+	ANKI_RESOURCE_LOGI("Loaded shader variant manifest with %u variants", U32(m_variants.getSize()));
+	return Error::kNone;
+}
+
+void ShaderVariantWarmup::startWarmup()
+{
+	if(!g_cvarRsrcShaderVariantWarmup || m_variants.getSize() == 0)
+	{
+		return;
+	}
+
+	ANKI_ASSERT(!m_warmupJobManager);
+	m_warmupBegin = HighRezTimer::getCurrentTime();
+
+	// Copy the lines because creating the variants will record them again
+	{
+		LockGuard lock(m_mtx);
+		for(const ResourceString& line : m_variants)
+		{
+			m_warmupLines.emplaceBack(line);
+		}
+	}
+
+	m_programs.resize(m_warmupLines.getSize());
+
+	// Use half of the cores so the frames that render in the meantime still have some. Every task takes lines till there are no more
+	const U32 threadCount = max(1u, getCpuCoresCount() / 2);
+	m_warmupJobManager = newInstance<ThreadJobManager>(ResourceMemoryPool::getSingleton(), threadCount);
+	m_warmupTaskCount.store(threadCount);
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		m_warmupJobManager->dispatchTask([this]([[maybe_unused]] U32 tid) {
+			warmupTask();
+		});
+	}
+}
+
+void ShaderVariantWarmup::warmupTask()
+{
+	ANKI_TRACE_FUNCTION();
+
+	g_warmupThread = true;
+
+	U32 i;
+	while(!m_stopWarmup.load() && (i = m_nextWarmupLine.fetchAdd(1)) < m_warmupLines.getSize())
+	{
+		if(createVariant(m_warmupLines[i], m_programs[i]))
+		{
+			m_createdCount.fetchAdd(1);
+		}
+		else
+		{
+			// Stale line (the program or its mutators changed), don't write it to the manifest again
+			ANKI_RESOURCE_LOGV("Dropping shader variant from the manifest: %s", m_warmupLines[i].cstr());
+			m_programs[i].reset(nullptr);
+
+			LockGuard lock(m_mtx);
+			auto it = m_variants.find(computeHash(m_warmupLines[i].cstr(), m_warmupLines[i].getLength()));
+			if(it != m_variants.getEnd())
+			{
+				m_variants.erase(it);
+			}
+		}
+	}
+
+	g_warmupThread = false;
+
+	if(m_warmupTaskCount.fetchSub(1) == 1 && !m_stopWarmup.load())
+	{
+		ANKI_RESOURCE_LOGI("Pre-created %u shader variants in %fms", m_createdCount.load(),
+						   (HighRezTimer::getCurrentTime() - m_warmupBegin) * 1000.0);
+	}
+}
+
+void ShaderVariantWarmup::stopWarmup()
+{
+	if(m_warmupJobManager)
+	{
+		m_stopWarmup.store(1);
+		m_warmupJobManager->waitForAllTasksToFinish();
+		deleteInstance(ResourceMemoryPool::getSingleton(), m_warmupJobManager);
+		m_warmupJobManager = nullptr;
+	}
+}
+
+Bool ShaderVariantWarmup::createVariant(CString line, ShaderProgramResourcePtr& prog)
+{
+	ResourceStringList parts;
+	parts.splitString(line, ';', true);
+	if(parts.getSize() != 3)
+	{
+		return false;
+	}
+
+	auto partIt = parts.getBegin();
+	const ResourceString& filename = *partIt;
+	const ResourceString& techniques = *(++partIt);
+	const ResourceString& mutations = *(++partIt);
+
+	if(filename.isEmpty() || techniques.isEmpty() || ResourceManager::getSingleton().loadResource(filename, prog))
+	{
+		return false;
+	}
+
+	const ShaderBinary& binary = prog->getBinary();
+	ShaderProgramResourceVariantInitInfo initInfo(prog);
+
+	ResourceStringList list;
+	list.splitString(techniques, ',');
+	for(const ResourceString& str : list)
+	{
+		ResourceString typeStr, technique;
+		U32 type;
+		if(!splitPair(str, ':', typeStr, technique) || typeStr.toNumber(type) || type >= U32(ShaderType::kCount)
+		   || technique.getLength() > ShaderProgramResourceVariantInitInfo::kMaxTechniqueNameLength
+		   || !!(initInfo.m_shaderTypes & ShaderTypeBit(1 << type)))
+		{
+			return false;
+		}
+
+		Bool found = false;
+		for(const ShaderBinaryTechnique& t : binary.m_techniques)
+		{
+			if(technique == t.m_name.getBegin() && !!(t.m_shaderTypes & ShaderTypeBit(1 << type)))
+			{
+				found = true;
+				break;
+			}
+		}
+
+		if(!found)
+		{
+			return false;
+		}
+
+		initInfo.requestTechniqueAndTypes(ShaderTypeBit(1 << type), technique);
+	}
+
+	list.destroy();
+	if(!mutations.isEmpty())
+	{
+		list.splitString(mutations, ',');
+	}
+
+	for(const ResourceString& str : list)
+	{
+		ResourceString name, valueStr;
+		MutatorValue value;
+		if(!splitPair(str, '=', name, valueStr) || valueStr.toNumber(value))
+		{
+			return false;
+		}
+
+		const ShaderBinaryMutator* mutator = prog->tryFindMutator(name);
+		if(!mutator || initInfo.m_setMutators.get(mutator - binary.m_mutators.getBegin()))
+		{
+			return false;
+		}
+
+		Bool valueExists = false;
+		for(MutatorValue v : mutator->m_values)
+		{
+			valueExists = valueExists || v == value;
+		}
+
+		if(!valueExists)
+		{
+			return false;
+		}
+
+		initInfo.addMutation(name, value);
+	}
+
+	if(initInfo.m_setMutators.getSetBitCount() != binary.m_mutators.getSize())
+	{
+		return false;
+	}
+
+	const ShaderProgramResourceVariant* variant;
+	prog->getOrCreateVariant(initInfo, variant);
+	return variant != nullptr;
+}
+
+void ShaderVariantWarmup::recordVariant(const ShaderProgramResource& prog, const ShaderProgramResourceVariantInitInfo& info)
+{
+	if(m_gameplayStarted.load() && !g_warmupThread)
+	{
+		g_svarShaderVariantsCreatedOnDemand.increment(1);
+	}
+
+	ResourceString line = prog.getFilename();
+	line += ";";
+
+	Bool first = true;
+	for(ShaderType type : EnumBitsIterable<ShaderType, ShaderTypeBit>(info.m_shaderTypes))
+	{
+		line += ResourceString().sprintf("%s%u:%s", (first) ? "" : ",", U32(type), info.m_techniqueNames[type].getBegin());
+		first = false;
+	}
+
+	line += ";";
+
+	const ShaderBinary& binary = prog.getBinary();
+	for(U32 i = 0; i < binary.m_mutators.getSize(); ++i)
+	{
+		line += ResourceString().sprintf("%s%s=%d", (i == 0) ? "" : ",", binary.m_mutators[i].m_name.getBegin(), info.m_mutation[i]);
+	}
+
+	const U64 hash = computeHash(line.cstr(), line.getLength());
+
+	LockGuard lock(m_mtx);
+	if(m_variants.find(hash) == m_variants.getEnd())
+	{
+		m_variants.emplace(hash, std::move(line));
+	}
+}
+
+Error ShaderVariantWarmup::writeManifest()
+{
+	if(m_manifestFilename.isEmpty())
+	{
+		return Error::kNone;
+	}
+
+	stopWarmup();
+
+	LockGuard lock(m_mtx);
+
+	// Write to a temp file and rename it so a crash in the middle of writing doesn't leave a truncated manifest
+	ResourceString tmpFilename;
+	tmpFilename.sprintf("%s.tmp", m_manifestFilename.cstr());
+	{
+		File file;
+		ANKI_CHECK(file.open(tmpFilename, FileOpenFlag::kWrite));
+		for(const ResourceString& line : m_variants)
+		{
+			ANKI_CHECK(file.writeTextf("%s\n", line.cstr()));
+		}
+	}
+
+	ANKI_CHECK(renameFile(tmpFilename, m_manifestFilename));
+
+	ANKI_RESOURCE_LOGI("Wrote shader variant manifest with %u variants", U32(m_variants.getSize()));
+	return Error::kNone;
+}
+
+} // end namespace anki
@@ -0,0 +1,83 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Resource/Common.h>
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/String.h>
+#include <AnKi/Util/Thread.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/CVarSet.h>
+
+namespace anki {
+
+// Forward
+class ShaderProgramResource;
+class ShaderProgramResourceVariantInitInfo;
+
+ANKI_CVAR(BoolCVar, Rsrc, ShaderVariantWarmup, true, "Pre-create at startup the shader variants that the previous sessions used")
+
+// Records the shader program variants that get created during a session and writes them to a manifest in the cache directory. At the next
+// startup it pre-creates the variants of the manifest in parallel so they don't get created in the middle of a frame.
+// There is no loading screen so the pre-creation runs in the background while the first frames render. A frame that needs a variant that is
+// being pre-created waits for it.
+// The manifest only grows. Clearing the cache directory starts it fresh.
+class ShaderVariantWarmup : public MakeSingleton<ShaderVariantWarmup>
+{
+	template<typename>
+	friend class MakeSingleton;
+
+public:
+	// Read the manifest of the previous sessions.
+	Error init(CString cacheDir);
+
+	// Start creating the variants of the manifest in background threads. It doesn't block. Call it from the main thread.
+	void startWarmup();
+
+	// Write all the variants created so far (plus the manifest's) to the manifest. It stops the warmup first. Call it from the main thread.
+	Error writeManifest();
+
+	// After that every new variant counts as created on demand. See the ShaderVariantsCreatedOnDemand stat.
+	void startGameplay()
+	{
+		m_gameplayStarted.store(1);
+	}
+
+	// Thread-safe. ShaderProgramResource calls it when it creates a new variant.
+	void recordVariant(const ShaderProgramResource& prog, const ShaderProgramResourceVariantInitInfo& info);
+
+private:
+	ResourceString m_manifestFilename;
+
+	ResourceHashMap<U64, ResourceString> m_variants; // Variant hash to manifest line
+	Mutex m_mtx;
+
+	// Warmup state
+	ThreadJobManager* m_warmupJobManager = nullptr;
+	ResourceDynamicArray<ResourceString> m_warmupLines; // The manifest lines to pre-create
+	ResourceDynamicArray<ShaderProgramResourcePtr> m_programs; // Keep the programs of the pre-created variants alive. One per line
+	Atomic<U32> m_nextWarmupLine = {0};
+	Atomic<U32> m_warmupTaskCount = {0}; // Tasks still running
+	Atomic<U32> m_createdCount = {0};
+	Atomic<U32> m_stopWarmup = {0};
+	Second m_warmupBegin = 0.0;
+
+	Atomic<U32> m_gameplayStarted = {0};
+
+	ShaderVariantWarmup() = default;
+
+	~ShaderVariantWarmup();
+
+	// Stop the background warmup and wait for its threads.
+	void stopWarmup();
+
+	void warmupTask();
+
+	// Parse a line of the manifest and create the variant. Returns false if the line is no longer valid.
+	static Bool createVariant(CString line, ShaderProgramResourcePtr& prog);
+};
+
+} // end namespace anki
@@ -37,6 +37,7 @@ AnimationComponent& AnimationComponent::setAnimationFilename(U32 track, CString
 	Track& t = m_tracks[track];
 	t.m_anim = std::move(newRsrc);
 	t.m_channel = 0; // Reset the channel
+	t.m_cursor = {};
 
 	m_validTracks.set(track);
 
@@ -95,6 +96,7 @@ AnimationComponent& AnimationComponent::setAnimationChannel(U32 track, CString c
 	}
 
 	t.m_channel = channelIdx;
+	t.m_cursor = {};
 
 	return *this;
 }
@@ -173,7 +175,7 @@ void AnimationComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 		Vec3 pos;
 		Quat rot;
 		F32 scale = 1.0;
-		t.m_anim->interpolate(t.m_channel, animTime, pos, rot, scale);
+		t.m_anim->interpolate(t.m_channel, animTime, t.m_cursor, pos, rot, scale);
 
 		if(t.m_blendMode == AnimationBlendMode::kBlend)
 		{
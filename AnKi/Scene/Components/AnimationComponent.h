@@ -7,6 +7,7 @@
 
 #include <AnKi/Scene/Components/SceneComponent.h>
 #include <AnKi/Resource/Forward.h>
+#include <AnKi/Resource/AnimationResource.h>
 
 namespace anki {
 
@@ -179,6 +180,7 @@ private:
 		Second m_relativeTimePassed = 0.0;
 		AnimationResourcePtr m_anim;
 		U32 m_channel = 0;
+		AnimationCursor m_cursor;
 		F32 m_animationSpeedScale = 1.0f;
 		F32 m_blendWeight = 1.0f;
 		AnimationState m_state = AnimationState::kStopped;
@@ -18,7 +18,6 @@ ANKI_SVAR(BodiesCreated, StatCategory::kScene, "Bodies created", StatFlag::kNone
 
 BodyComponent::BodyComponent(const SceneComponentInitInfo& init)
 	: SceneComponent(kClassType, init)
-	, m_node(init.m_node)
 {
 	// A body lives in world space, so its node must ignore the parent's transform (after this, world == local). If the node currently has a parent,
 	// bake the real world transform into the local first, otherwise enabling ignore-parent would snap the node to its parent-relative transform. Do
@@ -87,8 +86,8 @@ void BodyComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 
 		PhysicsBodyInitInfo init;
 		init.m_mass = m_mass;
-		// The node ignores its parent so local == world. Use local: it's the fresh value here, because MoveComponent (which recomputes the world
-		// transform via updateTransform()) updates after us.
+		// The node ignores its parent so local == world. Use local: it's the fresh value here, because the world transforms are computed by the
+		// SceneTransformStore after us.
 		init.m_transform = m_node->getLocalTransform();
 
 		const Bool isStatic = m_mass == 0.0f;
@@ -114,13 +114,7 @@ public:
 		return m_body;
 	}
 
-	ANKI_INTERNAL SceneNode& getSceneNode()
-	{
-		return *m_node;
-	}
-
 private:
-	SceneNode* m_node = nullptr;
 	PhysicsBodyPtr m_body;
 	Vec3 m_creationScale = Vec3(0.0f); // Track the scale the body was created with
 
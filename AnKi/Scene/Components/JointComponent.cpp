@@ -14,7 +14,6 @@ ANKI_SVAR(JointsCreated, StatCategory::kScene, "Joints created", StatFlag::kNone
 
 JointComponent::JointComponent(const SceneComponentInitInfo& init)
 	: SceneComponent(kClassType, init)
-	, m_node(init.m_node)
 {
 	m_node->setIgnoreParentTransform(true);
 }
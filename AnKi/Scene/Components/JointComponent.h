@@ -110,8 +110,6 @@ public:
 private:
 	PhysicsJointPtr m_joint;
 
-	SceneNode* m_node = nullptr;
-
 	U32 m_parentNodeUuid = 0;
 
 	Transform m_pivot1 = Transform::getIdentity();
@@ -9,12 +9,15 @@
 #include <AnKi/Scene/SceneNode.h>
 #include <AnKi/Scene/SceneGraph.h>
 #include <AnKi/Collision.h>
+#include <AnKi/Core/StatsSet.h>
 #include <AnKi/Resource/ResourceManager.h>
 #include <AnKi/Resource/ImageResource.h>
 #include <AnKi/Shaders/Include/ClusteredShadingTypes.h>
 
 namespace anki {
 
+ANKI_SVAR(SceneCpuOccludedLights, StatCategory::kScene, "Point and spot lights hidden by the CPU occlusion culling", StatFlag::kZeroEveryFrame)
+
 // Calculate day of the year
 static U32 dayOfYear(U32 year, U32 month, U32 day)
 {
@@ -94,13 +97,29 @@ LightComponent& LightComponent::setLightComponentType(LightComponentType newType
 void LightComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 {
 	const Bool moveUpdated = info.m_node->movedThisFrame();
-	updated = moveUpdated || m_shapeDirty || m_otherDirty;
 
 	if(moveUpdated)
 	{
 		m_worldTransform = info.m_node->getWorldTransform();
 	}
 
+	// CPU occlusion culling. Hide the light if its whole influence volume is behind the occluders
+	Bool cpuOccluded = false;
+	if(SceneGraph::getSingleton().isCpuOcclusionCullingActive() && (m_type == LightComponentType::kPoint || m_type == LightComponentType::kSpot))
+	{
+		const Vec3 center = m_worldTransform.getOrigin().xyz;
+		const Vec3 extend(m_pointAndSpot.m_influenceRadius);
+		cpuOccluded = SceneGraph::getSingleton().isOccludedOnCpu(Aabb(center - extend, center + extend));
+	}
+	const Bool cpuOcclusionChanged = cpuOccluded != m_cpuOccludedLastFrame;
+	m_cpuOccludedLastFrame = cpuOccluded;
+	if(cpuOccluded)
+	{
+		g_svarSceneCpuOccludedLights.increment(1);
+	}
+
+	updated = moveUpdated || m_shapeDirty || m_otherDirty || cpuOcclusionChanged;
+
 	if(updated && m_type == LightComponentType::kPoint)
 	{
 		const Bool reallyShadow = m_shadow && m_shadowAtlasUvViewportCount == 6;
@@ -149,6 +168,13 @@ void LightComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 			gpuLight.m_spotLightMatrixOrPointLightUvViewports[f] = m_shadowAtlasUvViewports[f];
 		}
 
+		if(cpuOccluded)
+		{
+			// Same as the default GpuSceneLight that no one can see
+			gpuLight.m_position = Vec3(kSomeFarDistance);
+			gpuLight.m_influenceRadius = 0.0f;
+		}
+
 		if(!m_gpuSceneLight.isValid())
 		{
 			m_gpuSceneLight.allocate();
@@ -227,6 +253,16 @@ void LightComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 			gpuLight.m_spotLightMatrixOrPointLightUvViewports[3] = texMat.getRow(3);
 		}
 
+		if(cpuOccluded)
+		{
+			gpuLight.m_position = Vec3(kSomeFarDistance);
+			gpuLight.m_influenceRadius = 0.0f;
+			for(U32 i = 0; i < 4; ++i)
+			{
+				gpuLight.m_edgePoints[i] = Vec4(kSomeFarDistance, kSomeFarDistance, kSomeFarDistance, 0.0f);
+			}
+		}
+
 		if(!m_gpuSceneLight.isValid())
 		{
 			m_gpuSceneLight.allocate();
@@ -352,6 +352,7 @@ private:
 	U8 m_shadow : 1 = false;
 	U8 m_shapeDirty : 1 = true;
 	U8 m_otherDirty : 1 = true;
+	U8 m_cpuOccludedLastFrame : 1 = false;
 	U8 m_shadowAtlasUvViewportCount : 3 = 0;
 
 	void update(SceneComponentUpdateInfo& info, Bool& updated) override;
@@ -8,14 +8,33 @@
 #include <AnKi/Scene/Components/MeshComponent.h>
 #include <AnKi/Scene/Components/MoveComponent.h>
 #include <AnKi/Scene/Components/ParticleEmitter2Component.h>
+#include <AnKi/Scene/SceneGraph.h>
 #include <AnKi/Resource/MeshResource.h>
 #include <AnKi/Resource/MaterialResource.h>
 #include <AnKi/Resource/ResourceManager.h>
 #include <AnKi/Core/App.h>
+#include <AnKi/Core/StatsSet.h>
 #include <AnKi/Shaders/Include/GpuSceneFunctions.h>
 
 namespace anki {
 
+ANKI_SVAR(SceneCpuOccludedRenderables, StatCategory::kScene, "Renderables hidden by the CPU occlusion culling", StatFlag::kZeroEveryFrame)
+
+// The techniques that render from the main camera get an invisible volume if the renderable is hidden by the CPU occluders. The shadows and the
+// RT still need it
+static GpuSceneRenderableBoundingVolume initBoundingVolume(const Aabb& aabbWorld, RenderingTechnique t, Bool cpuOccluded, U32 renderableIndex,
+														   U32 renderStateBucket)
+{
+	if(cpuOccluded && (t == RenderingTechnique::kGBuffer || t == RenderingTechnique::kForward))
+	{
+		return initGpuSceneRenderableBoundingVolume(Vec3(kSomeFarDistance), Vec3(kSomeFarDistance), renderableIndex, renderStateBucket);
+	}
+	else
+	{
+		return initGpuSceneRenderableBoundingVolume(aabbWorld.getMin().xyz, aabbWorld.getMax().xyz, renderableIndex, renderStateBucket);
+	}
+}
+
 MaterialComponent::MaterialComponent(const SceneComponentInitInfo& init)
 	: SceneComponent(kClassType, init)
 {
@@ -199,6 +218,19 @@ void MaterialComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 		dirty = dirty || m_meshComponent->gpuSceneReallocationsThisFrame();
 	}
 
+	// CPU occlusion culling. Emitters and occluders are never hidden
+	Bool cpuOccluded = false;
+	if(SceneGraph::getSingleton().isCpuOcclusionCullingActive() && !prioritizeEmitter && !m_meshComponent->isOccluder())
+	{
+		cpuOccluded = SceneGraph::getSingleton().isOccludedOnCpu(computeAabb(*info.m_node));
+	}
+	const Bool cpuOcclusionChanged = cpuOccluded != m_cpuOccludedLastFrame;
+	m_cpuOccludedLastFrame = cpuOccluded;
+	if(cpuOccluded)
+	{
+		g_svarSceneCpuOccludedRenderables.increment(1);
+	}
+
 	if(!dirty) [[likely]]
 	{
 		// Update Scene bounds
@@ -209,13 +241,13 @@ void MaterialComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 		}
 
 		// Update the GPU scene AABBs
-		if(prioritizeEmitter || m_skinComponent || moved)
+		if(prioritizeEmitter || m_skinComponent || moved || cpuOcclusionChanged)
 		{
 			const Aabb aabbWorld = computeAabb(*info.m_node);
 			for(RenderingTechnique t : EnumBitsIterable<RenderingTechnique, RenderingTechniqueBit>(mtl.getRenderingTechniques()))
 			{
-				const GpuSceneRenderableBoundingVolume gpuVolume = initGpuSceneRenderableBoundingVolume(
-					aabbWorld.getMin().xyz, aabbWorld.getMax().xyz, m_gpuSceneRenderable.getIndex(), m_renderStateBucketIndices[t].get());
+				const GpuSceneRenderableBoundingVolume gpuVolume =
+					initBoundingVolume(aabbWorld, t, cpuOccluded, m_gpuSceneRenderable.getIndex(), m_renderStateBucketIndices[t].get());
 
 				switch(t)
 				{
@@ -447,8 +479,8 @@ void MaterialComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 			}
 			else
 			{
-				const GpuSceneRenderableBoundingVolume gpuVolume = initGpuSceneRenderableBoundingVolume(
-					aabbWorld.getMin().xyz, aabbWorld.getMax().xyz, m_gpuSceneRenderable.getIndex(), m_renderStateBucketIndices[t].get());
+				const GpuSceneRenderableBoundingVolume gpuVolume =
+					initBoundingVolume(aabbWorld, t, cpuOccluded, m_gpuSceneRenderable.getIndex(), m_renderStateBucketIndices[t].get());
 
 				switch(t)
 				{
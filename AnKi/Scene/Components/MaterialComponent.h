@@ -63,6 +63,7 @@ private:
 
 	Bool m_anyDirty : 1 = true; // A compound flag because it's too difficult to track everything
 	Bool m_movedLastFrame : 1 = true;
+	Bool m_cpuOccludedLastFrame : 1 = false;
 
 	static inline Atomic<U32> m_renderableUuid = {1};
 
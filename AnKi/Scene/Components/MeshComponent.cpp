@@ -113,7 +113,7 @@ static void generateSpherePrimitive(U32 subdivisions, DynamicArray<U16Vec3, Memo
 	// sure an edge shared by two triangles produces a single shared midpoint, which keeps the mesh watertight and small
 	for(U32 s = 0; s < subdivisions; ++s)
 	{
-		HashMap<U64, U32, DefaultHasher<U64>, Pool, HashMapSparseArrayConfig> midpointCache(pool);
+		HashMap<U64, U32, DefaultHasher<U64>, Pool, HashMapDefaultConfig> midpointCache(pool);
 
 		auto getMidpoint = [&](U32 i0, U32 i1) -> U32 {
 			const U64 key = (U64(min(i0, i1)) << 32) | U64(max(i0, i1));
@@ -443,7 +443,7 @@ Bool MeshComponent::isValid() const
 		   || (m_type == MeshComponentType::kMeshResource && !!m_resource && m_resource->isLoaded());
 }
 
-void MeshComponent::update([[maybe_unused]] SceneComponentUpdateInfo& info, Bool& updated)
+void MeshComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 {
 	if(!isValid()) [[unlikely]]
 	{
@@ -454,6 +454,8 @@ void MeshComponent::update([[maybe_unused]] SceneComponentUpdateInfo& info, Bool
 		return;
 	}
 
+	m_occluderWorldTransform = info.m_node->getWorldTransform();
+
 	m_gpuSceneMeshLodsReallocatedThisFrame = false;
 	if(!m_dirty) [[likely]]
 	{
@@ -640,6 +642,7 @@ Error MeshComponent::serialize(SceneSerializer& serializer)
 	ANKI_SERIALIZE(m_type, 1);
 	ANKI_SERIALIZE(m_primitiveType, 1);
 	ANKI_SERIALIZE(m_sphereSubdivision, 1);
+	ANKI_SERIALIZE(m_occluder, 2);
 
 	return Error::kNone;
 }
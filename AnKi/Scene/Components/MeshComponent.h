@@ -100,6 +100,25 @@ public:
 
 	MeshComponent& setMeshFilename(CString fname);
 
+	// Make the mesh an occluder of the CPU occlusion culling. Only primitives can be occluders since they are the only ones with CPU geometry.
+	MeshComponent& setOccluder(Bool occluder)
+	{
+		m_occluder = occluder;
+		return *this;
+	}
+
+	Bool isOccluder() const
+	{
+		return m_occluder;
+	}
+
+	// The world transform of the node as it was on the last update.
+	ANKI_INTERNAL const Transform& getOccluderWorldTransform() const
+	{
+		ANKI_ASSERT(m_occluder && getTimestamp() > 0);
+		return m_occluderWorldTransform;
+	}
+
 	Bool hasMeshResource() const
 	{
 		return !!m_resource;
@@ -148,10 +167,13 @@ private:
 
 	SceneDynamicArray<GpuSceneArrays::MeshLod::Allocation> m_gpuSceneMeshLods;
 
+	Transform m_occluderWorldTransform; // Cache it because the CPU occlusion rasterizes before the nodes update
+
 	MeshComponentType m_type = MeshComponentType::kMeshResource;
 	MeshComponentPrimitiveType m_primitiveType = MeshComponentPrimitiveType::kBox;
 	Bool m_dirty = true;
 	Bool m_gpuSceneMeshLodsReallocatedThisFrame = false;
+	Bool m_occluder = false;
 
 	void* m_primitiveGometry = nullptr;
 	U32 m_sphereSubdivision = 1;
@@ -10,7 +10,8 @@ namespace anki {
 
 void MoveComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 {
-	const Bool movedThisFrame = info.m_node->updateTransform();
+	// The world transforms are computed by the SceneTransformStore before the MoveComponents get updated. Upload only what changed
+	const Bool movedThisFrame = info.m_node->movedThisFrame();
 	const Bool movedLastFrame = m_movedLastFrame;
 	m_movedLastFrame = movedThisFrame;
 	updated = movedThisFrame || movedLastFrame != movedThisFrame;
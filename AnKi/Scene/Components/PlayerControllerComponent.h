@@ -28,14 +28,8 @@ public:
 		return *m_player;
 	}
 
-	ANKI_INTERNAL SceneNode& getSceneNode() const
-	{
-		return *m_node;
-	}
-
 private:
 	PhysicsPlayerControllerPtr m_player;
-	SceneNode* m_node = nullptr;
 	U32 m_positionVersion = kMaxU32;
 
 	void update(SceneComponentUpdateInfo& info, Bool& updated) override;
@@ -83,7 +83,7 @@ public:
 	const Bool m_checkForResourceUpdates : 1;
 #endif
 	const Bool m_paused : 1;
-	StackMemoryPool* m_framePool = nullptr;
+	StackMemoryPool* m_framePool = nullptr; // Frame memory of the calling thread. It's reset at the beginning of the next update
 
 	SceneComponentUpdateInfo(Second prevTime, Second crntTime, Bool forceUpdateSceneBounds
 #if ANKI_WITH_EDITOR
@@ -151,7 +151,8 @@ class SceneComponent
 {
 public:
 	SceneComponent(SceneComponentType type, const SceneComponentInitInfo& init)
-		: m_type(U8(type))
+		: m_node(init.m_node)
+		, m_type(U8(type))
 		, m_sceneUuid(init.m_sceneUuid)
 		, m_componentUuid(init.m_componentUuid)
 	{
@@ -174,6 +175,11 @@ public:
 		return m_timestamp;
 	}
 
+	ANKI_INTERNAL SceneNode& getSceneNode() const
+	{
+		return *m_node;
+	}
+
 	U32 getUuid() const
 	{
 		ANKI_ASSERT(m_sceneUuid && m_componentUuid);
@@ -248,6 +254,8 @@ public:
 	}
 
 protected:
+	SceneNode* m_node = nullptr; // The owner
+
 	// A convenience function for components to keep tabs on other components of a SceneNode
 	template<typename TComponent>
 	static void bookkeepComponent(SceneDynamicArray<TComponent*>& arr, SceneComponent* other, Bool added, Bool& firstDirty)
@@ -8,6 +8,7 @@
 #include <AnKi/Resource/ResourceManager.h>
 #include <AnKi/Resource/ScriptResource.h>
 #include <AnKi/Script/ScriptEnvironment.h>
+#include <AnKi/Script/ScriptManager.h>
 #include <AnKi/Scene/Components/TriggerComponent.h>
 
 namespace anki {
@@ -15,11 +16,49 @@ namespace anki {
 ScriptComponent::ScriptComponent(const SceneComponentInitInfo& init)
 	: SceneComponent(kClassType, init)
 {
+	static_assert(kNoFunctionRef == LUA_NOREF);
 }
 
 ScriptComponent::~ScriptComponent()
+{
+	setEnvironment(nullptr);
+}
+
+Error ScriptComponent::createEnvironment(ConstWeakArray<U8, PtrSize> bytecode, CString chunkName, ScriptEnvironment*& env)
+{
+	env = newInstance<ScriptEnvironment>(SceneMemoryPool::getSingleton(), Bool(g_cvarScriptSharedState));
+	const Error err = env->evalBytecode(bytecode, chunkName);
+	if(err)
+	{
+		deleteInstance(SceneMemoryPool::getSingleton(), env);
+		env = nullptr;
+	}
+
+	return err;
+}
+
+void ScriptComponent::setEnvironment(ScriptEnvironment* env)
 {
 	deleteInstance(SceneMemoryPool::getSingleton(), m_env);
+	m_env = env;
+
+	if(m_env)
+	{
+		// Cache the callbacks to avoid looking them up by name every frame
+		m_updateFuncRef = m_env->getFunctionReference("update");
+		m_onTriggerEnterFuncRef = m_env->getFunctionReference("onTriggerEnter");
+		m_onTriggerExitFuncRef = m_env->getFunctionReference("onTriggerExit");
+
+		m_vars.rebuildVarsFromLua(*m_env);
+	}
+	else
+	{
+		m_updateFuncRef = kNoFunctionRef;
+		m_onTriggerEnterFuncRef = kNoFunctionRef;
+		m_onTriggerExitFuncRef = kNoFunctionRef;
+
+		m_vars.destroy();
+	}
 }
 
 ScriptComponent& ScriptComponent::setScriptResourceFilename(CString fname)
@@ -36,30 +75,29 @@ ScriptComponent& ScriptComponent::setScriptResourceFilename(CString fname)
 	ScriptEnvironment* env = nullptr;
 	if(fname && !err)
 	{
-		env = newInstance<ScriptEnvironment>(SceneMemoryPool::getSingleton());
-		err = env->evalString(rsrc->getSource());
+		ConstWeakArray<U8, PtrSize> bytecode;
+		err = ScriptManager::getSingleton().getOrCompileBytecode(*rsrc, bytecode);
+		if(!err)
+		{
+			err = createEnvironment(bytecode, fname, env);
+		}
 	}
 
 	if(err)
 	{
-		deleteInstance(SceneMemoryPool::getSingleton(), env);
 		ANKI_SCENE_LOGE("Failed to load the script resource");
 	}
 	else if(!fname)
 	{
 		m_text.destroy();
 		m_resource.reset(nullptr);
-		deleteInstance(SceneMemoryPool::getSingleton(), m_env);
-		m_env = nullptr;
-		m_vars.destroy();
+		setEnvironment(nullptr);
 	}
 	else
 	{
 		m_text.destroy();
 		m_resource = std::move(rsrc);
-		deleteInstance(SceneMemoryPool::getSingleton(), m_env);
-		m_env = env;
-		m_vars.rebuildVarsFromLua(*m_env);
+		setEnvironment(env);
 	}
 
 #if ANKI_WITH_EDITOR
@@ -83,35 +121,34 @@ CString ScriptComponent::getScriptResourceFilename() const
 
 ScriptComponent& ScriptComponent::setScriptText(CString text)
 {
-	// Init the env
+	// Init the env. Many components have the same text so compile it once
 	ScriptEnvironment* env = nullptr;
 	Error err = Error::kNone;
 	if(text)
 	{
-		env = newInstance<ScriptEnvironment>(SceneMemoryPool::getSingleton());
-		err = env->evalString(text);
+		ConstWeakArray<U8, PtrSize> bytecode;
+		err = ScriptManager::getSingleton().getOrCompileBytecode(text, "=ScriptComponent", bytecode);
+		if(!err)
+		{
+			err = createEnvironment(bytecode, "=ScriptComponent", env);
+		}
 	}
 
 	if(err)
 	{
-		deleteInstance(SceneMemoryPool::getSingleton(), env);
 		ANKI_SCENE_LOGE("Failed to init the script");
 	}
 	else if(!text)
 	{
 		m_text.destroy();
 		m_resource.reset(nullptr);
-		deleteInstance(SceneMemoryPool::getSingleton(), m_env);
-		m_env = nullptr;
-		m_vars.destroy();
+		setEnvironment(nullptr);
 	}
 	else
 	{
 		m_resource.reset(nullptr);
 		m_text = text;
-		deleteInstance(SceneMemoryPool::getSingleton(), m_env);
-		m_env = env;
-		m_vars.rebuildVarsFromLua(*m_env);
+		setEnvironment(env);
 	}
 
 #if ANKI_WITH_EDITOR
@@ -155,97 +192,48 @@ void ScriptComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 	}
 #endif
 
-	lua_State* lua = &m_env->getLuaState();
+	// Shared environments run one at a time
+	LockGuard lock(*m_env);
 
 	// Flush C++ to LUA env
 	m_vars.flushDirtyVarsToLua(*m_env);
 
 	// Call update()
+	if(m_updateFuncRef != kNoFunctionRef)
 	{
-		// Push function name
-		lua_getglobal(lua, "update");
-
-		if(!lua_isfunction(lua, -1))
+		if(callFunction(m_updateFuncRef, "update", &info))
 		{
-			// Not defined (lua_isnil) or defined as a non-function, pop whatever lua_getglobal pushed
-			lua_pop(lua, 1);
+			return;
 		}
-		else
-		{
-			// Push args
-			LuaBinder::pushVariableToTheStack(lua, &info);
-
-			// Do the call (1 argument, no result)
-			if(lua_pcall(lua, 1, 0, 0) != 0)
-			{
-				ANKI_SCENE_LOGE("Error running ScriptComponent's \"update\": %s", lua_tostring(lua, -1));
-				return;
-			}
 
-			updated = true;
-		}
+		updated = true;
 	}
 
-	// Call onTriggerEnter
+	// Call onTriggerEnter and onTriggerExit
 	TriggerComponent* comp = info.m_node->tryGetFirstComponentOfType<TriggerComponent>();
-	if(comp)
+	if(comp && m_onTriggerEnterFuncRef != kNoFunctionRef)
 	{
 		for(SceneNode* node : comp->getSceneNodesEnter())
 		{
-			// Push function name
-			lua_getglobal(lua, "onTriggerEnter");
-
-			if(!lua_isfunction(lua, -1))
+			if(callFunction(m_onTriggerEnterFuncRef, "onTriggerEnter", node))
 			{
-				// Not defined (lua_isnil) or defined as a non-function, pop whatever lua_getglobal pushed
-				lua_pop(lua, 1);
-				break;
+				return;
 			}
-			else
-			{
-				// Push args
-				LuaBinder::pushVariableToTheStack(lua, node);
-
-				// Do the call (1 argument, no result)
-				if(lua_pcall(lua, 1, 0, 0) != 0)
-				{
-					ANKI_SCENE_LOGE("Error running ScriptComponent's \"onTriggerEnter\": %s", lua_tostring(lua, -1));
-					return;
-				}
 
-				updated = true;
-			}
+			updated = true;
 		}
 	}
 
-	// Call onTriggerExit
-	if(comp)
+	if(comp && m_onTriggerExitFuncRef != kNoFunctionRef)
 	{
 		for(SceneNode* node : comp->getSceneNodesExit())
 		{
-			// Push function name
-			lua_getglobal(lua, "onTriggerExit");
-
-			if(!lua_isfunction(lua, -1))
+			if(callFunction(m_onTriggerExitFuncRef, "onTriggerExit", node))
 			{
-				// Not defined (lua_isnil) or defined as a non-function, pop whatever lua_getglobal pushed
-				lua_pop(lua, 1);
-				break;
+				return;
 			}
-			else
-			{
-				// Push args
-				LuaBinder::pushVariableToTheStack(lua, node);
-
-				// Do the call (1 argument, no result)
-				if(lua_pcall(lua, 1, 0, 0) != 0)
-				{
-					ANKI_SCENE_LOGE("Error running ScriptComponent's \"onTriggerExit\": %s", lua_tostring(lua, -1));
-					return;
-				}
 
-				updated = true;
-			}
+			updated = true;
 		}
 	}
 
@@ -256,6 +244,25 @@ void ScriptComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 	}
 }
 
+template<typename T>
+Error ScriptComponent::callFunction(I32 funcRef, CString funcName, T* arg)
+{
+	lua_State* lua = &m_env->getLuaState();
+
+	m_env->pushFunction(funcRef);
+	LuaBinder::pushVariableToTheStack(lua, arg);
+
+	// Do the call (1 argument, no result)
+	if(lua_pcall(lua, 1, 0, 0) != 0)
+	{
+		ANKI_SCENE_LOGE("Error running ScriptComponent's \"%s\": %s", funcName.cstr(), lua_tostring(lua, -1));
+		lua_pop(lua, 1); // Pop the error
+		return Error::kUserData;
+	}
+
+	return Error::kNone;
+}
+
 Error ScriptComponent::serialize(SceneSerializer& serializer)
 {
 	ANKI_SERIALIZE(m_resource, 1);
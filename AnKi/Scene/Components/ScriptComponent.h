@@ -70,6 +70,12 @@ private:
 
 	ScriptEnvironment* m_env = nullptr;
 
+	// Registry references of the script's callbacks. Same as LUA_NOREF if the script doesn't define them
+	static constexpr I32 kNoFunctionRef = -2;
+	I32 m_updateFuncRef = kNoFunctionRef;
+	I32 m_onTriggerEnterFuncRef = kNoFunctionRef;
+	I32 m_onTriggerExitFuncRef = kNoFunctionRef;
+
 	ScriptVariables m_vars;
 
 #if ANKI_WITH_EDITOR
@@ -78,6 +84,14 @@ private:
 
 	void update(SceneComponentUpdateInfo& info, Bool& updated) override;
 
+	static Error createEnvironment(ConstWeakArray<U8, PtrSize> bytecode, CString chunkName, ScriptEnvironment*& env);
+
+	// Replace the current environment. Passing nullptr destroys it
+	void setEnvironment(ScriptEnvironment* env);
+
+	template<typename T>
+	Error callFunction(I32 funcRef, CString funcName, T* arg);
+
 	Error serialize(SceneSerializer& serializer) override;
 };
 
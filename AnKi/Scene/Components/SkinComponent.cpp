@@ -50,6 +50,9 @@ void SkinComponent::playAnimation(U32 trackIdx, AnimationResourcePtr anim, const
 	Track& track = m_tracks[trackIdx];
 
 	track.m_anim = anim;
+	track.m_cursors.destroy(); // Reset the cursors
+	track.m_cursors.resize(anim->getChannels().getSize());
+	track.m_channelBones.destroy(); // Will be recomputed on update
 	track.m_absoluteStartTime = m_absoluteTime + info.m_startTime;
 	track.m_relativeTimePassed = 0.0;
 	if(info.m_repeatTimes > 0.0)
@@ -139,23 +142,38 @@ void SkinComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 		const Second animTime = track.m_relativeTimePassed;
 		track.m_relativeTimePassed += dt * Second(track.m_animationSpeedScale);
 
-		// Iterate the animation channels and interpolate
-		for(U32 i = 0; i < track.m_anim->getChannels().getSize(); ++i)
+		// Map the channels to bones
+		const ConstWeakArray<AnimationChannel> channels = track.m_anim->getChannels();
+		if(resourceDirty || track.m_channelBones.getSize() != channels.getSize()) [[unlikely]]
 		{
-			const AnimationChannel& channel = track.m_anim->getChannels()[i];
-			const Bone* bone = m_resource->tryFindBone(channel.m_name.toCString());
-			if(!bone)
+			track.m_channelBones.resize(channels.getSize());
+			for(U32 i = 0; i < channels.getSize(); ++i)
+			{
+				const Bone* bone = m_resource->tryFindBone(channels[i].m_name.toCString());
+				if(!bone)
+				{
+					ANKI_SCENE_LOGW("Animation is referencing unknown bone \"%s\"", channels[i].m_name.cstr());
+				}
+				track.m_channelBones[i] = (bone) ? U16(bone->getIndex()) : kMaxU16;
+			}
+		}
+
+		// Interpolate all channels at once
+		DynamicArray<AnimationSample, MemoryPoolPtrWrapper<StackMemoryPool>> samples(info.m_framePool);
+		samples.resize(channels.getSize());
+		track.m_anim->sampleChannels(animTime, WeakArray<AnimationCursor>(track.m_cursors), WeakArray<AnimationSample>(samples));
+
+		for(U32 i = 0; i < channels.getSize(); ++i)
+		{
+			const U32 boneIdx = track.m_channelBones[i];
+			if(boneIdx == kMaxU16)
 			{
-				ANKI_SCENE_LOGW("Animation is referencing unknown bone \"%s\"", &channel.m_name[0]);
 				continue;
 			}
-			const U32 boneIdx = bone->getIndex();
 
-			// Interpolate
-			Vec3 position;
-			Quat rotation;
-			F32 scale;
-			track.m_anim->interpolate(i, animTime, position, rotation, scale);
+			Vec3 position = samples[i].m_position;
+			Quat rotation = samples[i].m_rotation;
+			F32 scale = samples[i].m_scale;
 
 			// Blend with previous track
 			if(bonesAnimated.get(boneIdx) && (track.m_blendInTime > 0.0 || track.m_blendOutTime > 0.0))
@@ -7,6 +7,7 @@
 
 #include <AnKi/Scene/Components/SceneComponent.h>
 #include <AnKi/Resource/Forward.h>
+#include <AnKi/Resource/AnimationResource.h>
 #include <AnKi/Collision/Aabb.h>
 #include <AnKi/Util/Forward.h>
 #include <AnKi/Util/WeakArray.h>
@@ -104,6 +105,8 @@ private:
 	{
 	public:
 		AnimationResourcePtr m_anim;
+		SceneDynamicArray<AnimationCursor> m_cursors; // One per channel
+		SceneDynamicArray<U16> m_channelBones; // The bone of each channel. kMaxU16 if the skeleton doesn't have it
 		Second m_absoluteStartTime = 0.0;
 		Second m_relativeTimePassed = 0.0;
 		Second m_blendInTime = 0.0;
@@ -86,7 +86,9 @@ ScriptEvent& ScriptEvent::setScriptResourceFilename(CString fname)
 		return *this;
 	}
 
-	if(!ANKI_EXPECT(!m_env.evalString(m_scriptRsrc->getSource())))
+	ConstWeakArray<U8, PtrSize> bytecode;
+	if(!ANKI_EXPECT(!ScriptManager::getSingleton().getOrCompileBytecode(*m_scriptRsrc, bytecode))
+	   || !ANKI_EXPECT(!m_env.evalBytecode(bytecode, fname)))
 	{
 		markForDeletion();
 		return *this;
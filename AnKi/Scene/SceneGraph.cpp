@@ -5,6 +5,7 @@
 
 #include <AnKi/Scene/SceneGraph.h>
 #include <AnKi/Scene/RenderStateBucket.h>
+#include <AnKi/Scene/SceneTransformStore.h>
 #include <AnKi/Physics/PhysicsWorld.h>
 #include <AnKi/Resource/ResourceManager.h>
 #include <AnKi/Util/CVarSet.h>
@@ -46,6 +47,16 @@ namespace anki {
 ANKI_SVAR(SceneUpdateTime, StatCategory::kTime, "All scene update", StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates)
 ANKI_SVAR(SceneComponentsUpdated, StatCategory::kScene, "Scene components updated per frame", StatFlag::kZeroEveryFrame)
 ANKI_SVAR(SceneNodesUpdated, StatCategory::kScene, "Scene nodes updated per frame", StatFlag::kZeroEveryFrame)
+ANKI_SVAR(SceneFrameMemory, StatCategory::kCpuMem, "Scene frame mem: all threads", StatFlag::kBytes | StatFlag::kMainThreadUpdates)
+ANKI_SVAR(SceneFrameMemoryMaxPerThread, StatCategory::kCpuMem, "Scene frame mem: max of a thread", StatFlag::kBytes | StatFlag::kMainThreadUpdates)
+ANKI_SVAR(SceneFrameMemoryHighWaterMark, StatCategory::kCpuMem, "Scene frame mem: max ever used by a thread",
+		  StatFlag::kBytes | StatFlag::kMainThreadUpdates)
+ANKI_SVAR(SceneUpdateImbalance, StatCategory::kScene, "Scene update imbalance %: busiest thread vs average",
+		  StatFlag::kFloat | StatFlag::kMainThreadUpdates)
+ANKI_SVAR(SceneCpuOccluderTriangles, StatCategory::kScene, "Occluder triangles rasterized on the CPU", StatFlag::kZeroEveryFrame)
+ANKI_SVAR(ScenePhysicsWaitTime, StatCategory::kTime, "Wait for the pipelined physics",
+		  StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kZeroEveryFrame)
+ANKI_SVAR(SceneWorldTransformsUpdated, StatCategory::kScene, "World transforms updated per frame", StatFlag::kZeroEveryFrame)
 
 class SceneGraph::UpdateSceneNodesCtx
 {
@@ -61,6 +72,8 @@ public:
 		Vec3 m_sceneMin = Vec3(kMaxF32);
 		Vec3 m_sceneMax = Vec3(kMinF32);
 
+		U32 m_updatedNodeCount = 0;
+
 		Bool m_multipleDirLights : 1 = false;
 		Bool m_multipleSkyboxes : 1 = false;
 
@@ -80,6 +93,12 @@ public:
 
 	Bool m_forceUpdateSceneBounds = false;
 
+	// The update happens in 2 passes. The 1st updates the components that move the nodes (scripts, physics etc) and the 2nd the rest. The world
+	// transforms are computed in between
+	Bool m_transformsUpdated = false;
+
+	Bool m_componentsUpdatedByType = false; // The components of the 2nd pass got updated by updateComponentsByType()
+
 	UpdateSceneNodesCtx(U32 threadCount)
 		: m_perThread(&SceneGraph::getSingleton().m_framePool)
 	{
@@ -93,6 +112,12 @@ SceneGraph::SceneGraph()
 
 SceneGraph::~SceneGraph()
 {
+	waitPhysicsUpdate();
+	if(m_physicsThread)
+	{
+		deleteInstance(SceneMemoryPool::getSingleton(), m_physicsThread);
+	}
+
 	EventManager::freeSingleton();
 
 	for(SceneNode* node : m_deferredOps.m_nodesForRegistration)
@@ -111,6 +136,7 @@ SceneGraph::~SceneGraph()
 #define ANKI_CAT_TYPE(arrayName, gpuSceneType, id, cvarName) GpuSceneArrays::arrayName::freeSingleton();
 #include <AnKi/Scene/GpuSceneArrays.def.h>
 
+	SceneTransformStore::freeSingleton();
 	RenderStateBucketContainer::freeSingleton();
 }
 
@@ -120,6 +146,14 @@ Error SceneGraph::init(AllocAlignedCallback allocCallback, void* allocCallbackDa
 
 	m_framePool.init(allocCallback, allocCallbackData, 1_MB, 2.0, 0, true, "SceneGraphFramePool");
 
+	SceneTransformStore::allocateSingleton();
+
+	m_threadFramePools.resize(CoreThreadJobManager::getSingleton().getThreadCount());
+	for(ThreadFramePool& threadPool : m_threadFramePools)
+	{
+		threadPool.m_pool.init(allocCallback, allocCallbackData, 256_KB, 2.0, 0, true, "SceneGraphThreadFramePool");
+	}
+
 	EventManager::allocateSingleton();
 	EventManager::getSingleton().init();
 
@@ -212,6 +246,54 @@ SceneNode* SceneGraph::tryFindSceneNode(const CString& name)
 	return nullptr;
 }
 
+void SceneGraph::rasterizeCpuOccluders()
+{
+	m_cpuOcclusionBufferReady = false;
+	if(!g_cvarSceneCpuOcclusionCulling)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(SceneCpuOcclusion);
+
+	const CameraComponent& camc = m_mainCamNode->getFirstComponentOfType<CameraComponent>();
+	const Frustum& frustum = camc.getFrustum();
+	if(m_frame == 0 || frustum.getFrustumType() != FrustumType::kPerspective)
+	{
+		// The camera hasn't been updated yet
+		return;
+	}
+
+	const Mat4& proj = frustum.getProjectionMatrix();
+	const U32 width = g_cvarSceneCpuOcclusionBufferWidth;
+	const U32 height = max(1u, U32(F32(width) * proj(1, 1) / proj(0, 0)));
+	m_occlusionRasterizer.prepare(Mat4(frustum.getViewMatrix(), Vec4(0.0f, 0.0f, 0.0f, 1.0f)), proj, width, height);
+
+	// The sphere is drawn as a box that fits inside the sphere geometry no matter the subdivision
+	constexpr F32 kSphereInnerBoxScale = 0.45f;
+
+	for(MeshComponent& meshc : m_MeshArray)
+	{
+		if(!meshc.isOccluder() || !meshc.isValid() || meshc.getMeshComponentType() != MeshComponentType::kPrimitive || meshc.getTimestamp() == 0)
+		{
+			continue;
+		}
+
+		Transform trf = meshc.getOccluderWorldTransform();
+		if(meshc.getMeshComponentPrimitiveType() == MeshComponentPrimitiveType::kSphere)
+		{
+			trf.setScale(trf.getScale() * kSphereInnerBoxScale);
+		}
+
+		m_occlusionRasterizer.drawBox(Mat3x4(trf));
+	}
+
+	m_occlusionRasterizer.rasterize(&CoreThreadJobManager::getSingleton());
+	m_cpuOcclusionBufferReady = true;
+
+	g_svarSceneCpuOccluderTriangles.increment(m_occlusionRasterizer.getTriangleCount());
+}
+
 void SceneGraph::update(Second prevUpdateTime, Second crntTime)
 {
 	ANKI_ASSERT(m_mainCamNode);
@@ -219,18 +301,30 @@ void SceneGraph::update(Second prevUpdateTime, Second crntTime)
 
 	const Second startUpdateTime = HighRezTimer::getCurrentTime();
 
-	// Reset the framepool
+	// Reset the framepools
 	m_framePool.reset();
+	for(ThreadFramePool& threadPool : m_threadFramePools)
+	{
+		threadPool.m_pool.reset();
+	}
 
 	// Deferred ops at the beginning
 	doDeferredOperations();
 
-	// Update physics
-	if(!m_paused) [[likely]]
+	// Update physics. It might have been simulated already while the previous frame was rendering
+	waitPhysicsUpdate();
+	if(m_physicsUpdatedAhead)
+	{
+		m_physicsUpdatedAhead = false;
+	}
+	else if(!m_paused) [[likely]]
 	{
 		PhysicsWorld::getSingleton().update(crntTime - prevUpdateTime);
 	}
 
+	// Rasterize the occluders before the components update. The transforms are of the previous frame
+	rasterizeCpuOccluders();
+
 #if ANKI_ASSERTIONS_ENABLED
 	m_inUpdate = true;
 #endif
@@ -248,26 +342,76 @@ void SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		}
 
 		ANKI_TRACE_SCOPED_EVENT(SceneNodesUpdate);
-		updateCtx.m_crntNodeIndex.setNonAtomically((m_updatableNodes.isEmpty()) ? 0 : m_updatableNodes.getFront().getArrayIndex());
-		updateCtx.m_lastNodeIndex = (m_updatableNodes.isEmpty()) ? 0 : m_updatableNodes.getBack().getArrayIndex();
 		updateCtx.m_prevUpdateTime = prevUpdateTime;
 		updateCtx.m_crntTime = crntTime;
 		updateCtx.m_forceUpdateSceneBounds = (m_frame % kForceSetSceneBoundsFrameCount) == 0;
 
-		for(U32 i = 0; i < CoreThreadJobManager::getSingleton().getThreadCount(); i++)
+		// Update the components that might move the nodes
+		updateNodesPass(updateCtx);
+
+		// Compute the world transforms one hierarchy level at a time
 		{
-			CoreThreadJobManager::getSingleton().dispatchTask([this, &updateCtx](U32 tid) {
-				updateNodes(tid, updateCtx);
-			});
+			ANKI_TRACE_SCOPED_EVENT(SceneTransformsUpdate);
+			SceneTransformStore& transforms = SceneTransformStore::getSingleton();
+			if(transforms.isHierarchyDirty())
+			{
+				rebuildTransformStore();
+			}
+
+			transforms.updateWorldTransforms(&CoreThreadJobManager::getSingleton());
+			g_svarSceneWorldTransformsUpdated.increment(transforms.getUpdatedSlotCount());
+		}
+
+		// Update the rest of the components
+		updateCtx.m_transformsUpdated = true;
+		if(g_cvarSceneTypeBatchedComponentUpdate)
+		{
+			updateComponentsByType(updateCtx);
+			updateCtx.m_componentsUpdatedByType = true;
 		}
 
-		CoreThreadJobManager::getSingleton().waitForAllTasksToFinish();
+		// Finish the nodes
+		updateNodesPass(updateCtx);
 	}
 
 #if ANKI_ASSERTIONS_ENABLED
 	m_inUpdate = false;
 #endif
 
+	// Thread imbalance. Count the nodes every thread updated and compare the busiest thread with the average
+	{
+		U32 nodeCount = 0;
+		U32 maxNodeCount = 0;
+		for(const UpdateSceneNodesCtx::PerThread& thread : updateCtx.m_perThread)
+		{
+			nodeCount += thread.m_updatedNodeCount;
+			maxNodeCount = max(maxNodeCount, thread.m_updatedNodeCount);
+		}
+
+		const F64 avgNodeCount = F64(nodeCount) / F64(updateCtx.m_perThread.getSize());
+		g_svarSceneUpdateImbalance.set((nodeCount) ? (F64(maxNodeCount) / avgNodeCount - 1.0) * 100.0 : 0.0);
+	}
+
+	// Frame memory stats
+	{
+		PtrSize allThreads = 0;
+		PtrSize maxOfThread = 0;
+		PtrSize highWaterMark = 0;
+		for(ThreadFramePool& threadPool : m_threadFramePools)
+		{
+			const PtrSize allocated = threadPool.m_pool.getAllocatedSize();
+			threadPool.m_highWaterMark = max(threadPool.m_highWaterMark, allocated);
+
+			allThreads += allocated;
+			maxOfThread = max(maxOfThread, allocated);
+			highWaterMark = max(highWaterMark, threadPool.m_highWaterMark);
+		}
+
+		g_svarSceneFrameMemory.set(allThreads);
+		g_svarSceneFrameMemoryMaxPerThread.set(maxOfThread);
+		g_svarSceneFrameMemoryHighWaterMark.set(highWaterMark);
+	}
+
 	// Update scene bounds
 	{
 		Vec3 sceneMin = Vec3(kMaxF32);
@@ -355,6 +499,12 @@ void SceneGraph::update(Second prevUpdateTime, Second crntTime)
 	{
 		const auto& thread = updateCtx.m_perThread[tid];
 
+		if(thread.m_nodesForDeletion.getSize())
+		{
+			// The deleted nodes have slots that point to them
+			SceneTransformStore::getSingleton().markHierarchyDirty();
+		}
+
 		// First detach the deleted nodes from their parents. Do it before deleting anything because a parent might be deleted before its
 		// child and removeParent() would touch freed memory. Iterating the flat list (not m_children) makes this safe
 		for(SceneNode* node : thread.m_nodesForDeletion)
@@ -433,9 +583,16 @@ void SceneGraph::updateNode(U32 tid, SceneNode& node, UpdateSceneNodesCtx& ctx)
 	ANKI_TRACE_INC_COUNTER(SceneNodeVisited, 1);
 
 	UpdateSceneNodesCtx::PerThread& thread = ctx.m_perThread[tid];
+	++thread.m_updatedNodeCount;
 
 	if(node.isMarkedForDeletion()) [[unlikely]]
 	{
+		if(!ctx.m_transformsUpdated)
+		{
+			// Will be gathered in the 2nd pass
+			return;
+		}
+
 		thread.m_nodesForDeletion.emplaceBack(&node);
 
 		node.visitAllChildren([&](SceneNode& child) {
@@ -454,17 +611,32 @@ void SceneGraph::updateNode(U32 tid, SceneNode& node, UpdateSceneNodesCtx& ctx)
 #endif
 												 ,
 												 m_paused);
-	componentUpdateInfo.m_framePool = &m_framePool;
+	componentUpdateInfo.m_framePool = &m_threadFramePools[tid].m_pool;
 	U32 sceneComponentUpdatedCount = 0;
+	const F32 moveComponentWeight = SceneComponent::getUpdateOrderWeight(SceneComponentType::kMove);
 	node.iterateComponents([&](SceneComponent& comp) {
-		componentUpdateInfo.m_node = &node;
-		Bool updated = false;
-		comp.update(componentUpdateInfo, updated);
+		// The components are sorted by their weight. The ones before the MoveComponent are updated in the 1st pass
+		const Bool firstPassComponent = SceneComponent::getUpdateOrderWeight(comp.getType()) < moveComponentWeight;
+		if(firstPassComponent == ctx.m_transformsUpdated)
+		{
+			return (ctx.m_transformsUpdated) ? FunctorContinue::kContinue : FunctorContinue::kStop;
+		}
+
+		if(!ctx.m_componentsUpdatedByType)
+		{
+			componentUpdateInfo.m_node = &node;
+			Bool updated = false;
+			comp.update(componentUpdateInfo, updated);
 
-		if(updated)
+			if(updated)
+			{
+				ANKI_TRACE_INC_COUNTER(SceneComponentUpdate, 1);
+				comp.setTimestamp(GlobalFrameIndex::getSingleton().m_value);
+			}
+		}
+
+		if(comp.updatedThisFrame())
 		{
-			ANKI_TRACE_INC_COUNTER(SceneComponentUpdate, 1);
-			comp.setTimestamp(GlobalFrameIndex::getSingleton().m_value);
 			++sceneComponentUpdatedCount;
 		}
 
@@ -511,18 +683,24 @@ void SceneGraph::updateNode(U32 tid, SceneNode& node, UpdateSceneNodesCtx& ctx)
 
 	// Node update
 	{
+		const Timestamp crntTimestamp = GlobalFrameIndex::getSingleton().m_value;
 		if(sceneComponentUpdatedCount)
 		{
-			node.setComponentMaxTimestamp(GlobalFrameIndex::getSingleton().m_value);
+			node.setComponentMaxTimestamp(crntTimestamp);
 			g_svarSceneComponentsUpdated.increment(sceneComponentUpdatedCount);
-			g_svarSceneNodesUpdated.increment(1);
 		}
 		else
 		{
 			// No components or nothing updated, don't change the timestamp
 		}
 
-		if(!m_paused || node.getUpdateOnPause()) [[likely]]
+		// Count the node once even if it had updates in both passes
+		if(ctx.m_transformsUpdated && node.getComponentMaxTimestamp() == crntTimestamp)
+		{
+			g_svarSceneNodesUpdated.increment(1);
+		}
+
+		if(ctx.m_transformsUpdated && (!m_paused || node.getUpdateOnPause())) [[likely]]
 		{
 			ANKI_TRACE_INC_COUNTER(SceneNodeUpdated, 1);
 			SceneNodeUpdateInfo info(ctx.m_prevUpdateTime, ctx.m_crntTime, m_paused);
@@ -530,14 +708,271 @@ void SceneGraph::updateNode(U32 tid, SceneNode& node, UpdateSceneNodesCtx& ctx)
 		}
 	}
 
-	// Update children
-	node.visitChildrenMaxDepth(0, [&](SceneNode& child) {
-		updateNode(tid, child, ctx);
-		return FunctorContinue::kContinue;
-	});
+	// Update children. The node is done so its children can be updated by other threads. Group the children into tasks that have enough work
+	// and let the idle threads steal them. The last group is updated by this thread.
+	// Work on a copy of the children because scripts can reparent nodes while the children are updated and that reallocates the array
+	const WeakArray<SceneNode*> nodeChildren = node.getChildren();
+	WeakArray<SceneNode*> children;
+	if(nodeChildren.getSize())
+	{
+		children = {newArray<SceneNode*>(m_threadFramePools[tid].m_pool, nodeChildren.getSize()), nodeChildren.getSize()};
+		memcpy(children.getBegin(), nodeChildren.getBegin(), nodeChildren.getSizeInBytes());
+	}
+
+	U32 groupBegin = 0;
+	U32 groupWeight = 0;
+	for(U32 i = 0; i < children.getSize(); ++i)
+	{
+		// Guess the work of a child's subtree using the children of the child
+		groupWeight += 1 + children[i]->getChildrenCount();
+
+		const Bool lastChild = i == children.getSize() - 1;
+		if(groupWeight >= kSubtreeTaskMinWeight && !lastChild)
+		{
+			const WeakArray<SceneNode*> group(&children[groupBegin], i - groupBegin + 1);
+			CoreThreadJobManager::getSingleton().dispatchTask([this, group, &ctx](U32 tid) {
+				ANKI_TRACE_SCOPED_EVENT(SceneNodeUpdate);
+				for(SceneNode* child : group)
+				{
+					updateNode(tid, *child, ctx);
+				}
+			});
+
+			groupBegin = i + 1;
+			groupWeight = 0;
+		}
+	}
+
+	for(U32 i = groupBegin; i < children.getSize(); ++i)
+	{
+		updateNode(tid, *children[i], ctx);
+	}
+
+	thread.m_sceneMin = thread.m_sceneMin.min(componentUpdateInfo.m_sceneMin);
+	thread.m_sceneMax = thread.m_sceneMax.max(componentUpdateInfo.m_sceneMax);
+}
+
+void SceneGraph::updateNodesPass(UpdateSceneNodesCtx& ctx)
+{
+	ctx.m_crntNodeIndex.setNonAtomically((m_updatableNodes.isEmpty()) ? 0 : m_updatableNodes.getFront().getArrayIndex());
+	ctx.m_lastNodeIndex = (m_updatableNodes.isEmpty()) ? 0 : m_updatableNodes.getBack().getArrayIndex();
+
+	for(U32 i = 0; i < CoreThreadJobManager::getSingleton().getThreadCount(); i++)
+	{
+		CoreThreadJobManager::getSingleton().dispatchTask([this, &ctx](U32 tid) {
+			updateNodes(tid, ctx);
+		});
+	}
+
+	CoreThreadJobManager::getSingleton().waitForAllTasksToFinish();
+}
+
+void SceneGraph::rebuildTransformStore()
+{
+	ANKI_TRACE_FUNCTION();
+
+	U32 nodeCount = 0;
+	for(const Scene& scene : m_scenes)
+	{
+		nodeCount += scene.m_nodes.getSize();
+	}
+
+	SceneTransformStore& transforms = SceneTransformStore::getSingleton();
+	transforms.beginRebuild(nodeCount);
+
+	// Breadth-first walk so the slots end up sorted by depth
+	DynamicArray<SceneNode*, MemoryPoolPtrWrapper<StackMemoryPool>> queue(&m_framePool);
+	queue.resizeStorage(nodeCount);
+	for(SceneNode* node : m_updatableNodes)
+	{
+		queue.emplaceBack(node);
+	}
+
+	U32 levelBegin = 0;
+	U32 depth = 0;
+	while(levelBegin < queue.getSize())
+	{
+		const U32 levelEnd = queue.getSize();
+		for(U32 i = levelBegin; i < levelEnd; ++i)
+		{
+			SceneNode& node = *queue[i];
+
+			// The parent is in the previous level so it already has its new slot
+			const SceneNode* parent = node.getParent();
+			const U32 parentSlot = (parent && !node.m_ignoreParentNodeTransform) ? parent->m_transformSlot : SceneTransformStore::kInvalidSlot;
+
+			node.m_transformSlot = transforms.addSlot(&node.m_ltrf, parentSlot, depth, node.m_transformSlot, node.m_localTransformDirty);
+			node.m_localTransformDirty = false;
+
+			for(SceneNode* child : node.getChildren())
+			{
+				queue.emplaceBack(child);
+			}
+		}
+
+		levelBegin = levelEnd;
+		++depth;
+	}
 
-	ctx.m_perThread[tid].m_sceneMin = ctx.m_perThread[tid].m_sceneMin.min(componentUpdateInfo.m_sceneMin);
-	ctx.m_perThread[tid].m_sceneMax = ctx.m_perThread[tid].m_sceneMax.max(componentUpdateInfo.m_sceneMax);
+	transforms.endRebuild();
+}
+
+// The type passes run in the order of SceneComponentClasses.def.h so it needs to be sorted by weight
+static constexpr Bool componentClassesSortedByWeight()
+{
+	Bool sorted = true;
+	F32 prevWeight = 0.0f;
+#define ANKI_DEFINE_SCENE_COMPONENT(name, weight, sceneNodeCanHaveMany, icon, serializable, canBeDeleted) \
+	sorted = sorted && weight >= prevWeight; \
+	prevWeight = weight;
+#include <AnKi/Scene/Components/SceneComponentClasses.def.h>
+	return sorted;
+}
+
+static_assert(componentClassesSortedByWeight(), "SceneComponentClasses.def.h should be sorted by weight");
+
+void SceneGraph::updateComponentsByType(UpdateSceneNodesCtx& ctx)
+{
+	ANKI_TRACE_FUNCTION();
+
+	// Gather the nodes that the per-node walk visits. The subtrees of the nodes that will be deleted are skipped, same as updateNode()
+	U32 nodeCount = 0;
+	for(const Scene& scene : m_scenes)
+	{
+		nodeCount += scene.m_nodes.getSize();
+	}
+
+	DynamicArray<SceneNode*, MemoryPoolPtrWrapper<StackMemoryPool>> nodes(&m_framePool);
+	nodes.resizeStorage(nodeCount);
+	for(SceneNode* node : m_updatableNodes)
+	{
+		if(!node->isMarkedForDeletion())
+		{
+			nodes.emplaceBack(node);
+		}
+	}
+
+	for(U32 i = 0; i < nodes.getSize(); ++i)
+	{
+		for(SceneNode* child : nodes[i]->getChildren())
+		{
+			if(!child->isMarkedForDeletion())
+			{
+				nodes.emplaceBack(child);
+			}
+		}
+	}
+
+	// Bucket the nodes by the types of their 2nd pass components. A node goes once to a bucket even if it has many components of that type
+	const F32 moveComponentWeight = SceneComponent::getUpdateOrderWeight(SceneComponentType::kMove);
+	auto iterateSecondPassTypes = [&](SceneNode& node, auto func) {
+		SceneComponentTypeMask visitedTypes = SceneComponentTypeMask::kNone;
+		node.iterateComponents([&](SceneComponent& comp) {
+			const SceneComponentTypeMask typeBit = SceneComponentTypeMask(1u << U32(comp.getType()));
+			if(SceneComponent::getUpdateOrderWeight(comp.getType()) >= moveComponentWeight && !(visitedTypes & typeBit))
+			{
+				visitedTypes |= typeBit;
+				func(comp.getType());
+			}
+			return FunctorContinue::kContinue;
+		});
+	};
+
+	Array<U32, U32(SceneComponentType::kCount)> bucketOffsets = {};
+	Array<U32, U32(SceneComponentType::kCount)> bucketSizes = {};
+	for(SceneNode* node : nodes)
+	{
+		iterateSecondPassTypes(*node, [&](SceneComponentType type) {
+			++bucketSizes[type];
+		});
+	}
+
+	U32 bucketedNodeCount = 0;
+	for(SceneComponentType type : EnumIterable<SceneComponentType>())
+	{
+		bucketOffsets[type] = bucketedNodeCount;
+		bucketedNodeCount += bucketSizes[type];
+		bucketSizes[type] = 0;
+	}
+
+	WeakArray<SceneNode*> bucketedNodes(newArray<SceneNode*>(m_framePool, bucketedNodeCount), bucketedNodeCount);
+	for(SceneNode* node : nodes)
+	{
+		iterateSecondPassTypes(*node, [&](SceneComponentType type) {
+			bucketedNodes[bucketOffsets[type] + bucketSizes[type]++] = node;
+		});
+	}
+
+	// Update the types in the order of their weights
+#define ANKI_DEFINE_SCENE_COMPONENT(name, weight, sceneNodeCanHaveMany, icon, serializable, canBeDeleted) \
+	if(bucketSizes[SceneComponentType::k##name]) \
+	{ \
+		ANKI_TRACE_SCOPED_EVENT(name##ComponentsUpdate); \
+		updateComponentsOfType<name##Component>( \
+			ConstWeakArray<SceneNode*>(&bucketedNodes[bucketOffsets[SceneComponentType::k##name]], bucketSizes[SceneComponentType::k##name]), ctx); \
+	}
+#include <AnKi/Scene/Components/SceneComponentClasses.def.h>
+}
+
+template<typename TComponent>
+void SceneGraph::updateComponentsOfType(ConstWeakArray<SceneNode*> nodes, UpdateSceneNodesCtx& ctx)
+{
+	Atomic<U32> crntIndex = {0};
+
+	auto updateBatches = [&](U32 tid) {
+		SceneComponentUpdateInfo componentUpdateInfo(ctx.m_prevUpdateTime, ctx.m_crntTime, ctx.m_forceUpdateSceneBounds
+#if ANKI_WITH_EDITOR
+													 ,
+													 m_checkForResourceUpdates
+#endif
+													 ,
+													 m_paused);
+		componentUpdateInfo.m_framePool = &m_threadFramePools[tid].m_pool;
+
+		while(true)
+		{
+			const U32 batchBegin = crntIndex.fetchAdd(kNodeBatchSize);
+			if(batchBegin >= nodes.getSize())
+			{
+				break;
+			}
+
+			// All the components of a type that belong to a node are updated by the same thread and in the order of the node
+			const U32 batchEnd = min(batchBegin + kNodeBatchSize, nodes.getSize());
+			for(U32 i = batchBegin; i < batchEnd; ++i)
+			{
+				SceneNode& node = *nodes[i];
+				componentUpdateInfo.m_node = &node;
+				node.iterateComponentsOfType<TComponent>([&](TComponent& typedComp) {
+					// Still a virtual call but all the calls of the pass go to the same function
+					SceneComponent& comp = typedComp;
+					Bool updated = false;
+					comp.update(componentUpdateInfo, updated);
+
+					if(updated)
+					{
+						ANKI_TRACE_INC_COUNTER(SceneComponentUpdate, 1);
+						comp.setTimestamp(GlobalFrameIndex::getSingleton().m_value);
+					}
+
+					return FunctorContinue::kContinue;
+				});
+			}
+		}
+
+		UpdateSceneNodesCtx::PerThread& thread = ctx.m_perThread[tid];
+		thread.m_sceneMin = thread.m_sceneMin.min(componentUpdateInfo.m_sceneMin);
+		thread.m_sceneMax = thread.m_sceneMax.max(componentUpdateInfo.m_sceneMax);
+	};
+
+	const U32 batchCount = (nodes.getSize() + kNodeBatchSize - 1) / kNodeBatchSize;
+	const U32 taskCount = min(batchCount, CoreThreadJobManager::getSingleton().getThreadCount());
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		CoreThreadJobManager::getSingleton().dispatchTask(updateBatches);
+	}
+
+	CoreThreadJobManager::getSingleton().waitForAllTasksToFinish();
 }
 
 void SceneGraph::updateNodes(U32 tid, UpdateSceneNodesCtx& ctx)
@@ -575,6 +1010,44 @@ void SceneGraph::updateNodes(U32 tid, UpdateSceneNodesCtx& ctx)
 	}
 }
 
+void SceneGraph::startPhysicsUpdate(Second dt)
+{
+	forbidCallOnUpdate();
+	ANKI_ASSERT(!m_physicsUpdateInFlight && !m_physicsUpdatedAhead && "Already started");
+
+	if(m_paused)
+	{
+		return;
+	}
+
+	if(m_physicsThread == nullptr)
+	{
+		m_physicsThread = newInstance<ThreadJobManager>(SceneMemoryPool::getSingleton(), 1u);
+	}
+
+	m_physicsUpdateInFlight = true;
+	m_physicsThread->dispatchTask([dt]([[maybe_unused]] U32 tid) {
+		ANKI_TRACE_SCOPED_EVENT(PipelinedPhysics);
+		PhysicsWorld::getSingleton().update(dt);
+	});
+}
+
+void SceneGraph::waitPhysicsUpdate()
+{
+	if(!m_physicsUpdateInFlight)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(PipelinedPhysicsWait);
+	const Second begin = HighRezTimer::getCurrentTime();
+	m_physicsThread->waitForAllTasksToFinish();
+	g_svarScenePhysicsWaitTime.increment((HighRezTimer::getCurrentTime() - begin) * 1000.0);
+
+	m_physicsUpdateInFlight = false;
+	m_physicsUpdatedAhead = true;
+}
+
 const SceneNode& SceneGraph::getActiveCameraNode() const
 {
 	forbidCallOnUpdate();
@@ -602,59 +1075,65 @@ void SceneGraph::setActiveCameraNode(SceneNode* cam)
 	}
 }
 
-void SceneGraph::countSerializableNodes(SceneNode& root, U32& serializableNodeCount)
+static constexpr CString kTextSceneMagic = "ANKISCEN";
+static constexpr CString kBinarySceneMagic = "ANKISCEB";
+static constexpr CString kBinarySceneExtension = "ankiscenebin";
+
+void SceneGraph::gatherSerializableNodes(SceneNode& root, SceneDynamicArray<SceneNode*>& nodes)
 {
 	if(root.getSerialization())
 	{
-		++serializableNodeCount;
+		nodes.emplaceBack(&root);
 
 		root.visitChildrenMaxDepth(0, [&](SceneNode& child) {
-			countSerializableNodes(child, serializableNodeCount);
+			gatherSerializableNodes(child, nodes);
 			return FunctorContinue::kContinue;
 		});
 	}
 }
 
-void SceneGraph::serializeSerializableNodes(SceneSerializer& serializer, SceneNode& root, SceneNode::SerializeCommonArgs& args,
-											U32& serializedNodeCount, Error& err)
+Error SceneGraph::serializeNode(SceneSerializer& serializer, SceneNode& node, SceneNode::SerializeCommonArgs& args)
 {
-	auto serializeNode = [&](SceneNode& node) -> Error {
-		SceneString className = (node.getSceneNodeRegistryRecord()) ? node.getSceneNodeRegistryRecord()->m_name : "SceneNode";
-		ANKI_SERIALIZE(className, 1);
+	SceneString className = (node.getSceneNodeRegistryRecord()) ? node.getSceneNodeRegistryRecord()->m_name : "SceneNode";
+	ANKI_SERIALIZE(className, 1);
 
-		SceneString name = (node.getName() != "Unnamed") ? node.getName() : "";
-		ANKI_SERIALIZE(name, 1);
+	SceneString name = (node.getName() != "Unnamed") ? node.getName() : "";
+	ANKI_SERIALIZE(name, 1);
 
-		U32 uuid = node.getNodeUuid();
-		ANKI_SERIALIZE(uuid, 1);
+	U32 uuid = node.getNodeUuid();
+	ANKI_SERIALIZE(uuid, 1);
 
-		ANKI_CHECK(node.serializeCommon(serializer, args));
-		ANKI_CHECK(node.serialize(serializer));
-
-		++serializedNodeCount;
-
-		return Error::kNone;
-	};
+	ANKI_CHECK(node.serializeCommon(serializer, args));
+	ANKI_CHECK(node.serialize(serializer));
 
-	if(!err && root.getSerialization())
-	{
-		err = serializeNode(root);
+	return Error::kNone;
+}
 
-		if(!err)
-		{
-			root.visitChildrenMaxDepth(0, [&](SceneNode& child) {
-				serializeSerializableNodes(serializer, child, args, serializedNodeCount, err);
-				return (!err) ? FunctorContinue::kContinue : FunctorContinue::kStop;
-			});
-		}
+void SceneGraph::gatherSerializableComponents(const SceneNode::SerializeCommonArgs& args, SerializableComponentArrays& components)
+{
+	// The component arrays are global to the SceneGraph. The mask tells which components belong to a node of this scene that got serialized
+#define ANKI_DEFINE_SCENE_COMPONENT(name, weight, sceneNodeCanHaveMany, icon, serializable, canBeDeleted) \
+	if(serializable) \
+	{ \
+		for(SceneComponent & comp : getComponentArray<name##Component>()) \
+		{ \
+			if(args.m_write.m_serializableComponentMask[comp.getType()].getBit(comp.getArrayIndex())) \
+			{ \
+				ANKI_ASSERT(comp.getSerialization()); \
+				components[comp.getType()].emplaceBack(&comp); \
+			} \
+		} \
+		ANKI_ASSERT(components[SceneComponentType::k##name].getSize() == args.m_write.m_componentsToBeSerializedCount[SceneComponentType::k##name]); \
 	}
+#include <AnKi/Scene/Components/SceneComponentClasses.def.h>
 }
 
 Error SceneGraph::saveScene(CString filename, Scene& scene)
 {
 	// How it works:
+	// - Gathers the serializable nodes. Parents go before their children
 	// - Writes a header
-	// - Counts the serializable nodes and saves the count. Count needs to be first
+	// - Saves the count of the serializable nodes. Count needs to be first
 	// - For every node that is serializable
 	//   - Serialize common stuff
 	//   - Iterate its components to save their UUIDs but also count per component type (used in [componentCounts])
@@ -662,6 +1141,7 @@ Error SceneGraph::saveScene(CString filename, Scene& scene)
 	// - For every type of component
 	//   - [componentCounts] Save the total count of serializable components
 	//   - For every serializable component call SceneComponent::serialize()
+	// The binary format stores the same things but every node and every component goes to its own record. See saveSceneBinary()
 
 	ANKI_TRACE_FUNCTION();
 	forbidCallOnUpdate();
@@ -676,109 +1156,159 @@ Error SceneGraph::saveScene(CString filename, Scene& scene)
 
 	ANKI_LOGI("Saving scene: %s", filename.cstr());
 
-	File file;
-	ANKI_CHECK(file.open(filename, FileOpenFlag::kWrite));
-
-	TextSceneSerializer serializer(&file);
-
-	// Header
-	SceneString magic = "ANKISCEN";
-	ANKI_SERIALIZE(magic, 1);
-	U32 version = kSceneBinaryVersion;
-	ANKI_SERIALIZE(version, 1);
-
-	// Count the serializable nodes
-	U32 serializableNodeCount = 0;
+	SceneDynamicArray<SceneNode*> nodes;
 	scene.visitNodes([&](SceneNode& node) {
 		if(node.getParent() == nullptr)
 		{
 			// Only root nodes, rest will be visited later
-			countSerializableNodes(node, serializableNodeCount);
+			gatherSerializableNodes(node, nodes);
 		}
 
 		return FunctorContinue::kContinue;
 	});
+	ANKI_ASSERT(nodes.getSize() <= scene.m_nodes.getSize());
+
+	const Bool binary = getFileExtension(filename) == kBinarySceneExtension;
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::kWrite | ((binary) ? FileOpenFlag::kBinary : FileOpenFlag::kNone)));
+
+	if(binary)
+	{
+		ANKI_CHECK(saveSceneBinary(file, nodes));
+	}
+	else
+	{
+		ANKI_CHECK(saveSceneText(file, nodes));
+	}
+
+	const F64 timeDiffMs = F64(HighRezTimer::getCurrentTimeUs() - begin) / 1000.0;
+	ANKI_SCENE_LOGI("Saving scene finished. %fms", timeDiffMs);
+
+	return Error::kNone;
+}
+
+Error SceneGraph::saveSceneText(File& file, ConstWeakArray<SceneNode*> nodes)
+{
+	TextSceneSerializer serializer(&file);
+
+	// Header
+	SceneString magic = kTextSceneMagic;
+	ANKI_SERIALIZE(magic, 1);
+	U32 version = kSceneBinaryVersion;
+	ANKI_SERIALIZE(version, 1);
 
 	// Scene nodes
 	SceneNode::SerializeCommonArgs serializationArgs;
-	ANKI_ASSERT(serializableNodeCount <= scene.m_nodes.getSize());
-	U32 nodeCount = serializableNodeCount;
+	U32 nodeCount = nodes.getSize();
 	ANKI_SERIALIZE(nodeCount, 1);
 
-	Error err = Error::kNone;
-	U32 serializedNodeCount = 0;
-	scene.visitNodes([&](SceneNode& node) {
-		if(!err && node.getParent() == nullptr)
-		{
-			// Only root nodes, rest will be visited later
-			serializeSerializableNodes(serializer, node, serializationArgs, serializedNodeCount, err);
-		}
+	for(SceneNode* node : nodes)
+	{
+		ANKI_CHECK(serializeNode(serializer, *node, serializationArgs));
+	}
 
-		return (!err) ? FunctorContinue::kContinue : FunctorContinue::kStop;
-	});
+	// Components
+	SerializableComponentArrays components;
+	gatherSerializableComponents(serializationArgs, components);
 
-	if(err)
-	{
-		return err;
+#define ANKI_DEFINE_SCENE_COMPONENT(name, weight, sceneNodeCanHaveMany, icon, serializable, canBeDeleted) \
+	if(serializable) \
+	{ \
+		U32 name##Count = components[SceneComponentType::k##name].getSize(); \
+		ANKI_SERIALIZE(name##Count, 1); \
+		for(SceneComponent * comp : components[SceneComponentType::k##name]) \
+		{ \
+			U32 uuid = comp->getComponentUuid(); \
+			ANKI_SERIALIZE(uuid, 1); \
+			ANKI_CHECK(comp->serialize(serializer)); \
+		} \
 	}
+#include <AnKi/Scene/Components/SceneComponentClasses.def.h>
+
+	return Error::kNone;
+}
 
-	ANKI_ASSERT(serializedNodeCount == nodeCount);
+Error SceneGraph::saveSceneBinary(File& file, ConstWeakArray<SceneNode*> nodes)
+{
+	// Layout of the file:
+	// - The table of contents. A header, the offsets of the node records and the UUIDs and offsets of the component records per component type
+	// - The records. A node record has the same things a node has in the text format. A component record has what SceneComponent::serialize()
+	//   wrote
+	// The offsets are relative to the first record and every array of offsets has one more element to mark the end of the last record
 
-	// Components
-	auto serializeComponent = [&](auto& comp) -> Error {
-		// The component arrays are global to the SceneGraph. The mask tells which components belong to a node of this scene that got serialized
-		if(!serializationArgs.m_write.m_serializableComponentMask[comp.getType()].getBit(comp.getArrayIndex()))
+	SceneDynamicArrayLarge<U8> records;
+	BinarySceneSerializer recordSerializer(&records);
+
+	SceneDynamicArrayLarge<U8> toc;
+	BinarySceneSerializer serializer(&toc);
+
+	auto getRecordOffset = [&](U32& offset) -> Error {
+		if(records.getSize() >= kMaxU32)
 		{
-			return Error::kNone;
+			ANKI_SCENE_LOGE("Scene too large for the binary format");
+			return Error::kUserData;
 		}
 
-		ANKI_ASSERT(comp.getSerialization());
+		offset = U32(records.getSize());
+		return Error::kNone;
+	};
 
-		U32 uuid = comp.getComponentUuid();
-		ANKI_SERIALIZE(uuid, 1);
+	// Header
+	SceneString magic = kBinarySceneMagic;
+	ANKI_SERIALIZE(magic, 1);
+	U32 version = kSceneBinaryVersion;
+	ANKI_SERIALIZE(version, 1);
 
-		ANKI_CHECK(comp.serialize(serializer));
+	// Scene nodes
+	SceneNode::SerializeCommonArgs serializationArgs;
+	U32 nodeCount = nodes.getSize();
+	ANKI_SERIALIZE(nodeCount, 1);
 
-		--serializationArgs.m_write.m_componentsToBeSerializedCount[comp.getType()];
+	SceneDynamicArray<U32> nodeOffsets;
+	nodeOffsets.resize(nodeCount + 1);
+	for(U32 i = 0; i < nodeCount; ++i)
+	{
+		ANKI_CHECK(getRecordOffset(nodeOffsets[i]));
+		ANKI_CHECK(serializeNode(recordSerializer, *nodes[i], serializationArgs));
+	}
+	ANKI_CHECK(getRecordOffset(nodeOffsets[nodeCount]));
+	ANKI_SERIALIZE(nodeOffsets, 1);
 
-		return Error::kNone;
-	};
+	// Components
+	SerializableComponentArrays components;
+	gatherSerializableComponents(serializationArgs, components);
 
 #define ANKI_DEFINE_SCENE_COMPONENT(name, weight, sceneNodeCanHaveMany, icon, serializable, canBeDeleted) \
 	if(serializable) \
 	{ \
-		U32 name##Count = serializationArgs.m_write.m_componentsToBeSerializedCount[SceneComponentType::k##name]; \
+		const ConstWeakArray<SceneComponent*> comps = components[SceneComponentType::k##name]; \
+		U32 name##Count = comps.getSize(); \
 		ANKI_SERIALIZE(name##Count, 1); \
-		for(SceneComponent & comp : getComponentArray<name##Component>()) \
+		SceneDynamicArray<U32> name##Uuids; \
+		name##Uuids.resize(name##Count); \
+		SceneDynamicArray<U32> name##Offsets; \
+		name##Offsets.resize(name##Count + 1); \
+		for(U32 i = 0; i < name##Count; ++i) \
 		{ \
-			ANKI_CHECK(serializeComponent(comp)); \
+			name##Uuids[i] = comps[i]->getComponentUuid(); \
+			ANKI_CHECK(getRecordOffset(name##Offsets[i])); \
+			ANKI_CHECK(comps[i]->serialize(recordSerializer)); \
 		} \
-		ANKI_ASSERT(serializationArgs.m_write.m_componentsToBeSerializedCount[SceneComponentType::k##name] == 0); \
+		ANKI_CHECK(getRecordOffset(name##Offsets[name##Count])); \
+		ANKI_SERIALIZE(name##Uuids, 1); \
+		ANKI_SERIALIZE(name##Offsets, 1); \
 	}
 #include <AnKi/Scene/Components/SceneComponentClasses.def.h>
 
-	const F64 timeDiffMs = F64(HighRezTimer::getCurrentTimeUs() - begin) / 1000.0;
-	ANKI_SCENE_LOGI("Saving scene finished. %fms", timeDiffMs);
+	ANKI_CHECK(file.write(toc.getBegin(), toc.getSizeInBytes()));
+	ANKI_CHECK(file.write(records.getBegin(), records.getSizeInBytes()));
 
 	return Error::kNone;
 }
 
 Error SceneGraph::loadScene(CString filepath, Scene*& scene)
 {
-	// How it works:
-	// - Read header and stuff
-	// - Read number of scene nodes
-	// - For every scene node
-	//   - Create node and deserialize common stuff like name. Depending on the class name use a different constructor, this is why records are for
-	//   - Deserialize the component UUIDs and just store a component UUID to node ptr mapping. Will be used later in [mapNodeToComp]
-	//   - [parentMapping] Use the node UUID mapping to find which node to set as parent
-	//   - Add a node UUID to node ptr mapping. Will be used by the nodes that follow in [parentMapping]
-	// - For every type of component
-	//   - Create the component array
-	//   - For every component
-	//     - [mapNodeToComp] Use the mapping created before to pass the proper node to the constructor
-	//     - Deserialize using SceneComponent::serialize()
-
 	ANKI_ASSERT(scene == nullptr);
 
 	ANKI_TRACE_FUNCTION();
@@ -798,7 +1328,9 @@ Error SceneGraph::loadScene(CString filepath, Scene*& scene)
 
 		ScriptResourcePtr script;
 		ANKI_CHECK(ResourceManager::getSingleton().loadResource(filepath, script));
-		ANKI_CHECK(ScriptManager::getSingleton().evalString(script->getSource()));
+		ConstWeakArray<U8, PtrSize> bytecode;
+		ANKI_CHECK(ScriptManager::getSingleton().getOrCompileBytecode(*script, bytecode));
+		ANKI_CHECK(ScriptManager::getSingleton().evalBytecode(bytecode, script->getFilename()));
 
 		scene->m_filepath = filepath;
 
@@ -811,12 +1343,24 @@ Error SceneGraph::loadScene(CString filepath, Scene*& scene)
 	ResourceFilePtr file;
 	ANKI_CHECK(ResourceFilesystem::getSingleton().openFile(filepath, file));
 
-	TextSceneSerializer serializer(file.get());
+	if(extension == kBinarySceneExtension)
+	{
+		ANKI_CHECK(loadSceneBinary(*file, filepath, scene));
+	}
+	else
+	{
+		ANKI_CHECK(loadSceneText(*file, filepath, scene));
+	}
 
-	// Header
+	ANKI_SCENE_LOGI("Loading scene finished. %fms", F64(HighRezTimer::getCurrentTimeUs() - begin) / 1000.0);
+	return Error::kNone;
+}
+
+Error SceneGraph::loadSceneHeader(SceneSerializer& serializer, CString expectedMagic, CString filepath, Scene*& scene)
+{
 	SceneString magic;
 	ANKI_SERIALIZE(magic, 1);
-	if(magic != "ANKISCEN")
+	if(magic != expectedMagic)
 	{
 		ANKI_LOGE("Wrong magic value");
 		return Error::kUserData;
@@ -835,6 +1379,107 @@ Error SceneGraph::loadScene(CString filepath, Scene*& scene)
 	scene->m_filepath = filepath;
 	scene->m_canBeSaved = true;
 
+	return Error::kNone;
+}
+
+Error SceneGraph::deserializeNode(SceneSerializer& serializer, Scene& scene, SceneNode::SerializeCommonArgs& args, U32& maxNodesUuid)
+{
+	SceneString className;
+	ANKI_SERIALIZE(className, 1);
+
+	SceneNodeInitInfo initInf;
+
+	SceneString name;
+	ANKI_SERIALIZE(name, 1);
+	initInf.m_name = name;
+
+	U32 uuid;
+	ANKI_SERIALIZE(uuid, 1);
+	initInf.m_nodeUuid = uuid;
+	initInf.m_sceneUuid = scene.m_sceneUuid;
+	initInf.m_sceneIndex = scene.m_arrayIndex;
+
+	maxNodesUuid = max(maxNodesUuid, uuid);
+
+	SceneNode* node;
+	if(className != "SceneNode")
+	{
+		// Derived SceneNode class
+		GlobalRegistryRecord* rec = GlobalRegistry::getSingleton().tryFindRecord(className);
+		if(!rec || rec->m_type != GlobalRegistryRecordType::kSceneNode)
+		{
+			ANKI_SCENE_LOGE("Can't load scene. Failed to find record for class: %s", className.cstr());
+			return Error::kUserData;
+		}
+
+		const SceneNodeRegistryRecord& record = *static_cast<SceneNodeRegistryRecord*>(rec);
+
+		void* mem = SceneMemoryPool::getSingleton().allocate(record.m_getClassSizeCallback(), ANKI_SAFE_ALIGNMENT);
+		record.m_constructCallback(mem, initInf);
+
+		node = static_cast<SceneNode*>(mem);
+	}
+	else
+	{
+		node = newInstance<SceneNode>(SceneMemoryPool::getSingleton(), initInf);
+	}
+
+	ANKI_CHECK(node->serializeCommon(serializer, args));
+	ANKI_CHECK(node->serialize(serializer));
+
+	node->m_sceneIndex = scene.m_arrayIndex;
+	node->m_sceneUuid = scene.m_sceneUuid;
+
+	m_deferredOps.m_nodesForRegistration.emplaceBack(node);
+
+	return Error::kNone;
+}
+
+template<typename TComponent>
+Error SceneGraph::newDeserializedComponent(U32 uuid, Scene& scene, const SceneNode::SerializeCommonArgs& args, U32& maxNodesUuid,
+										   SceneComponent*& comp)
+{
+	auto it2 = args.m_read.m_componentUuidToNode.find(uuid);
+	if(it2 == args.m_read.m_componentUuidToNode.getEnd())
+	{
+		ANKI_SCENE_LOGE("Incorrect UUID");
+		return Error::kUserData;
+	}
+
+	SceneComponentInitInfo initInf;
+	initInf.m_node = *it2;
+	initInf.m_componentUuid = uuid;
+	initInf.m_sceneUuid = scene.m_sceneUuid;
+
+	maxNodesUuid = max(maxNodesUuid, uuid); // Components also use the same UUID generator as nodes
+
+	auto it = getComponentArray<TComponent>().emplace(initInf);
+	comp = &(*it);
+	comp->setArrayIndex(it.getArrayIndex());
+
+	return Error::kNone;
+}
+
+Error SceneGraph::loadSceneText(ResourceFile& file, CString filepath, Scene*& scene)
+{
+	// How it works:
+	// - Read header and stuff
+	// - Read number of scene nodes
+	// - For every scene node
+	//   - Create node and deserialize common stuff like name. Depending on the class name use a different constructor, this is why records are for
+	//   - Deserialize the component UUIDs and just store a component UUID to node ptr mapping. Will be used later in [mapNodeToComp]
+	//   - [parentMapping] Use the node UUID mapping to find which node to set as parent
+	//   - Add a node UUID to node ptr mapping. Will be used by the nodes that follow in [parentMapping]
+	// - For every type of component
+	//   - Create the component array
+	//   - For every component
+	//     - [mapNodeToComp] Use the mapping created before to pass the proper node to the constructor
+	//     - Deserialize using SceneComponent::serialize()
+
+	TextSceneSerializer serializer(&file);
+
+	ANKI_CHECK(loadSceneHeader(serializer, kTextSceneMagic, filepath, scene));
+
 	// Scene nodes
 	SceneNode::SerializeCommonArgs serializationArgs;
 	U32 nodeCount = 0;
@@ -843,105 +1488,231 @@ Error SceneGraph::loadScene(CString filepath, Scene*& scene)
 
 	for(U32 i = 0; i < nodeCount; ++i)
 	{
-		SceneString className;
-		ANKI_SERIALIZE(className, 1);
-
-		SceneNodeInitInfo initInf;
-
-		SceneString name;
-		ANKI_SERIALIZE(name, 1);
-		initInf.m_name = name;
-
-		U32 uuid;
-		ANKI_SERIALIZE(uuid, 1);
-		initInf.m_nodeUuid = uuid;
-		initInf.m_sceneUuid = scene->m_sceneUuid;
-		initInf.m_sceneIndex = scene->m_arrayIndex;
+		ANKI_CHECK(deserializeNode(serializer, *scene, serializationArgs, maxNodesUuid));
+	}
 
-		maxNodesUuid = max(maxNodesUuid, uuid);
+	// Components
+#define ANKI_DEFINE_SCENE_COMPONENT(name, weight, sceneNodeCanHaveMany, icon, serializable, canBeDeleted) \
+	if(serializable) \
+	{ \
+		U32 name##Count = 0; \
+		ANKI_SERIALIZE(name##Count, 1); \
+		for(U32 i = 0; i < name##Count; ++i) \
+		{ \
+			U32 uuid; \
+			ANKI_SERIALIZE(uuid, 1); \
+			SceneComponent* comp; \
+			ANKI_CHECK(newDeserializedComponent<name##Component>(uuid, *scene, serializationArgs, maxNodesUuid, comp)); \
+			ANKI_CHECK(comp->serialize(serializer)); \
+			comp->getSceneNode().addComponent(comp); \
+		} \
+	}
+#include <AnKi/Scene/Components/SceneComponentClasses.def.h>
 
-		SceneNode* node;
-		if(className != "SceneNode")
-		{
-			// Derived SceneNode class
-			GlobalRegistryRecord* rec = GlobalRegistry::getSingleton().tryFindRecord(className);
-			if(!rec || rec->m_type != GlobalRegistryRecordType::kSceneNode)
-			{
-				ANKI_SCENE_LOGE("Can't load scene. Failed to find record for class: %s", className.cstr());
-				return Error::kUserData;
-			}
+	// Need to adjust the scene's UUID generator
+	scene->m_nodesUuid.setNonAtomically(maxNodesUuid + 1);
 
-			const SceneNodeRegistryRecord& record = *static_cast<SceneNodeRegistryRecord*>(rec);
+	return Error::kNone;
+}
 
-			void* mem = SceneMemoryPool::getSingleton().allocate(record.m_getClassSizeCallback(), ANKI_SAFE_ALIGNMENT);
-			record.m_constructCallback(mem, initInf);
+Error SceneGraph::loadSceneBinary(ResourceFile& file, CString filepath, Scene*& scene)
+{
+	// How it works:
+	// - Read the whole file and then the table of contents. See saveSceneBinary() for the layout
+	// - Create and deserialize the nodes in the order they were saved. That needs to be serial because the parents need to come before the
+	//   children and the node constructors touch the global component arrays. Without the text parsing it's cheap anyway
+	// - Create all the components. Serial for the same reason
+	// - Deserialize the components in parallel. That's where the resources are discovered so their loading starts as soon as a thread gets to
+	//   them. The scripts might touch the scene so they are deserialized later, serially
+	// - Add the components to their nodes in file order
+
+	SceneDynamicArrayLarge<U8> storage;
+	ConstWeakArray<U8, PtrSize> data;
+	const ConstWeakArray<U8> inMemory = file.getContentsInMemory();
+	if(inMemory.getSize())
+	{
+		data = ConstWeakArray<U8, PtrSize>(inMemory.getBegin(), inMemory.getSize());
+	}
+	else
+	{
+		storage.resize(file.getSize());
+		ANKI_CHECK(file.read(storage.getBegin(), storage.getSizeInBytes()));
+		data = storage;
+	}
 
-			node = static_cast<SceneNode*>(mem);
-		}
-		else
-		{
-			node = newInstance<SceneNode>(SceneMemoryPool::getSingleton(), initInf);
-		}
+	BinarySceneSerializer serializer(data);
 
-		ANKI_CHECK(node->serializeCommon(serializer, serializationArgs));
-		ANKI_CHECK(node->serialize(serializer));
+	ANKI_CHECK(loadSceneHeader(serializer, kBinarySceneMagic, filepath, scene));
+	const U32 version = serializer.m_crntBinaryVersion;
 
-		node->m_sceneIndex = scene->m_arrayIndex;
-		node->m_sceneUuid = scene->m_sceneUuid;
+	// Table of contents
+	U32 nodeCount = 0;
+	ANKI_SERIALIZE(nodeCount, 1);
+	SceneDynamicArray<U32> nodeOffsets;
+	nodeOffsets.resize(nodeCount + 1);
+	ANKI_SERIALIZE(nodeOffsets, 1);
 
-		m_deferredOps.m_nodesForRegistration.emplaceBack(node);
+	Array<SceneDynamicArray<U32>, U32(SceneComponentType::kCount)> componentUuids;
+	Array<SceneDynamicArray<U32>, U32(SceneComponentType::kCount)> componentOffsets;
+#define ANKI_DEFINE_SCENE_COMPONENT(name, weight, sceneNodeCanHaveMany, icon, serializable, canBeDeleted) \
+	if(serializable) \
+	{ \
+		U32 name##Count = 0; \
+		ANKI_SERIALIZE(name##Count, 1); \
+		SceneDynamicArray<U32>& name##Uuids = componentUuids[SceneComponentType::k##name]; \
+		name##Uuids.resize(name##Count); \
+		SceneDynamicArray<U32>& name##Offsets = componentOffsets[SceneComponentType::k##name]; \
+		name##Offsets.resize(name##Count + 1); \
+		ANKI_SERIALIZE(name##Uuids, 1); \
+		ANKI_SERIALIZE(name##Offsets, 1); \
 	}
+#include <AnKi/Scene/Components/SceneComponentClasses.def.h>
 
-	// Components
-	auto serializeComponent = [&](auto& compArray) -> Error {
-		U32 uuid;
-		ANKI_SERIALIZE(uuid, 1);
-
-		auto it2 = serializationArgs.m_read.m_componentUuidToNode.find(uuid);
-		if(it2 == serializationArgs.m_read.m_componentUuidToNode.getEnd())
+	const PtrSize recordsOffset = serializer.getReadOffset();
+	auto getRecord = [&](ConstWeakArray<U32> offsets, U32 idx, ConstWeakArray<U8, PtrSize>& record) -> Error {
+		const PtrSize begin = recordsOffset + offsets[idx];
+		const PtrSize end = recordsOffset + offsets[idx + 1];
+		if(begin > end || end > data.getSize())
 		{
-			ANKI_SCENE_LOGE("Incorrect UUID");
+			ANKI_SCENE_LOGE("Scene record out of bounds");
 			return Error::kUserData;
 		}
 
-		SceneComponentInitInfo initInf;
-		initInf.m_node = *it2;
-		initInf.m_componentUuid = uuid;
-		initInf.m_sceneUuid = scene->m_sceneUuid;
+		record = ConstWeakArray<U8, PtrSize>(data.getBegin() + begin, end - begin);
+		return Error::kNone;
+	};
 
-		maxNodesUuid = max(maxNodesUuid, uuid); // Components also use the same UUID generator as nodes
+	// Scene nodes
+	SceneNode::SerializeCommonArgs serializationArgs;
+	U32 maxNodesUuid = 0;
+	for(U32 i = 0; i < nodeCount; ++i)
+	{
+		ConstWeakArray<U8, PtrSize> record;
+		ANKI_CHECK(getRecord(nodeOffsets, i, record));
 
-		auto it = compArray.emplace(initInf);
-		SceneComponent& comp = *it;
-		comp.setArrayIndex(it.getArrayIndex());
-		ANKI_CHECK(comp.serialize(serializer));
+		BinarySceneSerializer nodeSerializer(record);
+		nodeSerializer.setBinaryVersion(version);
+		ANKI_CHECK(deserializeNode(nodeSerializer, *scene, serializationArgs, maxNodesUuid));
+	}
 
-		initInf.m_node->addComponent(&comp);
+	// Create the components
+	class ComponentRecord
+	{
+	public:
+		SceneComponent* m_comp = nullptr;
+		ConstWeakArray<U8, PtrSize> m_record;
 
-		return Error::kNone;
+		Error deserialize(U32 version) const
+		{
+			BinarySceneSerializer serializer(m_record);
+			serializer.setBinaryVersion(version);
+			return m_comp->serialize(serializer);
+		}
 	};
 
+	SceneDynamicArray<ComponentRecord> componentRecords;
+	U32 componentCount = 0;
+	for(const SceneDynamicArray<U32>& uuids : componentUuids)
+	{
+		componentCount += uuids.getSize();
+	}
+	componentRecords.resizeStorage(componentCount);
+
 #define ANKI_DEFINE_SCENE_COMPONENT(name, weight, sceneNodeCanHaveMany, icon, serializable, canBeDeleted) \
 	if(serializable) \
 	{ \
-		U32 name##Count = 0; \
-		ANKI_SERIALIZE(name##Count, 1); \
-		for(U32 i = 0; i < name##Count; ++i) \
+		const SceneDynamicArray<U32>& uuids = componentUuids[SceneComponentType::k##name]; \
+		for(U32 i = 0; i < uuids.getSize(); ++i) \
 		{ \
-			ANKI_CHECK(serializeComponent(SceneGraph::getSingleton().getComponentArray<name##Component>())); \
+			ComponentRecord& record = *componentRecords.emplaceBack(); \
+			ANKI_CHECK(newDeserializedComponent<name##Component>(uuids[i], *scene, serializationArgs, maxNodesUuid, record.m_comp)); \
+			ANKI_CHECK(getRecord(componentOffsets[SceneComponentType::k##name], i, record.m_record)); \
 		} \
 	}
 #include <AnKi/Scene/Components/SceneComponentClasses.def.h>
 
+	// Deserialize the components
+	auto deserializeInParallel = [](const ComponentRecord& record) {
+		return record.m_comp->getType() != SceneComponentType::kScript;
+	};
+
+	Atomic<U32> crntRecord(0);
+	Atomic<U32> errorCount(0);
+	auto deserializeBatches = [&]([[maybe_unused]] U32 tid) {
+		constexpr U32 kBatchSize = 16;
+		while(true)
+		{
+			const U32 batchBegin = crntRecord.fetchAdd(kBatchSize);
+			if(batchBegin >= componentRecords.getSize())
+			{
+				break;
+			}
+
+			const U32 batchEnd = min(batchBegin + kBatchSize, componentRecords.getSize());
+			for(U32 i = batchBegin; i < batchEnd; ++i)
+			{
+				const ComponentRecord& record = componentRecords[i];
+				if(deserializeInParallel(record) && record.deserialize(version))
+				{
+					errorCount.fetchAdd(1);
+				}
+			}
+		}
+	};
+
+	const U32 taskCount = min(componentRecords.getSize(), CoreThreadJobManager::getSingleton().getThreadCount());
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		CoreThreadJobManager::getSingleton().dispatchTask(deserializeBatches);
+	}
+	CoreThreadJobManager::getSingleton().waitForAllTasksToFinish();
+
+	if(errorCount.load())
+	{
+		ANKI_SCENE_LOGE("Failed to deserialize %u components", errorCount.load());
+		return Error::kUserData;
+	}
+
+	for(const ComponentRecord& record : componentRecords)
+	{
+		if(!deserializeInParallel(record))
+		{
+			ANKI_CHECK(record.deserialize(version));
+		}
+
+		record.m_comp->getSceneNode().addComponent(record.m_comp);
+	}
+
 	// Need to adjust the scene's UUID generator
 	scene->m_nodesUuid.setNonAtomically(maxNodesUuid + 1);
 
-	ANKI_SCENE_LOGI("Loading scene finished. %fms", F64(HighRezTimer::getCurrentTimeUs() - begin) / 1000.0);
 	return Error::kNone;
 }
 
+Error SceneGraph::convertScene(CString inFilepath, CString outFilename)
+{
+	forbidCallOnUpdate();
+
+	Scene* scene = nullptr;
+	ANKI_CHECK(loadScene(inFilepath, scene));
+
+	// The nodes and the hierarchy are deferred
+	doDeferredOperations();
+
+	const Error err = saveScene(outFilename, *scene);
+	deleteScene(scene);
+
+	return err;
+}
+
 void SceneGraph::doDeferredOperations()
 {
+	if(m_deferredOps.m_nodesForRegistration.getSize() || m_deferredOps.m_nodesParentChanged.getSize())
+	{
+		// The new nodes need transform slots and the reparented need new ones
+		SceneTransformStore::getSingleton().markHierarchyDirty();
+	}
+
 	// Register new nodes
 	for(SceneNode* node : m_deferredOps.m_nodesForRegistration)
 	{
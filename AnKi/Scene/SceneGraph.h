@@ -7,6 +7,7 @@
 
 #include <AnKi/Scene/Common.h>
 #include <AnKi/Scene/SceneNode.h>
+#include <AnKi/Scene/SoftwareRasterizer.h>
 #include <AnKi/Math.h>
 #include <AnKi/Util/HashMap.h>
 #include <AnKi/Util/BlockArray.h>
@@ -18,6 +19,8 @@ namespace anki {
 
 ANKI_CVAR(NumericCVar<F32>, Scene, ProbeEffectiveDistance, 256.0f, 1.0f, kMaxF32, "How far various probes can render")
 ANKI_CVAR(NumericCVar<F32>, Scene, ProbeShadowEffectiveDistance, 32.0f, 1.0f, kMaxF32, "How far to render shadows for the various probes")
+ANKI_CVAR(BoolCVar, Scene, TypeBatchedComponentUpdate, false,
+		  "Update the components that run after the transforms one type at a time instead of one node at a time")
 
 // Gpu scene arrays
 ANKI_CVAR(NumericCVar<U32>, Scene, MinGpuSceneTransforms, 2 * 10 * 1024, 8, 100 * 1024, "The min number of transforms stored in the GPU scene")
@@ -31,6 +34,12 @@ ANKI_CVAR(NumericCVar<U32>, Scene, MinGpuSceneDecals, 2 * 1024, 8, 100 * 1024, "
 ANKI_CVAR(NumericCVar<U32>, Scene, MinGpuSceneFogDensityVolumes, 512, 8, 100 * 1024, "The min number fog density volumes stored in the GPU scene")
 ANKI_CVAR(NumericCVar<U32>, Scene, MinGpuSceneRenderables, 10 * 1024, 8, 100 * 1024, "The min number of renderables stored in the GPU scene")
 
+// CPU occlusion culling
+ANKI_CVAR(BoolCVar, Scene, CpuOcclusionCulling, false,
+		  "Rasterize the occluder meshes on the CPU and hide the renderables and lights behind them. Probes rendered at the same time miss them too")
+ANKI_CVAR(NumericCVar<U32>, Scene, CpuOcclusionBufferWidth, 256, 64, 2048,
+		  "The width of the CPU occlusion buffer. The height is derived from the aspect ratio of the camera")
+
 // The scenegraph consists of multiple scenes. Scenes are containers of nodes.
 class Scene
 {
@@ -203,10 +212,15 @@ public:
 		return m_scenes[m_activeSceneIndex];
 	}
 
+	// Save a scene. If the extension is .ankiscenebin the scene will be saved in the binary format, else in the text format
 	Error saveScene(CString filename, Scene& scene);
 
+	// Load a .ankiscene, a .ankiscenebin or a .lua scene
 	Error loadScene(CString filepath, Scene*& scene);
 
+	// Convert a scene between the text and the binary formats. The formats are deduced from the extensions
+	Error convertScene(CString inFilepath, CString outFilename);
+
 	void deleteScene(Scene* scene);
 
 	U32 getSceneCount() const
@@ -347,6 +361,28 @@ public:
 		return m_paused;
 	}
 
+	// Check if something is hidden behind the CPU occluders. The test uses the occluders of the previous frame.
+	// Note: Thread-safe. Can be called by SceneComponent::update
+	ANKI_INTERNAL Bool isOccludedOnCpu(const Aabb& aabb) const
+	{
+		return m_cpuOcclusionBufferReady && !m_occlusionRasterizer.visibilityTest(aabb);
+	}
+
+	// Note: Thread-safe. Can be called by SceneComponent::update
+	ANKI_INTERNAL Bool isCpuOcclusionCullingActive() const
+	{
+		return m_cpuOcclusionBufferReady;
+	}
+
+	// Start simulating the physics of the next frame in a separate thread so it can overlap with the rendering of the current frame. The next
+	// update() will not simulate again. Nothing else should touch the PhysicsWorld till waitPhysicsUpdate(). Whatever the user code does to the
+	// physics before the next update() is simulated a frame later, so it adds a frame of input latency.
+	// dt: The time step. The time of the next frame is not known yet so it's usually the time step of the current frame.
+	ANKI_INTERNAL void startPhysicsUpdate(Second dt);
+
+	// Wait for the physics of startPhysicsUpdate() to finish. It's fine to call it even if nothing was started.
+	ANKI_INTERNAL void waitPhysicsUpdate();
+
 #if ANKI_WITH_EDITOR
 	// If enable is true the components will be checking for updates of resources. Useful for the editor resource updates. It has a perf hit so it
 	// should be enabled only by the editor
@@ -370,9 +406,21 @@ private:
 	} m_initMemPoolDummy;
 
 	static constexpr U32 kForceSetSceneBoundsFrameCount = 60 * 2; // Re-set the scene bounds after 2".
+	static constexpr U32 kSubtreeTaskMinWeight = 32; // Children whose subtrees are roughly that many nodes are updated in a separate task
+	static constexpr U32 kNodeBatchSize = 64; // Nodes a thread grabs at a time in the type batched update
 
 	mutable StackMemoryPool m_framePool;
 
+	// Frame memory of a single update thread. Same lifetime as m_framePool. Aligned so the threads don't share cache lines
+	class alignas(ANKI_CACHE_LINE_SIZE) ThreadFramePool
+	{
+	public:
+		StackMemoryPool m_pool;
+		PtrSize m_highWaterMark = 0;
+	};
+
+	SceneDynamicArray<ThreadFramePool> m_threadFramePools; // One per CoreThreadJobManager thread
+
 	SceneBlockArray<Scene, BlockArrayConfig<4>> m_scenes;
 	U8 m_activeSceneIndex = 0;
 
@@ -411,6 +459,13 @@ private:
 	LightComponent* m_activeDirLight = nullptr;
 	SkyboxComponent* m_activeSkybox = nullptr;
 
+	SoftwareRasterizer m_occlusionRasterizer;
+	Bool m_cpuOcclusionBufferReady = false;
+
+	ThreadJobManager* m_physicsThread = nullptr; // Runs the physics of startPhysicsUpdate(). Created on first use
+	Bool m_physicsUpdateInFlight = false;
+	Bool m_physicsUpdatedAhead = false; // The physics of the next update() are already simulated
+
 #if ANKI_ASSERTIONS_ENABLED
 	volatile Bool m_inUpdate = false;
 #endif
@@ -419,9 +474,21 @@ private:
 
 	~SceneGraph();
 
+	void rasterizeCpuOccluders();
+
+	void updateNodesPass(UpdateSceneNodesCtx& ctx);
 	void updateNodes(U32 tid, UpdateSceneNodesCtx& ctx);
 	void updateNode(U32 tid, SceneNode& node, UpdateSceneNodesCtx& ctx);
 
+	// Re-assign the slots of the SceneTransformStore by walking the hierarchy breadth-first
+	void rebuildTransformStore();
+
+	// Update the components of the 2nd pass one type at a time. Every type is a parallel for over the nodes that have components of that type
+	void updateComponentsByType(UpdateSceneNodesCtx& ctx);
+
+	template<typename TComponent>
+	void updateComponentsOfType(ConstWeakArray<SceneNode*> nodes, UpdateSceneNodesCtx& ctx);
+
 	// Begin deferred operations //
 	void sceneNodeChangedNameDeferred(SceneNode& node, CString oldName)
 	{
@@ -441,9 +508,22 @@ private:
 	void removeNodeFromDeferredOps(SceneNode* node);
 	// End deferred operations //
 
-	static void countSerializableNodes(SceneNode& root, U32& serializableNodeCount);
-	static void serializeSerializableNodes(SceneSerializer& serializer, SceneNode& root, SceneNode::SerializeCommonArgs& args,
-										   U32& serializedNodeCount, Error& err);
+	// Begin serialization //
+	using SerializableComponentArrays = Array<SceneDynamicArray<SceneComponent*>, U32(SceneComponentType::kCount)>;
+
+	static void gatherSerializableNodes(SceneNode& root, SceneDynamicArray<SceneNode*>& nodes);
+	static Error serializeNode(SceneSerializer& serializer, SceneNode& node, SceneNode::SerializeCommonArgs& args);
+	void gatherSerializableComponents(const SceneNode::SerializeCommonArgs& args, SerializableComponentArrays& components);
+	Error saveSceneText(File& file, ConstWeakArray<SceneNode*> nodes);
+	Error saveSceneBinary(File& file, ConstWeakArray<SceneNode*> nodes);
+
+	Error loadSceneHeader(SceneSerializer& serializer, CString expectedMagic, CString filepath, Scene*& scene);
+	Error deserializeNode(SceneSerializer& serializer, Scene& scene, SceneNode::SerializeCommonArgs& args, U32& maxNodesUuid);
+	template<typename TComponent>
+	Error newDeserializedComponent(U32 uuid, Scene& scene, const SceneNode::SerializeCommonArgs& args, U32& maxNodesUuid, SceneComponent*& comp);
+	Error loadSceneText(ResourceFile& file, CString filepath, Scene*& scene);
+	Error loadSceneBinary(ResourceFile& file, CString filepath, Scene*& scene);
+	// End serialization //
 
 	void forbidCallOnUpdate() const
 	{
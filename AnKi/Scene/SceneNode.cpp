@@ -205,45 +205,6 @@ void SceneNode::addComponent(SceneComponent* newc)
 	});
 }
 
-Bool SceneNode::updateTransform()
-{
-	const Bool needsUpdate = m_localTransformDirty;
-	m_localTransformDirty = false;
-	const Bool updatedLastFrame = m_transformUpdatedThisFrame;
-	m_transformUpdatedThisFrame = needsUpdate;
-
-	if(needsUpdate || updatedLastFrame)
-	{
-		m_prevWTrf = m_wtrf;
-	}
-
-	// Update world transform
-	if(needsUpdate)
-	{
-		const SceneNode* parent = getParent();
-
-		if(parent == nullptr || m_ignoreParentNodeTransform)
-		{
-			m_wtrf = m_ltrf;
-		}
-		else
-		{
-			m_wtrf = parent->getWorldTransform().combineTransformations(m_ltrf);
-		}
-
-		// Make children dirty as well. Don't walk the whole tree because you will re-walk it later
-		visitChildrenMaxDepth(1, [](SceneNode& childNode) {
-			if(!childNode.m_ignoreParentNodeTransform)
-			{
-				childNode.m_localTransformDirty = true;
-			}
-			return FunctorContinue::kContinue;
-		});
-	}
-
-	return needsUpdate;
-}
-
 void SceneNode::setName(CString name)
 {
 	const SceneString oldName = getName();
@@ -271,7 +232,7 @@ Error SceneNode::serializeCommon(SceneSerializer& serializer, SerializeCommonArg
 	// Flags. Can't serialize the bitfields directly
 	Bool ignoreParentNodeTransform = m_ignoreParentNodeTransform;
 	ANKI_SERIALIZE(ignoreParentNodeTransform, 1);
-	m_ignoreParentNodeTransform = ignoreParentNodeTransform;
+	setIgnoreParentTransform(ignoreParentNodeTransform);
 
 	Bool updateOnPause = m_updateOnPause;
 	ANKI_SERIALIZE(updateOnPause, 1);
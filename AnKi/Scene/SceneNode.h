@@ -6,6 +6,7 @@
 #pragma once
 
 #include <AnKi/Scene/Components/SceneComponent.h>
+#include <AnKi/Scene/SceneTransformStore.h>
 #include <AnKi/Util/Hierarchy.h>
 #include <AnKi/Util/Enum.h>
 #include <AnKi/Util/DynamicBitSet.h>
@@ -465,7 +466,12 @@ public:
 	// Ignore parent nodes's transform.
 	void setIgnoreParentTransform(Bool ignore)
 	{
-		m_ignoreParentNodeTransform = ignore;
+		if(m_ignoreParentNodeTransform != ignore)
+		{
+			m_ignoreParentNodeTransform = ignore;
+			SceneTransformStore::getSingleton().markHierarchyDirty();
+			markLocalTransformDirty();
+		}
 	}
 
 	const Transform& getLocalTransform() const
@@ -476,13 +482,13 @@ public:
 	void setLocalTransform(const Transform& x)
 	{
 		m_ltrf = x;
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	void setLocalOrigin(const Vec3& x)
 	{
 		m_ltrf.setOrigin(x);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	Vec3 getLocalOrigin() const
@@ -493,7 +499,7 @@ public:
 	void setLocalRotation(const Mat3& x)
 	{
 		m_ltrf.setRotation(x);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	Mat3 getLocalRotation() const
@@ -504,7 +510,7 @@ public:
 	void setLocalScale(const Vec3& x)
 	{
 		m_ltrf.setScale(x);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	Vec3 getLocalScale() const
@@ -512,19 +518,22 @@ public:
 		return m_ltrf.getScale().xyz;
 	}
 
+	// Before the node gets its first update the world transform is the local one
 	const Transform& getWorldTransform() const
 	{
-		return m_wtrf;
+		return (m_transformSlot != SceneTransformStore::kInvalidSlot) ? SceneTransformStore::getSingleton().getWorldTransform(m_transformSlot)
+																	  : m_ltrf;
 	}
 
 	const Transform& getPreviousWorldTransform() const
 	{
-		return m_prevWTrf;
+		return (m_transformSlot != SceneTransformStore::kInvalidSlot) ? SceneTransformStore::getSingleton().getPreviousWorldTransform(m_transformSlot)
+																	  : m_ltrf;
 	}
 
 	Vec3 getWorldScale() const
 	{
-		return m_wtrf.getScale().xyz;
+		return getWorldTransform().getScale().xyz;
 	}
 
 	void rotateLocalX(F32 angleRad)
@@ -532,7 +541,7 @@ public:
 		Mat3x4 r = m_ltrf.getRotation();
 		r.rotateXAxis(angleRad);
 		m_ltrf.setRotation(r);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	void rotateLocalY(F32 angleRad)
@@ -540,7 +549,7 @@ public:
 		Mat3x4 r = m_ltrf.getRotation();
 		r.rotateYAxis(angleRad);
 		m_ltrf.setRotation(r);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	void rotateLocalZ(F32 angleRad)
@@ -548,53 +557,53 @@ public:
 		Mat3x4 r = m_ltrf.getRotation();
 		r.rotateZAxis(angleRad);
 		m_ltrf.setRotation(r);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	void moveLocalX(F32 distance)
 	{
 		Vec3 x_axis = m_ltrf.getRotation().getColumn(0);
 		m_ltrf.setOrigin(m_ltrf.getOrigin() + Vec4(x_axis, 0.0f) * distance);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	void moveLocalY(F32 distance)
 	{
 		Vec3 y_axis = m_ltrf.getRotation().getColumn(1);
 		m_ltrf.setOrigin(m_ltrf.getOrigin() + Vec4(y_axis, 0.0) * distance);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	void moveLocalZ(F32 distance)
 	{
 		Vec3 z_axis = m_ltrf.getRotation().getColumn(2);
 		m_ltrf.setOrigin(m_ltrf.getOrigin() + Vec4(z_axis, 0.0) * distance);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	void scale(F32 s)
 	{
 		m_ltrf.setScale(m_ltrf.getScale() * s);
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	void lookAtPoint(const Vec4& point)
 	{
 		m_ltrf = m_ltrf.lookAt(point, Vec4::yAxis());
-		m_localTransformDirty = true;
+		markLocalTransformDirty();
 	}
 
 	Bool movedThisFrame() const
 	{
-		return m_transformUpdatedThisFrame;
+		return (m_transformSlot != SceneTransformStore::kInvalidSlot)
+				   ? SceneTransformStore::getSingleton().getWorldTransformUpdatedThisFrame(m_transformSlot)
+				   : true;
 	}
 
-	// Returns true if the transform got updated
-	ANKI_INTERNAL Bool updateTransform();
-
 	ANKI_INTERNAL Bool isLocalTransformDirty() const
 	{
-		return m_localTransformDirty;
+		return (m_transformSlot != SceneTransformStore::kInvalidSlot) ? SceneTransformStore::getSingleton().isLocalTransformDirty(m_transformSlot)
+																	  : m_localTransformDirty;
 	}
 
 private:
@@ -622,6 +631,7 @@ private:
 
 	U32 m_nodeArrayIndex = kMaxU32; // Index in Scene::m_nodes
 	U32 m_updatableNodesArrayIndex = kMaxU32; // Index in SceneGraph::m_updatableNodes
+	U32 m_transformSlot = SceneTransformStore::kInvalidSlot; // Slot in the SceneTransformStore. Changes when the hierarchy changes
 
 	U32 m_nodeUuid : kSceneNodeUuidBits = 0; // Persists serialization. Can have many scene nodes sharing the same UUID but be in different scenes
 	U32 m_sceneUuid : kSceneUuidBits = 0;
@@ -630,9 +640,8 @@ private:
 
 	// Flags
 	Bool m_markedForDeletion : 1 = false;
-	Bool m_localTransformDirty : 1 = true;
+	Bool m_localTransformDirty : 1 = true; // Only used before the node gets a transform slot
 	Bool m_ignoreParentNodeTransform : 1 = false;
-	Bool m_transformUpdatedThisFrame : 1 = true;
 	Bool m_serialize : 1 = true;
 	Bool m_updateOnPause : 1 = false;
 
@@ -645,12 +654,22 @@ private:
 
 	Timestamp m_maxComponentTimestamp = 0;
 
-	Transform m_ltrf = Transform::getIdentity(); // The transformation in local space
-	Transform m_wtrf = Transform::getIdentity(); // The transformation in world space (local combined with parent's transformation)
-	Transform m_prevWTrf = Transform::getIdentity(); // Keep the previous transformation for checking if it moved
+	Transform m_ltrf = Transform::getIdentity(); // The transformation in local space. The world transforms live in the SceneTransformStore
 
 	void addComponent(SceneComponent* newc);
 
+	void markLocalTransformDirty()
+	{
+		if(m_transformSlot != SceneTransformStore::kInvalidSlot)
+		{
+			SceneTransformStore::getSingleton().markLocalTransformDirty(m_transformSlot);
+		}
+		else
+		{
+			m_localTransformDirty = true;
+		}
+	}
+
 	Error serializeCommon(SceneSerializer& serializer, SerializeCommonArgs& args);
 
 	// For the IntrusiveHierarchy interface
@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Scene/SceneSerializer.h>
+#include <AnKi/Util/Hash.h>
 
 namespace anki {
 
@@ -139,4 +140,108 @@ Error TextSceneSerializer::parseCurrentLine(SceneStringList& tokens, CString fie
 	return Error::kNone;
 }
 
+static U32 computeFieldNameHash(CString name)
+{
+	return U32(computeHash(name.cstr(), name.getLength()));
+}
+
+Error BinarySceneSerializer::writeInternal(CString name, ValueType type, const void* values, U32 elementCount, PtrSize size)
+{
+	if(elementCount >= (1u << kElementCountBits))
+	{
+		ANKI_SCENE_LOGE("Too many elements to serialize: %s", name.cstr());
+		return Error::kUserData;
+	}
+
+	const Array<U32, 2> header = {computeFieldNameHash(name), (U32(type) << kElementCountBits) | elementCount};
+
+	SceneDynamicArrayLarge<U8>& buffer = *m_write.m_buffer;
+	const PtrSize offset = buffer.getSize();
+	buffer.resize(offset + header.getSizeInBytes() + size);
+	memcpy(&buffer[offset], header.getBegin(), header.getSizeInBytes());
+	if(size)
+	{
+		memcpy(&buffer[offset + header.getSizeInBytes()], values, size);
+	}
+
+	return Error::kNone;
+}
+
+Error BinarySceneSerializer::readBytes(void* out, PtrSize size)
+{
+	if(m_read.m_offset + size > m_read.m_data.getSize())
+	{
+		ANKI_SCENE_LOGE("Reading past the end of the data. Offset %zu", m_read.m_offset);
+		return Error::kUserData;
+	}
+
+	if(size)
+	{
+		memcpy(out, &m_read.m_data[m_read.m_offset], size);
+		m_read.m_offset += size;
+	}
+
+	return Error::kNone;
+}
+
+Error BinarySceneSerializer::readHeader(CString name, ValueType type, U32& elementCount)
+{
+	Array<U32, 2> header;
+	ANKI_CHECK(readBytes(header.getBegin(), header.getSizeInBytes()));
+
+	if(header[0] != computeFieldNameHash(name))
+	{
+		ANKI_SCENE_LOGE("Wrong field. Expecting: %s. Offset %zu", name.cstr(), m_read.m_offset - header.getSizeInBytes());
+		return Error::kUserData;
+	}
+
+	if(ValueType(header[1] >> kElementCountBits) != type)
+	{
+		ANKI_SCENE_LOGE("Wrong type of field: %s", name.cstr());
+		return Error::kUserData;
+	}
+
+	elementCount = header[1] & ((1u << kElementCountBits) - 1);
+	return Error::kNone;
+}
+
+Error BinarySceneSerializer::readInternal(CString name, ValueType type, void* values, U32 elementCount, PtrSize size)
+{
+	U32 storedElementCount;
+	ANKI_CHECK(readHeader(name, type, storedElementCount));
+
+	if(storedElementCount != elementCount)
+	{
+		ANKI_SCENE_LOGE("Incorrect number of elements of field %s. Got %u, expecting %u", name.cstr(), storedElementCount, elementCount);
+		return Error::kUserData;
+	}
+
+	return readBytes(values, size);
+}
+
+Error BinarySceneSerializer::read(CString name, SceneString& value)
+{
+	U32 length;
+	ANKI_CHECK(readHeader(name, ValueType::kString, length));
+
+	if(m_read.m_offset + length > m_read.m_data.getSize())
+	{
+		ANKI_SCENE_LOGE("Reading past the end of the data. Offset %zu", m_read.m_offset);
+		return Error::kUserData;
+	}
+
+	if(length)
+	{
+		const Char* begin = reinterpret_cast<const Char*>(&m_read.m_data[m_read.m_offset]);
+		value = SceneString(begin, begin + length);
+		m_read.m_offset += length;
+	}
+	else
+	{
+		value = "";
+	}
+
+	return Error::kNone;
+}
+
 } // end namespace anki
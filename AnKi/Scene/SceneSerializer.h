@@ -10,7 +10,7 @@
 
 namespace anki {
 
-constexpr U32 kSceneBinaryVersion = 1;
+constexpr U32 kSceneBinaryVersion = 2;
 
 #define ANKI_SERIALIZE(var, version) \
 	{ \
@@ -379,4 +379,103 @@ private:
 	Error parseCurrentLine(SceneStringList& tokens, CString fieldName, U32 checkTokenCount = kMaxU32);
 };
 
+// Serialize in a compact binary format. Every value is preceded by the hash of its name, its type and its element count so reading the wrong
+// field fails early instead of returning garbage. The versioning works the same way as the text format since it lives in SceneSerializer
+class BinarySceneSerializer : public SceneSerializer
+{
+public:
+	// Write mode. Appends to the buffer
+	BinarySceneSerializer(SceneDynamicArrayLarge<U8>* buffer)
+		: SceneSerializer(true)
+	{
+		ANKI_ASSERT(buffer);
+		m_write.m_buffer = buffer;
+	}
+
+	// Read mode. The data need to outlive the serializer
+	BinarySceneSerializer(ConstWeakArray<U8, PtrSize> data)
+		: SceneSerializer(false)
+	{
+		m_read.m_data = data;
+	}
+
+	Error write(CString name, ConstWeakArray<U32> values) final
+	{
+		return writeInternal(name, ValueType::kU32, values.getBegin(), values.getSize(), values.getSizeInBytes());
+	}
+
+	Error read(CString name, WeakArray<U32> values) final
+	{
+		return readInternal(name, ValueType::kU32, values.getBegin(), values.getSize(), values.getSizeInBytes());
+	}
+
+	Error write(CString name, ConstWeakArray<I32> values) final
+	{
+		return writeInternal(name, ValueType::kI32, values.getBegin(), values.getSize(), values.getSizeInBytes());
+	}
+
+	Error read(CString name, WeakArray<I32> values) final
+	{
+		return readInternal(name, ValueType::kI32, values.getBegin(), values.getSize(), values.getSizeInBytes());
+	}
+
+	Error write(CString name, ConstWeakArray<F32> values) final
+	{
+		return writeInternal(name, ValueType::kF32, values.getBegin(), values.getSize(), values.getSizeInBytes());
+	}
+
+	Error read(CString name, WeakArray<F32> values) final
+	{
+		return readInternal(name, ValueType::kF32, values.getBegin(), values.getSize(), values.getSizeInBytes());
+	}
+
+	Error write(CString name, CString value) final
+	{
+		return writeInternal(name, ValueType::kString, value.cstr(), value.getLength(), value.getLength());
+	}
+
+	Error read(CString name, SceneString& value) final;
+
+	// The bytes consumed so far in read mode
+	PtrSize getReadOffset() const
+	{
+		ANKI_ASSERT(isInReadMode());
+		return m_read.m_offset;
+	}
+
+private:
+	enum class ValueType : U8
+	{
+		kU32,
+		kI32,
+		kF32,
+		kString,
+
+		kCount
+	};
+
+	static constexpr U32 kElementCountBits = 28;
+
+	class
+	{
+	public:
+		SceneDynamicArrayLarge<U8>* m_buffer = nullptr;
+	} m_write;
+
+	class
+	{
+	public:
+		ConstWeakArray<U8, PtrSize> m_data;
+		PtrSize m_offset = 0;
+	} m_read;
+
+	Error writeInternal(CString name, ValueType type, const void* values, U32 elementCount, PtrSize size);
+
+	Error readInternal(CString name, ValueType type, void* values, U32 elementCount, PtrSize size);
+
+	Error readHeader(CString name, ValueType type, U32& elementCount);
+
+	Error readBytes(void* out, PtrSize size);
+};
+
 } // end namespace anki
@@ -0,0 +1,152 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Scene/SceneTransformStore.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/Tracer.h>
+
+namespace anki {
+
+void SceneTransformStore::beginRebuild(U32 slotCount)
+{
+	ANKI_TRACE_FUNCTION();
+#if ANKI_ASSERTIONS_ENABLED
+	ANKI_ASSERT(!m_inRebuild);
+	m_inRebuild = true;
+#endif
+
+	m_old.m_localTransforms = std::move(m_localTransforms);
+	m_old.m_worldTransforms = std::move(m_worldTransforms);
+	m_old.m_prevWorldTransforms = std::move(m_prevWorldTransforms);
+	m_old.m_flags = std::move(m_flags);
+
+	m_parents.destroy();
+	m_levelEnds.destroy();
+
+	m_localTransforms.resizeStorage(slotCount);
+	m_parents.resizeStorage(slotCount);
+	m_worldTransforms.resizeStorage(slotCount);
+	m_prevWorldTransforms.resizeStorage(slotCount);
+	m_flags.resizeStorage(slotCount);
+
+	m_hierarchyDirty.store(false);
+}
+
+U32 SceneTransformStore::addSlot(const Transform* localTransform, U32 parentSlot, U32 depth, U32 oldSlot, Bool localTransformDirty)
+{
+	ANKI_ASSERT(m_inRebuild);
+	ANKI_ASSERT(localTransform);
+	const U32 slot = m_localTransforms.getSize();
+	ANKI_ASSERT(parentSlot == kInvalidSlot || parentSlot < slot);
+
+	// Open new levels. Some levels might be empty if there are nodes that don't inherit their parent's transform
+	ANKI_ASSERT(depth + 1 >= m_levelEnds.getSize() && "Slots should be added in depth order");
+	while(m_levelEnds.getSize() <= depth)
+	{
+		m_levelEnds.emplaceBack(slot);
+	}
+	ANKI_ASSERT(parentSlot == kInvalidSlot || (depth > 0 && parentSlot < m_levelEnds[depth - 1]));
+	++m_levelEnds[depth];
+
+	m_localTransforms.emplaceBack(localTransform);
+	m_parents.emplaceBack(parentSlot);
+
+	if(oldSlot != kInvalidSlot)
+	{
+		ANKI_ASSERT(m_old.m_localTransforms[oldSlot] == localTransform);
+		m_worldTransforms.emplaceBack(m_old.m_worldTransforms[oldSlot]);
+		m_prevWorldTransforms.emplaceBack(m_old.m_prevWorldTransforms[oldSlot]);
+		m_flags.emplaceBack(U8(m_old.m_flags[oldSlot] | ((localTransformDirty) ? kLocalTransformDirty : 0)));
+	}
+	else
+	{
+		// Same as a node that was never updated
+		m_worldTransforms.emplaceBack(Transform::getIdentity());
+		m_prevWorldTransforms.emplaceBack(Transform::getIdentity());
+		m_flags.emplaceBack(U8(kUpdatedThisFrame | ((localTransformDirty) ? kLocalTransformDirty : 0)));
+	}
+
+	return slot;
+}
+
+void SceneTransformStore::endRebuild()
+{
+	ANKI_ASSERT(m_inRebuild);
+#if ANKI_ASSERTIONS_ENABLED
+	m_inRebuild = false;
+#endif
+
+	m_old.m_localTransforms.destroy();
+	m_old.m_worldTransforms.destroy();
+	m_old.m_prevWorldTransforms.destroy();
+	m_old.m_flags.destroy();
+}
+
+U32 SceneTransformStore::updateSlots(U32 begin, U32 end)
+{
+	U32 updatedCount = 0;
+	for(U32 slot = begin; slot < end; ++slot)
+	{
+		const U8 flags = m_flags[slot];
+		const U32 parent = m_parents[slot];
+
+		// The parents are in previous levels so they are already updated
+		const Bool dirty = (flags & kLocalTransformDirty) || (parent != kInvalidSlot && (m_flags[parent] & kUpdatedThisFrame));
+
+		if(dirty || (flags & kUpdatedThisFrame))
+		{
+			m_prevWorldTransforms[slot] = m_worldTransforms[slot];
+		}
+
+		if(dirty)
+		{
+			const Transform& localTrf = *m_localTransforms[slot];
+			m_worldTransforms[slot] = (parent != kInvalidSlot) ? m_worldTransforms[parent].combineTransformations(localTrf) : localTrf;
+			++updatedCount;
+		}
+
+		m_flags[slot] = (dirty) ? kUpdatedThisFrame : 0;
+	}
+
+	return updatedCount;
+}
+
+void SceneTransformStore::updateWorldTransforms(ThreadJobManager* jobManager)
+{
+	ANKI_TRACE_FUNCTION();
+	ANKI_ASSERT(!m_inRebuild);
+	ANKI_ASSERT(!isHierarchyDirty() && "Need to rebuild first");
+
+	m_updatedSlotCount.setNonAtomically(0);
+
+	U32 levelBegin = 0;
+	for(const U32 levelEnd : m_levelEnds)
+	{
+		const U32 levelSlotCount = levelEnd - levelBegin;
+
+		if(jobManager == nullptr || levelSlotCount <= kSlotsPerTask)
+		{
+			m_updatedSlotCount.fetchAdd(updateSlots(levelBegin, levelEnd));
+		}
+		else
+		{
+			// Split the level into tasks and wait for all of them before moving to the next level
+			for(U32 taskBegin = levelBegin; taskBegin < levelEnd; taskBegin += kSlotsPerTask)
+			{
+				const U32 taskEnd = min(taskBegin + kSlotsPerTask, levelEnd);
+				jobManager->dispatchTask([this, taskBegin, taskEnd]([[maybe_unused]] U32 tid) {
+					ANKI_TRACE_SCOPED_EVENT(SceneTransformsUpdate);
+					m_updatedSlotCount.fetchAdd(updateSlots(taskBegin, taskEnd));
+				});
+			}
+
+			jobManager->waitForAllTasksToFinish();
+		}
+
+		levelBegin = levelEnd;
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,145 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Scene/Common.h>
+#include <AnKi/Math.h>
+#include <AnKi/Util/Atomic.h>
+
+namespace anki {
+
+// Forward
+class ThreadJobManager;
+
+// Holds the world transforms of all the scene nodes. The transforms are stored in arrays (SoA) that are sorted by the depth of the nodes in the
+// hierarchy so the world transforms can be computed one depth level at a time. The parents of a level are always in a previous level so the slots
+// of a level can be processed in parallel without dependencies. The nodes keep their local transforms and the store points to them.
+// The slots are re-assigned with beginRebuild(), addSlot(), endRebuild() every time the hierarchy changes.
+class SceneTransformStore : public MakeSingleton<SceneTransformStore>
+{
+public:
+	static constexpr U32 kInvalidSlot = kMaxU32;
+
+	// Levels with more slots than that will be split into tasks
+	static constexpr U32 kSlotsPerTask = 1024;
+
+	SceneTransformStore() = default;
+
+	SceneTransformStore(const SceneTransformStore&) = delete; // Non-copyable
+
+	SceneTransformStore& operator=(const SceneTransformStore&) = delete; // Non-copyable
+
+	// Start re-assigning the slots. The old slots stay valid until endRebuild().
+	// slotCount: A hint of the number of slots that will be added.
+	void beginRebuild(U32 slotCount);
+
+	// Add a slot. The slots should be added in depth order (breadth-first) and the parents should be added before their children.
+	// localTransform: The local transform of the node. The pointer should stay valid for as long as the slot is alive.
+	// parentSlot: The new slot of the parent or kInvalidSlot if the local transform is also the world transform.
+	// depth: The depth in the hierarchy.
+	// oldSlot: The slot of the node before the rebuild. Its state will be carried to the new slot. kInvalidSlot for new nodes.
+	// localTransformDirty: Force a world transform update.
+	// Returns the new slot.
+	U32 addSlot(const Transform* localTransform, U32 parentSlot, U32 depth, U32 oldSlot, Bool localTransformDirty);
+
+	void endRebuild();
+
+	// Something changed in the hierarchy and the slots need to be re-assigned. It's thread-safe.
+	void markHierarchyDirty()
+	{
+		m_hierarchyDirty.store(true);
+	}
+
+	Bool isHierarchyDirty() const
+	{
+		return m_hierarchyDirty.load();
+	}
+
+	// Compute the world transforms of the slots that changed (or their parents changed) since the last call.
+	// jobManager: The threads to use for the big levels. If it's nullptr it will update everything in the calling thread.
+	void updateWorldTransforms(ThreadJobManager* jobManager);
+
+	// Mark that the local transform of a slot changed. It's thread-safe as long as different threads touch different slots.
+	void markLocalTransformDirty(U32 slot)
+	{
+		m_flags[slot] |= kLocalTransformDirty;
+	}
+
+	Bool isLocalTransformDirty(U32 slot) const
+	{
+		return !!(m_flags[slot] & kLocalTransformDirty);
+	}
+
+	const Transform& getWorldTransform(U32 slot) const
+	{
+		return m_worldTransforms[slot];
+	}
+
+	const Transform& getPreviousWorldTransform(U32 slot) const
+	{
+		return m_prevWorldTransforms[slot];
+	}
+
+	// Returns true if the world transform got updated in the last updateWorldTransforms().
+	Bool getWorldTransformUpdatedThisFrame(U32 slot) const
+	{
+		return !!(m_flags[slot] & kUpdatedThisFrame);
+	}
+
+	U32 getSlotCount() const
+	{
+		return m_localTransforms.getSize();
+	}
+
+	U32 getLevelCount() const
+	{
+		return m_levelEnds.getSize();
+	}
+
+	// The number of slots that got updated in the last updateWorldTransforms().
+	U32 getUpdatedSlotCount() const
+	{
+		return m_updatedSlotCount.load();
+	}
+
+private:
+	enum : U8
+	{
+		kLocalTransformDirty = 1 << 0,
+		kUpdatedThisFrame = 1 << 1
+	};
+
+	class Arrays
+	{
+	public:
+		SceneDynamicArray<const Transform*> m_localTransforms;
+		SceneDynamicArray<Transform> m_worldTransforms;
+		SceneDynamicArray<Transform> m_prevWorldTransforms;
+		SceneDynamicArray<U8> m_flags;
+	};
+
+	// The SoA of the slots
+	SceneDynamicArray<const Transform*> m_localTransforms;
+	SceneDynamicArray<U32> m_parents;
+	SceneDynamicArray<Transform> m_worldTransforms;
+	SceneDynamicArray<Transform> m_prevWorldTransforms;
+	SceneDynamicArray<U8> m_flags;
+
+	SceneDynamicArray<U32> m_levelEnds; // One past the last slot of every depth level
+
+	Arrays m_old; // The arrays before the rebuild
+
+	Atomic<U32> m_updatedSlotCount = {0};
+	Atomic<Bool> m_hierarchyDirty = {true};
+
+#if ANKI_ASSERTIONS_ENABLED
+	Bool m_inRebuild = false;
+#endif
+
+	U32 updateSlots(U32 begin, U32 end);
+};
+
+} // end namespace anki
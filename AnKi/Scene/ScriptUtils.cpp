@@ -103,7 +103,7 @@ void ScriptVariables::rebuildVarsFromLua(ScriptEnvironment& env)
 		}
 	} countCallbacks;
 
-	LuaBinder::visitGlobals(&env.getLuaState(), countCallbacks);
+	env.visitGlobals(countCallbacks);
 
 	std::sort(countCallbacks.m_names.getBegin(), countCallbacks.m_names.getEnd());
 
@@ -222,7 +222,7 @@ void ScriptVariables::rebuildVarsFromLua(ScriptEnvironment& env)
 		}
 	} callbacks(*this, countCallbacks.m_names);
 
-	LuaBinder::visitGlobals(&env.getLuaState(), callbacks);
+	env.visitGlobals(callbacks);
 }
 
 void ScriptVariables::flushDirtyVarsToLua(ScriptEnvironment& env)
@@ -320,7 +320,7 @@ void ScriptVariables::flushDirtyVarsToLua(ScriptEnvironment& env)
 		}
 	} callbacks(*this);
 
-	LuaBinder::visitGlobals(&env.getLuaState(), callbacks);
+	env.visitGlobals(callbacks);
 }
 
 void ScriptVariables::updateVarsFromLua(ScriptEnvironment& env)
@@ -409,7 +409,7 @@ void ScriptVariables::updateVarsFromLua(ScriptEnvironment& env)
 		}
 	} callbacks(*this);
 
-	LuaBinder::visitGlobals(&env.getLuaState(), callbacks);
+	env.visitGlobals(callbacks);
 }
 
 Error ScriptVariables::serialize(SceneSerializer& serializer, ScriptEnvironment& env)
@@ -63,7 +63,12 @@ public:
 private:
 	union Value
 	{
-		F64 m_number = 0.0;
+		Value()
+			: m_number(0.0)
+		{
+		}
+
+		F64 m_number;
 		Bool m_bool;
 		Char* m_string;
 		Vec2 m_vec2;
@@ -6,32 +6,73 @@
 #include <AnKi/Scene/SoftwareRasterizer.h>
 #include <AnKi/Collision/Aabb.h>
 #include <AnKi/Collision/Functions.h>
+#include <AnKi/Util/ThreadJobManager.h>
 #include <AnKi/Util/Tracer.h>
 
 namespace anki {
 
+// Added to the depth of the pixels a triangle doesn't cover. It pushes them to infinity without branches
+static constexpr F32 kUncoveredDepthScale = 1.0e30f;
+
 void SoftwareRasterizer::prepare(const Mat4& mv, const Mat4& p, U32 width, U32 height)
 {
+	ANKI_ASSERT(width > 0 && height > 0);
+
 	m_mv = mv;
 	m_p = p;
 	m_mvp = p * mv;
 
 	extractClipPlanes(p, m_planesL);
-	extractClipPlanes(m_mvp, m_planesW);
 
-	// Reset z buffer
-	ANKI_ASSERT(width > 0 && height > 0);
 	m_width = width;
 	m_height = height;
-	U32 size = width * height;
-	if(m_zbuffer.getSize() < size)
+	m_tileCountX = (width + kTileSize - 1) / kTileSize;
+	m_tileCountY = (height + kTileSize - 1) / kTileSize;
+	const U32 tileCount = m_tileCountX * m_tileCountY;
+
+	if(m_depth.getSize() < tileCount * kVec4sPerTile)
 	{
-		m_zbuffer.resize(size);
+		m_depth.resize(tileCount * kVec4sPerTile);
+		m_tileMaxDepth.resize(tileCount);
+		m_binOffsets.resize(tileCount + 1);
+	}
+
+	// Reset the depth. The pixels outside the screen are set to zero so they don't affect the max depth of the tiles
+	for(U32 ty = 0; ty < m_tileCountY; ++ty)
+	{
+		for(U32 tx = 0; tx < m_tileCountX; ++tx)
+		{
+			const U32 tileIdx = ty * m_tileCountX + tx;
+			const Bool edgeTile = (tx + 1) * kTileSize > width || (ty + 1) * kTileSize > height;
+			Vec4* tileDepth = &m_depth[tileIdx * kVec4sPerTile];
+
+			if(!edgeTile) [[likely]]
+			{
+				for(U32 i = 0; i < kVec4sPerTile; ++i)
+				{
+					tileDepth[i] = Vec4(1.0f);
+				}
+			}
+			else
+			{
+				for(U32 y = 0; y < kTileSize; ++y)
+				{
+					for(U32 x = 0; x < kTileSize; ++x)
+					{
+						const Bool inside = tx * kTileSize + x < width && ty * kTileSize + y < height;
+						tileDepth[y * (kTileSize / 4) + x / 4][x % 4] = (inside) ? 1.0f : 0.0f;
+					}
+				}
+			}
+
+			m_tileMaxDepth[tileIdx] = 1.0f;
+		}
 	}
-	memset(&m_zbuffer[0], 0xFF, sizeof(m_zbuffer[0]) * size);
+
+	m_triangleCount = 0;
 }
 
-void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& outVertCount) const
+void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U32& outVertCount) const
 {
 	ANKI_ASSERT(inVerts && outVerts);
 
@@ -40,8 +81,8 @@ void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& ou
 	ANKI_ASSERT(clipZ < 0.0);
 
 	Array<Bool, 3> vertInside;
-	U vertInsideCount = 0;
-	for(U i = 0; i < 3; ++i)
+	U32 vertInsideCount = 0;
+	for(U32 i = 0; i < 3; ++i)
 	{
 		vertInside[i] = inVerts[i].z < clipZ;
 		vertInsideCount += (vertInside[i]) ? 1 : 0;
@@ -62,7 +103,7 @@ void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& ou
 		break;
 	case 1:
 	{
-		U i, next, prev;
+		U32 i, next, prev;
 		if(vertInside[0])
 		{
 			i = 0;
@@ -107,7 +148,7 @@ void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& ou
 	}
 	case 2:
 	{
-		U in0, in1, out;
+		U32 in0, in1, out;
 		if(vertInside[0] && vertInside[1])
 		{
 			in0 = 0;
@@ -158,18 +199,103 @@ void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& ou
 	}
 }
 
-void SoftwareRasterizer::draw(const F32* verts, U vertCount, U stride, Bool backfaceCulling)
+Bool SoftwareRasterizer::setupTriangle(const Vec4* tri, Triangle& out) const
+{
+	ANKI_ASSERT(tri);
+
+	// To window space
+	const Vec2 windowSize{F32(m_width), F32(m_height)};
+	Array<Vec3, 3> window;
+	for(U32 i = 0; i < 3; i++)
+	{
+		const Vec3 ndc = tri[i].xyz / tri[i].w;
+		window[i] = Vec3((ndc.xy / 2.0f + 0.5f) * windowSize, ndc.z);
+	}
+
+	// Make it counter clockwise
+	F32 area = (window[1].x - window[0].x) * (window[2].y - window[0].y) - (window[2].x - window[0].x) * (window[1].y - window[0].y);
+	if(area < 0.0f)
+	{
+		std::swap(window[1], window[2]);
+		area = -area;
+	}
+
+	if(area < kEpsilonf)
+	{
+		// Degenerate
+		return false;
+	}
+
+	// Bounding box
+	const Vec3 bboxMin = window[0].min(window[1]).min(window[2]);
+	const Vec3 bboxMax = window[0].max(window[1]).max(window[2]);
+	out.m_bbox.x = U32(clamp(std::floor(bboxMin.x), 0.0f, windowSize.x));
+	out.m_bbox.y = U32(clamp(std::floor(bboxMin.y), 0.0f, windowSize.y));
+	out.m_bbox.z = U32(clamp(std::ceil(bboxMax.x), 0.0f, windowSize.x));
+	out.m_bbox.w = U32(clamp(std::ceil(bboxMax.y), 0.0f, windowSize.y));
+	if(out.m_bbox.x >= out.m_bbox.z || out.m_bbox.y >= out.m_bbox.w)
+	{
+		// Outside the screen
+		return false;
+	}
+
+	// Edge functions. They are positive inside the triangle
+	for(U32 i = 0; i < 3; ++i)
+	{
+		const Vec3& a = window[i];
+		const Vec3& b = window[(i + 1) % 3];
+		out.m_edgeA[i] = a.y - b.y;
+		out.m_edgeB[i] = b.x - a.x;
+		out.m_edgeC[i] = a.x * b.y - a.y * b.x;
+	}
+	out.m_edgeA.w = out.m_edgeB.w = out.m_edgeC.w = 0.0f;
+
+	// Depth plane. Move it back by half a pixel (in the worst direction) to get the max depth inside a pixel
+	const F32 dz1 = window[1].z - window[0].z;
+	const F32 dz2 = window[2].z - window[0].z;
+	const F32 a = (dz1 * (window[2].y - window[0].y) - dz2 * (window[1].y - window[0].y)) / area;
+	const F32 b = (dz2 * (window[1].x - window[0].x) - dz1 * (window[2].x - window[0].x)) / area;
+	const F32 c = window[0].z - a * window[0].x - b * window[0].y + 0.5f * (absolute(a) + absolute(b));
+	out.m_depthPlane = Vec4(a, b, c, 0.0f);
+
+	return true;
+}
+
+void SoftwareRasterizer::draw(const F32* verts, U32 vertCount, U32 stride, Bool backfaceCulling)
 {
 	ANKI_ASSERT(verts && vertCount > 0 && (vertCount % 3) == 0);
 	ANKI_ASSERT(stride >= sizeof(F32) * 3 && (stride % sizeof(F32)) == 0);
 
-	U floatStride = stride / sizeof(F32);
+	// Set up the triangles in batches and then append them to the shared array to avoid locking for every triangle
+	constexpr U32 kBatchSize = 64;
+	Array<Triangle, kBatchSize> batch;
+	U32 batchCount = 0;
+
+	auto flushBatch = [&]() {
+		if(batchCount == 0)
+		{
+			return;
+		}
+
+		LockGuard lock(m_trianglesMtx);
+
+		if(m_triangles.getSize() < m_triangleCount + batchCount)
+		{
+			m_triangles.resize(max(m_triangleCount + batchCount, m_triangles.getSize() * 2));
+		}
+
+		memcpy(&m_triangles[m_triangleCount], &batch[0], sizeof(Triangle) * batchCount);
+		m_triangleCount += batchCount;
+		batchCount = 0;
+	};
+
+	const U32 floatStride = stride / sizeof(F32);
 	const F32* vertsEnd = verts + vertCount * floatStride;
 	while(verts != vertsEnd)
 	{
 		// Convert triangle to view space
 		Array<Vec4, 3> triVspace;
-		for(U j = 0; j < 3; ++j)
+		for(U32 j = 0; j < 3; ++j)
 		{
 			triVspace[j] = m_mv * Vec4(verts[0], verts[1], verts[2], 1.0);
 			verts += floatStride;
@@ -190,7 +316,7 @@ void SoftwareRasterizer::draw(const F32* verts, U vertCount, U stride, Bool back
 
 		// Clip it
 		Array<Vec4, 6> clippedTrisVspace;
-		U clippedCount = 0;
+		U32 clippedCount = 0;
 		clipTriangle(&triVspace[0], &clippedTrisVspace[0], clippedCount);
 		if(clippedCount == 0)
 		{
@@ -198,94 +324,237 @@ void SoftwareRasterizer::draw(const F32* verts, U vertCount, U stride, Bool back
 			continue;
 		}
 
-		// Rasterize
+		// Set up
 		Array<Vec4, 3> clip;
-		for(U j = 0; j < clippedCount; j += 3)
+		for(U32 j = 0; j < clippedCount; j += 3)
 		{
-			for(U k = 0; k < 3; k++)
+			for(U32 k = 0; k < 3; k++)
 			{
 				clip[k] = m_p * clippedTrisVspace[j + k].xyz1;
 				ANKI_ASSERT(clip[k].w > 0.0f);
 			}
 
-			rasterizeTriangle(&clip[0]);
+			if(setupTriangle(&clip[0], batch[batchCount]))
+			{
+				++batchCount;
+				if(batchCount == kBatchSize)
+				{
+					flushBatch();
+				}
+			}
 		}
 	}
+
+	flushBatch();
 }
 
-Bool SoftwareRasterizer::computeBarycetrinc(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& p, Vec3& uvw) const
+void SoftwareRasterizer::drawBox(const Mat3x4& worldTransform)
 {
-	Vec2 dca = c - a;
-	Vec2 dba = b - a;
-	Vec2 dap = a - p;
-
-	Vec3 n(dca.x, dba.x, dap.x);
-	Vec3 m(dca.y, dba.y, dap.y);
+	// Every face is defined by its normal and 2 axes that give a counter-clockwise winding when viewed from outside
+	class Face
+	{
+	public:
+		Vec3 m_normal;
+		Vec3 m_u;
+		Vec3 m_v;
+	};
+
+	constexpr Array<Face, 6> kFaces = {{{Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f)},
+										{Vec3(-1.0f, 0.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f), Vec3(0.0f, 1.0f, 0.0f)},
+										{Vec3(0.0f, 1.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f), Vec3(1.0f, 0.0f, 0.0f)},
+										{Vec3(0.0f, -1.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f)},
+										{Vec3(0.0f, 0.0f, 1.0f), Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f)},
+										{Vec3(0.0f, 0.0f, -1.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f)}}};
+
+	// Skip the box if all its corners are outside the same clip plane. Cheaper than culling and clipping the 12 triangles
+	U32 outsideAll = kMaxU32;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		const Vec3 corner((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+		const Vec4 clip = m_mvp * (worldTransform * corner.xyz1).xyz1;
+
+		U32 outside = 0;
+		outside |= (clip.x < -clip.w) ? 1u << 0u : 0u;
+		outside |= (clip.x > clip.w) ? 1u << 1u : 0u;
+		outside |= (clip.y < -clip.w) ? 1u << 2u : 0u;
+		outside |= (clip.y > clip.w) ? 1u << 3u : 0u;
+		outside |= (clip.z < 0.0f) ? 1u << 4u : 0u;
+		outside |= (clip.z > clip.w) ? 1u << 5u : 0u;
+		outsideAll &= outside;
+	}
 
-	Vec3 k = n.cross(m);
+	if(outsideAll)
+	{
+		return;
+	}
 
-	Bool skip = false;
-	if(!isZero(k.z))
+	Array<Vec3, 36> verts;
+	U32 count = 0;
+	for(const Face& face : kFaces)
 	{
-		uvw = Vec3(1.0f - (k.x + k.y) / k.z, k.y / k.z, k.x / k.z);
+		const Array<Vec3, 4> corners = {
+			worldTransform * (face.m_normal - face.m_u - face.m_v).xyz1, worldTransform * (face.m_normal + face.m_u - face.m_v).xyz1,
+			worldTransform * (face.m_normal + face.m_u + face.m_v).xyz1, worldTransform * (face.m_normal - face.m_u + face.m_v).xyz1};
+
+		verts[count++] = corners[0];
+		verts[count++] = corners[1];
+		verts[count++] = corners[2];
+		verts[count++] = corners[0];
+		verts[count++] = corners[2];
+		verts[count++] = corners[3];
+	}
+
+	draw(&verts[0][0], verts.getSize(), sizeof(Vec3), true);
+}
+
+void SoftwareRasterizer::binTriangles()
+{
+	ANKI_TRACE_SCOPED_EVENT(SceneRasterizerBin);
 
-		if(uvw.x < 0.0f || uvw.y < 0.0f || uvw.z < 0.0f)
+	const U32 tileCount = m_tileCountX * m_tileCountY;
+
+	// Count the triangles of each tile
+	memset(&m_binOffsets[0], 0, sizeof(U32) * (tileCount + 1));
+	U32 binnedTriangleCount = 0;
+	for(U32 i = 0; i < m_triangleCount; ++i)
+	{
+		const UVec4& bbox = m_triangles[i].m_bbox;
+		for(U32 ty = bbox.y / kTileSize; ty <= (bbox.w - 1) / kTileSize; ++ty)
 		{
-			skip = true;
+			for(U32 tx = bbox.x / kTileSize; tx <= (bbox.z - 1) / kTileSize; ++tx)
+			{
+				++m_binOffsets[ty * m_tileCountX + tx + 1];
+				++binnedTriangleCount;
+			}
 		}
 	}
-	else
+
+	// Prefix sum
+	for(U32 i = 1; i <= tileCount; ++i)
+	{
+		m_binOffsets[i] += m_binOffsets[i - 1];
+	}
+
+	if(m_binnedTriangles.getSize() < binnedTriangleCount)
 	{
-		skip = true;
+		m_binnedTriangles.resize(binnedTriangleCount);
 	}
 
-	return skip;
+	// Fill the bins. It uses the offsets as cursors so it moves them one tile forward and then it moves them back
+	for(U32 i = 0; i < m_triangleCount; ++i)
+	{
+		const UVec4& bbox = m_triangles[i].m_bbox;
+		for(U32 ty = bbox.y / kTileSize; ty <= (bbox.w - 1) / kTileSize; ++ty)
+		{
+			for(U32 tx = bbox.x / kTileSize; tx <= (bbox.z - 1) / kTileSize; ++tx)
+			{
+				m_binnedTriangles[m_binOffsets[ty * m_tileCountX + tx]++] = i;
+			}
+		}
+	}
+
+	for(U32 i = tileCount; i > 0; --i)
+	{
+		m_binOffsets[i] = m_binOffsets[i - 1];
+	}
+	m_binOffsets[0] = 0;
 }
 
-void SoftwareRasterizer::rasterizeTriangle(const Vec4* tri)
+void SoftwareRasterizer::rasterizeTile(U32 tileX, U32 tileY)
 {
-	ANKI_ASSERT(tri);
+	const U32 tileIdx = tileY * m_tileCountX + tileX;
+	const U32 binBegin = m_binOffsets[tileIdx];
+	const U32 binEnd = m_binOffsets[tileIdx + 1];
+	if(binBegin == binEnd)
+	{
+		return;
+	}
 
-	const Vec2 windowSize{F32(m_width), F32(m_height)};
-	Array<Vec3, 3> ndc;
-	Array<Vec2, 3> window;
-	Vec2 bboxMin(kMaxF32), bboxMax(kMinF32);
-	for(U i = 0; i < 3; i++)
+	Vec4* tileDepth = &m_depth[tileIdx * kVec4sPerTile];
+	const U32 tileMinX = tileX * kTileSize;
+	const U32 tileMinY = tileY * kTileSize;
+	const Vec4 pixelOffsets(0.5f, 1.5f, 2.5f, 3.5f);
+
+	for(U32 i = binBegin; i < binEnd; ++i)
 	{
-		ndc[i] = tri[i].xyz / tri[i].w;
-		window[i] = (ndc[i].xy / 2.0f + 0.5f) * windowSize;
+		const Triangle& tri = m_triangles[m_binnedTriangles[i]];
+
+		// The part of the triangle's bounding box that is inside the tile. In groups of 4 pixels in the X axis
+		const U32 minY = max(tri.m_bbox.y, tileMinY) - tileMinY;
+		const U32 maxY = min(tri.m_bbox.w, tileMinY + kTileSize) - tileMinY;
+		const U32 minGroup = (max(tri.m_bbox.x, tileMinX) - tileMinX) / 4;
+		const U32 maxGroup = (min(tri.m_bbox.z, tileMinX + kTileSize) - tileMinX + 3) / 4;
 
-		for(U32 j = 0; j < 2; j++)
+		for(U32 y = minY; y < maxY; ++y)
 		{
-			bboxMin[j] = std::floor(min(bboxMin[j], window[i][j]));
-			bboxMin[j] = clamp(bboxMin[j], 0.0f, windowSize[j]);
+			const F32 py = F32(tileMinY + y) + 0.5f;
+			const Vec4 rowEdges = tri.m_edgeB * py + tri.m_edgeC;
+			const F32 rowDepth = tri.m_depthPlane.y * py + tri.m_depthPlane.z;
+
+			for(U32 group = minGroup; group < maxGroup; ++group)
+			{
+				const Vec4 px = Vec4(F32(tileMinX + group * 4)) + pixelOffsets;
 
-			bboxMax[j] = std::ceil(max(bboxMax[j], window[i][j]));
-			bboxMax[j] = clamp(bboxMax[j], 0.0f, windowSize[j]);
+				const Vec4 e0 = px * tri.m_edgeA.x + rowEdges.x;
+				const Vec4 e1 = px * tri.m_edgeA.y + rowEdges.y;
+				const Vec4 e2 = px * tri.m_edgeA.z + rowEdges.z;
+				const Vec4 coverage = e0.min(e1).min(e2); // Negative if the pixel is not covered
+
+				const Vec4 depth = px * tri.m_depthPlane.x + rowDepth + (-coverage).max(0.0f) * kUncoveredDepthScale;
+
+				Vec4& dst = tileDepth[y * (kTileSize / 4) + group];
+				dst = dst.min(depth);
+			}
 		}
 	}
 
-	for(F32 y = bboxMin.y + 0.5f; y < bboxMax.y + 0.5f; y += 1.0f)
+	computeTileMaxDepth(tileIdx);
+}
+
+void SoftwareRasterizer::computeTileMaxDepth(U32 tileIdx)
+{
+	const Vec4* tileDepth = &m_depth[tileIdx * kVec4sPerTile];
+	Vec4 maxDepth(0.0f);
+	for(U32 i = 0; i < kVec4sPerTile; ++i)
 	{
-		for(F32 x = bboxMin.x + 0.5f; x < bboxMax.x + 0.5f; x += 1.0f)
-		{
-			Vec2 p(x, y);
-			Vec3 bc;
-			if(!computeBarycetrinc(window[0], window[1], window[2], p, bc))
-			{
-				const F32 z0 = ndc[0].z;
-				const F32 z1 = ndc[1].z;
-				const F32 z2 = ndc[2].z;
+		maxDepth = maxDepth.max(tileDepth[i]);
+	}
 
-				F32 depth = z0 * bc[0] + z1 * bc[1] + z2 * bc[2];
-				ANKI_ASSERT(depth >= 0.0 && depth <= 1.0);
+	m_tileMaxDepth[tileIdx] = max(max(maxDepth.x, maxDepth.y), max(maxDepth.z, maxDepth.w));
+}
+
+void SoftwareRasterizer::rasterize(ThreadJobManager* jobManager)
+{
+	ANKI_TRACE_SCOPED_EVENT(SceneRasterizerRasterize);
+
+	if(m_triangleCount == 0)
+	{
+		return;
+	}
 
-				// Clamp it to a bit less that 1.0f because 1.0f will produce a 0 depthi
-				depth = min(depth, 1.0f - kEpsilonf);
+	binTriangles();
+
+	if(jobManager)
+	{
+		for(U32 ty = 0; ty < m_tileCountY; ++ty)
+		{
+			jobManager->dispatchTask([this, ty]([[maybe_unused]] U32 tid) {
+				for(U32 tx = 0; tx < m_tileCountX; ++tx)
+				{
+					rasterizeTile(tx, ty);
+				}
+			});
+		}
 
-				// Store the min of the current value and new one
-				const U32 depthi = U32(depth * F32(kMaxU32));
-				m_zbuffer[U32(y) * m_width + U32(x)].min(depthi);
+		jobManager->waitForAllTasksToFinish();
+	}
+	else
+	{
+		for(U32 ty = 0; ty < m_tileCountY; ++ty)
+		{
+			for(U32 tx = 0; tx < m_tileCountX; ++tx)
+			{
+				rasterizeTile(tx, ty);
 			}
 		}
 	}
@@ -294,13 +563,7 @@ void SoftwareRasterizer::rasterizeTriangle(const Vec4* tri)
 Bool SoftwareRasterizer::visibilityTest(const Aabb& aabb) const
 {
 	ANKI_TRACE_SCOPED_EVENT(SceneRasterizerTest);
-	Bool inside = visibilityTestInternal(aabb);
-
-	return inside;
-}
 
-Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
-{
 	// Set the AABB points
 	const Vec4& minv = aabb.getMin();
 	const Vec4& maxv = aabb.getMax();
@@ -314,27 +577,19 @@ Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
 	boxPoints[6] = Vec4(maxv.x, minv.y, minv.z, 1.0f);
 	boxPoints[7] = Vec4(maxv.x, maxv.y, minv.z, 1.0f);
 
-	// Transform points
+	// Compute the min and max bounds
+	Vec4 bboxMin(kMaxF32);
+	Vec4 bboxMax(kMinF32);
 	for(Vec4& p : boxPoints)
 	{
 		p = m_mvp * p;
-	}
 
-	// Check of a point touches the near plane
-	for(const Vec4& p : boxPoints)
-	{
 		if(p.w <= 0.0f)
 		{
-			// Don't bother clipping. Just mark it as visible.
+			// Touches the near plane. Don't bother clipping. Just mark it as visible.
 			return true;
 		}
-	}
 
-	// Compute the min and max bounds
-	Vec4 bboxMin(kMaxF32);
-	Vec4 bboxMax(kMinF32);
-	for(Vec4& p : boxPoints)
-	{
 		// Perspecrive divide
 		p /= p.w;
 
@@ -345,38 +600,46 @@ Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
 		// To [0, m_width|m_height]
 		p *= Vec4(F32(m_width), F32(m_height), 1.0f, 1.0f);
 
-		// Min
 		bboxMin = bboxMin.min(p);
-
-		// Max
 		bboxMax = bboxMax.max(p);
 	}
 
 	// Fix the bounds
-	bboxMin.x = floorf(bboxMin.x);
-	bboxMin.x = clamp(bboxMin.x, 0.0f, F32(m_width));
-
-	bboxMax.x = ceilf(bboxMax.x);
-	bboxMax.x = clamp(bboxMax.x, 0.0f, F32(m_width));
-
-	bboxMin.y = floorf(bboxMin.y);
-	bboxMin.y = clamp(bboxMin.y, 0.0f, F32(m_height));
-
-	bboxMax.y = ceilf(bboxMax.y);
-	bboxMax.y = clamp(bboxMax.y, 0.0f, F32(m_height));
+	const U32 minX = U32(clamp(std::floor(bboxMin.x), 0.0f, F32(m_width)));
+	const U32 maxX = U32(clamp(std::ceil(bboxMax.x), 0.0f, F32(m_width)));
+	const U32 minY = U32(clamp(std::floor(bboxMin.y), 0.0f, F32(m_height)));
+	const U32 maxY = U32(clamp(std::ceil(bboxMax.y), 0.0f, F32(m_height)));
+	if(minX >= maxX || minY >= maxY)
+	{
+		// Outside the screen
+		return true;
+	}
 
-	// Loop the tiles
-	F32 minZ = bboxMin.z;
-	for(F32 y = bboxMin.y; y < bboxMax.y; y += 1.0f)
+	// Test the tiles first and the pixels only if the tile is not enough
+	const F32 minZ = bboxMin.z;
+	for(U32 ty = minY / kTileSize; ty <= (maxY - 1) / kTileSize; ++ty)
 	{
-		for(F32 x = bboxMin.x; x < bboxMax.x; x += 1.0f)
+		for(U32 tx = minX / kTileSize; tx <= (maxX - 1) / kTileSize; ++tx)
 		{
-			const U32 idx = U32(y) * m_width + U32(x);
-			const U32 depthi = m_zbuffer[idx].getNonAtomically();
-			const F32 depthf = F32(depthi) / F32(kMaxU32);
-			if(minZ < depthf)
+			if(minZ > m_tileMaxDepth[ty * m_tileCountX + tx])
 			{
-				return true;
+				// The whole tile is in front
+				continue;
+			}
+
+			const U32 tileMinY = max(minY, ty * kTileSize);
+			const U32 tileMaxY = min(maxY, (ty + 1) * kTileSize);
+			const U32 tileMinX = max(minX, tx * kTileSize);
+			const U32 tileMaxX = min(maxX, (tx + 1) * kTileSize);
+			for(U32 y = tileMinY; y < tileMaxY; ++y)
+			{
+				for(U32 x = tileMinX; x < tileMaxX; ++x)
+				{
+					if(minZ <= getPixelDepth(x, y))
+					{
+						return true;
+					}
+				}
 			}
 		}
 	}
@@ -386,18 +649,24 @@ Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
 
 void SoftwareRasterizer::fillDepthBuffer(ConstWeakArray<F32> depthValues)
 {
-	ANKI_ASSERT(m_zbuffer.getSize() == depthValues.getSize());
+	ANKI_ASSERT(depthValues.getSize() == m_width * m_height);
 
-	U32 count = depthValues.getSize();
-	while(count--)
+	for(U32 y = 0; y < m_height; ++y)
 	{
-		F32 depth = depthValues[count];
-		ANKI_ASSERT(depth >= 0.0f && depth <= 1.0f);
+		for(U32 x = 0; x < m_width; ++x)
+		{
+			const F32 depth = depthValues[y * m_width + x];
+			ANKI_ASSERT(depth >= 0.0f && depth <= 1.0f);
 
-		depth = min(depth, 1.0f - kEpsilonf); // See a few lines above why is that
+			const U32 tileIdx = (y / kTileSize) * m_tileCountX + x / kTileSize;
+			const U32 vecIdx = tileIdx * kVec4sPerTile + (y % kTileSize) * (kTileSize / 4) + (x % kTileSize) / 4;
+			m_depth[vecIdx][x % 4] = depth;
+		}
+	}
 
-		const U32 depthi = U32(depth * F32(kMaxU32));
-		m_zbuffer[count].setNonAtomically(depthi);
+	for(U32 i = 0; i < m_tileCountX * m_tileCountY; ++i)
+	{
+		computeTileMaxDepth(i);
 	}
 }
 
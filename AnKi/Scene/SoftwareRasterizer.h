@@ -9,55 +9,114 @@
 #include <AnKi/Math.h>
 #include <AnKi/Collision/Plane.h>
 #include <AnKi/Util/WeakArray.h>
+#include <AnKi/Util/Thread.h>
 
 namespace anki {
 
+// Forward
+class ThreadJobManager;
+
 /// @addtogroup scene
 /// @{
 
-/// Software rasterizer for visibility tests.
+/// Tiled software rasterizer for occlusion tests. The screen is split into tiles and every tile keeps the max depth of its pixels. That is a
+/// conservative hierarchical depth buffer that lets most visibility tests finish without touching the pixels. Rendering happens in 2 steps:
+/// draw() transforms, clips and sets up the triangles and rasterize() bins them to tiles and rasterizes the tiles in parallel. The inner loops
+/// work on 4 pixels at a time using Vec4 so they go through the SIMD paths of the math library.
+/// A pixel is covered if the triangle covers its center, like the GPUs do. The written depth is the max depth of the triangle inside the pixel so
+/// an occluder doesn't hide things that are slightly in front of it.
 class SoftwareRasterizer
 {
 public:
-	/// Prepare for rendering. Call it before every draw.
+	static constexpr U32 kTileSize = 16; ///< The tiles are kTileSize x kTileSize pixels.
+
+	/// Prepare for rendering. Call it before every frame.
 	void prepare(const Mat4& mv, const Mat4& p, U32 width, U32 height);
 
-	/// Render some verts.
+	/// Transform, clip and set up some triangles. They will be rasterized on rasterize().
 	/// @param[in] verts Pointer to the first vertex to draw.
 	/// @param vertCount The number of verts to draw.
 	/// @param stride The stride (in bytes) of the next vertex.
 	/// @param backfaceCulling If true it will do backface culling.
 	/// @note It's thread-safe against other draw() invocations only.
-	void draw(const F32* verts, U vertCount, U stride, Bool backfaceCulling);
+	void draw(const F32* verts, U32 vertCount, U32 stride, Bool backfaceCulling);
+
+	/// Draw the [-1, 1] cube transformed by some matrix. Same as draw().
+	void drawBox(const Mat3x4& worldTransform);
+
+	/// Bin and rasterize the triangles of draw(). Every row of tiles is a separate task.
+	/// @param jobManager The threads to use. If it's nullptr it will rasterize in the calling thread.
+	void rasterize(ThreadJobManager* jobManager);
 
 	/// Fill the depth buffer with some values.
 	void fillDepthBuffer(ConstWeakArray<F32> depthValues);
 
-	/// Perform visibility tests.
-	/// @param aabb The Aabb in of the cs in world space.
-	/// @return Return true if it's visible and false otherwise.
+	/// Perform visibility tests. Call it after rasterize().
+	/// @param aabb The Aabb in world space.
+	/// @return Return true if it's visible and false otherwise. Objects outside the screen are considered visible since it doesn't do frustum
+	///         culling.
+	/// @note It's thread-safe.
 	Bool visibilityTest(const Aabb& aabb) const;
 
+	/// The number of triangles that survived culling and clipping since the last prepare().
+	U32 getTriangleCount() const
+	{
+		return m_triangleCount;
+	}
+
 private:
+	class Triangle
+	{
+	public:
+		Vec4 m_edgeA; ///< The x coefficients of the 3 edge functions.
+		Vec4 m_edgeB; ///< The y coefficients of the 3 edge functions.
+		Vec4 m_edgeC; ///< The constants of the 3 edge functions.
+		Vec4 m_depthPlane; ///< depth = x * a + y * b + c. Biased to give the max depth inside a pixel.
+		UVec4 m_bbox; ///< The pixel bounds. Min x, min y, max x, max y (exclusive).
+	};
+
+	static constexpr U32 kVec4sPerTile = kTileSize * kTileSize / 4;
+
 	Mat4 m_mv; ///< ModelView.
 	Mat4 m_p; ///< Projection.
 	Mat4 m_mvp;
 	Array<Plane, 6> m_planesL; ///< In view space.
-	Array<Plane, 6> m_planesW; ///< In world space.
-	U32 m_width;
-	U32 m_height;
-	SceneDynamicArray<Atomic<U32>> m_zbuffer;
+	U32 m_width = 0;
+	U32 m_height = 0;
+	U32 m_tileCountX = 0;
+	U32 m_tileCountY = 0;
 
-	/// @param tri In clip space.
-	void rasterizeTriangle(const Vec4* tri);
+	SceneDynamicArray<Vec4> m_depth; ///< Stored tile by tile. Every Vec4 holds 4 horizontally adjacent pixels.
+	SceneDynamicArray<F32> m_tileMaxDepth;
+
+	SceneDynamicArray<Triangle> m_triangles; ///< It never shrinks. The valid triangles are m_triangleCount.
+	U32 m_triangleCount = 0;
+	SpinLock m_trianglesMtx;
 
-	Bool computeBarycetrinc(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& p, Vec3& uvw) const;
+	SceneDynamicArray<U32> m_binOffsets; ///< Where the triangles of each tile start in m_binnedTriangles.
+	SceneDynamicArray<U32> m_binnedTriangles;
 
 	/// Clip triangle in the near plane.
 	/// @note Triangles in view space.
-	void clipTriangle(const Vec4* inTriangle, Vec4* outTriangles, U& outTriangleCount) const;
+	void clipTriangle(const Vec4* inTriangle, Vec4* outTriangles, U32& outTriangleCount) const;
+
+	/// Compute the triangle's edge functions and depth plane.
+	/// @param tri In clip space.
+	/// @return False if it's not visible.
+	Bool setupTriangle(const Vec4* tri, Triangle& out) const;
+
+	void binTriangles();
+
+	void rasterizeTile(U32 tileX, U32 tileY);
+
+	void computeTileMaxDepth(U32 tileIdx);
 
-	Bool visibilityTestInternal(const Aabb& aabb) const;
+	F32 getPixelDepth(U32 x, U32 y) const
+	{
+		const U32 tileIdx = (y / kTileSize) * m_tileCountX + x / kTileSize;
+		const U32 vecIdx = tileIdx * kVec4sPerTile + (y % kTileSize) * (kTileSize / 4) + (x % kTileSize) / 4;
+		return m_depth[vecIdx][x % 4];
+	}
 };
 /// @}
 
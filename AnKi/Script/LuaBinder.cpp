@@ -121,6 +121,88 @@ Error LuaBinder::evalString(lua_State* state, const CString& str)
 	return err;
 }
 
+Error LuaBinder::evalChunk(lua_State* state, ConstWeakArray<U8, PtrSize> chunk, CString chunkName, I32 envTableRef, Bool textOnly)
+{
+	ANKI_TRACE_SCOPED_EVENT(LuaExec);
+
+	[[maybe_unused]] const I topBefore = lua_gettop(state);
+
+	if(luaL_loadbufferx(state, reinterpret_cast<const char*>(chunk.getBegin()), chunk.getSize(), chunkName.cstr(), (textOnly) ? "t" : "bt"))
+	{
+		ANKI_SCRIPT_LOGE("%s", lua_tostring(state, -1));
+		lua_pop(state, 1);
+		return Error::kUserData;
+	}
+
+	if(envTableRef != LUA_NOREF)
+	{
+		// The first upvalue of a main chunk is its _ENV. Replace it with the environment table
+		pushEnvironmentTable(state, envTableRef);
+		lua_setupvalue(state, -2, 1);
+	}
+
+	if(lua_pcall(state, 0, 0, 0))
+	{
+		ANKI_SCRIPT_LOGE("%s", lua_tostring(state, -1));
+		lua_pop(state, 1);
+		return Error::kUserData;
+	}
+
+	ANKI_ASSERT(lua_gettop(state) == topBefore && "Lua stack is unbalanced");
+	return Error::kNone;
+}
+
+static int luaBytecodeWriter([[maybe_unused]] lua_State* l, const void* data, size_t size, void* userData)
+{
+	ScriptDynamicArray<U8>& bytecode = *static_cast<ScriptDynamicArray<U8>*>(userData);
+	const U32 offset = bytecode.getSize();
+	bytecode.resize(offset + U32(size));
+	memcpy(&bytecode[offset], data, size);
+	return 0;
+}
+
+Error LuaBinder::compileToBytecode(CString source, CString chunkName, ScriptDynamicArray<U8>& bytecode)
+{
+	ANKI_TRACE_SCOPED_EVENT(LuaCompile);
+
+	// Use a bare state so it can run in any thread. The allocator doesn't need a binder
+	lua_State* l = lua_newstate(luaAllocCallback, &ScriptMemoryPool::getSingleton());
+	if(!l)
+	{
+		ANKI_SCRIPT_LOGE("lua_newstate() failed");
+		return Error::kOutOfMemory;
+	}
+
+	Error err = Error::kNone;
+	if(luaL_loadbufferx(l, source.cstr(), source.getLength(), chunkName.cstr(), "t"))
+	{
+		ANKI_SCRIPT_LOGE("%s", lua_tostring(l, -1));
+		err = Error::kUserData;
+	}
+	else
+	{
+		bytecode.destroy();
+		if(lua_dump(l, luaBytecodeWriter, &bytecode))
+		{
+			ANKI_SCRIPT_LOGE("lua_dump() failed");
+			err = Error::kFunctionFailed;
+		}
+	}
+
+	lua_close(l);
+	return err;
+}
+
+I32 LuaBinder::createEnvironmentTable(lua_State* state)
+{
+	lua_newtable(state); // push env
+	lua_newtable(state); // push metatable
+	lua_pushglobaltable(state); // push
+	lua_setfield(state, -2, "__index"); // pop: metatable.__index = globals
+	lua_setmetatable(state, -2); // pop metatable
+	return luaL_ref(state, LUA_REGISTRYINDEX); // pop env
+}
+
 void LuaBinder::createClass(lua_State* l, const LuaUserDataTypeInfo* typeInfo)
 {
 	ANKI_ASSERT(typeInfo);
@@ -284,13 +366,13 @@ Error LuaBinder::checkArgsCount(lua_State* l, const Char* file, U32 line, const
 	return Error::kNone;
 }
 
-void LuaBinder::visitGlobals(lua_State* l, LuaBinderVisitGlobalsCallbacks& callbacks)
+void LuaBinder::visitGlobals(lua_State* l, LuaBinderVisitGlobalsCallbacks& callbacks, I32 envTableRef)
 {
 	ANKI_ASSERT(l);
 
 	[[maybe_unused]] const I topBefore = lua_gettop(l); // For validation
 
-	lua_pushglobaltable(l);
+	pushEnvironmentTable(l, envTableRef);
 	const I32 globalsTableIdx = lua_gettop(l); // Absolute index, robust no matter what's pushed later
 	lua_pushnil(l);
 
@@ -362,19 +444,19 @@ void LuaBinder::visitGlobals(lua_State* l, LuaBinderVisitGlobalsCallbacks& callb
 		lua_pop(l, 1); // Pop the value, keep the key for the next lua_next
 	}
 
-	// lua_next popped the last key but lua_pushglobaltable's table is still on the stack, pop it
+	// lua_next popped the last key but the globals table is still on the stack, pop it
 	lua_pop(l, 1);
 
 	ANKI_ASSERT(lua_gettop(l) == topBefore && "Lua stack is unbalanced");
 }
 
-void LuaBinder::serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback& callback)
+void LuaBinder::serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback& callback, I32 envTableRef)
 {
 	ANKI_ASSERT(l);
 
 	[[maybe_unused]] const I topBefore = lua_gettop(l); // For validation
 
-	lua_pushglobaltable(l);
+	pushEnvironmentTable(l, envTableRef);
 	lua_pushnil(l);
 
 	while(lua_next(l, -2) != 0)
@@ -475,18 +557,21 @@ void LuaBinder::serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback
 		lua_pop(l, 1); // Pop the value, keep the key for the next lua_next
 	}
 
-	// lua_next popped the last key but lua_pushglobaltable's table is still on the stack, pop it
+	// lua_next popped the last key but the globals table is still on the stack, pop it
 	lua_pop(l, 1);
 
 	ANKI_ASSERT(lua_gettop(l) == topBefore && "Lua stack is unbalanced");
 }
 
-void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataSize)
+void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataSize, I32 envTableRef)
 {
 	ANKI_ASSERT(dataSize > 0 && data);
 	const U8* ptr = static_cast<const U8*>(data);
 	const U8* end = ptr + dataSize;
 
+	pushEnvironmentTable(l, envTableRef);
+	const I32 globalsTableIdx = lua_gettop(l);
+
 	while(ptr < end)
 	{
 		// Get name
@@ -506,7 +591,7 @@ void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataS
 			const F64 val = *reinterpret_cast<const F64*>(ptr);
 			ptr += sizeof(F64);
 			lua_pushnumber(l, val);
-			lua_setglobal(l, name.cstr());
+			lua_setfield(l, globalsTableIdx, name.cstr());
 			break;
 		}
 		case LUA_TSTRING:
@@ -516,7 +601,7 @@ void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataS
 			ptr += len + 1;
 			ANKI_ASSERT(len > 0);
 			lua_pushstring(l, val.cstr());
-			lua_setglobal(l, name.cstr());
+			lua_setfield(l, globalsTableIdx, name.cstr());
 			break;
 		}
 		case LUA_TUSERDATA:
@@ -545,12 +630,14 @@ void LuaBinder::deserializeGlobals(lua_State* l, const void* data, PtrSize dataS
 			typeInfo->m_deserializeCallback(ptr, *userData);
 			ptr += dataSize;
 			luaL_setmetatable(l, typeInfo->m_typeName);
-			lua_setglobal(l, name.cstr());
+			lua_setfield(l, globalsTableIdx, name.cstr());
 
 			break;
 		}
 		}
 	}
+
+	lua_pop(l, 1);
 }
 
 U64 LuaBinder::computeFunctionArgumentSignature(lua_State* l)
@@ -11,6 +11,7 @@
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/Functions.h>
 #include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/WeakArray.h>
 #include <Lua/lua.hpp>
 #ifndef ANKI_LUA_HPP
 #	error "Wrong LUA header included"
@@ -163,15 +164,14 @@ public:
 		return m_l;
 	}
 
-	// Expose a variable to the lua state
+	// Expose a variable to the lua state. If envTableRef is not LUA_NOREF the variable goes to that environment table instead of the globals
 	template<typename T>
-	static void exposeVariable(lua_State* state, CString name, T* y)
+	static void exposeVariable(lua_State* state, CString name, T* y, I32 envTableRef = LUA_NOREF)
 	{
-		void* ptr = lua_newuserdata(state, sizeof(LuaUserData));
-		LuaUserData* ud = static_cast<LuaUserData*>(ptr);
-		ud->initPointed(&LuaUserData::getDataTypeInfoFor<T>(), y);
-		luaL_setmetatable(state, LuaUserData::getDataTypeInfoFor<T>().m_typeName);
-		lua_setglobal(state, name.cstr());
+		pushEnvironmentTable(state, envTableRef);
+		pushVariableToTheStack(state, y);
+		lua_setfield(state, -2, name.cstr());
+		lua_pop(state, 1);
 	}
 
 	template<typename T>
@@ -186,11 +186,47 @@ public:
 	// Evaluate a string
 	static Error evalString(lua_State* state, const CString& str);
 
+	// Load and run a chunk of LUA text or bytecode. If envTableRef is not LUA_NOREF the globals of the chunk will be resolved in that table. If
+	// textOnly is true bytecode is rejected. Use it for strings that don't come from the engine since LUA doesn't verify bytecode
+	static Error evalChunk(lua_State* state, ConstWeakArray<U8, PtrSize> chunk, CString chunkName, I32 envTableRef = LUA_NOREF,
+						   Bool textOnly = false);
+
+	// Compile LUA text to bytecode that can be passed to evalChunk(). It's thread-safe
+	static Error compileToBytecode(CString source, CString chunkName, ScriptDynamicArray<U8>& bytecode);
+
+	static Bool isBytecode(ConstWeakArray<U8, PtrSize> chunk)
+	{
+		return chunk.getSize() >= sizeof(LUA_SIGNATURE) - 1 && memcmp(chunk.getBegin(), LUA_SIGNATURE, sizeof(LUA_SIGNATURE) - 1) == 0;
+	}
+
+	// Create a table that falls back to the globals for reading. Scripts that run in it will write their globals to it. Returns a registry
+	// reference to the table
+	static I32 createEnvironmentTable(lua_State* state);
+
+	// Push the table of an environment or the globals if envTableRef is LUA_NOREF
+	static void pushEnvironmentTable(lua_State* state, I32 envTableRef)
+	{
+		if(envTableRef == LUA_NOREF)
+		{
+			lua_pushglobaltable(state);
+		}
+		else
+		{
+			lua_rawgeti(state, LUA_REGISTRYINDEX, envTableRef);
+		}
+	}
+
 	static void garbageCollect(lua_State* state)
 	{
 		lua_gc(state, LUA_GCCOLLECT, 0);
 	}
 
+	// Do a single incremental step of the garbage collector. Returns true if the step finished a collection cycle
+	static Bool garbageCollectStep(lua_State* state)
+	{
+		return lua_gc(state, LUA_GCSTEP, 0) != 0;
+	}
+
 	// For debugging purposes
 	static void stackDump(lua_State* l);
 
@@ -206,14 +242,14 @@ public:
 	// Add a new function.
 	static void pushLuaCFunc(lua_State* l, const char* name, lua_CFunction luafunc);
 
-	// Dump global variables.
-	static void serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback& callback);
+	// Dump global variables. If envTableRef is not LUA_NOREF dump the variables of that environment table instead.
+	static void serializeGlobals(lua_State* l, LuaBinderSerializeGlobalsCallback& callback, I32 envTableRef = LUA_NOREF);
 
-	// Deserialize global variables.
-	static void deserializeGlobals(lua_State* l, const void* data, PtrSize dataSize);
+	// Deserialize global variables. If envTableRef is not LUA_NOREF deserialize to that environment table instead.
+	static void deserializeGlobals(lua_State* l, const void* data, PtrSize dataSize, I32 envTableRef = LUA_NOREF);
 
-	// Visit global variables
-	static void visitGlobals(lua_State* l, LuaBinderVisitGlobalsCallbacks& callbacks);
+	// Visit global variables. If envTableRef is not LUA_NOREF visit the variables of that environment table instead.
+	static void visitGlobals(lua_State* l, LuaBinderVisitGlobalsCallbacks& callbacks, I32 envTableRef = LUA_NOREF);
 
 	// Make sure that the arguments match the argsCount number
 	static Error checkArgsCount(lua_State* l, const Char* file, U32 line, const Char* func, I argsCount);
@@ -0,0 +1,128 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Script/ScriptEnvironment.h>
+#include <AnKi/Script/ScriptManager.h>
+
+namespace anki {
+
+ScriptEnvironment::ScriptEnvironment(Bool sharedState)
+{
+	if(sharedState)
+	{
+		ScriptManager& manager = ScriptManager::getSingleton();
+		LockGuard lock(manager);
+		m_l = manager.getLuaBinder().getLuaState();
+		m_envTableRef = LuaBinder::createEnvironmentTable(m_l);
+	}
+	else
+	{
+		m_binder = newInstance<LuaBinder>(ScriptMemoryPool::getSingleton());
+		m_l = m_binder->getLuaState();
+
+		if(ScriptManager::isAllocated())
+		{
+			ScriptManager::getSingleton().registerLuaState(m_l);
+		}
+	}
+}
+
+ScriptEnvironment::~ScriptEnvironment()
+{
+	if(m_binder)
+	{
+		if(ScriptManager::isAllocated())
+		{
+			ScriptManager::getSingleton().unregisterLuaState(m_l);
+		}
+
+		// The refs die with the state
+		m_functionRefs.destroy();
+		deleteInstance(ScriptMemoryPool::getSingleton(), m_binder);
+	}
+	else
+	{
+		LockGuard lock(*this);
+		for(I32 ref : m_functionRefs)
+		{
+			luaL_unref(m_l, LUA_REGISTRYINDEX, ref);
+		}
+		m_functionRefs.destroy();
+
+		luaL_unref(m_l, LUA_REGISTRYINDEX, m_envTableRef);
+	}
+}
+
+void ScriptEnvironment::lock()
+{
+	if(isSharedState())
+	{
+		ScriptManager::getSingleton().lock();
+	}
+}
+
+void ScriptEnvironment::unlock()
+{
+	if(isSharedState())
+	{
+		ScriptManager::getSingleton().unlock();
+	}
+}
+
+Error ScriptEnvironment::evalString(const CString& str)
+{
+	LockGuard lock(*this);
+	return LuaBinder::evalChunk(m_l, ConstWeakArray<U8, PtrSize>(reinterpret_cast<const U8*>(str.cstr()), str.getLength()), str, m_envTableRef, true);
+}
+
+Error ScriptEnvironment::evalBytecode(ConstWeakArray<U8, PtrSize> bytecode, CString chunkName)
+{
+	LockGuard lock(*this);
+	return LuaBinder::evalChunk(m_l, bytecode, chunkName, m_envTableRef);
+}
+
+void ScriptEnvironment::serializeGlobals(LuaBinderSerializeGlobalsCallback& callback)
+{
+	LockGuard lock(*this);
+	LuaBinder::serializeGlobals(m_l, callback, m_envTableRef);
+}
+
+void ScriptEnvironment::deserializeGlobals(const void* data, PtrSize dataSize)
+{
+	LockGuard lock(*this);
+	LuaBinder::deserializeGlobals(m_l, data, dataSize, m_envTableRef);
+}
+
+void ScriptEnvironment::visitGlobals(LuaBinderVisitGlobalsCallbacks& callbacks)
+{
+	LockGuard lock(*this);
+	LuaBinder::visitGlobals(m_l, callbacks, m_envTableRef);
+}
+
+I32 ScriptEnvironment::getFunctionReference(CString name)
+{
+	LockGuard lock(*this);
+
+	// Raw get because a shared environment shouldn't pick the functions of the globals
+	LuaBinder::pushEnvironmentTable(m_l, m_envTableRef);
+	lua_pushstring(m_l, name.cstr());
+	lua_rawget(m_l, -2);
+
+	I32 ref = LUA_NOREF;
+	if(lua_isfunction(m_l, -1))
+	{
+		ref = luaL_ref(m_l, LUA_REGISTRYINDEX); // Pops the function
+		m_functionRefs.emplaceBack(ref);
+	}
+	else
+	{
+		lua_pop(m_l, 1);
+	}
+
+	lua_pop(m_l, 1); // Pop the env table
+	return ref;
+}
+
+} // end namespace anki
@@ -9,44 +9,74 @@
 
 namespace anki {
 
-// A sandboxed LUA environment.
+// A sandboxed LUA environment. It either owns a LUA state or it's a table in the global LUA state of the ScriptManager.
 class ScriptEnvironment
 {
 public:
 	ANKI_NON_COPYABLE(ScriptEnvironment)
 
-	ScriptEnvironment() = default;
+	ScriptEnvironment()
+		: ScriptEnvironment(false)
+	{
+	}
+
+	// sharedState: If true the environment is a table in the global LUA state. The globals of the scripts go to that table and the rest of
+	// the globals are visible to the scripts. Much cheaper than a LUA state but all shared environments need to run serially.
+	explicit ScriptEnvironment(Bool sharedState);
+
+	~ScriptEnvironment();
 
 	// Expose a variable to the scripting engine.
 	template<typename T>
 	void exposeVariable(const char* name, T* y)
 	{
-		LuaBinder::exposeVariable<T>(m_thread.getLuaState(), name, y);
+		LockGuard lock(*this);
+		LuaBinder::exposeVariable<T>(m_l, name, y, m_envTableRef);
 	}
 
 	// Evaluate a string
-	Error evalString(const CString& str)
-	{
-		return LuaBinder::evalString(m_thread.getLuaState(), str);
-	}
+	Error evalString(const CString& str);
+
+	// Evaluate bytecode that came from LuaBinder::compileToBytecode(). Text works as well
+	Error evalBytecode(ConstWeakArray<U8, PtrSize> bytecode, CString chunkName);
 
-	void serializeGlobals(LuaBinderSerializeGlobalsCallback& callback)
+	void serializeGlobals(LuaBinderSerializeGlobalsCallback& callback);
+
+	void deserializeGlobals(const void* data, PtrSize dataSize);
+
+	void visitGlobals(LuaBinderVisitGlobalsCallbacks& callbacks);
+
+	// Get a registry reference to a function the script defined. Returns LUA_NOREF if there is no such function. Use the reference with
+	// pushFunction(). It's valid while the environment is alive.
+	I32 getFunctionReference(CString name);
+
+	// Push to the stack a function of getFunctionReference().
+	void pushFunction(I32 ref)
 	{
-		LuaBinder::serializeGlobals(m_thread.getLuaState(), callback);
+		ANKI_ASSERT(ref != LUA_NOREF);
+		lua_rawgeti(m_l, LUA_REGISTRYINDEX, ref);
 	}
 
-	void deserializeGlobals(const void* data, PtrSize dataSize)
+	// Lock the LUA state. Hold it while accessing the state directly. It's recursive.
+	void lock();
+
+	void unlock();
+
+	Bool isSharedState() const
 	{
-		LuaBinder::deserializeGlobals(m_thread.getLuaState(), data, dataSize);
+		return m_envTableRef != LUA_NOREF;
 	}
 
 	lua_State& getLuaState()
 	{
-		return *m_thread.getLuaState();
+		return *m_l;
 	}
 
 private:
-	LuaBinder m_thread;
+	LuaBinder* m_binder = nullptr; // Not null if it owns the state
+	lua_State* m_l = nullptr;
+	I32 m_envTableRef = LUA_NOREF;
+	ScriptDynamicArray<I32> m_functionRefs;
 };
 
 } // end namespace anki
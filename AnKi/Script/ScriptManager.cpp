@@ -5,7 +5,10 @@
 
 #include <AnKi/Script/ScriptManager.h>
 #include <AnKi/Script/ScriptEnvironment.h>
+#include <AnKi/Resource/ScriptResource.h>
 #include <AnKi/Util/Logger.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/Tracer.h>
 
 namespace anki {
 
@@ -23,11 +26,161 @@ ScriptManager::ScriptManager(AllocAlignedCallback allocCb, void* allocCbData)
 	: m_poolInit(allocCb, allocCbData)
 {
 	ANKI_SCRIPT_LOGI("Initializing scripting");
+	registerLuaState(m_lua.getLuaState());
 }
 
 ScriptManager::~ScriptManager()
 {
 	ANKI_SCRIPT_LOGI("Destroying scripting");
+	unregisterLuaState(m_lua.getLuaState());
+	ANKI_ASSERT(m_gcStates.getSize() == 0 && "Some script environments are still alive");
+}
+
+void ScriptManager::lock()
+{
+	// Only this thread can write its ID so reading it without the lock is fine
+	const ThreadId tid = Thread::getCurrentThreadId();
+	if(m_luaMtxOwner.load() == tid)
+	{
+		++m_luaMtxLockCount;
+		return;
+	}
+
+	m_luaMtx.lock();
+	m_luaMtxOwner.store(tid);
+	m_luaMtxLockCount = 1;
+}
+
+void ScriptManager::unlock()
+{
+	ANKI_ASSERT(m_luaMtxOwner.load() == Thread::getCurrentThreadId() && m_luaMtxLockCount > 0);
+	if(--m_luaMtxLockCount == 0)
+	{
+		m_luaMtxOwner.store(0);
+		m_luaMtx.unlock();
+	}
+}
+
+Error ScriptManager::getOrCompileBytecode(CString source, CString chunkName, ConstWeakArray<U8, PtrSize>& bytecode)
+{
+	const U64 hash = computeHash(source.cstr(), source.getLength());
+
+	{
+		LockGuard lock(m_bytecodeCacheMtx);
+		auto it = m_bytecodeCache.find(hash);
+		if(it != m_bytecodeCache.getEnd())
+		{
+			bytecode = ConstWeakArray<U8, PtrSize>(it->getBegin(), it->getSize());
+			return Error::kNone;
+		}
+	}
+
+	// Compile outside the lock. If another thread compiled the same text in the meantime keep the old bytecode
+	ScriptDynamicArray<U8> newBytecode;
+	ANKI_CHECK(LuaBinder::compileToBytecode(source, chunkName, newBytecode));
+
+	LockGuard lock(m_bytecodeCacheMtx);
+	auto it = m_bytecodeCache.find(hash);
+	if(it == m_bytecodeCache.getEnd())
+	{
+		it = m_bytecodeCache.emplace(hash, std::move(newBytecode));
+	}
+
+	// The hashmap may move the arrays around but their storage stays where it is
+	bytecode = ConstWeakArray<U8, PtrSize>(it->getBegin(), it->getSize());
+	return Error::kNone;
+}
+
+Error ScriptManager::getOrCompileBytecode(const ScriptResource& script, ConstWeakArray<U8, PtrSize>& bytecode)
+{
+	if(script.getBytecode().getSize())
+	{
+		// Precompiled
+		bytecode = script.getBytecode();
+		return Error::kNone;
+	}
+
+	// Prefix with @ to have LUA print the filename in its errors
+	ScriptString chunkName;
+	chunkName.sprintf("@%s", script.getFilename().cstr());
+	return getOrCompileBytecode(script.getSource(), chunkName, bytecode);
+}
+
+void ScriptManager::registerLuaState(lua_State* state)
+{
+	ANKI_ASSERT(state);
+	LockGuard lock(m_gcMtx);
+	m_gcStates.emplaceBack(state);
+
+	if(m_gcManual)
+	{
+		lua_gc(state, LUA_GCSTOP, 0);
+	}
+}
+
+void ScriptManager::unregisterLuaState(lua_State* state)
+{
+	LockGuard lock(m_gcMtx);
+	for(auto it = m_gcStates.getBegin(); it != m_gcStates.getEnd(); ++it)
+	{
+		if(*it == state)
+		{
+			m_gcStates.erase(it);
+			return;
+		}
+	}
+
+	ANKI_ASSERT(!"State not found");
+}
+
+void ScriptManager::collectGarbage()
+{
+	ANKI_TRACE_SCOPED_EVENT(LuaGarbageCollect);
+
+	const Second budget = Second(g_cvarScriptGarbageCollectionBudget) / 1000.0;
+	const Bool manual = budget > 0.0;
+
+	LockGuard luaLock(*this); // For the global state. Lock it first because environments register states while holding it
+	LockGuard gcLock(m_gcMtx);
+
+	if(manual != m_gcManual)
+	{
+		for(lua_State* state : m_gcStates)
+		{
+			lua_gc(state, (manual) ? LUA_GCSTOP : LUA_GCRESTART, 0);
+		}
+
+		m_gcManual = manual;
+	}
+
+	if(!manual || m_gcStates.getSize() == 0)
+	{
+		return;
+	}
+
+	// Step the states round robin. Move to the next state when the current one finishes a cycle and stop when the budget is exhausted or
+	// all states finished a cycle
+	const Second deadline = HighRezTimer::getCurrentTime() + budget;
+	U32 finishedCount = 0;
+	Bool outOfTime = false;
+	while(finishedCount < m_gcStates.getSize() && !outOfTime)
+	{
+		m_gcNextState = m_gcNextState % m_gcStates.getSize();
+		lua_State* state = m_gcStates[m_gcNextState];
+
+		Bool cycleFinished = false;
+		do
+		{
+			cycleFinished = LuaBinder::garbageCollectStep(state);
+			outOfTime = HighRezTimer::getCurrentTime() >= deadline;
+		} while(!cycleFinished && !outOfTime);
+
+		if(cycleFinished)
+		{
+			++finishedCount;
+			++m_gcNextState;
+		}
+	}
 }
 
 } // end namespace anki
@@ -6,12 +6,23 @@
 #pragma once
 
 #include <AnKi/Script/LuaBinder.h>
+#include <AnKi/Util/CVarSet.h>
+#include <AnKi/Util/Thread.h>
 
 namespace anki {
 
+// Forward
+class ScriptResource;
+
 /// @addtogroup script
 /// @{
 
+ANKI_CVAR(BoolCVar, Script, SharedState, false,
+		  "Script components share a single LUA state. Each component gets its own environment table. Saves memory but the scripts run serially")
+ANKI_CVAR(NumericCVar<F32>, Script, GarbageCollectionBudget, 0.0f, 0.0f, 100.0f,
+		  "Time in ms the LUA garbage collector can spend every frame. If zero LUA collects garbage automatically. A budget too small for the "
+		  "garbage the scripts create lets the memory grow")
+
 /// The scripting manager.
 class ScriptManager : public MakeSingleton<ScriptManager>
 {
@@ -23,22 +34,50 @@ public:
 	template<typename T>
 	void exposeVariable(const char* name, T* y)
 	{
-		LockGuard<Mutex> lock(n_luaMtx);
+		LockGuard lock(*this);
 		LuaBinder::exposeVariable<T>(m_lua.getLuaState(), name, y);
 	}
 
 	/// Evaluate a string
 	Error evalString(const CString& str)
 	{
-		LockGuard<Mutex> lock(n_luaMtx);
+		LockGuard lock(*this);
 		return LuaBinder::evalString(m_lua.getLuaState(), str);
 	}
 
+	/// Evaluate bytecode (or text) in the global LUA state.
+	Error evalBytecode(ConstWeakArray<U8, PtrSize> bytecode, CString chunkName)
+	{
+		LockGuard lock(*this);
+		return LuaBinder::evalChunk(m_lua.getLuaState(), bytecode, chunkName);
+	}
+
+	/// Compile some LUA text to bytecode or get it from the cache if the same text was compiled before. It's thread-safe.
+	/// @param[out] bytecode The bytecode. It's valid for the lifetime of the ScriptManager.
+	Error getOrCompileBytecode(CString source, CString chunkName, ConstWeakArray<U8, PtrSize>& bytecode);
+
+	/// Same as above but for a script resource that can be text or bytecode. If it's bytecode the output is valid while the resource is alive.
+	Error getOrCompileBytecode(const ScriptResource& script, ConstWeakArray<U8, PtrSize>& bytecode);
+
+	/// Lock the global LUA state. It's recursive because scripts may end up creating script environments.
+	void lock();
+
+	void unlock();
+
+	/// Spend some time (see the GarbageCollectionBudget CVar) collecting the garbage of all LUA states. Call it once per frame when no scripts
+	/// are running.
+	void collectGarbage();
+
 	ANKI_INTERNAL LuaBinder& getLuaBinder()
 	{
 		return m_lua;
 	}
 
+	/// Register a LUA state so its garbage will be collected by collectGarbage().
+	ANKI_INTERNAL void registerLuaState(lua_State* state);
+
+	ANKI_INTERNAL void unregisterLuaState(lua_State* state);
+
 private:
 	class PoolInit
 	{
@@ -50,7 +89,17 @@ private:
 
 	PoolInit m_poolInit;
 	LuaBinder m_lua;
-	Mutex n_luaMtx;
+	Mutex m_luaMtx;
+	Atomic<ThreadId> m_luaMtxOwner = {0};
+	U32 m_luaMtxLockCount = 0;
+
+	ScriptHashMap<U64, ScriptDynamicArray<U8>> m_bytecodeCache;
+	Mutex m_bytecodeCacheMtx;
+
+	ScriptDynamicArray<lua_State*> m_gcStates;
+	U32 m_gcNextState = 0; ///< Continue from this state in the next frame.
+	Bool m_gcManual = false; ///< The automatic GC of all the states is stopped.
+	Mutex m_gcMtx;
 
 	ScriptManager(AllocAlignedCallback allocCb, void* allocCbData);
 
@@ -9,6 +9,7 @@
 #include <AnKi/Util/File.h>
 #include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Util/StringList.h>
+#include <AnKi/Util/Hash.h>
 
 #include <string>
 #if ANKI_OS_WINDOWS
@@ -35,6 +36,7 @@ static HMODULE g_dxilLib = 0;
 static HMODULE g_dxcLib = 0;
 static DxcCreateInstanceProc g_DxcCreateInstance = nullptr;
 static Mutex g_dxcLibMtx;
+static U64 g_dxcVersionHash = 0;
 
 #define ANKI_DXC_CHECK(x) \
 	do \
@@ -281,6 +283,45 @@ Error compileHlslToDxil(CString src, ShaderType shaderType, Bool compileWith16bi
 	return compileHlsl(src, shaderType, compileWith16bitTypes, debugInfo, sm, compilerArgs, false, dxil, errorMessage);
 }
 
+Error getDxcVersionHash(U64& hash, ShaderCompilerString& errorMessage)
+{
+	ANKI_CHECK(lazyDxcInit(errorMessage));
+
+	LockGuard lock(g_dxcLibMtx);
+
+	if(g_dxcVersionHash == 0)
+	{
+		CComPtr<IDxcCompiler3> dxcCompiler;
+		ANKI_DXC_CHECK(g_DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&dxcCompiler)));
+
+		CComPtr<IDxcVersionInfo> versionInfo;
+		ANKI_DXC_CHECK(dxcCompiler->QueryInterface(IID_PPV_ARGS(&versionInfo)));
+
+		Array<U32, 2> version;
+		ANKI_DXC_CHECK(versionInfo->GetVersion(&version[0], &version[1]));
+		U64 newHash = computeHash(version.getBegin(), version.getSizeInBytes());
+
+		// Builds of the same version might still produce different code. Add the commit if it's there
+		CComPtr<IDxcVersionInfo2> versionInfo2;
+		U32 commitCount = 0;
+		char* commitHash = nullptr;
+		if(versionInfo->QueryInterface(IID_PPV_ARGS(&versionInfo2)) >= 0 && versionInfo2->GetCommitInfo(&commitCount, &commitHash) >= 0)
+		{
+			newHash = appendObjectHash(commitCount, newHash);
+			if(commitHash)
+			{
+				newHash = appendHash(commitHash, strlen(commitHash), newHash);
+				CoTaskMemFree(commitHash);
+			}
+		}
+
+		g_dxcVersionHash = newHash;
+	}
+
+	hash = g_dxcVersionHash;
+	return Error::kNone;
+}
+
 #if ANKI_OS_WINDOWS
 Error doReflectionDxil(ConstWeakArray<U8> dxil, ShaderType type, ShaderReflection& refl, ShaderCompilerString& errorMessage)
 {
@@ -5,6 +5,7 @@
 
 #include <AnKi/ShaderCompiler/ShaderCompiler.h>
 #include <AnKi/ShaderCompiler/ShaderParser.h>
+#include <AnKi/ShaderCompiler/ShaderCompilerCache.h>
 #include <AnKi/ShaderCompiler/Dxc.h>
 #include <AnKi/ShaderCompiler/Spirv.h>
 #include <AnKi/Util/Serializer.h>
@@ -94,20 +95,71 @@ static Bool spinDials(ShaderCompilerDynamicArray<U32>& dials, ConstWeakArray<Sha
 	return done;
 }
 
-static void compileVariantAsync(const ShaderParser& parser, Bool spirv, Bool debugInfo, ShaderModel sm, ShaderBinaryMutation& mutation,
-								ShaderCompilerDynamicArray<ShaderBinaryVariant>& variants,
-								ShaderCompilerDynamicArray<ShaderBinaryCodeBlock>& codeBlocks, ShaderCompilerDynamicArray<U64>& sourceCodeHashes,
-								ShaderCompilerAsyncTaskInterface& taskManager, Mutex& mtx, Atomic<I32>& error)
+/// The code blocks of a program and the tables that deduplicate them. The compilation tasks share it. It's split in shards, each with its own
+/// lock, so the tasks don't serialize on a single lock.
+class CodeBlockTable
+{
+public:
+	static constexpr U32 kShardCount = 16;
+
+	class Shard
+	{
+	public:
+		Mutex m_mtx;
+		ShaderCompilerHashMap<U64, U64> m_sourceHashToCodeBlockHash; ///< The shard is chosen by the source hash.
+		ShaderCompilerHashMap<U64, ShaderBinaryCodeBlock> m_codeBlocks; ///< The shard is chosen by the code block hash.
+	};
+
+	Array<Shard, kShardCount> m_shards;
+
+	~CodeBlockTable()
+	{
+		// Free what wasn't moved to the binary
+		for(Shard& shard : m_shards)
+		{
+			for(ShaderBinaryCodeBlock& block : shard.m_codeBlocks)
+			{
+				ShaderCompilerMemoryPool::getSingleton().free(block.m_binary.getBegin());
+			}
+		}
+	}
+
+	static Shard& getShard(Array<Shard, kShardCount>& shards, U64 hash)
+	{
+		return shards[hash % kShardCount];
+	}
+
+	Shard& getSourceShard(U64 sourceHash)
+	{
+		return getShard(m_shards, sourceHash);
+	}
+
+	Shard& getCodeBlockShard(U64 codeBlockHash)
+	{
+		return getShard(m_shards, codeBlockHash);
+	}
+};
+
+/// The code blocks of a single technique of a variant. Instead of indices to the final code block array it has the hashes of the code blocks.
+/// The indices are assigned at the end in a deterministic order.
+class TechniqueCodeBlockHashes
+{
+public:
+	Array<U64, U32(ShaderType::kCount)> m_codeBlockHashes = {}; ///< Zero if the shader type is not present.
+};
+
+static void compileVariantAsync(const ShaderParser& parser, Bool spirv, Bool debugInfo, ShaderModel sm, ConstWeakArray<MutatorValue> mutation,
+								ShaderCompilerDynamicArray<TechniqueCodeBlockHashes>& techniqueCodeBlocks, CodeBlockTable& codeBlockTable,
+								ShaderCompilerAsyncTaskInterface& taskManager, ShaderCompilerCache* cache, Atomic<I32>& error)
 {
 	class Ctx
 	{
 	public:
 		const ShaderParser* m_parser;
-		ShaderBinaryMutation* m_mutation;
-		ShaderCompilerDynamicArray<ShaderBinaryVariant>* m_variants;
-		ShaderCompilerDynamicArray<ShaderBinaryCodeBlock>* m_codeBlocks;
-		ShaderCompilerDynamicArray<U64>* m_sourceCodeHashes;
-		Mutex* m_mtx;
+		ConstWeakArray<MutatorValue> m_mutation;
+		ShaderCompilerDynamicArray<TechniqueCodeBlockHashes>* m_techniqueCodeBlocks;
+		CodeBlockTable* m_codeBlockTable;
+		ShaderCompilerCache* m_cache;
 		Atomic<I32>* m_err;
 		Bool m_spirv;
 		Bool m_debugInfo;
@@ -116,11 +168,10 @@ static void compileVariantAsync(const ShaderParser& parser, Bool spirv, Bool deb
 
 	Ctx* ctx = newInstance<Ctx>(ShaderCompilerMemoryPool::getSingleton());
 	ctx->m_parser = &parser;
-	ctx->m_mutation = &mutation;
-	ctx->m_variants = &variants;
-	ctx->m_codeBlocks = &codeBlocks;
-	ctx->m_sourceCodeHashes = &sourceCodeHashes;
-	ctx->m_mtx = &mtx;
+	ctx->m_mutation = mutation;
+	ctx->m_techniqueCodeBlocks = &techniqueCodeBlocks;
+	ctx->m_codeBlockTable = &codeBlockTable;
+	ctx->m_cache = cache;
 	ctx->m_err = &error;
 	ctx->m_spirv = spirv;
 	ctx->m_debugInfo = debugInfo;
@@ -147,120 +198,137 @@ static void compileVariantAsync(const ShaderParser& parser, Bool spirv, Bool deb
 
 		const U32 techniqueCount = ctx.m_parser->getTechniques().getSize();
 
-		// Compile the sources
-		ShaderCompilerDynamicArray<ShaderBinaryTechniqueCodeBlocks> codeBlockIndices;
-		codeBlockIndices.resize(techniqueCount);
-		for(auto& it : codeBlockIndices)
-		{
-			it.m_codeBlockIndices.fill(kMaxU32);
-		}
+		// Compile the sources. Every task writes to its own array so no need to lock
+		ShaderCompilerDynamicArray<TechniqueCodeBlockHashes>& codeBlockHashes = *ctx.m_techniqueCodeBlocks;
+		codeBlockHashes.resize(techniqueCount);
 
 		ShaderCompilerString compilerErrorLog;
 		Error err = Error::kNone;
-		U newCodeBlockCount = 0;
 		for(U32 t = 0; t < techniqueCount && !err; ++t)
 		{
 			const ShaderParserTechnique& technique = ctx.m_parser->getTechniques()[t];
 			for(ShaderType shaderType : EnumBitsIterable<ShaderType, ShaderTypeBit>(technique.m_shaderTypes))
 			{
 				ShaderCompilerString source;
-				ctx.m_parser->generateVariant(ctx.m_mutation->m_values, technique, shaderType, source);
+				ctx.m_parser->generateVariant(ctx.m_mutation, technique, shaderType, source);
 
-				// Check if the source code was found before
+				// Check if the source code was found before. If all mutators are active every source is unique so don't bother
 				const U64 sourceCodeHash = source.computeHash();
+				const Bool dedupSource = technique.m_activeMutators[shaderType] != kMaxU64;
 
-				if(technique.m_activeMutators[shaderType] != kMaxU64)
+				if(dedupSource)
 				{
-					LockGuard lock(*ctx.m_mtx);
-
-					ANKI_ASSERT(ctx.m_sourceCodeHashes->getSize() == ctx.m_codeBlocks->getSize());
+					CodeBlockTable::Shard& shard = ctx.m_codeBlockTable->getSourceShard(sourceCodeHash);
+					LockGuard lock(shard.m_mtx);
 
-					Bool found = false;
-					for(U32 i = 0; i < ctx.m_sourceCodeHashes->getSize(); ++i)
-					{
-						if((*ctx.m_sourceCodeHashes)[i] == sourceCodeHash)
-						{
-							codeBlockIndices[t].m_codeBlockIndices[shaderType] = i;
-							found = true;
-							break;
-						}
-					}
-
-					if(found)
+					auto it = shard.m_sourceHashToCodeBlockHash.find(sourceCodeHash);
+					if(it != shard.m_sourceHashToCodeBlockHash.getEnd())
 					{
+						codeBlockHashes[t].m_codeBlockHashes[shaderType] = *it;
 						continue;
 					}
 				}
 
+				// Try the persistent cache before compiling. Code compiled by another DXC build doesn't count
 				ShaderCompilerDynamicArray<U8> il;
-				if(ctx.m_spirv)
-				{
-					err = compileHlslToSpirv(source, shaderType, true, ctx.m_debugInfo, ctx.m_sm, ctx.m_parser->getExtraCompilerArgs(), il,
-											 compilerErrorLog);
-				}
-				else
+				U64 cacheKey = 0;
+				if(ctx.m_cache)
 				{
-					err = compileHlslToDxil(source, shaderType, true, ctx.m_debugInfo, ctx.m_sm, ctx.m_parser->getExtraCompilerArgs(), il,
-											compilerErrorLog);
+					U64 dxcVersion;
+					err = getDxcVersionHash(dxcVersion, compilerErrorLog);
+					if(err)
+					{
+						break;
+					}
+
+					cacheKey = ShaderCompilerCache::computeKey(dxcVersion, source, shaderType, ctx.m_spirv, true, ctx.m_debugInfo, ctx.m_sm,
+															   ctx.m_parser->getExtraCompilerArgs());
 				}
 
-				if(err)
+				if(!ctx.m_cache || !ctx.m_cache->find(cacheKey, il))
 				{
-					break;
+					if(ctx.m_spirv)
+					{
+						err = compileHlslToSpirv(source, shaderType, true, ctx.m_debugInfo, ctx.m_sm, ctx.m_parser->getExtraCompilerArgs(), il,
+												 compilerErrorLog);
+					}
+					else
+					{
+						err = compileHlslToDxil(source, shaderType, true, ctx.m_debugInfo, ctx.m_sm, ctx.m_parser->getExtraCompilerArgs(), il,
+												compilerErrorLog);
+					}
+
+					if(err)
+					{
+						break;
+					}
+
+					if(ctx.m_cache)
+					{
+						ctx.m_cache->store(cacheKey, il);
+					}
 				}
 
 				const U64 newHash = computeHash(il.getBegin(), il.getSizeInBytes());
+				ANKI_ASSERT(newHash != 0);
 
-				ShaderReflection refl;
-				if(ctx.m_spirv)
+				// Add the binary if not already there
+				Bool codeBlockFound;
 				{
-					err = doReflectionSpirv(il, shaderType, refl, compilerErrorLog);
+					CodeBlockTable::Shard& shard = ctx.m_codeBlockTable->getCodeBlockShard(newHash);
+					LockGuard lock(shard.m_mtx);
+					codeBlockFound = shard.m_codeBlocks.find(newHash) != shard.m_codeBlocks.getEnd();
 				}
-				else
+
+				if(!codeBlockFound)
 				{
+					// Do the reflection outside the lock
+					ShaderReflection refl;
+					if(ctx.m_spirv)
+					{
+						err = doReflectionSpirv(il, shaderType, refl, compilerErrorLog);
+					}
+					else
+					{
 #if ANKI_OS_WINDOWS
-					err = doReflectionDxil(il, shaderType, refl, compilerErrorLog);
+						err = doReflectionDxil(il, shaderType, refl, compilerErrorLog);
 #else
-					ANKI_SHADER_COMPILER_LOGE("Can't generate shader compilation on non-windows platforms");
-					err = Error::kFunctionFailed;
+						ANKI_SHADER_COMPILER_LOGE("Can't generate shader compilation on non-windows platforms");
+						err = Error::kFunctionFailed;
 #endif
-				}
-
-				if(err)
-				{
-					break;
-				}
-
-				// Add the binary if not already there
-				{
-					LockGuard lock(*ctx.m_mtx);
+					}
 
-					Bool found = false;
-					for(U32 j = 0; j < ctx.m_codeBlocks->getSize(); ++j)
+					if(err)
 					{
-						if((*ctx.m_codeBlocks)[j].m_hash == newHash)
-						{
-							codeBlockIndices[t].m_codeBlockIndices[shaderType] = j;
-							found = true;
-							break;
-						}
+						break;
 					}
 
-					if(!found)
-					{
-						codeBlockIndices[t].m_codeBlockIndices[shaderType] = ctx.m_codeBlocks->getSize();
+					CodeBlockTable::Shard& shard = ctx.m_codeBlockTable->getCodeBlockShard(newHash);
+					LockGuard lock(shard.m_mtx);
 
-						auto& codeBlock = *ctx.m_codeBlocks->emplaceBack();
+					// Another task might have added it in the meantime
+					if(shard.m_codeBlocks.find(newHash) == shard.m_codeBlocks.getEnd())
+					{
+						ShaderBinaryCodeBlock codeBlock;
 						il.moveAndReset(codeBlock.m_binary);
 						codeBlock.m_hash = newHash;
 						codeBlock.m_reflection = refl;
+						shard.m_codeBlocks.emplace(newHash, codeBlock);
+					}
+				}
 
-						ctx.m_sourceCodeHashes->emplaceBack(sourceCodeHash);
-						ANKI_ASSERT(ctx.m_sourceCodeHashes->getSize() == ctx.m_codeBlocks->getSize());
+				if(dedupSource)
+				{
+					CodeBlockTable::Shard& shard = ctx.m_codeBlockTable->getSourceShard(sourceCodeHash);
+					LockGuard lock(shard.m_mtx);
 
-						++newCodeBlockCount;
+					if(shard.m_sourceHashToCodeBlockHash.find(sourceCodeHash) == shard.m_sourceHashToCodeBlockHash.getEnd())
+					{
+						shard.m_sourceHashToCodeBlockHash.emplace(sourceCodeHash, newHash);
 					}
 				}
+
+				codeBlockHashes[t].m_codeBlockHashes[shaderType] = newHash;
 			}
 		}
 
@@ -275,59 +343,90 @@ static void compileVariantAsync(const ShaderParser& parser, Bool spirv, Bool deb
 			}
 			return;
 		}
+	};
 
-		// Do variant stuff
+	taskManager.enqueueTask(callback, ctx);
+}
+
+/// Convert the code block hashes of the mutations to code blocks and variants. It walks the mutations in order and assigns the indices in order
+/// of first appearance so the output doesn't depend on the order the tasks finished.
+/// @param mutationCodeBlocks The code block hashes of every mutation. Empty for the skipped mutations.
+static void createVariants(ConstWeakArray<ShaderCompilerDynamicArray<TechniqueCodeBlockHashes>> mutationCodeBlocks, CodeBlockTable& codeBlockTable,
+						   WeakArray<ShaderBinaryMutation> mutations, ShaderCompilerDynamicArray<ShaderBinaryCodeBlock>& codeBlocks,
+						   ShaderCompilerDynamicArray<ShaderBinaryVariant>& variants)
+{
+	ANKI_ASSERT(mutationCodeBlocks.getSize() == mutations.getSize());
+
+	ShaderCompilerHashMap<U64, U32> codeBlockHashToIdx;
+	ShaderCompilerHashMap<U64, U32> variantHashToIdx;
+
+	for(U32 m = 0; m < mutations.getSize(); ++m)
+	{
+		const ShaderCompilerDynamicArray<TechniqueCodeBlockHashes>& hashes = mutationCodeBlocks[m];
+		if(hashes.getSize() == 0)
 		{
-			LockGuard lock(*ctx.m_mtx);
+			ANKI_ASSERT(mutations[m].m_variantIndex == kMaxU32);
+			continue;
+		}
 
-			Bool createVariant = true;
-			if(newCodeBlockCount == 0)
+		// Code block hashes to indices
+		ShaderCompilerDynamicArray<ShaderBinaryTechniqueCodeBlocks> techniqueCodeBlocks;
+		techniqueCodeBlocks.resize(hashes.getSize());
+		for(U32 t = 0; t < hashes.getSize(); ++t)
+		{
+			for(ShaderType shaderType : EnumIterable<ShaderType>())
 			{
-				// No new code blocks generated, search all variants to see if there is a duplicate
-
-				for(U32 i = 0; i < ctx.m_variants->getSize(); ++i)
+				const U64 hash = hashes[t].m_codeBlockHashes[shaderType];
+				if(hash == 0)
 				{
-					Bool same = true;
-					for(U32 t = 0; t < techniqueCount; ++t)
-					{
-						const ShaderBinaryTechniqueCodeBlocks& a = (*ctx.m_variants)[i].m_techniqueCodeBlocks[t];
-						const ShaderBinaryTechniqueCodeBlocks& b = codeBlockIndices[t];
-
-						if(memcmp(&a, &b, sizeof(a)) != 0)
-						{
-							// Not the same
-							same = false;
-							break;
-						}
-					}
+					techniqueCodeBlocks[t].m_codeBlockIndices[shaderType] = kMaxU32;
+					continue;
+				}
 
-					if(same)
-					{
-						createVariant = false;
-						ctx.m_mutation->m_variantIndex = i;
-						break;
-					}
+				auto it = codeBlockHashToIdx.find(hash);
+				if(it != codeBlockHashToIdx.getEnd())
+				{
+					techniqueCodeBlocks[t].m_codeBlockIndices[shaderType] = *it;
+					continue;
 				}
-			}
 
-			// Create a new variant
-			if(createVariant)
-			{
-				ctx.m_mutation->m_variantIndex = ctx.m_variants->getSize();
+				// First appearance, move it to the binary
+				CodeBlockTable::Shard& shard = codeBlockTable.getCodeBlockShard(hash);
+				auto blockIt = shard.m_codeBlocks.find(hash);
+				ANKI_ASSERT(blockIt != shard.m_codeBlocks.getEnd());
 
-				ShaderBinaryVariant* variant = ctx.m_variants->emplaceBack();
+				const U32 idx = codeBlocks.getSize();
+				codeBlocks.emplaceBack(*blockIt);
+				shard.m_codeBlocks.erase(blockIt);
 
-				codeBlockIndices.moveAndReset(variant->m_techniqueCodeBlocks);
+				codeBlockHashToIdx.emplace(hash, idx);
+				techniqueCodeBlocks[t].m_codeBlockIndices[shaderType] = idx;
 			}
 		}
-	};
 
-	taskManager.enqueueTask(callback, ctx);
+		// Find a variant with the same code blocks
+		const U64 variantHash = computeHash(techniqueCodeBlocks.getBegin(), techniqueCodeBlocks.getSizeInBytes());
+		auto it = variantHashToIdx.find(variantHash);
+		if(it != variantHashToIdx.getEnd())
+		{
+			ANKI_ASSERT(memcmp(variants[*it].m_techniqueCodeBlocks.getBegin(), techniqueCodeBlocks.getBegin(), techniqueCodeBlocks.getSizeInBytes())
+						== 0);
+			mutations[m].m_variantIndex = *it;
+		}
+		else
+		{
+			mutations[m].m_variantIndex = variants.getSize();
+			variantHashToIdx.emplace(variantHash, variants.getSize());
+
+			ShaderBinaryVariant* variant = variants.emplaceBack();
+			techniqueCodeBlocks.moveAndReset(variant->m_techniqueCodeBlocks);
+		}
+	}
 }
 
 static Error compileShaderProgramInternal(CString fname, Bool spirv, Bool debugInfo, ShaderModel sm, ShaderCompilerFilesystemInterface& fsystem,
 										  ShaderCompilerPostParseInterface* postParseCallback, ShaderCompilerAsyncTaskInterface* taskManager_,
-										  ConstWeakArray<ShaderCompilerDefine> defines_, ShaderBinary*& binary)
+										  ShaderCompilerCache* cache, ConstWeakArray<ShaderCompilerDefine> defines_, ShaderBinary*& binary)
 {
 	ShaderCompilerMemoryPool& memPool = ShaderCompilerMemoryPool::getSingleton();
 
@@ -378,7 +477,6 @@ static Error compileShaderProgramInternal(CString fname, Bool spirv, Bool debugI
 	}
 
 	// Create all variants
-	Mutex mtx;
 	Atomic<I32> errorAtomic(0);
 	class SyncronousShaderCompilerAsyncTaskInterface : public ShaderCompilerAsyncTaskInterface
 	{
@@ -396,6 +494,10 @@ static Error compileShaderProgramInternal(CString fname, Bool spirv, Bool debugI
 	} syncTaskManager;
 	ShaderCompilerAsyncTaskInterface& taskManager = (taskManager_) ? *taskManager_ : syncTaskManager;
 
+	CodeBlockTable codeBlockTable;
+	ShaderCompilerDynamicArray<ShaderBinaryVariant> variants;
+	ShaderCompilerDynamicArray<ShaderBinaryCodeBlock> codeBlocks;
+
 	if(parser.getMutators().getSize() > 0)
 	{
 		// Initialize
@@ -403,15 +505,13 @@ static Error compileShaderProgramInternal(CString fname, Bool spirv, Bool debugI
 		mutationValues.resize(parser.getMutators().getSize());
 		ShaderCompilerDynamicArray<U32> dials;
 		dials.resize(parser.getMutators().getSize(), 0);
-		ShaderCompilerDynamicArray<ShaderBinaryVariant> variants;
-		ShaderCompilerDynamicArray<ShaderBinaryCodeBlock> codeBlocks;
-		ShaderCompilerDynamicArray<U64> sourceCodeHashes;
 		ShaderCompilerDynamicArray<ShaderBinaryMutation> mutations;
 		mutations.resize(mutationCount);
 		ShaderCompilerHashMap<U64, U32> mutationHashToIdx;
 
-		// Grow the storage of the variants array. Can't have it resize, threads will work on stale data
-		variants.resizeStorage(mutationCount);
+		// One element per mutation. The tasks write to them so it can't be resized
+		ShaderCompilerDynamicArray<ShaderCompilerDynamicArray<TechniqueCodeBlockHashes>> mutationCodeBlocks;
+		mutationCodeBlocks.resize(mutationCount);
 
 		mutationCount = 0;
 
@@ -441,7 +541,8 @@ static Error compileShaderProgramInternal(CString fname, Bool spirv, Bool debugI
 			{
 				// New and unique mutation and thus variant, add it
 
-				compileVariantAsync(parser, spirv, debugInfo, sm, mutation, variants, codeBlocks, sourceCodeHashes, taskManager, mtx, errorAtomic);
+				compileVariantAsync(parser, spirv, debugInfo, sm, mutation.m_values, mutationCodeBlocks[mutationCount - 1], codeBlockTable,
+									taskManager, cache, errorAtomic);
 
 				ANKI_ASSERT(mutationHashToIdx.find(mutation.m_hash) == mutationHashToIdx.getEnd());
 				mutationHashToIdx.emplace(mutation.m_hash, mutationCount - 1);
@@ -456,33 +557,32 @@ static Error compileShaderProgramInternal(CString fname, Bool spirv, Bool debugI
 		// Now error out
 		ANKI_CHECK(Error(errorAtomic.getNonAtomically()));
 
+		createVariants(mutationCodeBlocks, codeBlockTable, WeakArray<ShaderBinaryMutation>(mutations), codeBlocks, variants);
+
 		// Store temp containers to binary
-		codeBlocks.moveAndReset(binary->m_codeBlocks);
 		mutations.moveAndReset(binary->m_mutations);
-		variants.moveAndReset(binary->m_variants);
 	}
 	else
 	{
 		newArray(memPool, 1, binary->m_mutations);
-		ShaderCompilerDynamicArray<ShaderBinaryVariant> variants;
-		ShaderCompilerDynamicArray<ShaderBinaryCodeBlock> codeBlocks;
-		ShaderCompilerDynamicArray<U64> sourceCodeHashes;
+		ShaderCompilerDynamicArray<ShaderCompilerDynamicArray<TechniqueCodeBlockHashes>> mutationCodeBlocks;
+		mutationCodeBlocks.resize(1);
 
-		compileVariantAsync(parser, spirv, debugInfo, sm, binary->m_mutations[0], variants, codeBlocks, sourceCodeHashes, taskManager, mtx,
-							errorAtomic);
+		compileVariantAsync(parser, spirv, debugInfo, sm, {}, mutationCodeBlocks[0], codeBlockTable, taskManager, cache, errorAtomic);
 
 		ANKI_CHECK(taskManager.joinTasks());
 		ANKI_CHECK(Error(errorAtomic.getNonAtomically()));
 
-		ANKI_ASSERT(codeBlocks.getSize() >= parser.getTechniques().getSize());
+		createVariants(mutationCodeBlocks, codeBlockTable, binary->m_mutations, codeBlocks, variants);
+
 		ANKI_ASSERT(binary->m_mutations[0].m_variantIndex == 0);
 		ANKI_ASSERT(variants.getSize() == 1);
 		binary->m_mutations[0].m_hash = 1;
-
-		codeBlocks.moveAndReset(binary->m_codeBlocks);
-		variants.moveAndReset(binary->m_variants);
 	}
 
+	codeBlocks.moveAndReset(binary->m_codeBlocks);
+	variants.moveAndReset(binary->m_variants);
+
 	// Sort the mutations
 	std::sort(binary->m_mutations.getBegin(), binary->m_mutations.getEnd(), [](const ShaderBinaryMutation& a, const ShaderBinaryMutation& b) {
 		return a.m_hash < b.m_hash;
@@ -539,9 +639,9 @@ static Error compileShaderProgramInternal(CString fname, Bool spirv, Bool debugI
 
 Error compileShaderProgram(CString fname, Bool spirv, Bool debugInfo, ShaderModel sm, ShaderCompilerFilesystemInterface& fsystem,
 						   ShaderCompilerPostParseInterface* postParseCallback, ShaderCompilerAsyncTaskInterface* taskManager,
-						   ConstWeakArray<ShaderCompilerDefine> defines, ShaderBinary*& binary)
+						   ShaderCompilerCache* cache, ConstWeakArray<ShaderCompilerDefine> defines, ShaderBinary*& binary)
 {
-	const Error err = compileShaderProgramInternal(fname, spirv, debugInfo, sm, fsystem, postParseCallback, taskManager, defines, binary);
+	const Error err = compileShaderProgramInternal(fname, spirv, debugInfo, sm, fsystem, postParseCallback, taskManager, cache, defines, binary);
 	if(err)
 	{
 		ANKI_SHADER_COMPILER_LOGE("Failed to compile: %s", fname.cstr());
@@ -11,6 +11,9 @@
 
 namespace anki {
 
+// Forward
+class ShaderCompilerCache;
+
 /// @addtogroup shader_compiler
 /// @{
 
@@ -40,9 +43,10 @@ inline Error deserializeShaderBinaryFromFile(CString fname, ShaderBinary*& binar
 }
 
 /// Takes an AnKi special shader program and spits a binary.
+/// @param cache Optional persistent cache of the compiled code. The variants found in it won't be compiled again.
 Error compileShaderProgram(CString fname, Bool spirv, Bool debugInfo, ShaderModel sm, ShaderCompilerFilesystemInterface& fsystem,
 						   ShaderCompilerPostParseInterface* postParseCallback, ShaderCompilerAsyncTaskInterface* taskManager,
-						   ConstWeakArray<ShaderCompilerDefine> defines, ShaderBinary*& binary);
+						   ShaderCompilerCache* cache, ConstWeakArray<ShaderCompilerDefine> defines, ShaderBinary*& binary);
 
 /// Free the binary created ONLY by compileShaderProgram.
 void freeShaderBinary(ShaderBinary*& binary);
@@ -0,0 +1,263 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/ShaderCompiler/ShaderCompilerCache.h>
+#include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Hash.h>
+#include <filesystem>
+#include <random>
+
+namespace anki {
+
+static constexpr const Char* kEntryExtension = ".ankiil";
+static constexpr const Char* kTmpExtension = ".tmp";
+static constexpr Char kEntryMagic[8] = {'A', 'N', 'K', 'I', 'S', 'C', 'C', '1'};
+
+/// Temp files older than that belong to processes that died in the middle of writing.
+static constexpr std::chrono::hours kStaleTmpFileAge(1);
+
+class ShaderCompilerCacheEntryHeader
+{
+public:
+	Array<Char, 8> m_magic;
+	U64 m_key;
+	U64 m_ilSize;
+	U64 m_ilHash;
+};
+
+Error ShaderCompilerCache::init(CString directory, PtrSize maxSize)
+{
+	ANKI_ASSERT(directory.getLength() > 0);
+	m_dir = directory;
+	m_maxSize = maxSize;
+
+	if(!directoryExists(m_dir))
+	{
+		// Another process might have created it in the meantime
+		if(createDirectory(m_dir) && !directoryExists(m_dir))
+		{
+			ANKI_SHADER_COMPILER_LOGE("Failed to create the shader cache directory: %s", m_dir.cstr());
+			return Error::kFunctionFailed;
+		}
+	}
+
+	return Error::kNone;
+}
+
+U64 ShaderCompilerCache::computeKey(U64 compilerVersion, CString source, ShaderType shaderType, Bool spirv, Bool compileWith16bitTypes,
+									Bool debugInfo, ShaderModel sm, ConstWeakArray<CString> compilerArgs)
+{
+	U64 hash = computeHash(source.cstr(), source.getLength());
+	hash = appendObjectHash(compilerVersion, hash);
+
+	const Array<U32, 6> options = {kVersion, U32(shaderType), spirv, compileWith16bitTypes, debugInfo, U32(sm)};
+	hash = appendHash(options.getBegin(), options.getSizeInBytes(), hash);
+
+	for(CString arg : compilerArgs)
+	{
+		// Hash the length as well to tell apart {"ab", "c"} from {"a", "bc"}
+		const U64 len = arg.getLength();
+		hash = appendObjectHash(len, hash);
+		hash = appendHash(arg.cstr(), len, hash);
+	}
+
+	return hash;
+}
+
+ShaderCompilerString ShaderCompilerCache::getEntryFilename(U64 key) const
+{
+	ShaderCompilerString fname;
+	fname.sprintf("%s/%016" PRIx64 "%s", m_dir.cstr(), key, kEntryExtension);
+	return fname;
+}
+
+Bool ShaderCompilerCache::find(U64 key, ShaderCompilerDynamicArray<U8>& il)
+{
+	const ShaderCompilerString fname = getEntryFilename(key);
+
+	auto readEntry = [&]() -> Bool {
+		if(!fileExists(fname))
+		{
+			return false;
+		}
+
+		File file;
+		if(file.open(fname, FileOpenFlag::kRead | FileOpenFlag::kBinary))
+		{
+			// Might have been deleted by a trim() of another process
+			return false;
+		}
+
+		ShaderCompilerCacheEntryHeader header;
+		if(file.getSize() < sizeof(header) || file.read(&header, sizeof(header)))
+		{
+			return false;
+		}
+
+		if(memcmp(header.m_magic.getBegin(), kEntryMagic, sizeof(kEntryMagic)) != 0 || header.m_key != key
+		   || header.m_ilSize != file.getSize() - sizeof(header) || header.m_ilSize == 0)
+		{
+			ANKI_SHADER_COMPILER_LOGW("Corrupted shader cache entry: %s", fname.cstr());
+			return false;
+		}
+
+		il.resize(U32(header.m_ilSize));
+		if(file.read(il.getBegin(), il.getSizeInBytes()) || computeHash(il.getBegin(), il.getSizeInBytes()) != header.m_ilHash)
+		{
+			ANKI_SHADER_COMPILER_LOGW("Corrupted shader cache entry: %s", fname.cstr());
+			il.destroy();
+			return false;
+		}
+
+		return true;
+	};
+
+	const Bool found = readEntry();
+	if(found)
+	{
+		m_hitCount.fetchAdd(1);
+
+		// The modification time is the time of last use. trim() uses it to find the least recently used entries
+		std::error_code err;
+		std::filesystem::last_write_time(fname.cstr(), std::filesystem::file_time_type::clock::now(), err);
+	}
+	else
+	{
+		m_missCount.fetchAdd(1);
+	}
+
+	return found;
+}
+
+void ShaderCompilerCache::store(U64 key, ConstWeakArray<U8> il)
+{
+	ANKI_ASSERT(il.getSize() > 0);
+
+	// The temp filename needs to be unique across threads and processes
+	static const U64 processSalt = (U64(std::random_device()()) << 32u) | U64(std::random_device()());
+	ShaderCompilerString tmpFname;
+	tmpFname.sprintf("%s/%016" PRIx64 "_%016" PRIx64 "_%u%s", m_dir.cstr(), key, processSalt, m_tmpFileCount.fetchAdd(1), kTmpExtension);
+
+	ShaderCompilerCacheEntryHeader header;
+	memcpy(header.m_magic.getBegin(), kEntryMagic, sizeof(kEntryMagic));
+	header.m_key = key;
+	header.m_ilSize = il.getSizeInBytes();
+	header.m_ilHash = computeHash(il.getBegin(), il.getSizeInBytes());
+
+	Error err = Error::kNone;
+	{
+		File file;
+		err = file.open(tmpFname, FileOpenFlag::kWrite | FileOpenFlag::kBinary);
+		if(!err)
+		{
+			err = file.write(&header, sizeof(header));
+		}
+
+		if(!err)
+		{
+			err = file.write(il.getBegin(), il.getSizeInBytes());
+		}
+	}
+
+	// The rename is atomic so the other processes will see either the whole entry or nothing. If another process stored the same entry in the
+	// meantime it will be replaced with identical contents
+	if(!err)
+	{
+		err = renameFile(tmpFname, getEntryFilename(key));
+	}
+
+	if(err)
+	{
+		ANKI_SHADER_COMPILER_LOGW("Failed to store shader cache entry. Ignoring");
+		std::error_code stdErr;
+		std::filesystem::remove(tmpFname.cstr(), stdErr);
+	}
+}
+
+Error ShaderCompilerCache::trim()
+{
+	class Entry
+	{
+	public:
+		std::filesystem::path m_path;
+		std::filesystem::file_time_type m_lastUse;
+		PtrSize m_size;
+	};
+
+	const auto now = std::filesystem::file_time_type::clock::now();
+
+	ShaderCompilerDynamicArray<Entry> entries;
+	PtrSize totalSize = 0;
+	std::error_code err;
+	for(const std::filesystem::directory_entry& it : std::filesystem::directory_iterator(m_dir.cstr(), err))
+	{
+		std::error_code err2;
+		if(!it.is_regular_file(err2))
+		{
+			continue;
+		}
+
+		const std::filesystem::path ext = it.path().extension();
+		const std::filesystem::file_time_type lastUse = it.last_write_time(err2);
+		if(err2)
+		{
+			continue;
+		}
+
+		if(ext == kTmpExtension)
+		{
+			if(now - lastUse > kStaleTmpFileAge)
+			{
+				std::filesystem::remove(it.path(), err2);
+			}
+		}
+		else if(ext == kEntryExtension)
+		{
+			const PtrSize size = it.file_size(err2);
+			if(!err2)
+			{
+				entries.emplaceBack(Entry{it.path(), lastUse, size});
+				totalSize += size;
+			}
+		}
+	}
+
+	if(err)
+	{
+		ANKI_SHADER_COMPILER_LOGE("Failed to iterate the shader cache directory: %s", m_dir.cstr());
+		return Error::kFunctionFailed;
+	}
+
+	if(totalSize <= m_maxSize)
+	{
+		return Error::kNone;
+	}
+
+	// Evict the least recently used first
+	std::sort(entries.getBegin(), entries.getEnd(), [](const Entry& a, const Entry& b) {
+		return a.m_lastUse < b.m_lastUse;
+	});
+
+	U32 evictedCount = 0;
+	for(const Entry& entry : entries)
+	{
+		if(totalSize <= m_maxSize)
+		{
+			break;
+		}
+
+		// Another process might be reading it. That's fine, it will either get the whole entry or a miss
+		std::filesystem::remove(entry.m_path, err);
+		totalSize -= entry.m_size;
+		++evictedCount;
+	}
+
+	ANKI_SHADER_COMPILER_LOGV("Evicted %u shader cache entries", evictedCount);
+
+	return Error::kNone;
+}
+
+} // end namespace anki
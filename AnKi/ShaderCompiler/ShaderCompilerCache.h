@@ -0,0 +1,74 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/ShaderCompiler/Common.h>
+#include <AnKi/Util/WeakArray.h>
+#include <AnKi/Util/Atomic.h>
+
+namespace anki {
+
+/// @addtogroup shader_compiler
+/// @{
+
+/// A persistent cache of compiled shader code (SPIR-V or DXIL). Every entry is a file in a directory and its name is a hash of everything that
+/// affects the compilation (compiler version, source, shader type, target, shader model etc). Many threads and many compiler processes can share the
+/// same directory: The entries are written to temporary files and renamed when complete and the contents are validated when read.
+class ShaderCompilerCache
+{
+public:
+	/// Bump it to invalidate all the caches. Needs to change when the arguments that AnKi passes to the compiler change.
+	static constexpr U32 kVersion = 1;
+
+	ShaderCompilerCache() = default;
+
+	ShaderCompilerCache(const ShaderCompilerCache&) = delete; // Non-copyable
+
+	ShaderCompilerCache& operator=(const ShaderCompilerCache&) = delete; // Non-copyable
+
+	/// @param directory The directory of the cache. Will be created if it doesn't exist.
+	/// @param maxSize The size limit of the cache in bytes. See trim().
+	Error init(CString directory, PtrSize maxSize);
+
+	/// Compute the key of a cache entry.
+	/// @param compilerVersion A hash that identifies the compiler build. See getDxcVersionHash().
+	static U64 computeKey(U64 compilerVersion, CString source, ShaderType shaderType, Bool spirv, Bool compileWith16bitTypes, Bool debugInfo,
+						  ShaderModel sm, ConstWeakArray<CString> compilerArgs);
+
+	/// Find an entry. It's thread-safe.
+	/// @return True if found.
+	Bool find(U64 key, ShaderCompilerDynamicArray<U8>& il);
+
+	/// Add an entry. It's thread-safe. Failing to add an entry is not an error, the cache is just a cache.
+	void store(U64 key, ConstWeakArray<U8> il);
+
+	/// Delete the least recently used entries until the cache fits in the size limit. It's not thread-safe but it's safe to call while other
+	/// processes use the cache. It walks the whole directory so call it once after a batch of compilations and not in every compiler process.
+	Error trim();
+
+	U32 getHitCount() const
+	{
+		return m_hitCount.load();
+	}
+
+	U32 getMissCount() const
+	{
+		return m_missCount.load();
+	}
+
+private:
+	ShaderCompilerString m_dir;
+	PtrSize m_maxSize = 0;
+
+	Atomic<U32> m_hitCount = {0};
+	Atomic<U32> m_missCount = {0};
+	Atomic<U32> m_tmpFileCount = {0};
+
+	ShaderCompilerString getEntryFilename(U64 key) const;
+};
+/// @}
+
+} // end namespace anki
@@ -81,6 +81,51 @@ Error getFileModificationTime(CString filename, U32& year, U32& month, U32& day,
 // Get the path+filename of the currently running executable.
 Error getApplicationPath(String& path);
 
+// Maps a whole file in memory for reading. The OS will page in the parts of the file that get accessed.
+class MemoryMappedFile
+{
+public:
+	MemoryMappedFile() = default;
+
+	MemoryMappedFile(const MemoryMappedFile&) = delete; // Non-copyable
+
+	~MemoryMappedFile()
+	{
+		unmap();
+	}
+
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete; // Non-copyable
+
+	Error map(CString filename);
+
+	void unmap();
+
+	// Get the contents of the file. It's nullptr if the file is empty.
+	const U8* getData() const
+	{
+		return static_cast<const U8*>(m_data);
+	}
+
+	PtrSize getSize() const
+	{
+		return m_size;
+	}
+
+	Bool isMapped() const
+	{
+		return m_mapped;
+	}
+
+private:
+	void* m_data = nullptr;
+	PtrSize m_size = 0;
+#if ANKI_OS_WINDOWS
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+#endif
+	Bool m_mapped = false;
+};
+
 // A convenience class to delete a file when it goes out of scope. It tries multiple times because of Windows antivirus sometimes keeping a lock to
 // the file
 class CleanupFile
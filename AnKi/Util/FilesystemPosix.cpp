@@ -20,6 +20,8 @@
 #include <cstdlib>
 #include <time.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #if ANKI_OS_ANDROID
 #	include <android_native_app_glue.h>
 #endif
@@ -277,4 +279,57 @@ Error getApplicationPath(String& out)
 	return Error::kNone;
 }
 
+Error MemoryMappedFile::map(CString filename)
+{
+	unmap();
+
+	const int fd = open(filename.cstr(), O_RDONLY);
+	if(fd < 0)
+	{
+		ANKI_UTIL_LOGE("open() failed: %s", filename.cstr());
+		return Error::kFileAccess;
+	}
+
+	struct stat buff;
+	if(fstat(fd, &buff))
+	{
+		ANKI_UTIL_LOGE("fstat() failed: %s", filename.cstr());
+		close(fd);
+		return Error::kFileAccess;
+	}
+
+	const PtrSize size = PtrSize(buff.st_size);
+	void* data = nullptr;
+	if(size > 0)
+	{
+		data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(data == MAP_FAILED)
+		{
+			ANKI_UTIL_LOGE("mmap() failed: %s", filename.cstr());
+			close(fd);
+			return Error::kFileAccess;
+		}
+	}
+
+	// The mapping holds a reference to the file, no need to keep the descriptor around
+	close(fd);
+
+	m_data = data;
+	m_size = size;
+	m_mapped = true;
+	return Error::kNone;
+}
+
+void MemoryMappedFile::unmap()
+{
+	if(m_data)
+	{
+		munmap(m_data, m_size);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+}
+
 } // end namespace anki
@@ -221,4 +221,77 @@ Error getApplicationPath(String& out)
 	return Error::kNone;
 }
 
+Error MemoryMappedFile::map(CString filename)
+{
+	unmap();
+
+	HANDLE file = CreateFileA(filename.cstr(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		ANKI_UTIL_LOGE("CreateFileA() failed: %s", filename.cstr());
+		return Error::kFileAccess;
+	}
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size))
+	{
+		ANKI_UTIL_LOGE("GetFileSizeEx() failed: %s", filename.cstr());
+		CloseHandle(file);
+		return Error::kFileAccess;
+	}
+
+	HANDLE mapping = nullptr;
+	void* data = nullptr;
+	if(size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(mapping == nullptr)
+		{
+			ANKI_UTIL_LOGE("CreateFileMappingA() failed: %s", filename.cstr());
+			CloseHandle(file);
+			return Error::kFileAccess;
+		}
+
+		data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if(data == nullptr)
+		{
+			ANKI_UTIL_LOGE("MapViewOfFile() failed: %s", filename.cstr());
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return Error::kFileAccess;
+		}
+	}
+
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+	m_data = data;
+	m_size = PtrSize(size.QuadPart);
+	m_mapped = true;
+	return Error::kNone;
+}
+
+void MemoryMappedFile::unmap()
+{
+	if(m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+
+	if(m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+	}
+
+	if(m_fileHandle)
+	{
+		CloseHandle(m_fileHandle);
+	}
+
+	m_data = nullptr;
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+	m_size = 0;
+	m_mapped = false;
+}
+
 } // end namespace anki
@@ -28,7 +28,7 @@ class HashMap;
 template<typename TKey>
 class DefaultHasher;
 
-class HashMapSparseArrayConfig;
+class HashMapDefaultConfig;
 
 template<typename T, typename TMemoryPool>
 class List;
@@ -85,7 +85,7 @@ class XmlDocument;
 	template<typename T, typename TSize = PtrSize> \
 	using submoduleName##DynamicArrayLarge = DynamicArray<T, submoduleName##MemPoolWrapper, TSize>; \
 	template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>> \
-	using submoduleName##HashMap = HashMap<TKey, TValue, THasher, submoduleName##MemPoolWrapper, HashMapSparseArrayConfig>; \
+	using submoduleName##HashMap = HashMap<TKey, TValue, THasher, submoduleName##MemPoolWrapper, HashMapDefaultConfig>; \
 	template<typename T> \
 	using submoduleName##List = List<T, submoduleName##MemPoolWrapper>; \
 	using submoduleName##StringList = BaseStringList<submoduleName##MemPoolWrapper>; \
@@ -8,7 +8,14 @@
 #include <AnKi/Util/MemoryPool.h>
 #include <AnKi/Util/Hash.h>
 #include <AnKi/Util/Functions.h>
-#include <AnKi/Util/SparseArray.h>
+#include <AnKi/Util/Forward.h>
+#include <bit>
+
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
 
 namespace anki {
 
@@ -40,46 +47,246 @@ public:
 	}
 };
 
-/// SparseArray configuration. See SparseArray docs for details.
+/// HashMap configuration.
 /// @memberof HashMap
-class HashMapSparseArrayConfig
+class HashMapDefaultConfig
 {
 public:
-	using Index = U64;
-
-	static constexpr Index getInitialStorageSize()
+	/// The initial number of slots. It will be rounded up to a power of two.
+	static constexpr U32 getInitialStorageSize()
 	{
 		return 64;
 	}
 
-	static constexpr U32 getLinearProbingCount()
+	/// Load factor. If storage is loaded more than getMaxLoadFactor() then increase it.
+	static constexpr F32 getMaxLoadFactor()
 	{
-		return 8;
+		return 0.875f;
 	}
+};
 
-	static constexpr F32 getMaxLoadFactor()
+namespace detail {
+
+/// The positions inside a HashMapGroup that matched something.
+/// @internal
+class HashMapGroupBitMask
+{
+public:
+#if ANKI_SIMD_NEON
+	static constexpr U32 kBitsPerSlotLog2 = 2; ///< NEON doesn't have a movemask so every control byte becomes a nibble.
+#else
+	static constexpr U32 kBitsPerSlotLog2 = 0;
+#endif
+
+	U64 m_mask;
+
+	explicit operator Bool() const
+	{
+		return m_mask != 0;
+	}
+
+	U32 getLowestIndex() const
+	{
+		ANKI_ASSERT(m_mask);
+		return U32(std::countr_zero(m_mask)) >> kBitsPerSlotLog2;
+	}
+
+	void unsetLowest()
+	{
+		m_mask &= m_mask - 1;
+	}
+};
+
+/// A number of control bytes of the HashMap that are tested in one go.
+/// @internal
+class HashMapGroup
+{
+public:
+	static constexpr U32 kSize = 16;
+
+	/// The control byte of an empty slot. Full slots store 7 bits of their hash so the top bit is never set.
+	static constexpr U8 kEmpty = 0x80;
+
+	explicit HashMapGroup(const U8* ctrl)
+	{
+#if ANKI_SIMD_SSE
+		m_ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#elif ANKI_SIMD_NEON
+		m_ctrl = vld1q_u8(ctrl);
+#else
+		memcpy(&m_ctrl[0], ctrl, kSize);
+#endif
+	}
+
+	HashMapGroupBitMask match(U8 ctrlByte) const
+	{
+#if ANKI_SIMD_SSE
+		const __m128i eq = _mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(I8(ctrlByte)));
+		return {U64(U32(_mm_movemask_epi8(eq)))};
+#elif ANKI_SIMD_NEON
+		const uint8x16_t eq = vceqq_u8(m_ctrl, vdupq_n_u8(ctrlByte));
+		const U64 nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+		return {nibbles & 0x8888888888888888ull};
+#else
+		U64 mask = 0;
+		for(U32 i = 0; i < kSize; ++i)
+		{
+			mask |= U64(m_ctrl[i] == ctrlByte) << i;
+		}
+		return {mask};
+#endif
+	}
+
+	HashMapGroupBitMask matchEmpty() const
+	{
+		return match(kEmpty);
+	}
+
+private:
+#if ANKI_SIMD_SSE
+	__m128i m_ctrl;
+#elif ANKI_SIMD_NEON
+	uint8x16_t m_ctrl;
+#else
+	Array<U8, kSize> m_ctrl;
+#endif
+};
+
+} // end namespace detail
+
+/// HashMap iterator.
+template<typename TValuePointer, typename TValueReference, typename THashMapPtr>
+class HashMapIterator
+{
+	template<typename, typename, typename, typename, typename>
+	friend class HashMap;
+
+	template<typename, typename, typename>
+	friend class HashMapIterator;
+
+public:
+	/// Default constructor.
+	HashMapIterator() = default;
+
+	/// Copy.
+	HashMapIterator(const HashMapIterator& b) = default;
+
+	/// Allow conversion from iterator to const iterator.
+	template<typename YValuePointer, typename YValueReference, typename YHashMapPtr>
+	HashMapIterator(const HashMapIterator<YValuePointer, YValueReference, YHashMapPtr>& b)
+		: m_map(b.m_map)
+		, m_slotIdx(b.m_slotIdx)
+#if ANKI_EXTRA_CHECKS
+		, m_iteratorVer(b.m_iteratorVer)
+#endif
+	{
+	}
+
+	HashMapIterator& operator=(const HashMapIterator& b) = default;
+
+	TValueReference operator*() const
+	{
+		check();
+		return m_map->m_slots[m_slotIdx].m_value;
+	}
+
+	TValuePointer operator->() const
+	{
+		check();
+		return &m_map->m_slots[m_slotIdx].m_value;
+	}
+
+	HashMapIterator& operator++()
+	{
+		check();
+		m_slotIdx = m_map->findNextFull(m_slotIdx + 1);
+		return *this;
+	}
+
+	HashMapIterator operator++(int)
+	{
+		check();
+		HashMapIterator out = *this;
+		++(*this);
+		return out;
+	}
+
+	Bool operator==(const HashMapIterator& b) const
+	{
+		ANKI_ASSERT(m_map == b.m_map);
+#if ANKI_EXTRA_CHECKS
+		ANKI_ASSERT(m_iteratorVer == b.m_iteratorVer);
+#endif
+		return m_slotIdx == b.m_slotIdx;
+	}
+
+	Bool operator!=(const HashMapIterator& b) const
+	{
+		return !(*this == b);
+	}
+
+	/// Get the key of the element. Not available for maps that don't keep their keys (see HashMap::kStoresKeys).
+	const auto& getKey() const
+	{
+		static_assert(RemovePointer<THashMapPtr>::Type::kStoresKeys, "The map doesn't store keys");
+		check();
+		return m_map->m_slots[m_slotIdx].m_key;
+	}
+
+private:
+	THashMapPtr m_map = nullptr;
+	U32 m_slotIdx = kMaxU32;
+#if ANKI_EXTRA_CHECKS
+	U32 m_iteratorVer = kMaxU32; ///< See HashMap::m_iteratorVer.
+#endif
+
+	HashMapIterator(THashMapPtr map, U32 slotIdx)
+		: m_map(map)
+		, m_slotIdx(slotIdx)
+#if ANKI_EXTRA_CHECKS
+		, m_iteratorVer(map->m_iteratorVer)
+#endif
 	{
-		return 0.8f;
+		ANKI_ASSERT(map);
+	}
+
+	void check() const
+	{
+		ANKI_ASSERT(m_map);
+		ANKI_ASSERT(m_slotIdx < m_map->m_capacity);
+		ANKI_ASSERT(m_map->isFull(m_slotIdx));
+#if ANKI_EXTRA_CHECKS
+		ANKI_ASSERT(m_map->m_iteratorVer == m_iteratorVer);
+#endif
 	}
 };
 
-/// Hash map template.
+/// Hash map template. It's an open addressing hash table with linear probing. The metadata of the slots (a control byte that holds 7 bits of
+/// the hash) live in a separate array so probing tests a group of slots at once using SIMD. Erasing shifts the following elements back so
+/// there are no tombstones.
 template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>, typename TMemoryPool = SingletonMemoryPoolWrapper<DefaultMemoryPool>,
-		 typename TSparseArrayConfig = HashMapSparseArrayConfig>
+		 typename TConfig = HashMapDefaultConfig>
 class HashMap
 {
+	template<typename, typename, typename>
+	friend class HashMapIterator;
+
 public:
 	// Typedefs
-	using SparseArrayType = SparseArray<TValue, TMemoryPool, TSparseArrayConfig>;
 	using Value = TValue;
 	using Key = TKey;
 	using Hasher = THasher;
-	using Iterator = typename SparseArrayType::Iterator;
-	using ConstIterator = typename SparseArrayType::ConstIterator;
+	using Config = TConfig;
+	using Iterator = HashMapIterator<TValue*, TValue&, HashMap*>;
+	using ConstIterator = HashMapIterator<const TValue*, const TValue&, const HashMap*>;
+
+	/// The map keeps a copy of the keys and compares them on lookups. CString doesn't own its memory and the string it points to might not
+	/// outlive the map so for that the 64bit hash is the identity of the key.
+	static constexpr Bool kStoresKeys = !std::is_same_v<TKey, CString>;
 
 	/// Default constructor.
 	HashMap(const TMemoryPool& pool = TMemoryPool())
-		: m_sparseArr(pool)
+		: m_pool(pool)
 	{
 	}
 
@@ -91,48 +298,56 @@ public:
 
 	/// Copy.
 	HashMap(const HashMap& b)
-		: m_sparseArr(b.m_sparseArr)
 	{
+		*this = b;
 	}
 
-	~HashMap() = default;
-
-	/// Move.
-	HashMap& operator=(HashMap&& b)
+	~HashMap()
 	{
-		m_sparseArr = std::move(b.m_sparseArr);
-		return *this;
+		destroy();
 	}
 
 	/// Move.
-	HashMap& operator=(const HashMap& b)
+	HashMap& operator=(HashMap&& b)
 	{
-		m_sparseArr = b.m_sparseArr;
+		destroy();
+
+		m_pool = b.m_pool;
+		m_ctrl = b.m_ctrl;
+		m_slots = b.m_slots;
+		m_elementCount = b.m_elementCount;
+		m_capacity = b.m_capacity;
+		invalidateIterators();
+
+		b.resetMembers();
 		return *this;
 	}
 
+	/// Copy.
+	HashMap& operator=(const HashMap& b);
+
 	/// Get begin.
 	Iterator getBegin()
 	{
-		return m_sparseArr.getBegin();
+		return Iterator(this, findNextFull(0));
 	}
 
 	/// Get begin.
 	ConstIterator getBegin() const
 	{
-		return m_sparseArr.getBegin();
+		return ConstIterator(this, findNextFull(0));
 	}
 
 	/// Get end.
 	Iterator getEnd()
 	{
-		return m_sparseArr.getEnd();
+		return Iterator(this, kMaxU32);
 	}
 
 	/// Get end.
 	ConstIterator getEnd() const
 	{
-		return m_sparseArr.getEnd();
+		return ConstIterator(this, kMaxU32);
 	}
 
 	/// Get begin.
@@ -162,56 +377,222 @@ public:
 	/// Return true if map is empty.
 	Bool isEmpty() const
 	{
-		return m_sparseArr.isEmpty();
+		return m_elementCount == 0;
 	}
 
 	PtrSize getSize() const
 	{
-		return m_sparseArr.getSize();
+		return m_elementCount;
 	}
 
-	/// Destroy the list.
-	void destroy()
-	{
-		m_sparseArr.destroy();
-	}
+	/// Destroy the map and free its elements.
+	void destroy();
 
-	/// Construct an element inside the map.
+	/// Construct an element inside the map. If the key exists the old value is replaced.
 	template<typename... TArgs>
-	Iterator emplace(const TKey& key, TArgs&&... args)
-	{
-		const U64 hash = THasher()(key);
-		return m_sparseArr.emplace(hash, std::forward<TArgs>(args)...);
-	}
+	Iterator emplace(const TKey& key, TArgs&&... args);
 
 	/// Erase element.
-	void erase(Iterator it)
-	{
-		m_sparseArr.erase(it);
-	}
+	void erase(Iterator it);
 
 	/// Find a value using a key.
 	Iterator find(const Key& key)
 	{
-		const U64 hash = THasher()(key);
-		return m_sparseArr.find(hash);
+		return Iterator(this, findInternal(key));
 	}
 
 	/// Find a value using a key.
 	ConstIterator find(const Key& key) const
 	{
-		const U64 hash = THasher()(key);
-		return m_sparseArr.find(hash);
+		return ConstIterator(this, findInternal(key));
+	}
+
+	/// Check the validity of the map.
+	void validate() const;
+
+private:
+	static constexpr U32 kGroupSize = detail::HashMapGroup::kSize;
+	static constexpr U8 kEmpty = detail::HashMapGroup::kEmpty;
+
+	using StoredKey = std::conditional_t<kStoresKeys, TKey, U8>;
+
+	/// The storage of an element. The members are constructed in-place when the slot gets full.
+	class Slot
+	{
+	public:
+		U64 m_hash; ///< The mixed hash. Keeps the lookups and the re-hashing from calling the hasher again.
+
+		union
+		{
+			StoredKey m_key;
+		};
+
+		union
+		{
+			TValue m_value;
+		};
+
+		Slot()
+		{
+		}
+
+		~Slot()
+		{
+		}
+	};
+
+	TMemoryPool m_pool;
+	U8* m_ctrl = nullptr; ///< One control byte per slot. The first kGroupSize-1 are mirrored at the end so groups can wrap around.
+	Slot* m_slots = nullptr;
+	U32 m_elementCount = 0;
+	U32 m_capacity = 0;
+
+#if ANKI_EXTRA_CHECKS
+	/// Iterators version. Used to check if iterators point to the newest storage. Needs to be changed whenever we need to invalidate
+	/// iterators.
+	U32 m_iteratorVer = 0;
+#endif
+
+	/// The hashers might return weak hashes (identity for example) so mix the bits. It's a bijection so equal mixed hashes mean equal hashes.
+	static U64 mixHash(U64 h)
+	{
+		h ^= h >> 33u;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33u;
+		return h;
 	}
 
-	SparseArrayType& getSparseArray()
+	static U64 computeKeyHash(const TKey& key)
 	{
-		return m_sparseArr;
+		return mixHash(THasher()(key));
 	}
 
-protected:
-	SparseArrayType m_sparseArr;
+	/// Where the probing of a hash starts.
+	U32 getHomeSlot(U64 hash) const
+	{
+		return U32(hash >> 7u) & (m_capacity - 1);
+	}
+
+	/// The 7 bits of the hash that go to the control byte.
+	static U8 getControlByte(U64 hash)
+	{
+		return U8(hash & 0x7Fu);
+	}
+
+	U32 wrap(U32 slot) const
+	{
+		ANKI_ASSERT(isPowerOfTwo(m_capacity));
+		return slot & (m_capacity - 1);
+	}
+
+	Bool isFull(U32 slot) const
+	{
+		ANKI_ASSERT(slot < m_capacity);
+		return (m_ctrl[slot] & kEmpty) == 0;
+	}
+
+	void setControlByte(U32 slot, U8 ctrl)
+	{
+		ANKI_ASSERT(slot < m_capacity);
+		m_ctrl[slot] = ctrl;
+		if(slot < kGroupSize - 1)
+		{
+			m_ctrl[m_capacity + slot] = ctrl;
+		}
+	}
+
+	Bool keysEqual(const Slot& slot, [[maybe_unused]] const TKey& key) const
+	{
+		if constexpr(kStoresKeys)
+		{
+			return slot.m_key == key;
+		}
+		else
+		{
+			return true;
+		}
+	}
+
+	/// Find the first full slot starting from a slot. Returns kMaxU32 if there is none.
+	U32 findNextFull(U32 slot) const
+	{
+		for(; slot < m_capacity; ++slot)
+		{
+			if(isFull(slot))
+			{
+				return slot;
+			}
+		}
+
+		return kMaxU32;
+	}
+
+	/// Find an element and return its slot or kMaxU32 if not found.
+	U32 findInternal(const TKey& key) const;
+
+	/// Find an empty slot for a hash that is known not to be in the map.
+	U32 findEmptySlot(U64 hash) const;
+
+	/// Allocate new storage and re-insert the elements.
+	void rehash(U32 newCapacity);
+
+	void destroySlot(Slot& slot)
+	{
+		if constexpr(kStoresKeys)
+		{
+			callDestructor(slot.m_key);
+		}
+		callDestructor(slot.m_value);
+#if ANKI_EXTRA_CHECKS
+		memset(static_cast<void*>(&slot), 0xC, sizeof(slot));
+#endif
+	}
+
+	/// Move-construct a slot and destroy the source.
+	void moveSlot(Slot& from, Slot& to)
+	{
+		to.m_hash = from.m_hash;
+		if constexpr(kStoresKeys)
+		{
+			callConstructor(to.m_key, std::move(from.m_key));
+		}
+		callConstructor(to.m_value, std::move(from.m_value));
+		destroySlot(from);
+	}
+
+	/// Reset the class.
+	void resetMembers()
+	{
+		m_ctrl = nullptr;
+		m_slots = nullptr;
+		m_elementCount = 0;
+		m_capacity = 0;
+		invalidateIterators();
+	}
+
+	void invalidateIterators()
+	{
+#if ANKI_EXTRA_CHECKS
+		++m_iteratorVer;
+#endif
+	}
+
+	static U32 getInitialStorageSize()
+	{
+		const U32 o = max<U32>(kGroupSize, nextPowerOfTwo(U32(TConfig::getInitialStorageSize())));
+		ANKI_ASSERT(isPowerOfTwo(o));
+		return o;
+	}
+
+	static F32 getMaxLoadFactor()
+	{
+		const F32 f = TConfig::getMaxLoadFactor();
+		ANKI_ASSERT(f > 0.0f && f < 1.0f);
+		return f;
+	}
 };
 /// @}
 
 } // end namespace anki
+
+#include <AnKi/Util/HashMap.inl.h>
@@ -0,0 +1,289 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/HashMap.h>
+
+namespace anki {
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool, typename TConfig>
+void HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>::destroy()
+{
+	if(m_slots)
+	{
+		for(U32 i = 0; i < m_capacity; ++i)
+		{
+			if(isFull(i))
+			{
+				destroySlot(m_slots[i]);
+			}
+		}
+
+		m_pool.free(m_slots);
+
+		ANKI_ASSERT(m_ctrl);
+		m_pool.free(m_ctrl);
+	}
+
+	resetMembers();
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool, typename TConfig>
+HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>& HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>::operator=(const HashMap& b)
+{
+	destroy();
+
+	m_pool = b.m_pool;
+
+	if(b.m_capacity == 0)
+	{
+		return *this;
+	}
+
+	// Allocate memory
+	m_slots = static_cast<Slot*>(m_pool.allocate(b.m_capacity * sizeof(Slot), alignof(Slot)));
+	m_ctrl = static_cast<U8*>(m_pool.allocate(b.m_capacity + kGroupSize - 1, 1));
+	memcpy(m_ctrl, b.m_ctrl, b.m_capacity + kGroupSize - 1);
+
+	for(U32 i = 0; i < b.m_capacity; ++i)
+	{
+		if(b.isFull(i))
+		{
+			m_slots[i].m_hash = b.m_slots[i].m_hash;
+			if constexpr(kStoresKeys)
+			{
+				callConstructor(m_slots[i].m_key, b.m_slots[i].m_key);
+			}
+			callConstructor(m_slots[i].m_value, b.m_slots[i].m_value);
+		}
+	}
+
+	// Set the rest
+	m_elementCount = b.m_elementCount;
+	m_capacity = b.m_capacity;
+	invalidateIterators();
+
+	return *this;
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool, typename TConfig>
+U32 HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>::findInternal(const TKey& key) const
+{
+	if(m_elementCount == 0) [[unlikely]]
+	{
+		return kMaxU32;
+	}
+
+	const U64 hash = computeKeyHash(key);
+	const U8 ctrl = getControlByte(hash);
+	U32 pos = getHomeSlot(hash);
+	while(true)
+	{
+		const detail::HashMapGroup group(m_ctrl + pos);
+
+		for(detail::HashMapGroupBitMask mask = group.match(ctrl); mask; mask.unsetLowest())
+		{
+			const U32 slot = wrap(pos + mask.getLowestIndex());
+			if(m_slots[slot].m_hash == hash && keysEqual(m_slots[slot], key)) [[likely]]
+			{
+				return slot;
+			}
+		}
+
+		// The elements are contiguous from their home slot so a gap means it's not there
+		if(group.matchEmpty())
+		{
+			return kMaxU32;
+		}
+
+		pos = wrap(pos + kGroupSize);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool, typename TConfig>
+U32 HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>::findEmptySlot(U64 hash) const
+{
+	U32 pos = getHomeSlot(hash);
+	while(true)
+	{
+		const detail::HashMapGroupBitMask mask = detail::HashMapGroup(m_ctrl + pos).matchEmpty();
+		if(mask)
+		{
+			return wrap(pos + mask.getLowestIndex());
+		}
+
+		pos = wrap(pos + kGroupSize);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool, typename TConfig>
+template<typename... TArgs>
+typename HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>::Iterator HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>::emplace(const TKey& key,
+																																	  TArgs&&... args)
+{
+	if(m_capacity == 0 || F32(m_elementCount + 1) > F32(m_capacity) * getMaxLoadFactor())
+	{
+		rehash((m_capacity == 0) ? getInitialStorageSize() : m_capacity * 2);
+	}
+
+	invalidateIterators();
+
+	const U64 hash = computeKeyHash(key);
+	const U8 ctrl = getControlByte(hash);
+	U32 pos = getHomeSlot(hash);
+	while(true)
+	{
+		const detail::HashMapGroup group(m_ctrl + pos);
+
+		for(detail::HashMapGroupBitMask mask = group.match(ctrl); mask; mask.unsetLowest())
+		{
+			const U32 slot = wrap(pos + mask.getLowestIndex());
+			if(m_slots[slot].m_hash == hash && keysEqual(m_slots[slot], key))
+			{
+				// Same key was found, replace. Construct first in case the args point to the old value
+				TValue tmp(std::forward<TArgs>(args)...);
+				callDestructor(m_slots[slot].m_value);
+				callConstructor(m_slots[slot].m_value, std::move(tmp));
+				return Iterator(this, slot);
+			}
+		}
+
+		// No tombstones so the first empty slot is where the element goes
+		const detail::HashMapGroupBitMask emptyMask = group.matchEmpty();
+		if(emptyMask)
+		{
+			const U32 slot = wrap(pos + emptyMask.getLowestIndex());
+			Slot& s = m_slots[slot];
+			s.m_hash = hash;
+			if constexpr(kStoresKeys)
+			{
+				callConstructor(s.m_key, key);
+			}
+			callConstructor(s.m_value, std::forward<TArgs>(args)...);
+			setControlByte(slot, ctrl);
+			++m_elementCount;
+
+			return Iterator(this, slot);
+		}
+
+		pos = wrap(pos + kGroupSize);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool, typename TConfig>
+void HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>::rehash(U32 newCapacity)
+{
+	ANKI_ASSERT(isPowerOfTwo(newCapacity) && newCapacity >= kGroupSize);
+	ANKI_ASSERT(F32(m_elementCount) < F32(newCapacity) * getMaxLoadFactor());
+
+	Slot* const oldSlots = m_slots;
+	U8* const oldCtrl = m_ctrl;
+	const U32 oldCapacity = m_capacity;
+
+	m_capacity = newCapacity;
+	m_slots = static_cast<Slot*>(m_pool.allocate(m_capacity * sizeof(Slot), alignof(Slot)));
+	m_ctrl = static_cast<U8*>(m_pool.allocate(m_capacity + kGroupSize - 1, 1));
+	memset(m_ctrl, kEmpty, m_capacity + kGroupSize - 1);
+
+	for(U32 i = 0; i < oldCapacity; ++i)
+	{
+		if((oldCtrl[i] & kEmpty) == 0)
+		{
+			const U32 slot = findEmptySlot(oldSlots[i].m_hash);
+			moveSlot(oldSlots[i], m_slots[slot]);
+			setControlByte(slot, oldCtrl[i]);
+		}
+	}
+
+	if(oldSlots)
+	{
+		m_pool.free(oldSlots);
+		m_pool.free(oldCtrl);
+	}
+
+	invalidateIterators();
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool, typename TConfig>
+void HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>::erase(Iterator it)
+{
+	ANKI_ASSERT(it.m_map == this);
+	it.check();
+	ANKI_ASSERT(m_elementCount > 0);
+
+	U32 hole = it.m_slotIdx;
+	destroySlot(m_slots[hole]);
+
+	// Shift back the elements that follow so the probing sequences stay contiguous
+	U32 pos = hole;
+	while(true)
+	{
+		pos = wrap(pos + 1);
+		if(!isFull(pos))
+		{
+			break;
+		}
+
+		// Move the element if its home slot is not in the cyclic range (hole, pos]
+		const U32 home = getHomeSlot(m_slots[pos].m_hash);
+		const Bool homeInRange = (hole <= pos) ? (home > hole && home <= pos) : (home > hole || home <= pos);
+		if(!homeInRange)
+		{
+			moveSlot(m_slots[pos], m_slots[hole]);
+			setControlByte(hole, m_ctrl[pos]);
+			hole = pos;
+		}
+	}
+
+	setControlByte(hole, kEmpty);
+	--m_elementCount;
+
+	// If you erased everything destroy the storage
+	if(m_elementCount == 0)
+	{
+		destroy();
+	}
+
+	invalidateIterators();
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool, typename TConfig>
+void HashMap<TKey, TValue, THasher, TMemoryPool, TConfig>::validate() const
+{
+	if(m_capacity == 0)
+	{
+		ANKI_ASSERT(m_elementCount == 0 && m_slots == nullptr && m_ctrl == nullptr);
+		return;
+	}
+
+	ANKI_ASSERT(isPowerOfTwo(m_capacity) && m_capacity >= kGroupSize);
+	ANKI_ASSERT(m_elementCount < m_capacity);
+
+	[[maybe_unused]] U32 elementCount = 0;
+	for(U32 i = 0; i < m_capacity; ++i)
+	{
+		ANKI_ASSERT(i >= kGroupSize - 1 || m_ctrl[i] == m_ctrl[m_capacity + i]);
+
+		if(isFull(i))
+		{
+			ANKI_ASSERT(m_ctrl[i] == getControlByte(m_slots[i].m_hash));
+
+			// Every slot from the home to the element should be full
+			for(U32 pos = getHomeSlot(m_slots[i].m_hash); pos != i; pos = wrap(pos + 1))
+			{
+				ANKI_ASSERT(isFull(pos));
+			}
+
+			++elementCount;
+		}
+		else
+		{
+			ANKI_ASSERT(m_ctrl[i] == kEmpty);
+		}
+	}
+
+	ANKI_ASSERT(m_elementCount == elementCount);
+}
+
+} // end namespace anki
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <AnKi/Util/String.h>
+#include <AnKi/Util/HashMap.h>
 
 namespace anki {
 
@@ -36,18 +37,51 @@ public:
 		return initInternal();
 	}
 
+	/// Watch a directory and all its subdirectories for files that get written. Use pollModifiedFiles() to get them.
+	/// @param dir The directory.
+	Error initRecursive(CString dir)
+	{
+		m_path = dir;
+		m_recursive = true;
+		return initInternal();
+	}
+
 	/// Check if the file was modified in any way.
 	Error pollEvents(Bool& modified);
 
+	/// Get the files that were written since the last call. Only works with initRecursive().
+	/// @param func A functor with signature void(CString filename). The filename is relative to the directory that was passed to
+	///             initRecursive(). The same file may be reported more than once.
+	/// @param[out] overflow If true some events were lost and the caller should assume that all files changed.
+	template<typename TFunc>
+	Error pollModifiedFiles(TFunc func, Bool& overflow)
+	{
+		return pollModifiedFilesInternal(
+			[](void* userData, CString filename) {
+				(*static_cast<TFunc*>(userData))(filename);
+			},
+			&func, overflow);
+	}
+
 private:
+	using ModifiedFileCallback = void (*)(void* userData, CString filename);
+
 	String m_path;
+	Bool m_recursive = false;
 #if ANKI_POSIX
 	int m_fd = -1;
 	int m_watch = -1;
+	HashMap<I32, String> m_subdirWatches; ///< Maps watch descriptors to subdirectories of m_path. Only with m_recursive.
 #endif
 
 	void destroyInternal();
 	Error initInternal();
+	Error pollModifiedFilesInternal(ModifiedFileCallback callback, void* userData, Bool& overflow);
+
+#if ANKI_POSIX
+	/// Watch a subdirectory and the subdirectories inside it. If callback is not nullptr report the files inside them.
+	Error addSubdirWatches(CString subdir, ModifiedFileCallback callback, void* userData);
+#endif
 };
 /// @}
 
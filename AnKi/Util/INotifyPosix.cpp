@@ -5,6 +5,7 @@
 
 #include <AnKi/Util/INotify.h>
 #include <AnKi/Util/Logger.h>
+#include <AnKi/Util/Filesystem.h>
 #include <sys/inotify.h>
 #include <poll.h>
 #include <unistd.h>
@@ -24,7 +25,7 @@ Error INotify::initInternal()
 		err = Error::kFunctionFailed;
 	}
 
-	if(!err)
+	if(!err && !m_recursive)
 	{
 		m_watch = inotify_add_watch(m_fd, &m_path[0], IN_MODIFY | IN_CREATE | IN_DELETE | IN_IGNORED | IN_DELETE_SELF);
 		if(m_watch < 0)
@@ -33,6 +34,10 @@ Error INotify::initInternal()
 			err = Error::kFunctionFailed;
 		}
 	}
+	else if(!err)
+	{
+		err = addSubdirWatches("", nullptr, nullptr);
+	}
 
 	if(err)
 	{
@@ -42,8 +47,72 @@ Error INotify::initInternal()
 	return err;
 }
 
+Error INotify::addSubdirWatches(CString subdir, ModifiedFileCallback callback, void* userData)
+{
+	auto fullPath = [this](CString subdir) {
+		String path;
+		if(subdir.isEmpty())
+		{
+			path = m_path;
+		}
+		else
+		{
+			path.sprintf("%s/%s", m_path.cstr(), subdir.cstr());
+		}
+		return path;
+	};
+
+	// Gather the subdirectories. Also report the files since they might have been written before the watches are added
+	DynamicArray<String> subdirs;
+	subdirs.emplaceBack(subdir);
+	ANKI_CHECK(walkDirectoryTree(fullPath(subdir), [&](WalkDirectoryArgs& args) -> Error {
+		String path;
+		if(subdir.isEmpty())
+		{
+			path = args.m_path;
+		}
+		else
+		{
+			path.sprintf("%s/%s", subdir.cstr(), args.m_path.cstr());
+		}
+
+		if(args.m_isDirectory)
+		{
+			subdirs.emplaceBack(std::move(path));
+		}
+		else if(callback)
+		{
+			callback(userData, path);
+		}
+
+		return Error::kNone;
+	}));
+
+	for(String& dir : subdirs)
+	{
+		// IN_CREATE is only for the new subdirectories
+		const String path = fullPath(dir);
+		const int watch = inotify_add_watch(m_fd, path.cstr(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB | IN_CREATE | IN_ONLYDIR);
+		if(watch < 0)
+		{
+			ANKI_UTIL_LOGE("inotify_add_watch() failed for %s: %s", path.cstr(), strerror(errno));
+			return Error::kFunctionFailed;
+		}
+
+		m_subdirWatches.emplace(watch, std::move(dir));
+	}
+
+	return Error::kNone;
+}
+
 void INotify::destroyInternal()
 {
+	if(m_recursive)
+	{
+		// Closing the descriptor removes all the watches
+		m_subdirWatches.destroy();
+	}
+
 	if(m_watch >= 0)
 	{
 		int err = inotify_rm_watch(m_fd, m_watch);
@@ -128,4 +197,92 @@ Error INotify::pollEvents(Bool& modified)
 	return err;
 }
 
+Error INotify::pollModifiedFilesInternal(ModifiedFileCallback callback, void* userData, Bool& overflow)
+{
+	ANKI_ASSERT(m_fd >= 0 && m_recursive);
+
+	overflow = false;
+
+	while(true)
+	{
+		pollfd pfd = {m_fd, POLLIN, 0};
+		const int ret = poll(&pfd, 1, 0);
+
+		if(ret < 0)
+		{
+			ANKI_UTIL_LOGE("poll() failed: %s", strerror(errno));
+			return Error::kFunctionFailed;
+		}
+		else if(ret == 0)
+		{
+			// No events, move on
+			break;
+		}
+
+		alignas(inotify_event) Array<U8, 4_KB> readBuff;
+		const ssize_t nbytes = read(m_fd, &readBuff[0], sizeof(readBuff));
+		if(nbytes <= 0)
+		{
+			ANKI_UTIL_LOGE("read() failed to read the expected size of data: %s", strerror(errno));
+			return Error::kFunctionFailed;
+		}
+
+		// A read returns many events
+		PtrSize offset = 0;
+		while(offset < PtrSize(nbytes))
+		{
+			const inotify_event& event = *reinterpret_cast<const inotify_event*>(&readBuff[offset]);
+			offset += sizeof(inotify_event) + event.len;
+
+			if(event.mask & IN_Q_OVERFLOW)
+			{
+				overflow = true;
+				continue;
+			}
+
+			auto it = m_subdirWatches.find(event.wd);
+			if(it == m_subdirWatches.getEnd())
+			{
+				continue;
+			}
+
+			if(event.mask & IN_IGNORED)
+			{
+				// The directory was removed
+				m_subdirWatches.erase(it);
+				continue;
+			}
+
+			if(event.len == 0)
+			{
+				continue;
+			}
+
+			String filename;
+			if(it->isEmpty())
+			{
+				filename = event.name;
+			}
+			else
+			{
+				filename.sprintf("%s/%s", it->cstr(), event.name);
+			}
+
+			if(event.mask & IN_ISDIR)
+			{
+				if(event.mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					ANKI_CHECK(addSubdirWatches(filename, callback, userData));
+				}
+			}
+			else if(event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB))
+			{
+				callback(userData, filename);
+			}
+		}
+	}
+
+	return Error::kNone;
+}
+
 } // end namespace anki
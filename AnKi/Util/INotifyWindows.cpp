@@ -10,6 +10,12 @@ namespace anki {
 Error INotify::initInternal()
 {
 	// TODO
+	if(m_recursive)
+	{
+		// Not supported yet. Let the caller fallback to something else
+		return Error::kFunctionFailed;
+	}
+
 	return Error::kNone;
 }
 
@@ -25,4 +31,11 @@ Error INotify::pollEvents(Bool& modified)
 	return Error::kNone;
 }
 
+Error INotify::pollModifiedFilesInternal([[maybe_unused]] ModifiedFileCallback callback, [[maybe_unused]] void* userData, Bool& overflow)
+{
+	ANKI_ASSERT(!"Not supported");
+	overflow = true;
+	return Error::kNone;
+}
+
 } // end namespace anki
@@ -6,6 +6,7 @@
 #include <AnKi/Util/File.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Util/System.h>
+#include <AnKi/Util/HighRezTimer.h>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
@@ -19,6 +20,23 @@
 
 namespace anki {
 
+/// A slot of the queue of the asynchronous logger.
+class Logger::AsyncMessage
+{
+public:
+	Atomic<U64, AtomicMemoryOrder::kSeqCst> m_sequence = {0};
+
+	const Char* m_file;
+	const Char* m_func;
+	const Char* m_subsystem;
+	Char* m_longMsg; ///< Allocated if the message doesn't fit in m_msg.
+	Second m_time;
+	I32 m_line;
+	LoggerMessageType m_type;
+	Array<Char, Thread::kThreadNameMaxLength + 1> m_threadName;
+	Array<Char, 256> m_msg;
+};
+
 Logger::Logger()
 {
 	addMessageHandler(this, &defaultSystemMessageHandler);
@@ -32,6 +50,7 @@ Logger::Logger()
 
 Logger::~Logger()
 {
+	stopAsync();
 }
 
 void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback)
@@ -42,6 +61,9 @@ void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback
 
 void Logger::removeMessageHandler(void* data, LoggerMessageHandlerCallback callback)
 {
+	// The handler might be about to die. Give it the messages that are in flight
+	flush();
+
 	LockGuard<Mutex> lock(m_mutex);
 
 	U i;
@@ -69,17 +91,30 @@ void Logger::writeInternal(const Char* file, int line, const Char* func, const C
 	const Char* baseFile = strrchr(file, (ANKI_OS_WINDOWS) ? '\\' : '/');
 	baseFile = (baseFile) ? baseFile + 1 : file;
 
-	LoggerMessageInfo inf = {baseFile, line, func, type, msg, subsystem, threadName};
-
-	m_mutex.lock();
+	const Second time = HighRezTimer::getCurrentTime();
 
-	U count = m_handlersCount;
-	while(count-- != 0)
+	m_async.m_writerCount.fetchAdd(1);
+	Bool queued = false;
+	if(m_async.m_enabled.load())
 	{
-		m_handlers[count].m_callback(m_handlers[count].m_data, inf);
+		queued = asyncEnqueue(baseFile, line, func, subsystem, type, threadName, msg, time);
+
+		// Errors might be followed by a crash so make sure they are out
+		if(queued && (type == LoggerMessageType::kError || type == LoggerMessageType::kFatal))
+		{
+			flush();
+		}
 	}
+	m_async.m_writerCount.fetchSub(1);
+
+	if(!queued)
+	{
+		const LoggerMessageInfo inf = {baseFile, line, func, type, msg, subsystem, threadName, time};
 
-	m_mutex.unlock();
+		m_mutex.lock();
+		callHandlers(inf);
+		m_mutex.unlock();
+	}
 
 	if(type == LoggerMessageType::kFatal)
 	{
@@ -96,6 +131,258 @@ void Logger::writeInternal(const Char* file, int line, const Char* func, const C
 	}
 }
 
+void Logger::callHandlers(const LoggerMessageInfo& info)
+{
+	U count = m_handlersCount;
+	while(count-- != 0)
+	{
+		m_handlers[count].m_callback(m_handlers[count].m_data, info);
+	}
+}
+
+void Logger::startAsync(U32 queueSize, LoggerOverflowPolicy overflowPolicy)
+{
+	if(m_async.m_enabled.load())
+	{
+		return;
+	}
+
+	ANKI_ASSERT(queueSize > 0);
+	queueSize = nextPowerOfTwo(queueSize);
+
+	// Don't use the memory pools, the logger outlives them
+	m_async.m_queue = static_cast<AsyncMessage*>(malloc(sizeof(AsyncMessage) * queueSize));
+	if(!m_async.m_queue)
+	{
+		return;
+	}
+
+	for(U32 i = 0; i < queueSize; ++i)
+	{
+		::new(&m_async.m_queue[i]) AsyncMessage();
+		m_async.m_queue[i].m_sequence.setNonAtomically(i);
+	}
+
+	m_async.m_queueMask = queueSize - 1;
+	m_async.m_overflowPolicy = overflowPolicy;
+	m_async.m_enqueuePos.store(0);
+	m_async.m_dequeuePos.store(0);
+	m_async.m_quit.store(false);
+
+	m_async.m_thread.start(this, asyncThreadMain);
+	m_async.m_enabled.store(true);
+}
+
+void Logger::stopAsync()
+{
+	if(!m_async.m_enabled.load())
+	{
+		return;
+	}
+
+	// New messages will go to the handlers directly. Wait for the writers that saw the async mode enabled
+	m_async.m_enabled.store(false);
+	while(m_async.m_writerCount.load() != 0)
+	{
+		std::this_thread::yield();
+	}
+
+	// The thread will drain the queue before quitting
+	m_async.m_quit.store(true);
+	asyncWakeThread();
+	[[maybe_unused]] const Error err = m_async.m_thread.join();
+
+	for(U32 i = 0; i <= m_async.m_queueMask; ++i)
+	{
+		m_async.m_queue[i].~AsyncMessage();
+	}
+	free(m_async.m_queue);
+	m_async.m_queue = nullptr;
+	m_async.m_queueMask = 0;
+}
+
+void Logger::flush()
+{
+	if(!m_async.m_enabled.load() || Thread::getCurrentThreadName() == CString("AnKiLogger"))
+	{
+		return;
+	}
+
+	const U64 pos = m_async.m_enqueuePos.load();
+	while(m_async.m_dequeuePos.load() < pos)
+	{
+		asyncWakeThread();
+		std::this_thread::yield();
+	}
+}
+
+Bool Logger::asyncEnqueue(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
+						  const Char* msg, Second time)
+{
+	// The logger thread can't wait for itself (a handler wrote a message)
+	const Bool canBlock = m_async.m_overflowPolicy == LoggerOverflowPolicy::kBlock && Thread::getCurrentThreadName() != CString("AnKiLogger");
+
+	// Reserve a slot
+	AsyncMessage* slot;
+	U64 pos = m_async.m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
+	while(true)
+	{
+		slot = &m_async.m_queue[pos & m_async.m_queueMask];
+		const U64 seq = slot->m_sequence.load(AtomicMemoryOrder::kAcquire);
+		const I64 diff = I64(seq) - I64(pos);
+		if(diff == 0)
+		{
+			// The slot is free, try to grab it
+			if(m_async.m_enqueuePos.compareExchange(pos, pos + 1))
+			{
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			// The queue is full
+			if(!canBlock)
+			{
+				m_async.m_droppedMessageCount.fetchAdd(1);
+				asyncWakeThread();
+				return true;
+			}
+
+			asyncWakeThread();
+			std::this_thread::yield();
+			pos = m_async.m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
+		}
+		else
+		{
+			// Another thread got the slot
+			pos = m_async.m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
+		}
+	}
+
+	// Write it
+	slot->m_file = file;
+	slot->m_func = func;
+	slot->m_subsystem = subsystem;
+	slot->m_time = time;
+	slot->m_line = line;
+	slot->m_type = type;
+
+	const CString threadNameStr = (threadName) ? threadName : "";
+	const U32 threadNameLen = min<U32>(threadNameStr.getLength(), Thread::kThreadNameMaxLength);
+	memcpy(&slot->m_threadName[0], threadNameStr.cstr(), threadNameLen);
+	slot->m_threadName[threadNameLen] = '\0';
+
+	const PtrSize msgLen = strlen(msg);
+	if(msgLen < slot->m_msg.getSize())
+	{
+		memcpy(&slot->m_msg[0], msg, msgLen + 1);
+		slot->m_longMsg = nullptr;
+	}
+	else
+	{
+		slot->m_longMsg = static_cast<Char*>(malloc(msgLen + 1));
+		memcpy(slot->m_longMsg, msg, msgLen + 1);
+	}
+
+	// Publish it. Sequentially consistent because m_threadSleeping is read next
+	slot->m_sequence.store(pos + 1);
+
+	if(m_async.m_threadSleeping.load())
+	{
+		asyncWakeThread();
+	}
+
+	return true;
+}
+
+U32 Logger::asyncDrain()
+{
+	U32 count = 0;
+	LockGuard<Mutex> lock(m_mutex);
+
+	while(true)
+	{
+		const U64 pos = m_async.m_dequeuePos.load(AtomicMemoryOrder::kRelaxed);
+		AsyncMessage& slot = m_async.m_queue[pos & m_async.m_queueMask];
+		if(slot.m_sequence.load(AtomicMemoryOrder::kAcquire) != pos + 1)
+		{
+			// Empty
+			break;
+		}
+
+		const LoggerMessageInfo info = {
+			slot.m_file,      slot.m_line,           slot.m_func, slot.m_type, (slot.m_longMsg) ? slot.m_longMsg : &slot.m_msg[0],
+			slot.m_subsystem, &slot.m_threadName[0], slot.m_time};
+		callHandlers(info);
+
+		if(slot.m_longMsg)
+		{
+			free(slot.m_longMsg);
+			slot.m_longMsg = nullptr;
+		}
+
+		// Free the slot for the next round of the ring
+		slot.m_sequence.store(pos + m_async.m_queueMask + 1, AtomicMemoryOrder::kRelease);
+		m_async.m_dequeuePos.store(pos + 1);
+		++count;
+	}
+
+	const U32 droppedCount = m_async.m_droppedMessageCount.load();
+	if(droppedCount != m_async.m_reportedDroppedMessageCount)
+	{
+		Array<Char, 128> msg;
+		snprintf(&msg[0], msg.getSize(), "The logger queue was full and %u messages were dropped",
+				 droppedCount - m_async.m_reportedDroppedMessageCount);
+		m_async.m_reportedDroppedMessageCount = droppedCount;
+
+		const LoggerMessageInfo info = {ANKI_FILE, __LINE__, ANKI_FUNC,    LoggerMessageType::kWarning,
+										&msg[0],   "UTIL",   "AnKiLogger", HighRezTimer::getCurrentTime()};
+		callHandlers(info);
+	}
+
+	return count;
+}
+
+void Logger::asyncWakeThread()
+{
+	LockGuard<Mutex> lock(m_async.m_wakeMtx);
+	m_async.m_wakeCond.notifyOne();
+}
+
+Error Logger::asyncThreadMain(ThreadCallbackInfo& info)
+{
+	Logger& self = *static_cast<Logger*>(info.m_userData);
+	Async& async = self.m_async;
+
+	while(true)
+	{
+		if(self.asyncDrain() > 0)
+		{
+			continue;
+		}
+
+		if(async.m_quit.load())
+		{
+			// The writers are done (see stopAsync()) and the queue is empty
+			break;
+		}
+
+		// Sleep. The writers see m_threadSleeping and wake it. Check the queue after setting m_threadSleeping so a message that was written
+		// before the writer saw the flag is not missed
+		LockGuard<Mutex> lock(async.m_wakeMtx);
+		async.m_threadSleeping.store(true);
+		const U64 pos = async.m_dequeuePos.load();
+		const Bool empty = async.m_queue[pos & async.m_queueMask].m_sequence.load() != pos + 1;
+		if(empty && !async.m_quit.load())
+		{
+			async.m_wakeCond.wait(async.m_wakeMtx);
+		}
+		async.m_threadSleeping.store(false);
+	}
+
+	return Error::kNone;
+}
+
 void Logger::writeFormated(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
 						   const Char* fmt, ...)
 {
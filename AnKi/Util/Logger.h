@@ -8,6 +8,7 @@
 #include <AnKi/Config.h>
 #include <AnKi/Util/Singleton.h>
 #include <AnKi/Util/Thread.h>
+#include <AnKi/Util/Atomic.h>
 
 namespace anki {
 
@@ -43,6 +44,15 @@ public:
 	const Char* m_msg;
 	const Char* m_subsystem;
 	const Char* m_threadName;
+	Second m_time; ///< The time the message was written. See HighRezTimer::getCurrentTime().
+};
+
+/// What happens when the queue of the asynchronous logger is full.
+/// @memberof Logger
+enum class LoggerOverflowPolicy : U8
+{
+	kBlock, ///< Wait for the logger thread to make room.
+	kDrop ///< Drop the message. The logger thread will report how many messages were dropped.
 };
 
 /// The message handler callback.
@@ -52,6 +62,7 @@ using LoggerMessageHandlerCallback = void (*)(void*, const LoggerMessageInfo& in
 /// The logger singleton class. The logger cannot print errors or throw exceptions, it has to recover somehow. It's thread safe.
 /// To add a new signal:
 /// @code logger.addMessageHandler((void*)obj, &function) @endcode
+/// By default the handlers are called by the thread that writes the message. See startAsync() for the asynchronous mode.
 class Logger : public MakeSingleton<Logger>
 {
 	template<typename>
@@ -67,6 +78,24 @@ public:
 	/// Add file message handler.
 	void addFileMessageHandler(File* file);
 
+	/// Start a thread that will pass the messages to the handlers. From then on writing a message only copies it to a lock-free queue. Errors
+	/// and fatal errors still wait for the queue to flush so they are not lost if the application crashes right after.
+	/// The file, function and subsystem strings of the messages should outlive the messages (they are usually string literals).
+	/// @param queueSize The max number of messages in the queue. Will be rounded up to a power of two.
+	void startAsync(U32 queueSize = 1024, LoggerOverflowPolicy overflowPolicy = LoggerOverflowPolicy::kBlock);
+
+	/// Pass the remaining messages to the handlers and stop the logger thread.
+	void stopAsync();
+
+	/// Wait until the messages written so far reach the handlers. Does nothing if the logger is not asynchronous.
+	void flush();
+
+	/// The number of messages dropped because of LoggerOverflowPolicy::kDrop.
+	U32 getDroppedMessageCount() const
+	{
+		return m_async.m_droppedMessageCount.load();
+	}
+
 	/// Send a message.
 	void write(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName, const Char* msg)
 	{
@@ -103,11 +132,40 @@ private:
 		LoggerMessageHandlerCallback m_callback = nullptr;
 	};
 
+	class AsyncMessage;
+
+	/// The state of the asynchronous mode. The queue is a bounded MPSC ring buffer. Every slot has a sequence number that tells the producers
+	/// and the consumer if the slot is free or written. The atomics are sequentially consistent because the writers and the logger thread use
+	/// pairs of them to signal each other.
+	class Async
+	{
+	public:
+		AsyncMessage* m_queue = nullptr;
+		U32 m_queueMask = 0;
+		LoggerOverflowPolicy m_overflowPolicy = LoggerOverflowPolicy::kBlock;
+
+		Atomic<U64, AtomicMemoryOrder::kSeqCst> m_enqueuePos = {0};
+		Atomic<U64, AtomicMemoryOrder::kSeqCst> m_dequeuePos = {0}; ///< Only the logger thread changes it.
+
+		Atomic<Bool, AtomicMemoryOrder::kSeqCst> m_enabled = {false};
+		Atomic<U32, AtomicMemoryOrder::kSeqCst> m_writerCount = {0}; ///< Threads that are in the middle of writing.
+		Atomic<U32, AtomicMemoryOrder::kSeqCst> m_droppedMessageCount = {0};
+		U32 m_reportedDroppedMessageCount = 0;
+
+		Thread m_thread{"AnKiLogger"};
+		Mutex m_wakeMtx;
+		ConditionVariable m_wakeCond;
+		Atomic<Bool, AtomicMemoryOrder::kSeqCst> m_threadSleeping = {false};
+		Atomic<Bool, AtomicMemoryOrder::kSeqCst> m_quit = {false};
+	};
+
 	Mutex m_mutex; ///< For thread safety
 	Array<Handler, 4> m_handlers;
 	U32 m_handlersCount = 0;
 	Bool m_verbosityEnabled = false;
 
+	Async m_async;
+
 	/// Initialize the logger and add the default message handler
 	Logger();
 
@@ -118,6 +176,17 @@ private:
 
 	void writeInternal(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
 					   const Char* msg);
+
+	void callHandlers(const LoggerMessageInfo& info);
+
+	Bool asyncEnqueue(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
+					  const Char* msg, Second time);
+
+	U32 asyncDrain();
+
+	void asyncWakeThread();
+
+	static Error asyncThreadMain(ThreadCallbackInfo& info);
 };
 
 #define ANKI_LOG(subsystem_, t, ...) \
@@ -244,6 +244,13 @@ public:
 		return m_builder.getMemoryCapacity();
 	}
 
+	/// Get the memory allocated since the last reset().
+	/// @note It's not thread safe with other methods.
+	PtrSize getAllocatedSize() const
+	{
+		return m_builder.getAllocatedSize();
+	}
+
 private:
 	/// This is the absolute max alignment.
 	static constexpr U32 kMaxAlignment = ANKI_SAFE_ALIGNMENT;
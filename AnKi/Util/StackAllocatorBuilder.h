@@ -86,6 +86,10 @@ public:
 		return m_memoryCapacity;
 	}
 
+	/// Get the memory handed out since the last reset. It includes the alignment padding and the unused end of the full chunks.
+	/// @note Not thread safe. Don't call it while calling allocate.
+	PtrSize getAllocatedSize() const;
+
 private:
 	/// The current chunk. Chose the more strict memory order to avoid compiler re-ordering of instructions
 	Atomic<TChunk*, AtomicMemoryOrder::kSeqCst> m_crntChunk = {nullptr};
@@ -193,6 +193,23 @@ void StackAllocatorBuilder<TChunk, TInterface, TLock>::free()
 	}
 }
 
+template<typename TChunk, typename TInterface, typename TLock>
+PtrSize StackAllocatorBuilder<TChunk, TInterface, TLock>::getAllocatedSize() const
+{
+	PtrSize size = 0;
+	const TChunk* chunk = m_chunksListHead;
+	for(U32 i = 0; i < m_chunksInUse; ++i)
+	{
+		ANKI_ASSERT(chunk);
+
+		// The offset might be past the end of the chunk if an allocation didn't fit
+		size += min(chunk->m_offsetInChunk.load(), chunk->m_chunkSize);
+		chunk = chunk->m_nextChunk;
+	}
+
+	return size;
+}
+
 template<typename TChunk, typename TInterface, typename TLock>
 void StackAllocatorBuilder<TChunk, TInterface, TLock>::reset()
 {
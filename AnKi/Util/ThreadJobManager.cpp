@@ -5,29 +5,142 @@
 
 #include <AnKi/Util/ThreadJobManager.h>
 #include <AnKi/Util/String.h>
+#include <AnKi/Util/Tracer.h>
 
 namespace anki {
 
-ThreadJobManager::WorkerThread::WorkerThread(ThreadJobManager* manager, U32 id, Bool pinToCore, CString threadName)
+// How many times a thread will look for work before going to sleep
+constexpr U32 kSpinCount = 64;
+
+class ThreadJobManager::Task
+{
+public:
+	class Continuation
+	{
+	public:
+		Task* m_task;
+		Continuation* m_next;
+	};
+
+	Func m_func;
+	Task* m_parent = nullptr;
+	const Char* m_name = nullptr;
+	U64 m_uuid = 0;
+
+	Continuation* m_continuations = nullptr; // Protected by m_lock
+	Bool m_finished = false; // Protected by m_lock
+	mutable SpinLock m_lock;
+
+	Atomic<U32> m_pendingDependencyCount = {1}; // The dependencies plus one for the submit
+	Atomic<U32> m_unfinishedCount = {1}; // The task itself plus its unfinished children
+	Atomic<U64> m_flowId = {0}; // The edge that made the task runnable. Used for tracing
+
+#if ANKI_ASSERTIONS_ENABLED
+	Bool m_submitted = false;
+#endif
+};
+
+thread_local ThreadJobManager::WorkerThread* ThreadJobManager::m_currentWorker = nullptr;
+
+void ThreadJobManager::TaskQueue::init(U32 size)
+{
+	ANKI_ASSERT(isPowerOfTwo(size));
+	m_cells.resize(size);
+	m_mask = size - 1;
+
+	for(U32 i = 0; i < size; ++i)
+	{
+		m_cells[i].m_sequence.setNonAtomically(i);
+	}
+}
+
+Bool ThreadJobManager::TaskQueue::tryPush(const Func& func)
+{
+	Cell* cell;
+	U64 pos = m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
+	while(true)
+	{
+		cell = &m_cells[U32(pos & m_mask)];
+		const U64 seq = cell->m_sequence.load(AtomicMemoryOrder::kAcquire);
+		const I64 diff = I64(seq) - I64(pos);
+		if(diff == 0)
+		{
+			if(m_enqueuePos.compareExchange(pos, pos + 1, AtomicMemoryOrder::kRelaxed, AtomicMemoryOrder::kRelaxed))
+			{
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			// Full
+			return false;
+		}
+		else
+		{
+			pos = m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
+		}
+	}
+
+	cell->m_func = func;
+	cell->m_sequence.store(pos + 1, AtomicMemoryOrder::kRelease);
+	return true;
+}
+
+Bool ThreadJobManager::TaskQueue::tryPop(Func& func)
+{
+	Cell* cell;
+	U64 pos = m_dequeuePos.load(AtomicMemoryOrder::kRelaxed);
+	while(true)
+	{
+		cell = &m_cells[U32(pos & m_mask)];
+		const U64 seq = cell->m_sequence.load(AtomicMemoryOrder::kAcquire);
+		const I64 diff = I64(seq) - I64(pos + 1);
+		if(diff == 0)
+		{
+			if(m_dequeuePos.compareExchange(pos, pos + 1, AtomicMemoryOrder::kRelaxed, AtomicMemoryOrder::kRelaxed))
+			{
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			// Empty
+			return false;
+		}
+		else
+		{
+			pos = m_dequeuePos.load(AtomicMemoryOrder::kRelaxed);
+		}
+	}
+
+	func = std::move(cell->m_func);
+	cell->m_sequence.store(pos + m_mask + 1, AtomicMemoryOrder::kRelease);
+	return true;
+}
+
+ThreadJobManager::WorkerThread::WorkerThread(ThreadJobManager* manager, U32 id, CString threadName, U32 queueSize)
 	: m_id(id)
 	, m_thread(threadName.cstr())
 	, m_manager(manager)
 {
-	m_thread.start(this, threadCallback, ThreadCoreAffinityMask(false).set(m_id, pinToCore));
+	m_queue.init(queueSize);
 }
 
 Error ThreadJobManager::WorkerThread::threadCallback(ThreadCallbackInfo& info)
 {
 	WorkerThread& self = *static_cast<WorkerThread*>(info.m_userData);
-	self.m_manager->threadRun(self.m_id);
+	m_currentWorker = &self;
+	self.m_manager->threadRun(self);
+	m_currentWorker = nullptr;
 	return Error::kNone;
 }
 
 ThreadJobManager::ThreadJobManager(U32 threadCount, Bool pinToCores, U32 queueSize)
+	: m_taskPool(allocAligned, nullptr, 16_KB, 2.0, 0, true, "ThreadJobManagerTasks")
 {
 	ANKI_ASSERT(threadCount);
 
-	m_taskQueue.resize(queueSize);
+	queueSize = nextPowerOfTwo(max(queueSize, 2u));
 
 	void* mem = DefaultMemoryPool::getSingleton().allocate(threadCount * sizeof(WorkerThread), alignof(WorkerThread));
 	m_threads = WeakArray(static_cast<WorkerThread*>(mem), threadCount);
@@ -36,7 +149,13 @@ ThreadJobManager::ThreadJobManager(U32 threadCount, Bool pinToCores, U32 queueSi
 	{
 		String tname;
 		tname.sprintf("AnKiJobManager#%u", i);
-		callConstructor(m_threads[i], this, i, pinToCores, tname);
+		callConstructor(m_threads[i], this, i, tname, queueSize);
+	}
+
+	// Start the threads after all queues are initialized because the workers will steal from each other
+	for(WorkerThread& thread : m_threads)
+	{
+		thread.m_thread.start(&thread, WorkerThread::threadCallback, ThreadCoreAffinityMask(false).set(thread.m_id, pinToCores));
 	}
 }
 
@@ -63,59 +182,371 @@ ThreadJobManager::~ThreadJobManager()
 	DefaultMemoryPool::getSingleton().free(m_threads.getBegin());
 }
 
-Bool ThreadJobManager::pushBackTask(const Func& func)
+void ThreadJobManager::dispatchTask(const Func& func)
 {
-	LockGuard lock(m_mtx);
-	const U32 next = (m_tasksBack + 1) % m_taskQueue.getSize();
-	if(next != m_tasksFront)
+	m_activeTaskCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+	m_pendingTaskCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+
+	WorkerThread* worker = m_currentWorker;
+	if(worker && worker->m_manager == this)
+	{
+		// Called from a worker, push to its own queue. If it's full execute the task right away
+		if(!worker->m_queue.tryPush(func))
+		{
+			m_pendingTaskCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
+			runTask(func, worker->m_id);
+			return;
+		}
+	}
+	else
 	{
-		m_taskQueue[m_tasksBack] = func;
-		m_tasksBack = next;
-		m_activeTaskCount.fetchAdd(1);
-		return true;
+		// Called from the outside, spread the tasks to the queues
+		const U32 firstQueue = m_nextQueue.fetchAdd(1) % m_threads.getSize();
+		while(true)
+		{
+			Bool pushed = false;
+			for(U32 i = 0; i < m_threads.getSize() && !pushed; ++i)
+			{
+				pushed = m_threads[(firstQueue + i) % m_threads.getSize()].m_queue.tryPush(func);
+			}
+
+			if(pushed)
+			{
+				break;
+			}
+
+			// All queues are full, help to make some room
+			Func otherFunc;
+			if(popTask(firstQueue, otherFunc))
+			{
+				runTask(otherFunc, getExternalThreadId());
+			}
+		}
+	}
+
+	wakeUpWorker();
+}
+
+void ThreadJobManager::waitForAllTasksToFinish()
+{
+	ANKI_ASSERT(!(m_currentWorker && m_currentWorker->m_manager == this) && "Can't wait from a worker thread");
+
+	U32 spinCount = 0;
+	while(m_activeTaskCount.load(AtomicMemoryOrder::kAcquire) > 0)
+	{
+		// Help while waiting
+		Func func;
+		if(popTask(0, func))
+		{
+			runTask(func, getExternalThreadId());
+			spinCount = 0;
+			continue;
+		}
+
+		if(++spinCount < kSpinCount)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Nothing to help with and the remaining tasks are being executed. Sleep until they are done
+		LockGuard lock(m_mtx);
+		m_waitingThreadCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+		while(m_activeTaskCount.load(AtomicMemoryOrder::kSeqCst) > 0 && m_pendingTaskCount.load(AtomicMemoryOrder::kSeqCst) == 0)
+		{
+			m_waitCvar.wait(m_mtx);
+		}
+		m_waitingThreadCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
+		spinCount = 0;
+	}
+
+	// All graph tasks are done, recycle their memory
+	m_taskPool.reset();
+}
+
+Bool ThreadJobManager::popTask(U32 firstQueue, Func& func)
+{
+	if(m_pendingTaskCount.load(AtomicMemoryOrder::kAcquire) == 0)
+	{
+		return false;
+	}
+
+	for(U32 i = 0; i < m_threads.getSize(); ++i)
+	{
+		if(m_threads[(firstQueue + i) % m_threads.getSize()].m_queue.tryPop(func))
+		{
+			m_pendingTaskCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
+			return true;
+		}
 	}
 
 	return false;
 }
 
-Bool ThreadJobManager::popFrontTask(Func& func)
+void ThreadJobManager::runTask(const Func& func, U32 threadId)
 {
-	LockGuard lock(m_mtx);
+	func(threadId);
+	decrementActiveTaskCount();
+}
 
-	while(!m_quit && m_tasksBack == m_tasksFront)
+void ThreadJobManager::decrementActiveTaskCount()
+{
+	const U32 count = m_activeTaskCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
+	ANKI_ASSERT(count > 0);
+
+	if(count == 1 && m_waitingThreadCount.load(AtomicMemoryOrder::kSeqCst) > 0)
 	{
-		// No tasks, wait
-		m_cvar.wait(m_mtx);
+		LockGuard lock(m_mtx);
+		m_waitCvar.notifyAll();
 	}
+}
 
-	if(!m_quit)
+void ThreadJobManager::wakeUpWorker()
+{
+	if(m_sleepingThreadCount.load(AtomicMemoryOrder::kSeqCst) > 0)
 	{
-		func = std::move(m_taskQueue[m_tasksFront]);
-		m_tasksFront = (m_tasksFront + 1) % m_taskQueue.getSize();
+		LockGuard lock(m_mtx);
+		m_cvar.notifyOne();
 	}
 
-	return m_quit;
+	if(m_waitingThreadCount.load(AtomicMemoryOrder::kSeqCst) > 0)
+	{
+		// Wake the waiting thread as well so it can help
+		LockGuard lock(m_mtx);
+		m_waitCvar.notifyAll();
+	}
 }
 
-void ThreadJobManager::threadRun(U32 threadId)
+void ThreadJobManager::threadRun(WorkerThread& thread)
 {
+	U32 spinCount = 0;
 	while(true)
 	{
 		Func func;
-		const Bool quit = popFrontTask(func);
+		if(popTask(thread.m_id, func))
+		{
+			runTask(func, thread.m_id);
+			spinCount = 0;
+			continue;
+		}
+
+		if(++spinCount < kSpinCount)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// No work, sleep
+		spinCount = 0;
+		LockGuard lock(m_mtx);
+		m_sleepingThreadCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+		while(!m_quit && m_pendingTaskCount.load(AtomicMemoryOrder::kSeqCst) == 0)
+		{
+			m_cvar.wait(m_mtx);
+		}
+		m_sleepingThreadCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
 
-		if(quit)
+		if(m_quit)
 		{
 			break;
 		}
-		else
+	}
+}
+
+ThreadJobManager::Task* ThreadJobManager::newTask(const Func& func, Task* parent, const Char* name)
+{
+	Task* task = newInstance<Task>(m_taskPool);
+	task->m_func = func;
+	task->m_name = (name) ? name : "ThreadJobTask";
+	task->m_uuid = m_taskUuid.fetchAdd(1);
+
+	task->m_parent = parent;
+	return task;
+}
+
+void ThreadJobManager::addDependency(Task* task, Task* dependency)
+{
+	ANKI_ASSERT(task && dependency && task != dependency);
+	ANKI_ASSERT(!task->m_submitted && "Can't add dependencies after the task is submitted");
+
+	Task::Continuation* continuation = newInstance<Task::Continuation>(m_taskPool);
+
+	LockGuard lock(dependency->m_lock);
+	if(!dependency->m_finished)
+	{
+		task->m_pendingDependencyCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+
+		continuation->m_task = task;
+		continuation->m_next = dependency->m_continuations;
+		dependency->m_continuations = continuation;
+	}
+}
+
+void ThreadJobManager::submitTask(Task* task)
+{
+	ANKI_ASSERT(task);
+#if ANKI_ASSERTIONS_ENABLED
+	ANKI_ASSERT(!task->m_submitted);
+	task->m_submitted = true;
+#endif
+
+	// Children count towards their parent when they are submitted. A child that is created but never submitted doesn't block the parent
+	if(task->m_parent)
+	{
+		[[maybe_unused]] const U32 prev = task->m_parent->m_unfinishedCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+		ANKI_ASSERT(prev > 0 && "The parent has already finished");
+	}
+
+	// The graph task counts as an active task from now until it finishes
+	m_activeTaskCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+
+	if(task->m_pendingDependencyCount.fetchSub(1, AtomicMemoryOrder::kSeqCst) == 1)
+	{
+		scheduleGraphTask(task);
+	}
+}
+
+void ThreadJobManager::waitForTask(Task* task)
+{
+	ANKI_ASSERT(task && task->m_submitted);
+	ANKI_ASSERT(!(m_currentWorker && m_currentWorker->m_manager == this) && "Can't wait from a worker thread");
+
+	U32 spinCount = 0;
+	while(!isTaskFinished(task))
+	{
+		// Help while waiting
+		Func func;
+		if(popTask(0, func))
 		{
-			func(threadId);
+			runTask(func, getExternalThreadId());
+			spinCount = 0;
+			continue;
+		}
 
-			[[maybe_unused]] const U32 count = m_activeTaskCount.fetchSub(1);
-			ANKI_ASSERT(count > 0);
+		if(++spinCount < kSpinCount)
+		{
+			std::this_thread::yield();
+			continue;
 		}
+
+		// Nothing to help with. Sleep until a graph task finishes or there is new work
+		LockGuard lock(m_mtx);
+		m_waitingThreadCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+		while(!isTaskFinished(task) && m_pendingTaskCount.load(AtomicMemoryOrder::kSeqCst) == 0)
+		{
+			m_waitCvar.wait(m_mtx);
+		}
+		m_waitingThreadCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
+		spinCount = 0;
 	}
 }
 
+Bool ThreadJobManager::isTaskFinished(const Task* task) const
+{
+	ANKI_ASSERT(task);
+	LockGuard lock(task->m_lock);
+	return task->m_finished;
+}
+
+void ThreadJobManager::scheduleGraphTask(Task* task)
+{
+	dispatchTask([this, task](U32 threadId) {
+		runGraphTask(task, threadId);
+	});
+}
+
+void ThreadJobManager::runGraphTask(Task* task, U32 threadId)
+{
+#if ANKI_TRACING_ENABLED
+	// The manager can be used outside the engine (eg the importer) so the tracer might not be there
+	const Bool tracing = Tracer::isAllocated();
+	const Char* name = task->m_name; // Copy it because the task might be gone at the end
+	TracerEventHandle traceEvent;
+	if(tracing)
+	{
+		traceEvent = Tracer::getSingleton().beginEvent(name);
+
+		const U64 flowId = task->m_flowId.load(AtomicMemoryOrder::kAcquire);
+		if(flowId)
+		{
+			Tracer::getSingleton().addFlowEvent("ThreadJobTaskEdge", flowId, false);
+		}
+	}
+#endif
+
+	task->m_func(threadId);
+	task->m_func.destroy(); // The task memory will be reset without calling destructors so release what the function holds now
+	graphTaskPartFinished(task);
+
+#if ANKI_TRACING_ENABLED
+	if(tracing)
+	{
+		Tracer::getSingleton().endEvent(name, traceEvent);
+	}
+#endif
+}
+
+void ThreadJobManager::graphTaskPartFinished(Task* task)
+{
+	if(task->m_unfinishedCount.fetchSub(1, AtomicMemoryOrder::kSeqCst) != 1)
+	{
+		// Children are still running
+		return;
+	}
+
+	Task::Continuation* continuations;
+	{
+		LockGuard lock(task->m_lock);
+		task->m_finished = true;
+		continuations = task->m_continuations;
+		task->m_continuations = nullptr;
+	}
+
+	// Release the tasks that depend on this one
+	[[maybe_unused]] U32 edgeCount = 0;
+	while(continuations)
+	{
+		Task* next = continuations->m_task;
+		continuations = continuations->m_next;
+		++edgeCount;
+
+		if(next->m_pendingDependencyCount.fetchSub(1, AtomicMemoryOrder::kSeqCst) == 1)
+		{
+#if ANKI_TRACING_ENABLED
+			// Trace only the edge that made the task runnable
+			if(Tracer::isAllocated())
+			{
+				const U64 flowId = (task->m_uuid << 32u) | (next->m_uuid & kMaxU32);
+				next->m_flowId.store(flowId, AtomicMemoryOrder::kRelease);
+				Tracer::getSingleton().addFlowEvent("ThreadJobTaskEdge", flowId, true);
+			}
+#endif
+			scheduleGraphTask(next);
+		}
+	}
+
+#if ANKI_TRACING_ENABLED
+	if(Tracer::isAllocated())
+	{
+		ANKI_TRACE_INC_COUNTER(ThreadJobTaskEdges, edgeCount);
+		ANKI_TRACE_INC_COUNTER(ThreadJobTasks, 1);
+	}
+#endif
+
+	// Wake up the threads that are in waitForTask()
+	if(m_waitingThreadCount.load(AtomicMemoryOrder::kSeqCst) > 0)
+	{
+		LockGuard lock(m_mtx);
+		m_waitCvar.notifyAll();
+	}
+
+	if(task->m_parent)
+	{
+		graphTaskPartFinished(task->m_parent);
+	}
+
+	// Do that last because the waiting thread might reset the task memory
+	decrementActiveTaskCount();
+}
+
 } // end namespace anki
@@ -9,15 +9,25 @@
 #include <AnKi/Util/Function.h>
 #include <AnKi/Util/DynamicArray.h>
 #include <AnKi/Util/WeakArray.h>
+#include <AnKi/Util/MemoryPool.h>
 
 namespace anki {
 
 // Parallel task dispatcher. You feed it with tasks and sends them for execution in parallel and then waits for all to finish.
+// Every worker has its own lock-free task queue. Idle workers steal tasks from the queues of the others. The thread that waits for the tasks to
+// finish also executes tasks while waiting.
+// Tasks can be dispatched from the workers themselves and from a single non-worker thread (usually the main thread). That non-worker thread is
+// the one that should wait.
+// On top of the plain tasks there is a task graph. Graph tasks can have dependencies (continuations) and children. A graph task is considered
+// finished when its function and the functions of all its children have finished.
 class ThreadJobManager
 {
 public:
 	using Func = Function<void(U32 threadId)>;
 
+	// A node of the task graph. See newTask().
+	class Task;
+
 	ThreadJobManager(U32 threadCount, Bool pinToCores = false, U32 queueSize = 256);
 
 	ThreadJobManager(const ThreadJobManager&) = delete; // Non-copyable
@@ -27,59 +37,121 @@ public:
 	ThreadJobManager& operator=(const ThreadJobManager&) = delete; // Non-copyable
 
 	// Assign a task to a working thread
-	void dispatchTask(const Func& func)
-	{
-		while(!pushBackTask(func))
-		{
-			std::this_thread::yield();
-		}
+	void dispatchTask(const Func& func);
 
-		m_cvar.notifyOne();
-	}
+	// Wait for all tasks to finish. The calling thread will execute tasks while it waits.
+	void waitForAllTasksToFinish();
 
-	// Wait for all tasks to finish.
-	void waitForAllTasksToFinish()
+	// The number of distinct thread IDs a task might see. That's the number of workers plus one for the thread that waits.
+	U32 getThreadCount() const
 	{
-		while(m_activeTaskCount.load() > 0)
-		{
-			std::this_thread::yield();
-		}
+		return m_threads.getSize() + 1;
 	}
 
-	U32 getThreadCount() const
+	U32 getWorkerThreadCount() const
 	{
 		return m_threads.getSize();
 	}
 
+	// Create a graph task. It will run after it's submitted and all its dependencies have finished. If there is a parent the parent will not be
+	// considered finished before this task finishes. Children count towards the parent when they get submitted, so submit them before the parent
+	// finishes (eg from inside the parent's function). The task is valid until waitForAllTasksToFinish() returns.
+	// name: Optional name that will be used in the trace.
+	Task* newTask(const Func& func, Task* parent = nullptr, const Char* name = nullptr);
+
+	// Make a task run after another task (and its children) finishes. The task shouldn't have been submitted yet.
+	void addDependency(Task* task, Task* dependency);
+
+	// Allow the task to run. Can be called once per task.
+	void submitTask(Task* task);
+
+	// Wait for a graph task and its children to finish. The calling thread will execute tasks while it waits and sleep when there is nothing to
+	// execute.
+	void waitForTask(Task* task);
+
+	// Check if a graph task and its children have finished.
+	Bool isTaskFinished(const Task* task) const;
+
 private:
+	// Bounded multi-producer multi-consumer queue. Every cell has a sequence number that tells who owns it.
+	class TaskQueue
+	{
+	public:
+		class Cell
+		{
+		public:
+			Atomic<U64> m_sequence;
+			Func m_func;
+		};
+
+		DynamicArray<Cell> m_cells;
+		U64 m_mask = 0;
+
+		alignas(ANKI_CACHE_LINE_SIZE) Atomic<U64> m_enqueuePos = {0};
+		alignas(ANKI_CACHE_LINE_SIZE) Atomic<U64> m_dequeuePos = {0};
+
+		void init(U32 size);
+
+		Bool tryPush(const Func& func);
+
+		Bool tryPop(Func& func);
+	};
+
 	class alignas(ANKI_CACHE_LINE_SIZE) WorkerThread
 	{
 	public:
 		U32 m_id;
 		Thread m_thread;
 		ThreadJobManager* m_manager;
+		TaskQueue m_queue;
 
-		WorkerThread(ThreadJobManager* manager, U32 id, Bool pinToCore, CString threadName);
+		WorkerThread(ThreadJobManager* manager, U32 id, CString threadName, U32 queueSize);
 
 		static Error threadCallback(ThreadCallbackInfo& info);
 	};
 
 	WeakArray<WorkerThread> m_threads;
 
-	DynamicArray<Func> m_taskQueue;
-	U32 m_tasksFront = 0;
-	U32 m_tasksBack = 0;
-	Atomic<U32> m_activeTaskCount = {0};
+	Atomic<U32> m_activeTaskCount = {0}; // Dispatched but not finished
+	Atomic<U32> m_pendingTaskCount = {0}; // Dispatched but not picked by anyone
+	Atomic<U32> m_sleepingThreadCount = {0};
+	Atomic<U32> m_waitingThreadCount = {0};
+	Atomic<U32> m_nextQueue = {0};
 
 	ConditionVariable m_cvar;
+	ConditionVariable m_waitCvar;
 	Mutex m_mtx;
 
 	Bool m_quit = false;
 
-	Bool pushBackTask(const Func& func);
-	Bool popFrontTask(Func& func);
+	StackMemoryPool m_taskPool; // Storage for the graph tasks
+	Atomic<U64> m_taskUuid = {1};
+
+	static thread_local WorkerThread* m_currentWorker;
+
+	// The thread ID non-worker threads will pass to the tasks they execute.
+	U32 getExternalThreadId() const
+	{
+		return m_threads.getSize();
+	}
+
+	// Try to find a task starting from a specific queue and then steal from all the others.
+	Bool popTask(U32 firstQueue, Func& func);
+
+	void runTask(const Func& func, U32 threadId);
+
+	void decrementActiveTaskCount();
+
+	void scheduleGraphTask(Task* task);
+
+	void runGraphTask(Task* task, U32 threadId);
+
+	// Called when the function of a task or one of its children have finished.
+	void graphTaskPartFinished(Task* task);
+
+	void wakeUpWorker();
 
-	void threadRun(U32 threadId);
+	void threadRun(WorkerThread& thread);
 };
 
 } // end namespace anki
@@ -180,6 +180,8 @@ void Tracer::endEvent(const char* eventName, TracerEventHandle event)
 	writeEvent.m_name = eventName;
 	writeEvent.m_start = event.m_start;
 	writeEvent.m_duration = duration;
+	writeEvent.m_flowId = 0;
+	writeEvent.m_flowBegin = false;
 
 	// Write counter as well. In ns
 	TracerCounter& writeCounter = chunk.m_counters[chunk.m_counterCount++];
@@ -205,6 +207,8 @@ void Tracer::addCustomEvent(const char* eventName, Second start, Second duration
 	writeEvent.m_name = eventName;
 	writeEvent.m_start = start;
 	writeEvent.m_duration = duration;
+	writeEvent.m_flowId = 0;
+	writeEvent.m_flowBegin = false;
 
 	// Write counter as well. In ns
 	TracerCounter& writeCounter = chunk.m_counters[chunk.m_counterCount++];
@@ -212,6 +216,30 @@ void Tracer::addCustomEvent(const char* eventName, Second start, Second duration
 	writeCounter.m_value = U64(duration * 1000000000.0);
 }
 
+void Tracer::addFlowEvent(const char* flowName, U64 flowId, Bool flowBegin)
+{
+	ANKI_ASSERT(flowName && flowId);
+	if(!m_enabled)
+	{
+		return;
+	}
+
+	const Second time = HighRezTimer::getCurrentTime();
+
+	ThreadLocal& tlocal = getThreadLocal();
+
+	// Write the event
+	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
+	Chunk& chunk = getOrCreateChunk(tlocal);
+
+	TracerEvent& writeEvent = chunk.m_events[chunk.m_eventCount++];
+	writeEvent.m_name = flowName;
+	writeEvent.m_start = time;
+	writeEvent.m_duration = 0.0;
+	writeEvent.m_flowId = flowId;
+	writeEvent.m_flowBegin = flowBegin;
+}
+
 void Tracer::incrementCounter(const char* counterName, U64 value)
 {
 	if(!m_enabled)
@@ -30,6 +30,8 @@ public:
 	CString m_name;
 	Second m_start;
 	Second m_duration;
+	U64 m_flowId; // If non-zero it's not a regular event but the begining or the end of an arrow that connects events
+	Bool m_flowBegin;
 
 	TracerEvent()
 	{
@@ -75,6 +77,10 @@ public:
 	// It's thread-safe.
 	void addCustomEvent(const char* eventName, Second start, Second duration);
 
+	// Add the begining or the end of a flow. A flow connects the events that enclose its begining and its end. Used to show dependencies.
+	// It's thread-safe.
+	void addFlowEvent(const char* flowName, U64 flowId, Bool flowBegin);
+
 	// Increment a counter.
 	// It's thread-safe.
 	void incrementCounter(const char* counterName, U64 value);
@@ -114,6 +114,15 @@ ANKI_WINBASEAPI HANDLE ANKI_WINAPI FindFirstFileA(LPCSTR lpFileName, LPWIN32_FIN
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindClose(HANDLE hFindFile);
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindNextFileA(HANDLE hFindFile, LPWIN32_FIND_DATAA lpFindFileData);
 ANKI_WINBASEAPI DWORD ANKI_WINAPI GetTempPathA(DWORD nBufferLength, LPSTR lpBuffer);
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode,
+											   LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes,
+											   HANDLE hTemplateFile);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI GetFileSizeEx(HANDLE hFile, LARGE_INTEGER* lpFileSize);
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateFileMappingA(HANDLE hFile, LPSECURITY_ATTRIBUTES lpFileMappingAttributes, DWORD flProtect,
+													  DWORD dwMaximumSizeHigh, DWORD dwMaximumSizeLow, LPCSTR lpName);
+ANKI_WINBASEAPI LPVOID ANKI_WINAPI MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess, DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow,
+												 SIZE_T dwNumberOfBytesToMap);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI UnmapViewOfFile(LPCVOID lpBaseAddress);
 
 // Other
 ANKI_WINBASEAPI DWORD ANKI_WINAPI GetLastError(VOID);
@@ -178,6 +187,12 @@ constexpr DWORD FORMAT_MESSAGE_ARGUMENT_ARRAY = 0x00002000;
 constexpr DWORD FORMAT_MESSAGE_MAX_WIDTH_MASK = 0x000000FF;
 constexpr DWORD LANG_NEUTRAL = 0x00;
 constexpr DWORD SUBLANG_DEFAULT = 0x01;
+constexpr DWORD GENERIC_READ = 0x80000000L;
+constexpr DWORD FILE_SHARE_READ = 0x00000001;
+constexpr DWORD OPEN_EXISTING = 3;
+constexpr DWORD FILE_ATTRIBUTE_NORMAL = 0x00000080;
+constexpr DWORD PAGE_READONLY = 0x02;
+constexpr DWORD FILE_MAP_READ = 0x0004;
 
 // Types
 typedef union _LARGE_INTEGER
@@ -447,6 +462,25 @@ inline DWORD GetTempPathA(DWORD nBufferLength, LPSTR lpBuffer)
 	return ::GetTempPathA(nBufferLength, lpBuffer);
 }
 
+inline HANDLE CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, LPSECURITY_ATTRIBUTES lpSecurityAttributes,
+						  DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile)
+{
+	return ::CreateFileA(lpFileName, dwDesiredAccess, dwShareMode, reinterpret_cast<::LPSECURITY_ATTRIBUTES>(lpSecurityAttributes),
+						 dwCreationDisposition, dwFlagsAndAttributes, hTemplateFile);
+}
+
+inline BOOL GetFileSizeEx(HANDLE hFile, LARGE_INTEGER* lpFileSize)
+{
+	return ::GetFileSizeEx(hFile, reinterpret_cast<::LARGE_INTEGER*>(lpFileSize));
+}
+
+inline HANDLE CreateFileMappingA(HANDLE hFile, LPSECURITY_ATTRIBUTES lpFileMappingAttributes, DWORD flProtect, DWORD dwMaximumSizeHigh,
+								 DWORD dwMaximumSizeLow, LPCSTR lpName)
+{
+	return ::CreateFileMappingA(hFile, reinterpret_cast<::LPSECURITY_ATTRIBUTES>(lpFileMappingAttributes), flProtect, dwMaximumSizeHigh,
+								dwMaximumSizeLow, lpName);
+}
+
 // Other
 inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* lpFrequency)
 {
@@ -0,0 +1,53 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/GpuMemory/GpuSceneBuffer.h>
+
+using namespace anki;
+
+ANKI_TEST(GpuMemory, GpuSceneCopyMerging)
+{
+	StackMemoryPool pool(allocAligned, nullptr, 4_KB);
+
+	const Array<U32, 8> dataA = {1, 1, 1, 1, 1, 1, 1, 1};
+	const Array<U32, 8> dataB = {2, 2, 2, 2, 2, 2, 2, 2};
+	const Array<U32, 8> dataC = {3, 3, 3, 3, 3, 3, 3, 3};
+	const Array<U32, 8> dataD = {4, 4, 4, 4, 4, 4, 4, 4};
+	const Array<U32, 8> dataE = {5, 5, 5, 5, 5, 5, 5, 5};
+
+	// The array order is not the ticket order on purpose. That's how it looks when the streams of many threads are gathered
+	Array<GpuSceneCopy, 6> copies;
+	copies[0] = {4, 4, &dataB[0], 1}; // Adjacent to the 1st copy
+	copies[1] = {2, 4, &dataC[0], 2}; // Overlaps the 2 copies above and it was requested after them
+	copies[2] = {0, 4, &dataA[0], 0};
+	copies[3] = {100, 2, &dataE[0], 5}; // Same range as the bellow but it has a later ticket so it wins
+	copies[4] = {100, 2, &dataD[0], 4};
+	copies[5] = {101, 2, &dataD[0], 3}; // Overlaps partially and it's overwritten where it overlaps
+
+	DynamicArray<GpuSceneCopyRange, MemoryPoolPtrWrapper<StackMemoryPool>> ranges(&pool);
+	DynamicArray<U32, MemoryPoolPtrWrapper<StackMemoryPool>> rangeData(&pool);
+	mergeGpuSceneCopies(WeakArray<GpuSceneCopy>(copies), ranges, rangeData);
+
+	ANKI_TEST_EXPECT_EQ(ranges.getSize(), 2);
+
+	ANKI_TEST_EXPECT_EQ(ranges[0].m_dstDwordOffset, 0);
+	ANKI_TEST_EXPECT_EQ(ranges[0].m_dwordCount, 8);
+	const Array<U32, 8> expected0 = {1, 1, 3, 3, 3, 3, 2, 2};
+	for(U32 i = 0; i < 8; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(rangeData[ranges[0].m_srcDwordOffset + i], expected0[i]);
+	}
+
+	ANKI_TEST_EXPECT_EQ(ranges[1].m_dstDwordOffset, 100);
+	ANKI_TEST_EXPECT_EQ(ranges[1].m_dwordCount, 3);
+	const Array<U32, 3> expected1 = {5, 5, 4};
+	for(U32 i = 0; i < 3; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(rangeData[ranges[1].m_srcDwordOffset + i], expected1[i]);
+	}
+
+	ANKI_TEST_EXPECT_EQ(rangeData.getSize(), 11);
+}
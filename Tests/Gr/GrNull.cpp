@@ -0,0 +1,102 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <Tests/Gr/GrCommon.h>
+
+#if ANKI_GR_BACKEND_NULL
+#	include <AnKi/Gr/Null/NullCommandBuffer.h>
+
+using namespace anki;
+
+// The null backend doesn't look at the binaries
+static ShaderPtr createNullShader(ShaderType type)
+{
+	static const Array<U8, 4> kFakeBinary = {1, 2, 3, 4};
+	ShaderInitInfo init(type, kFakeBinary);
+	return GrManager::getSingleton().newShader(init);
+}
+
+ANKI_TEST(Gr, NullBackend)
+{
+	commonInit(false);
+
+	{
+		GrManager& gr = GrManager::getSingleton();
+
+		ShaderPtr vert = createNullShader(ShaderType::kVertex);
+		ShaderPtr pixel = createNullShader(ShaderType::kPixel);
+		ShaderProgramInitInfo progInit;
+		progInit.m_graphicsShaders[ShaderType::kVertex] = vert.get();
+		progInit.m_graphicsShaders[ShaderType::kPixel] = pixel.get();
+		ShaderProgramPtr prog = gr.newShaderProgram(progInit);
+
+		ShaderPtr comp = createNullShader(ShaderType::kCompute);
+		ShaderProgramInitInfo compProgInit;
+		compProgInit.m_computeShader = comp.get();
+		ShaderProgramPtr compProg = gr.newShaderProgram(compProgInit);
+
+		// Mapped buffers are backed by CPU memory
+		BufferPtr buff = gr.newBuffer(BufferInitInfo(1024, BufferUsageBit::kAllUav | BufferUsageBit::kCopySource, BufferMapAccessBit::kWrite));
+		ANKI_TEST_EXPECT_NEQ(buff->getGpuAddress(), 0);
+		U32* mapped = static_cast<U32*>(buff->map(0, kMaxPtrSize));
+		mapped[255] = 0xDEADBEEF;
+		buff->unmap();
+
+		BufferPtr buff2 = gr.newBuffer(BufferInitInfo(1024, BufferUsageBit::kAllUav, BufferMapAccessBit::kNone));
+		ANKI_TEST_EXPECT_NEQ(buff2->getGpuAddress(), buff->getGpuAddress());
+
+		TexturePtr presentable = gr.acquireNextPresentableTexture();
+		ANKI_TEST_EXPECT_EQ(presentable->getWidth(), kWidth);
+
+		TimestampQueryPtr timestamp = gr.newTimestampQuery();
+
+		CommandBufferPtr cmdb = gr.newCommandBuffer(CommandBufferInitInfo());
+		ANKI_TEST_EXPECT_EQ(cmdb->isEmpty(), true);
+
+		TextureBarrierInfo texBarrier = {TextureView(presentable.get()), TextureUsageBit::kNone, TextureUsageBit::kRtvDsvWrite};
+		BufferBarrierInfo buffBarriers[2] = {{BufferView(buff.get()), BufferUsageBit::kNone, BufferUsageBit::kAllUav},
+											 {BufferView(buff2.get()), BufferUsageBit::kNone, BufferUsageBit::kAllUav}};
+		cmdb->setPipelineBarrier({&texBarrier, 1}, {buffBarriers, 2}, {});
+
+		cmdb->writeTimestamp(timestamp.get());
+
+		cmdb->bindShaderProgram(compProg.get());
+		cmdb->bindUav(0, 0, BufferView(buff.get()));
+		cmdb->dispatchCompute(1, 1, 1);
+
+		cmdb->beginRenderPass({TextureView(presentable.get())});
+		cmdb->bindShaderProgram(prog.get());
+		cmdb->setViewport(0, 0, kWidth, kHeight);
+		for(U32 i = 0; i < 10; ++i)
+		{
+			cmdb->draw(PrimitiveTopology::kTriangles, 3);
+		}
+		cmdb->endRenderPass();
+		cmdb->endRecording();
+
+		// Consecutive commands of the same type collapse into one
+		const CommandBufferImpl& impl = static_cast<const CommandBufferImpl&>(*cmdb);
+		ANKI_TEST_EXPECT_EQ(impl.getCommands().getSize(), 10);
+		ANKI_TEST_EXPECT_EQ(impl.getCommands()[8].m_type, NullCommandType::kDraw);
+		ANKI_TEST_EXPECT_EQ(impl.getCommands()[8].m_count, 10);
+		ANKI_TEST_EXPECT_EQ(impl.getCommandCount(), 19);
+		ANKI_TEST_EXPECT_EQ(impl.getDrawcallCount(), 10);
+		ANKI_TEST_EXPECT_EQ(impl.getDispatchCount(), 1);
+		ANKI_TEST_EXPECT_EQ(impl.getBarrierCount(), 3);
+
+		Second time;
+		ANKI_TEST_EXPECT_EQ(timestamp->getResult(time), TimestampQueryResult::kNotAvailable);
+
+		FencePtr fence;
+		gr.submit(cmdb.get(), {}, &fence);
+		ANKI_TEST_EXPECT_EQ(fence->clientWait(0.0), true);
+		ANKI_TEST_EXPECT_EQ(timestamp->getResult(time), TimestampQueryResult::kAvailable);
+	}
+
+	commonDestroy();
+}
+
+#endif
@@ -0,0 +1,92 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Gr/BackendCommon/GraphicsPipelineKeyDatabase.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Filesystem.h>
+
+using namespace anki;
+
+ANKI_TEST(Gr, PipelineKeyDatabase)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	GrMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		String tmpDir;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(tmpDir));
+		const String filename = String().sprintf("%s/AnKiTestGraphicsPipelineKeys", tmpDir.cstr());
+		const String badFilename = String().sprintf("%s/AnKiTestGraphicsPipelineKeysBad", tmpDir.cstr());
+
+		// Some states of 2 programs
+		constexpr U64 kProgA = 0xA1A1A1A1;
+		constexpr U64 kProgB = 0xB2B2B2B2;
+
+		Array<GraphicsStateTracker, 3> states;
+		states[1].setPrimitiveTopology(PrimitiveTopology::kLines);
+		states[1].setCullMode(FaceSelectionBit::kFront);
+		states[2].setFillMode(FillMode::kWireframe);
+		states[2].setPrimitiveRestart(true);
+
+		GraphicsPipelineKeyDatabase db;
+		for(const GraphicsStateTracker& state : states)
+		{
+			db.recordKey(kProgA, state);
+		}
+		db.recordKey(kProgB, states[1]);
+		ANKI_TEST_EXPECT_EQ(db.getKeyCount(), 4);
+
+		// Duplicates are ignored
+		db.recordKey(kProgA, states[2]);
+		db.recordKey(kProgB, states[1]);
+		ANKI_TEST_EXPECT_EQ(db.getKeyCount(), 4);
+
+		ANKI_TEST_EXPECT_NO_ERR(db.store(filename));
+
+		// Load it back
+		GraphicsPipelineKeyDatabase db2;
+		ANKI_TEST_EXPECT_NO_ERR(db2.load(filename));
+		ANKI_TEST_EXPECT_EQ(db2.getKeyCount(), 4);
+
+		GrDynamicArray<GraphicsPipelineKeyDatabase::StaticState> keysA;
+		db2.getKeys(kProgA, keysA);
+		ANKI_TEST_EXPECT_EQ(keysA.getSize(), 3);
+
+		GrDynamicArray<GraphicsPipelineKeyDatabase::StaticState> keysB;
+		db2.getKeys(kProgB, keysB);
+		ANKI_TEST_EXPECT_EQ(keysB.getSize(), 1);
+
+		// The loaded keys have the same hashes as the recorded ones
+		for(const GraphicsStateTracker& state : states)
+		{
+			db2.recordKey(kProgA, state);
+		}
+		db2.recordKey(kProgB, states[1]);
+		ANKI_TEST_EXPECT_EQ(db2.getKeyCount(), 4);
+
+		// Incompatible files are ignored
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(badFilename, FileOpenFlag::kBinary | FileOpenFlag::kWrite));
+			const Array<U32, 4> header = {0x4F535041, kMaxU32, sizeof(GraphicsPipelineKeyDatabase::StaticState), 0};
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&header[0], sizeof(header)));
+		}
+
+		GraphicsPipelineKeyDatabase db3;
+		ANKI_TEST_EXPECT_NO_ERR(db3.load(badFilename));
+		ANKI_TEST_EXPECT_EQ(db3.getKeyCount(), 0);
+
+		// Missing files too
+		ANKI_TEST_EXPECT_NO_ERR(removeFile(badFilename));
+		ANKI_TEST_EXPECT_NO_ERR(db3.load(badFilename));
+		ANKI_TEST_EXPECT_EQ(db3.getKeyCount(), 0);
+
+		ANKI_TEST_EXPECT_NO_ERR(removeFile(filename));
+	}
+
+	GrMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
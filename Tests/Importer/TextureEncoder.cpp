@@ -0,0 +1,123 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Importer/TextureEncoder.h>
+#include <AnKi/Util/Hash.h>
+
+using namespace anki;
+
+// Encode and decode a surface and return the PSNR of the channels the format has
+static F64 encodeDecode(TextureEncoderFormat format, TextureEncoderQuality quality, ConstWeakArray<U8, PtrSize> pixels, U32 width, U32 height,
+						U32 channelCount)
+{
+	DynamicArray<U8, SingletonMemoryPoolWrapper<DefaultMemoryPool>, PtrSize> encoded;
+	encoded.resize(computeTextureEncoderOutputSize(format, width, height));
+
+	// Encode in 2 halves to exercise the block row ranges
+	const U32 blockRows = height / 4;
+	const WeakArray<U8, PtrSize> out(&encoded[0], encoded.getSize());
+	encodeTextureBlocks(format, quality, pixels, width, height, channelCount, 0, blockRows / 2, out);
+	encodeTextureBlocks(format, quality, pixels, width, height, channelCount, blockRows / 2, blockRows - blockRows / 2, out);
+
+	U32 formatChannels = channelCount;
+	if(format == TextureEncoderFormat::kBc1)
+	{
+		formatChannels = min(channelCount, 3u);
+	}
+	else if(format == TextureEncoderFormat::kBc4)
+	{
+		formatChannels = 1;
+	}
+	else if(format == TextureEncoderFormat::kBc5)
+	{
+		formatChannels = 2;
+	}
+	const U32 blockSize = (format == TextureEncoderFormat::kBc1 || format == TextureEncoderFormat::kBc4) ? 8 : 16;
+
+	F64 squaredError = 0.0;
+	for(U32 by = 0; by < height / 4; ++by)
+	{
+		for(U32 bx = 0; bx < width / 4; ++bx)
+		{
+			Array<U8, 16 * 4> decoded;
+			decodeTextureBlock(format, &encoded[(by * (width / 4) + bx) * blockSize], &decoded[0]);
+
+			for(U32 i = 0; i < 16; ++i)
+			{
+				const U32 x = bx * 4 + (i % 4);
+				const U32 y = by * 4 + (i / 4);
+				for(U32 c = 0; c < formatChannels; ++c)
+				{
+					const F64 diff = F64(decoded[i * 4 + c]) - F64(pixels[(y * width + x) * channelCount + c]);
+					squaredError += diff * diff;
+				}
+			}
+		}
+	}
+
+	const F64 mse = squaredError / F64(width * height * formatChannels);
+	return (mse > 0.0) ? 10.0 * log10(255.0 * 255.0 / mse) : 100.0;
+}
+
+ANKI_TEST(Importer, TextureEncoder)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kWidth = 64;
+		constexpr U32 kHeight = 32;
+		constexpr U32 kChannels = 4;
+
+		// Smooth gradients plus a bit of noise
+		DynamicArray<U8, SingletonMemoryPoolWrapper<DefaultMemoryPool>, PtrSize> pixels;
+		pixels.resize(kWidth * kHeight * kChannels);
+		for(U32 y = 0; y < kHeight; ++y)
+		{
+			for(U32 x = 0; x < kWidth; ++x)
+			{
+				const U32 noise = U32(computeHash(&x, sizeof(x), y) % 8);
+				U8* texel = &pixels[(y * kWidth + x) * kChannels];
+				texel[0] = U8(x * 4 + noise);
+				texel[1] = U8(y * 8);
+				texel[2] = U8(255 - x * 2 - noise);
+				texel[3] = U8((x + y) * 2);
+			}
+		}
+
+		for(TextureEncoderFormat format : EnumIterable<TextureEncoderFormat>())
+		{
+			Array<F64, U32(TextureEncoderQuality::kCount)> psnr;
+			for(TextureEncoderQuality quality : EnumIterable<TextureEncoderQuality>())
+			{
+				psnr[quality] = encodeDecode(format, quality, pixels, kWidth, kHeight, kChannels);
+			}
+
+			ANKI_TEST_LOGI("Format %u PSNR: fast %f normal %f high %f", U32(format), psnr[0], psnr[1], psnr[2]);
+
+			ANKI_TEST_EXPECT_GT(psnr[TextureEncoderQuality::kFast], 30.0);
+			ANKI_TEST_EXPECT_GEQ(psnr[TextureEncoderQuality::kNormal], psnr[TextureEncoderQuality::kFast] - 0.5);
+			ANKI_TEST_EXPECT_GEQ(psnr[TextureEncoderQuality::kHigh], psnr[TextureEncoderQuality::kNormal] - 0.01);
+		}
+
+		// A solid block should be lossless
+		{
+			DynamicArray<U8, SingletonMemoryPoolWrapper<DefaultMemoryPool>, PtrSize> solid;
+			solid.resize(4 * 4 * 4);
+			for(U32 i = 0; i < 16; ++i)
+			{
+				solid[i * 4 + 0] = 0;
+				solid[i * 4 + 1] = 255;
+				solid[i * 4 + 2] = 0;
+				solid[i * 4 + 3] = 128;
+			}
+
+			ANKI_TEST_EXPECT_EQ(encodeDecode(TextureEncoderFormat::kBc1, TextureEncoderQuality::kNormal, solid, 4, 4, 4), 100.0);
+			ANKI_TEST_EXPECT_EQ(encodeDecode(TextureEncoderFormat::kBc3, TextureEncoderQuality::kNormal, solid, 4, 4, 4), 100.0);
+		}
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -0,0 +1,214 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Resource/AnimationResource.h>
+#include <AnKi/Util/HighRezTimer.h>
+
+using namespace anki;
+
+class TestChannel
+{
+public:
+	DynamicArray<AnimationKeyframe<Vec3>> m_positions;
+	DynamicArray<AnimationKeyframe<Quat>> m_rotations;
+	DynamicArray<AnimationKeyframe<F32>> m_scales;
+};
+
+// The way AnimationResource used to interpolate. Linear search of the keys every time
+template<typename T, typename TFunc>
+static void interpolateLinearSearch(const DynamicArray<AnimationKeyframe<T>>& keys, Second time, T& out, TFunc func)
+{
+	for(U32 i = 0; i + 1 < keys.getSize(); ++i)
+	{
+		const AnimationKeyframe<T>& left = keys[i];
+		const AnimationKeyframe<T>& right = keys[i + 1];
+		if(time >= left.getTime() && time <= right.getTime())
+		{
+			const Second u = (time - left.getTime()) / (right.getTime() - left.getTime());
+			out = func(left.getValue(), right.getValue(), F32(u));
+			break;
+		}
+	}
+}
+
+ANKI_TEST(Resource, AnimationResource)
+{
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kChannelCount = 64;
+		constexpr U32 kKeyCount = 300; // 10 seconds at 30 FPS
+		constexpr Second kKeyInterval = 1.0 / 30.0;
+		constexpr U32 kFrameCount = 2000;
+		constexpr Second kFrameDt = 1.0 / 60.0;
+
+		// Create a skeleton clip
+		DynamicArray<TestChannel> channels;
+		channels.resize(kChannelCount);
+		DynamicArray<String> names;
+		names.resize(kChannelCount);
+		DynamicArray<AnimationChannelKeyframes> keyframes;
+		keyframes.resize(kChannelCount);
+		for(U32 c = 0; c < kChannelCount; ++c)
+		{
+			for(U32 k = 0; k < kKeyCount; ++k)
+			{
+				const Second time = Second(k) * kKeyInterval;
+				const F32 phase = F32(time) * 2.0f + F32(c);
+				channels[c].m_positions.emplaceBack(time, Vec3(sin(phase), cos(phase) * 0.5f, F32(c) * 0.1f));
+				channels[c].m_rotations.emplaceBack(time, Quat(Axisang(phase, Vec3(0.0f, 1.0f, 1.0f).normalize())));
+				if(c % 8 == 0)
+				{
+					channels[c].m_scales.emplaceBack(time, 1.0f + 0.2f * sin(phase));
+				}
+			}
+
+			names[c].sprintf("bone%u", c);
+			keyframes[c].m_name = names[c];
+			keyframes[c].m_positions = channels[c].m_positions;
+			keyframes[c].m_rotations = channels[c].m_rotations;
+			keyframes[c].m_scales = channels[c].m_scales;
+		}
+
+		DynamicArray<U8, SingletonMemoryPoolWrapper<DefaultMemoryPool>, PtrSize> binary;
+		binary.resize(AnimationResource::computeBinarySize(keyframes));
+		ANKI_TEST_EXPECT_NO_ERR(AnimationResource::encodeBinary(keyframes, WeakArray<U8, PtrSize>(binary)));
+
+		AnimationResource anim("test.ankianim", 1);
+		ANKI_TEST_EXPECT_NO_ERR(anim.loadBinary(binary));
+		ANKI_TEST_EXPECT_EQ(anim.getChannels().getSize(), kChannelCount);
+		ANKI_TEST_EXPECT_EQ(anim.getChannels()[3].m_name, "bone3");
+		ANKI_TEST_EXPECT_NEAR(anim.getDuration(), Second(kKeyCount - 1) * kKeyInterval, 0.0001);
+
+		// Corrupted files should fail
+		ANKI_TEST_EXPECT_ERR(anim.loadBinary(ConstWeakArray<U8, PtrSize>(&binary[0], binary.getSize() - 1)), Error::kUserData);
+
+		// Memory
+		PtrSize oldMemory = 0;
+		for(const TestChannel& ch : channels)
+		{
+			oldMemory += ch.m_positions.getSizeInBytes() + ch.m_rotations.getSizeInBytes() + ch.m_scales.getSizeInBytes();
+		}
+		ANKI_TEST_LOGI("Key memory per clip: old %zu bytes, new %zu bytes", oldMemory, anim.getKeyMemorySize());
+		ANKI_TEST_EXPECT_LT(anim.getKeyMemorySize() * 3, oldMemory);
+
+		// Play the animation with both ways and compare
+		DynamicArray<AnimationCursor> cursors;
+		cursors.resize(kChannelCount);
+		DynamicArray<AnimationSample> samples;
+		samples.resize(kChannelCount);
+
+		Second oldTime = 0.0;
+		Second newTime = 0.0;
+		F32 maxPosError = 0.0f;
+		F32 maxRotError = 0.0f;
+		F32 maxScaleError = 0.0f;
+		for(U32 frame = 0; frame < kFrameCount; ++frame)
+		{
+			// Loop a few times
+			const Second time = Second(frame) * kFrameDt;
+			const Second loopedTime = (time > anim.getDuration()) ? mod(time, anim.getDuration()) : time;
+
+			Second begin = HighRezTimer::getCurrentTime();
+			Array<AnimationSample, kChannelCount> refSamples;
+			for(U32 c = 0; c < kChannelCount; ++c)
+			{
+				AnimationSample& ref = refSamples[c];
+				ref = {Vec3(0.0f), Quat::getIdentity(), 1.0f};
+				interpolateLinearSearch(channels[c].m_positions, loopedTime, ref.m_position, [](const Vec3& a, const Vec3& b, F32 u) {
+					return linearInterpolate(a, b, u);
+				});
+				interpolateLinearSearch(channels[c].m_rotations, loopedTime, ref.m_rotation, [](const Quat& a, const Quat& b, F32 u) {
+					return a.slerp(b, u);
+				});
+				interpolateLinearSearch(channels[c].m_scales, loopedTime, ref.m_scale, [](F32 a, F32 b, F32 u) {
+					return linearInterpolate(a, b, u);
+				});
+			}
+			oldTime += HighRezTimer::getCurrentTime() - begin;
+
+			begin = HighRezTimer::getCurrentTime();
+			anim.sampleChannels(time, WeakArray<AnimationCursor>(cursors), WeakArray<AnimationSample>(samples));
+			newTime += HighRezTimer::getCurrentTime() - begin;
+
+			for(U32 c = 0; c < kChannelCount; ++c)
+			{
+				maxPosError = max(maxPosError, (samples[c].m_position - refSamples[c].m_position).length());
+				maxRotError = max(maxRotError, 1.0f - absolute(Vec4(samples[c].m_rotation).dot(Vec4(refSamples[c].m_rotation))));
+				maxScaleError = max(maxScaleError, absolute(samples[c].m_scale - refSamples[c].m_scale));
+			}
+
+			// The variant without the cursors should give the same results
+			if(frame % 100 == 0)
+			{
+				Vec3 pos;
+				Quat rot;
+				F32 scale;
+				anim.interpolate(8, time, pos, rot, scale);
+				ANKI_TEST_EXPECT_EQ(pos, samples[8].m_position);
+				ANKI_TEST_EXPECT_EQ(scale, samples[8].m_scale);
+			}
+		}
+
+		const F64 boneSampleCount = F64(kFrameCount * kChannelCount);
+		ANKI_TEST_LOGI("Sampling cost per bone: old %fns, new %fns", oldTime * 1000000000.0 / boneSampleCount,
+					   newTime * 1000000000.0 / boneSampleCount);
+		ANKI_TEST_LOGI("Max errors: position %f, rotation %f, scale %f", maxPosError, maxRotError, maxScaleError);
+
+		ANKI_TEST_EXPECT_LT(maxPosError, 0.001f);
+		ANKI_TEST_EXPECT_LT(maxRotError, 0.0001f);
+		ANKI_TEST_EXPECT_LT(maxScaleError, 0.001f);
+	}
+
+	// A long clip. The precision of the key times shouldn't depend on the duration of the clip
+	{
+		constexpr U32 kKeyCount = 36000; // 20 minutes at 30 FPS
+		constexpr Second kKeyInterval = 1.0 / 30.0;
+
+		TestChannel channel;
+		for(U32 k = 0; k < kKeyCount; ++k)
+		{
+			const Second time = Second(k) * kKeyInterval;
+			channel.m_positions.emplaceBack(time, Vec3(sin(F32(time)), 0.0f, 0.0f));
+		}
+
+		AnimationChannelKeyframes keyframes;
+		keyframes.m_name = "bone";
+		keyframes.m_positions = channel.m_positions;
+
+		DynamicArray<U8, SingletonMemoryPoolWrapper<DefaultMemoryPool>, PtrSize> binary;
+		binary.resize(AnimationResource::computeBinarySize({&keyframes, 1}));
+		ANKI_TEST_EXPECT_NO_ERR(AnimationResource::encodeBinary({&keyframes, 1}, WeakArray<U8, PtrSize>(binary)));
+
+		AnimationResource anim("test.ankianim", 2);
+		ANKI_TEST_EXPECT_NO_ERR(anim.loadBinary(binary));
+
+		F32 maxPosError = 0.0f;
+		for(U32 i = 0; i < 200; ++i)
+		{
+			// Sample the end of the clip where a quantization over the whole duration would be the worst
+			const Second time = channel.m_positions.getBack().getTime() - Second(i) * 0.0123;
+
+			Vec3 ref(0.0f);
+			interpolateLinearSearch(channel.m_positions, time, ref, [](const Vec3& a, const Vec3& b, F32 u) {
+				return linearInterpolate(a, b, u);
+			});
+
+			Vec3 pos;
+			Quat rot;
+			F32 scale;
+			anim.interpolate(0, time, pos, rot, scale);
+			maxPosError = max(maxPosError, (pos - ref).length());
+		}
+
+		ANKI_TEST_LOGI("Max position error of a long clip: %f", maxPosError);
+		ANKI_TEST_EXPECT_LT(maxPosError, 0.001f);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+	ResourceMemoryPool::freeSingleton();
+}
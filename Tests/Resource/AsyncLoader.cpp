@@ -8,6 +8,8 @@
 #include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Util/Atomic.h>
 #include <AnKi/Util/Functions.h>
+#include <AnKi/Util/Hash.h>
+#include <AnKi/Util/System.h>
 
 using namespace anki;
 
@@ -266,3 +268,121 @@ ANKI_TEST(Resource, AsyncLoader)
 #endif
 
 } // namespace
+
+namespace {
+
+// Simulates a resource that is read from disk and then decoded
+class SyntheticLoadTask : public AsyncLoaderTask
+{
+public:
+	Array<U8, 16_KB> m_data;
+	U32 m_seed = 0;
+	U32 m_resubmitCount = 0;
+	Atomic<U32>* m_ioCount = nullptr;
+	Atomic<U32>* m_decodeCount = nullptr;
+	Atomic<U64>* m_checksum = nullptr;
+
+	Error io([[maybe_unused]] AsyncLoaderTaskContext& ctx) override
+	{
+		// The I/O is mostly waiting
+		HighRezTimer::sleep(0.02_ms);
+		for(U32 i = 0; i < m_data.getSize(); ++i)
+		{
+			m_data[i] = U8(m_seed + i);
+		}
+
+		m_ioCount->fetchAdd(1);
+		return Error::kNone;
+	}
+
+	Error operator()(AsyncLoaderTaskContext& ctx) override
+	{
+		// The decoding is mostly CPU work
+		U64 hash = m_seed;
+		for(U32 i = 0; i < 16; ++i)
+		{
+			hash = computeHash(m_data.getBegin(), m_data.getSizeInBytes(), hash);
+		}
+
+		if(m_resubmitCount > 0)
+		{
+			--m_resubmitCount;
+			ctx.m_resubmitTask = true;
+			return Error::kNone;
+		}
+
+		m_checksum->fetchAdd(hash & 0xFFFF);
+		m_decodeCount->fetchAdd(1);
+		return Error::kNone;
+	}
+};
+
+} // namespace
+
+ANKI_TEST(Resource, AsyncLoaderThroughput)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	constexpr U32 kTaskCount = 2000;
+
+	// Compute the expected checksum
+	U64 expectedChecksum = 0;
+	{
+		SyntheticLoadTask task;
+		Atomic<U32> count;
+		Atomic<U64> checksum = {0};
+		task.m_ioCount = &count;
+		task.m_decodeCount = &count;
+		task.m_checksum = &checksum;
+		AsyncLoaderTaskContext ctx;
+		for(U32 i = 0; i < kTaskCount; ++i)
+		{
+			task.m_seed = i;
+			ANKI_TEST_EXPECT_NO_ERR(task.io(ctx));
+			ANKI_TEST_EXPECT_NO_ERR(task(ctx));
+		}
+		expectedChecksum = checksum.load();
+	}
+
+	const Array<U32, 2> decodeThreadCounts = {1, max(2u, getCpuCoresCount())};
+	for(U32 decodeThreadCount : decodeThreadCounts)
+	{
+		Atomic<U32> ioCount = {0};
+		Atomic<U32> decodeCount = {0};
+		Atomic<U64> checksum = {0};
+
+		{
+			AsyncLoader loader(1, decodeThreadCount);
+
+			const Second begin = HighRezTimer::getCurrentTime();
+			for(U32 i = 0; i < kTaskCount; ++i)
+			{
+				SyntheticLoadTask* task = loader.newTask<SyntheticLoadTask>();
+				task->m_seed = i;
+				task->m_resubmitCount = i % 2;
+				task->m_ioCount = &ioCount;
+				task->m_decodeCount = &decodeCount;
+				task->m_checksum = &checksum;
+
+				loader.submitTask(task, AsyncLoaderPriority(i % U32(AsyncLoaderPriority::kCount)));
+			}
+
+			while(loader.getTasksInFlightCount() > 0)
+			{
+				HighRezTimer::sleep(0.1_ms);
+			}
+			const Second elapsed = HighRezTimer::getCurrentTime() - begin;
+
+			ANKI_TEST_LOGI("%u tasks with 1 I/O thread and %u decode threads took %f ms", kTaskCount, decodeThreadCount, elapsed * 1000.0);
+		}
+
+		// I/O runs once per task even if it's resubmitted
+		ANKI_TEST_EXPECT_EQ(ioCount.load(), kTaskCount);
+		ANKI_TEST_EXPECT_EQ(decodeCount.load(), kTaskCount);
+		ANKI_TEST_EXPECT_EQ(checksum.load(), expectedChecksum);
+	}
+
+	ResourceMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
@@ -5,6 +5,10 @@
 
 #include <Tests/Framework/Framework.h>
 #include <AnKi/Resource/ResourceFilesystem.h>
+#include <AnKi/Resource/ResourceArchivePacker.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/Filesystem.h>
+#include <ZLib/contrib/minizip/zip.h>
 
 ANKI_TEST(Resource, ResourceFilesystem)
 {
@@ -31,3 +35,265 @@ ANKI_TEST(Resource, ResourceFilesystem)
 		ANKI_TEST_EXPECT_EQ(txt, "hell\n");
 	}
 }
+
+ANKI_TEST(Resource, ResourceFilesystemLookupBench)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kDataPathCount = 4;
+		constexpr U32 kFilesPerDataPath = 25000;
+		constexpr U32 kLookupCount = 10000;
+
+		// Create some synthetic data paths. Half of the files of every path override the files of the previous path
+		ResourceFilesystem fs;
+		for(U32 p = 0; p < kDataPathCount; ++p)
+		{
+			ResourceFilesystem::DataPath path;
+			path.m_path.sprintf("DataPath%u", p);
+			path.m_files.resize(kFilesPerDataPath);
+			for(U32 f = 0; f < kFilesPerDataPath; ++f)
+			{
+				const U32 fileIdx = p * kFilesPerDataPath / 2 + f;
+				path.m_files[f].m_filename.sprintf("Textures/Synthetic/File%u.ankitex", fileIdx);
+				path.m_files[f].m_filenameHash = path.m_files[f].m_filename.computeHash();
+			}
+
+			fs.m_dataPaths.emplaceFront(std::move(path));
+			fs.addToFileIndex(fs.m_dataPaths.getFront());
+		}
+
+		const U32 uniqueFileCount = (kDataPathCount + 1) * kFilesPerDataPath / 2;
+		ANKI_TEST_EXPECT_EQ(fs.m_fileIndex.getSize(), uniqueFileCount);
+
+		// Generate the filenames to search for
+		ResourceDynamicArray<ResourceString> filenames;
+		filenames.resize(kLookupCount);
+		for(U32 i = 0; i < kLookupCount; ++i)
+		{
+			filenames[i].sprintf("Textures/Synthetic/File%u.ankitex", (i * 7919) % uniqueFileCount);
+		}
+
+		// The old way. Scan all files of all paths
+		const Second linearBegin = HighRezTimer::getCurrentTime();
+		ResourceDynamicArray<const ResourceFilesystem::DataPath*> linearResults;
+		linearResults.resize(kLookupCount, nullptr);
+		for(U32 i = 0; i < kLookupCount; ++i)
+		{
+			const U64 hash = filenames[i].computeHash();
+			for(const ResourceFilesystem::DataPath& p : fs.m_dataPaths)
+			{
+				for(const ResourceFilesystem::FileInfo& file : p.m_files)
+				{
+					if(file.m_filenameHash == hash)
+					{
+						linearResults[i] = &p;
+						break;
+					}
+				}
+
+				if(linearResults[i])
+				{
+					break;
+				}
+			}
+		}
+		const Second linearTime = HighRezTimer::getCurrentTime() - linearBegin;
+
+		// The index
+		const Second indexBegin = HighRezTimer::getCurrentTime();
+		U32 mismatchCount = 0;
+		for(U32 i = 0; i < kLookupCount; ++i)
+		{
+			const ResourceFilesystem::DataPath* path;
+			const ResourceFilesystem::FileInfo* file = fs.findFile(filenames[i].computeHash(), path);
+			if(!file || path != linearResults[i] || file->m_filename != filenames[i])
+			{
+				++mismatchCount;
+			}
+		}
+		const Second indexTime = HighRezTimer::getCurrentTime() - indexBegin;
+
+		ANKI_TEST_EXPECT_EQ(mismatchCount, 0);
+
+		// Not found
+		const ResourceFilesystem::DataPath* path;
+		ANKI_TEST_EXPECT_EQ(fs.findFile(ResourceString("Textures/Synthetic/Nope.ankitex").computeHash(), path), nullptr);
+
+		ANKI_TEST_LOGI("%u lookups in %u files. Linear scan %f ms, index %f ms", kLookupCount, kDataPathCount * kFilesPerDataPath,
+					   linearTime * 1000.0, indexTime * 1000.0);
+	}
+
+	ResourceMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Resource, ResourceArchive)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		String tmpDir;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(tmpDir));
+		String archiveFilename;
+		archiveFilename.sprintf("%s/ResourceArchiveTest.ankizip", tmpDir.cstr());
+		CleanupFile cleanup(archiveFilename);
+
+		// Create an archive with a stored and a deflated file
+		ResourceDynamicArray<U8> data;
+		data.resize(200_KB);
+		for(U32 i = 0; i < data.getSize(); ++i)
+		{
+			data[i] = U8((i * 7) ^ (i >> 10));
+		}
+
+		zipFile zip = zipOpen(archiveFilename.cstr(), APPEND_STATUS_CREATE);
+		ANKI_TEST_EXPECT_NEQ(zip, nullptr);
+		const Array<CString, 2> filenames = {"stored.bin", "dir/deflated.bin"};
+		for(U32 i = 0; i < 2; ++i)
+		{
+			zip_fileinfo info = {};
+			ANKI_TEST_EXPECT_EQ(zipOpenNewFileInZip(zip, filenames[i].cstr(), &info, nullptr, 0, nullptr, 0, nullptr, (i == 0) ? 0 : Z_DEFLATED,
+													Z_DEFAULT_COMPRESSION),
+								ZIP_OK);
+			ANKI_TEST_EXPECT_EQ(zipWriteInFileInZip(zip, &data[0], data.getSize()), ZIP_OK);
+			ANKI_TEST_EXPECT_EQ(zipCloseFileInZip(zip), ZIP_OK);
+		}
+		ANKI_TEST_EXPECT_EQ(zipClose(zip, nullptr), ZIP_OK);
+
+		ResourceArchivePtr archive(newInstance<ResourceArchive>(ResourceMemoryPool::getSingleton()));
+		ANKI_TEST_EXPECT_NO_ERR(archive->open(archiveFilename));
+		ANKI_TEST_EXPECT_EQ(archive->getEntries().getSize(), 2);
+
+		for(U32 i = 0; i < 2; ++i)
+		{
+			const ResourceArchive::Entry& entry = archive->getEntries()[i];
+			ANKI_TEST_EXPECT_EQ(entry.m_filename, filenames[i]);
+			ANKI_TEST_EXPECT_EQ(entry.m_compressed, i == 1);
+			ANKI_TEST_EXPECT_EQ(entry.m_uncompressedSize, data.getSize());
+
+			ResourceFile* rfile;
+			ANKI_TEST_EXPECT_NO_ERR(archive->openFile(i, rfile));
+			ResourceFilePtr file(rfile);
+			ANKI_TEST_EXPECT_EQ(file->getSize(), data.getSize());
+			ANKI_TEST_EXPECT_EQ(file->getContentsInMemory().getSize(), (i == 0) ? data.getSize() : 0);
+
+			// Read everything
+			ResourceDynamicArray<U8> readData;
+			readData.resize(data.getSize());
+			ANKI_TEST_EXPECT_NO_ERR(file->read(&readData[0], readData.getSize()));
+			ANKI_TEST_EXPECT_EQ(memcmp(&readData[0], &data[0], data.getSize()), 0);
+
+			// Seek around
+			const Array<U32, 5> offsets = {150_KB, 10, 100_KB, 199_KB, 0};
+			for(U32 offset : offsets)
+			{
+				Array<U8, 512> buff;
+				ANKI_TEST_EXPECT_NO_ERR(file->seek(offset, FileSeekOrigin::kBeginning));
+				ANKI_TEST_EXPECT_NO_ERR(file->read(&buff[0], buff.getSize()));
+				ANKI_TEST_EXPECT_EQ(memcmp(&buff[0], &data[offset], buff.getSize()), 0);
+			}
+
+			// Can't read past the end
+			U32 u;
+			ANKI_TEST_EXPECT_NO_ERR(file->seek(data.getSize() - 2, FileSeekOrigin::kBeginning));
+			ANKI_TEST_EXPECT_ERR(file->readU32(u), Error::kFileAccess);
+		}
+	}
+
+	ResourceMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Resource, ResourceArchivePacker)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		String tmpDir;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(tmpDir));
+		String inputDir;
+		inputDir.sprintf("%s/ResourceArchivePackerTest", tmpDir.cstr());
+		String archiveFilename;
+		archiveFilename.sprintf("%s/ResourceArchivePackerTest.ankizip", tmpDir.cstr());
+		CleanupFile cleanupArchive(archiveFilename);
+		if(directoryExists(inputDir))
+		{
+			ANKI_TEST_EXPECT_NO_ERR(removeDirectory(inputDir));
+		}
+
+		// A compressible file that spans many blocks. The size is not a multiple of the block size so the last block is partial
+		constexpr U32 kBlockSize = 16_KB;
+		ResourceDynamicArray<U8> data;
+		data.resize(kBlockSize * 20 + 1234);
+		U32 seed = 1;
+		for(U32 i = 0; i < data.getSize(); ++i)
+		{
+			seed = seed * 1103515245u + 12345u;
+			data[i] = U8((i % 64 < 48) ? (i / 256) : (seed >> 16));
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory(inputDir));
+		String inputFilename;
+		inputFilename.sprintf("%s/big.bin", inputDir.cstr());
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(inputFilename, FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&data[0], data.getSize()));
+		}
+
+		ResourceArchivePackerConfig config;
+		config.m_inputDirectory = inputDir;
+		config.m_outputFilename = archiveFilename;
+		config.m_blockSize = kBlockSize;
+		ANKI_TEST_EXPECT_NO_ERR(packResourceArchive(config));
+
+		ResourceArchivePtr archive(newInstance<ResourceArchive>(ResourceMemoryPool::getSingleton()));
+		ANKI_TEST_EXPECT_NO_ERR(archive->open(archiveFilename));
+		ANKI_TEST_EXPECT_EQ(archive->getEntries().getSize(), 1);
+
+		const ResourceArchive::Entry& entry = archive->getEntries()[0];
+		ANKI_TEST_EXPECT_EQ(entry.m_filename, "big.bin");
+		ANKI_TEST_EXPECT_EQ(entry.m_compressed, true);
+		ANKI_TEST_EXPECT_EQ(entry.m_uncompressedSize, data.getSize());
+		ANKI_TEST_EXPECT_EQ(entry.m_seekBlockSize, kBlockSize);
+		ANKI_TEST_EXPECT_EQ(entry.m_seekBlockCount, (data.getSize() + kBlockSize - 1) / kBlockSize);
+
+		ResourceFile* rfile;
+		ANKI_TEST_EXPECT_NO_ERR(archive->openFile(0, rfile));
+		ResourceFilePtr file(rfile);
+		ANKI_TEST_EXPECT_EQ(file->getSize(), data.getSize());
+
+		// Random reads. Some start in the middle of a block, some cross block boundaries and some go backwards
+		Array<U8, 3 * kBlockSize / 2> buff;
+		seed = 7;
+		for(U32 i = 0; i < 200; ++i)
+		{
+			seed = seed * 1103515245u + 12345u;
+			const U32 offset = (seed >> 8) % data.getSize();
+			const U32 size = min<U32>(((seed >> 4) % buff.getSize()) + 1, data.getSize() - offset);
+
+			ANKI_TEST_EXPECT_NO_ERR(file->seek(offset, FileSeekOrigin::kBeginning));
+			ANKI_TEST_EXPECT_NO_ERR(file->read(&buff[0], size));
+			ANKI_TEST_EXPECT_EQ(memcmp(&buff[0], &data[offset], size), 0);
+		}
+
+		// Seek relative to the current position, to a block boundary and to the last byte
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(kBlockSize * 3, FileSeekOrigin::kBeginning));
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(kBlockSize * 5, FileSeekOrigin::kCurrent));
+		ANKI_TEST_EXPECT_NO_ERR(file->read(&buff[0], 16));
+		ANKI_TEST_EXPECT_EQ(memcmp(&buff[0], &data[kBlockSize * 8], 16), 0);
+
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(data.getSize() - 1, FileSeekOrigin::kBeginning));
+		ANKI_TEST_EXPECT_NO_ERR(file->read(&buff[0], 1));
+		ANKI_TEST_EXPECT_EQ(buff[0], data.getBack());
+
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(inputDir));
+	}
+
+	ResourceMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
@@ -6,6 +6,8 @@
 #include <Tests/Framework/Framework.h>
 #include <AnKi/Resource/DummyResource.h>
 #include <AnKi/Resource/ResourceManager.h>
+#include <AnKi/Util/Thread.h>
+#include <AnKi/Util/HighRezTimer.h>
 
 ANKI_TEST(Resource, ResourceManager)
 {
@@ -72,3 +74,84 @@ ANKI_TEST(Resource, ResourceManager)
 	// Delete
 	ResourceManager::freeSingleton();
 }
+
+ANKI_TEST(Resource, ResourceManagerConcurrentLoads)
+{
+	ResourceManager* resources = &ResourceManager::allocateSingleton();
+	ANKI_TEST_EXPECT_NO_ERR(resources->init(allocAligned, nullptr));
+
+	constexpr U32 kThreadCount = 8;
+	constexpr U32 kResourceCount = 256;
+	constexpr U32 kIterationCount = 200000;
+
+	class Ctx
+	{
+	public:
+		Array<DummyResourcePtr, kResourceCount> m_resident;
+		Atomic<U32> m_errors = {0};
+		Atomic<U32> m_threadCount = {0};
+		Bool m_churn = false; // If true load resources that are not resident so they get created and freed all the time
+	} ctx;
+
+	auto threadCallback = [](ThreadCallbackInfo& info) -> Error {
+		Ctx& ctx = *static_cast<Ctx*>(info.m_userData);
+		const U32 threadIdx = ctx.m_threadCount.fetchAdd(1);
+
+		for(U32 i = 0; i < kIterationCount; ++i)
+		{
+			const U32 idx = (i * 7 + threadIdx * 13) % kResourceCount;
+			Array<Char, 64> fname;
+			snprintf(fname.getBegin(), fname.getSize(), "%s%u", (ctx.m_churn) ? "churn" : "resident", idx);
+
+			DummyResourcePtr ptr;
+			if(ResourceManager::getSingleton().loadResource(fname.getBegin(), ptr) != Error::kNone || !ptr.isCreated()
+			   || (!ctx.m_churn && ptr.get() != ctx.m_resident[idx].get()))
+			{
+				ctx.m_errors.fetchAdd(1);
+			}
+		}
+
+		return Error::kNone;
+	};
+
+	for(U32 i = 0; i < kResourceCount; ++i)
+	{
+		ResourceString fname;
+		fname.sprintf("resident%u", i);
+		ANKI_TEST_EXPECT_NO_ERR(resources->loadResource(fname, ctx.m_resident[i]));
+	}
+
+	for(Bool churn : {false, true})
+	{
+		ctx.m_churn = churn;
+		ctx.m_threadCount.store(0);
+
+		Array<Thread*, kThreadCount> threads;
+		const U64 begin = HighRezTimer::getCurrentTimeUs();
+		for(U32 i = 0; i < kThreadCount; ++i)
+		{
+			threads[i] = newInstance<Thread>(ResourceMemoryPool::getSingleton(), "Loader");
+			threads[i]->start(&ctx, threadCallback);
+		}
+
+		for(Thread* thread : threads)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(thread->join());
+			deleteInstance(ResourceMemoryPool::getSingleton(), thread);
+		}
+		const U64 elapsed = HighRezTimer::getCurrentTimeUs() - begin;
+
+		ANKI_TEST_LOGI("%s: %u threads did %u loads in %luus, %fns per load", (churn) ? "Create and free" : "Already loaded", kThreadCount,
+					   kThreadCount * kIterationCount, elapsed, F64(elapsed) * 1000.0 / F64(kThreadCount * kIterationCount));
+	}
+
+	ANKI_TEST_EXPECT_EQ(ctx.m_errors.load(), 0);
+
+	for(DummyResourcePtr& ptr : ctx.m_resident)
+	{
+		ANKI_TEST_EXPECT_EQ(ptr->getRefcount(), 1);
+		ptr.reset(nullptr);
+	}
+
+	ResourceManager::freeSingleton();
+}
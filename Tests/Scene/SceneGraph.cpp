@@ -0,0 +1,240 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <Tests/Gr/GrCommon.h>
+#include <AnKi/Scene/SceneGraph.h>
+#include <AnKi/Scene/Components/LightComponent.h>
+#include <AnKi/Physics/PhysicsWorld.h>
+#include <AnKi/Script/ScriptManager.h>
+#include <AnKi/Resource/ResourceManager.h>
+#include <AnKi/GpuMemory/GpuSceneBuffer.h>
+#include <AnKi/GpuMemory/UnifiedGeometryBuffer.h>
+#include <AnKi/GpuMemory/RebarTransientMemoryPool.h>
+#include <AnKi/GpuMemory/GpuVisibleTransientMemoryPool.h>
+#include <AnKi/GpuMemory/GpuReadbackMemoryPool.h>
+#include <AnKi/GpuMemory/TextureMemoryPool.h>
+#include <AnKi/GpuMemory/CopyEngine.h>
+#include <AnKi/Core/Common.h>
+
+using namespace anki;
+
+namespace {
+
+// The state of a node after an update. The timestamps are relative to the 1st frame of the run
+class NodeState
+{
+public:
+	Timestamp m_lightTimestamp = 0;
+	Timestamp m_componentMaxTimestamp = 0;
+	Vec3 m_lightPosition = Vec3(0.0f);
+
+	Bool operator==(const NodeState& b) const
+	{
+		return m_lightTimestamp == b.m_lightTimestamp && m_componentMaxTimestamp == b.m_componentMaxTimestamp && m_lightPosition == b.m_lightPosition;
+	}
+};
+
+class TestRun;
+
+class TestNode : public SceneNode
+{
+public:
+	TestRun* m_run = nullptr;
+	U32 m_index = 0;
+
+	TestNode(const SceneNodeInitInfo& inf)
+		: SceneNode(inf)
+	{
+		newComponent<LightComponent>()->setLightComponentType(LightComponentType::kPoint);
+	}
+
+	~TestNode();
+
+	NodeState getState(Timestamp firstFrame) const
+	{
+		const LightComponent& lc = getFirstComponentOfType<LightComponent>();
+		NodeState state;
+		state.m_lightTimestamp = lc.getTimestamp() - firstFrame;
+		state.m_componentMaxTimestamp = getComponentMaxTimestamp() - firstFrame;
+		state.m_lightPosition = lc.getWorldPosition();
+		return state;
+	}
+};
+
+class TestRun
+{
+public:
+	static constexpr U32 kRootCount = 16;
+	static constexpr U32 kChildCount = 3;
+	static constexpr U32 kDepth = 4;
+	static constexpr U32 kFrameCount = 8;
+	static constexpr U32 kDeletionFrame = 3;
+	static constexpr U32 kTreeNodeCount = 1 + kChildCount + kChildCount * kChildCount + kChildCount * kChildCount * kChildCount;
+	static constexpr U32 kMovedNode = kTreeNodeCount + 1; // A child of the 2nd root
+
+	Timestamp m_firstFrame = 0;
+	DynamicArray<TestNode*> m_nodes; // Null if the node got deleted
+	DynamicArray<NodeState> m_finalStates; // The state of a node when it got deleted
+	DynamicArray<NodeState> m_states; // The states of all live nodes after every frame
+
+	void createSubtree(SceneNode* parent, U32 depth)
+	{
+		TestNode* node = SceneGraph::getSingleton().newSceneNode<TestNode>(String().sprintf("Node%u", m_nodes.getSize()));
+		node->m_run = this;
+		node->m_index = m_nodes.getSize();
+		m_nodes.emplaceBack(node);
+		m_finalStates.emplaceBack();
+
+		if(parent)
+		{
+			node->setParent(parent);
+		}
+
+		if(depth + 1 < kDepth)
+		{
+			for(U32 i = 0; i < kChildCount; ++i)
+			{
+				createSubtree(node, depth + 1);
+			}
+		}
+	}
+
+	// Move and delete nodes for a few frames and gather the state of the nodes after every update
+	void run(Bool typeBatched)
+	{
+		g_cvarSceneTypeBatchedComponentUpdate = typeBatched;
+		m_firstFrame = GlobalFrameIndex::getSingleton().m_value;
+
+		Scene* scene;
+		ANKI_TEST_EXPECT_NO_ERR(SceneGraph::getSingleton().newEmptyScene((typeBatched) ? "TypeBatched" : "PerNode", scene));
+		SceneGraph::getSingleton().setActiveScene(scene);
+
+		for(U32 r = 0; r < kRootCount; ++r)
+		{
+			createSubtree(nullptr, 0);
+		}
+
+		for(U32 frame = 0; frame < kFrameCount; ++frame)
+		{
+			// Move some nodes. They move their subtrees as well
+			for(U32 i = frame; i < m_nodes.getSize(); i += 7)
+			{
+				if(m_nodes[i])
+				{
+					m_nodes[i]->setLocalOrigin(Vec3(F32(frame), F32(i), 1.0f));
+				}
+			}
+
+			// Delete a subtree and move nodes inside it during the same frame. The components of the subtree shouldn't be updated. The moved
+			// node of the other tree joins the subtree after markForDeletion() so only its new parent is marked
+			if(frame == kDeletionFrame)
+			{
+				m_nodes[1]->markForDeletion();
+				m_nodes[2]->setLocalOrigin(Vec3(100.0f));
+				m_nodes[kMovedNode]->setParent(m_nodes[1]);
+				m_nodes[kMovedNode]->setLocalOrigin(Vec3(100.0f));
+			}
+
+			update(frame);
+
+			for(TestNode* node : m_nodes)
+			{
+				if(node)
+				{
+					m_states.emplaceBack(node->getState(m_firstFrame));
+				}
+			}
+		}
+
+		SceneGraph::getSingleton().deleteScene(scene);
+		update(kFrameCount);
+	}
+
+	// Same as the main loop of App
+	static void update(U32 frame)
+	{
+		++GlobalFrameIndex::getSingleton().m_value;
+		GpuSceneMicroPatcher::getSingleton().beginPatching();
+		SceneGraph::getSingleton().update(Second(frame) / 60.0, Second(frame + 1) / 60.0);
+		GpuSceneMicroPatcher::getSingleton().endPatching();
+	}
+};
+
+TestNode::~TestNode()
+{
+	m_run->m_finalStates[m_index] = getState(m_run->m_firstFrame);
+	m_run->m_nodes[m_index] = nullptr;
+}
+
+} // end anonymous namespace
+
+ANKI_TEST(Scene, TypeBatchedComponentUpdate)
+{
+	commonInit(false);
+	GlobalFrameIndex::allocateSingleton();
+	CoreThreadJobManager::allocateSingleton(4, false);
+	UnifiedGeometryBuffer::allocateSingleton().init();
+	GpuSceneBuffer::allocateSingleton().init();
+	RebarTransientMemoryPool::allocateSingleton().init();
+	GpuVisibleTransientMemoryPool::allocateSingleton();
+	GpuReadbackMemoryPool::allocateSingleton();
+	TextureMemoryPool::allocateSingleton();
+	CopyEngine::allocateSingleton();
+	PhysicsWorld::allocateSingleton();
+	ANKI_TEST_EXPECT_NO_ERR(PhysicsWorld::getSingleton().init(allocAligned, nullptr));
+	{
+		// Where App::init() looks for the shaders and the engine assets
+		String executable;
+		ANKI_TEST_EXPECT_NO_ERR(getApplicationPath(executable));
+		g_cvarRsrcDataPaths =
+			String().sprintf("%s|ankiprogbin:%s|EngineAssets,!AndroidProject", getParentFilepath(executable).cstr(), ANKI_SOURCE_DIRECTORY);
+		ANKI_TEST_EXPECT_NO_ERR(ResourceManager::allocateSingleton().init(allocAligned, nullptr));
+	}
+	ANKI_TEST_EXPECT_NO_ERR(GpuSceneMicroPatcher::allocateSingleton().init());
+	ScriptManager::allocateSingleton(allocAligned, nullptr);
+	ANKI_TEST_EXPECT_NO_ERR(SceneGraph::allocateSingleton().init(allocAligned, nullptr));
+
+	{
+		// Run the same frames with the per-node update and the type batched one
+		TestRun perNode;
+		perNode.run(false);
+
+		TestRun typeBatched;
+		typeBatched.run(true);
+		g_cvarSceneTypeBatchedComponentUpdate = false;
+
+		ANKI_TEST_EXPECT_EQ(perNode.m_states.getSize(), typeBatched.m_states.getSize());
+		for(U32 i = 0; i < min(perNode.m_states.getSize(), typeBatched.m_states.getSize()); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(perNode.m_states[i] == typeBatched.m_states[i], true);
+		}
+
+		for(U32 i = 0; i < perNode.m_finalStates.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(perNode.m_finalStates[i] == typeBatched.m_finalStates[i], true);
+		}
+
+		// The nodes that moved while their subtree got deleted weren't updated
+		ANKI_TEST_EXPECT_LT(typeBatched.m_finalStates[2].m_lightTimestamp, Timestamp(TestRun::kDeletionFrame + 1));
+		ANKI_TEST_EXPECT_LT(typeBatched.m_finalStates[TestRun::kMovedNode].m_lightTimestamp, Timestamp(TestRun::kDeletionFrame + 1));
+	}
+
+	SceneGraph::freeSingleton();
+	ScriptManager::freeSingleton();
+	GpuSceneMicroPatcher::freeSingleton();
+	ResourceManager::freeSingleton();
+	PhysicsWorld::freeSingleton();
+	RebarTransientMemoryPool::freeSingleton();
+	GpuVisibleTransientMemoryPool::freeSingleton();
+	UnifiedGeometryBuffer::freeSingleton();
+	GpuSceneBuffer::freeSingleton();
+	TextureMemoryPool::freeSingleton();
+	GpuReadbackMemoryPool::freeSingleton();
+	CopyEngine::freeSingleton();
+	CoreThreadJobManager::freeSingleton();
+	GlobalFrameIndex::freeSingleton();
+	commonDestroy();
+}
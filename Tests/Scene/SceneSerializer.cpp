@@ -0,0 +1,399 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Scene/SceneSerializer.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/System.h>
+
+using namespace anki;
+
+namespace {
+
+// What TextSceneSerializer needs to read from memory
+class MemoryResourceFile : public ResourceFile
+{
+public:
+	ResourceString m_text;
+
+	Error read(void*, PtrSize) override
+	{
+		return Error::kFunctionFailed;
+	}
+
+	Error readAllText(ResourceString& out) override
+	{
+		out = m_text;
+		return Error::kNone;
+	}
+
+	Error readU32(U32&) override
+	{
+		return Error::kFunctionFailed;
+	}
+
+	Error readF32(F32&) override
+	{
+		return Error::kFunctionFailed;
+	}
+
+	Error seek(PtrSize, FileSeekOrigin) override
+	{
+		return Error::kFunctionFailed;
+	}
+
+	PtrSize getSize() const override
+	{
+		return m_text.getLength();
+	}
+};
+
+enum class TestEnum : U8
+{
+	kA,
+	kB,
+	kC,
+
+	kCount
+};
+
+// Serializes the same kind of things a scene node does
+class TestNode
+{
+public:
+	SceneString m_className;
+	SceneString m_name;
+	U32 m_uuid = 0;
+	Vec3 m_origin = Vec3(0.0f);
+	Mat3 m_rotation = Mat3::getIdentity();
+	Vec3 m_scale = Vec3(1.0f);
+	Bool m_ignoreParentTransform = false;
+	TestEnum m_enum = TestEnum::kA;
+	I32 m_signed = 0;
+	SceneDynamicArray<U32> m_componentUuids;
+	U32 m_parentUuid = 0;
+
+	Error serialize(SceneSerializer& serializer)
+	{
+		ANKI_SERIALIZE(m_className, 1);
+		ANKI_SERIALIZE(m_name, 1);
+		ANKI_SERIALIZE(m_uuid, 1);
+		ANKI_SERIALIZE(m_origin, 1);
+		ANKI_SERIALIZE(m_rotation, 1);
+		ANKI_SERIALIZE(m_scale, 1);
+		ANKI_SERIALIZE(m_ignoreParentTransform, 1);
+		ANKI_SERIALIZE(m_enum, 1);
+		ANKI_SERIALIZE(m_signed, 2);
+
+		U32 componentCount = m_componentUuids.getSize();
+		ANKI_SERIALIZE(componentCount, 1);
+		if(serializer.isInReadMode())
+		{
+			m_componentUuids.resize(componentCount, 0);
+		}
+		ANKI_SERIALIZE(m_componentUuids, 1);
+
+		ANKI_SERIALIZE(m_parentUuid, 1);
+
+		return Error::kNone;
+	}
+
+	Bool operator==(const TestNode& b) const
+	{
+		Bool same = m_className == b.m_className && m_name == b.m_name && m_uuid == b.m_uuid && m_ignoreParentTransform == b.m_ignoreParentTransform
+					&& m_enum == b.m_enum && m_signed == b.m_signed && m_parentUuid == b.m_parentUuid
+					&& m_componentUuids.getSize() == b.m_componentUuids.getSize();
+
+		// The text format prints the floats with %f
+		same = same && (m_origin - b.m_origin).length() < 0.001f && (m_scale - b.m_scale).length() < 0.001f;
+		for(U32 i = 0; i < 9 && same; ++i)
+		{
+			same = absolute(m_rotation[i] - b.m_rotation[i]) < 0.001f;
+		}
+
+		for(U32 i = 0; i < m_componentUuids.getSize() && same; ++i)
+		{
+			same = m_componentUuids[i] == b.m_componentUuids[i];
+		}
+
+		return same;
+	}
+};
+
+} // namespace
+
+static void generateNodes(U32 count, SceneDynamicArray<TestNode>& nodes)
+{
+	srand(0);
+	nodes.resize(count);
+	for(U32 i = 0; i < count; ++i)
+	{
+		TestNode& node = nodes[i];
+		node.m_className = (i % 3) ? "SceneNode" : "SomeDerivedNode";
+		node.m_name.sprintf((i % 2) ? "Node %u\twith spaces" : "Node%u", i);
+		node.m_uuid = i + 1;
+		node.m_origin = Vec3(getRandomRange(-100.0f, 100.0f), getRandomRange(-100.0f, 100.0f), getRandomRange(-100.0f, 100.0f));
+		node.m_rotation = Mat3(Euler(getRandomRange(-kPi, kPi), getRandomRange(-kPi, kPi), getRandomRange(-kPi, kPi)));
+		node.m_scale = Vec3(getRandomRange(0.5f, 2.0f));
+		node.m_ignoreParentTransform = (i % 7) == 0;
+		node.m_enum = TestEnum(i % U32(TestEnum::kCount));
+		node.m_signed = I32(i) - I32(count / 2);
+		node.m_componentUuids.resize(i % 4);
+		for(U32 c = 0; c < node.m_componentUuids.getSize(); ++c)
+		{
+			node.m_componentUuids[c] = count + i * 4 + c;
+		}
+		node.m_parentUuid = (i > 0) ? U32(rand()) % i + 1 : 0;
+	}
+}
+
+static Error writeText(SceneDynamicArray<TestNode>& nodes, CString filename, MemoryResourceFile& text)
+{
+	{
+		File file;
+		ANKI_CHECK(file.open(filename, FileOpenFlag::kWrite));
+		TextSceneSerializer serializer(&file);
+		for(TestNode& node : nodes)
+		{
+			ANKI_CHECK(node.serialize(serializer));
+		}
+	}
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::kRead));
+	ANKI_CHECK(file.readAllText(text.m_text));
+	return Error::kNone;
+}
+
+static Error readText(MemoryResourceFile& text, SceneDynamicArray<TestNode>& nodes)
+{
+	TextSceneSerializer serializer(&text);
+	serializer.setBinaryVersion(kSceneBinaryVersion);
+	for(TestNode& node : nodes)
+	{
+		ANKI_CHECK(node.serialize(serializer));
+	}
+	return Error::kNone;
+}
+
+// Same as the scene: Every node in its own record and a table with the offsets of the records
+static Error writeBinary(SceneDynamicArray<TestNode>& nodes, SceneDynamicArrayLarge<U8>& records, SceneDynamicArray<U32>& offsets)
+{
+	BinarySceneSerializer serializer(&records);
+	offsets.resize(nodes.getSize() + 1);
+	for(U32 i = 0; i < nodes.getSize(); ++i)
+	{
+		offsets[i] = U32(records.getSize());
+		ANKI_CHECK(nodes[i].serialize(serializer));
+	}
+	offsets[nodes.getSize()] = U32(records.getSize());
+	return Error::kNone;
+}
+
+static Error readBinaryRecord(const SceneDynamicArrayLarge<U8>& records, const SceneDynamicArray<U32>& offsets, U32 idx, TestNode& node)
+{
+	BinarySceneSerializer serializer(ConstWeakArray<U8, PtrSize>(records.getBegin() + offsets[idx], offsets[idx + 1] - offsets[idx]));
+	serializer.setBinaryVersion(kSceneBinaryVersion);
+	ANKI_CHECK(node.serialize(serializer));
+	return (serializer.getReadOffset() == offsets[idx + 1] - offsets[idx]) ? Error::kNone : Error::kUserData;
+}
+
+static Bool compare(const SceneDynamicArray<TestNode>& a, const SceneDynamicArray<TestNode>& b)
+{
+	if(a.getSize() != b.getSize())
+	{
+		return false;
+	}
+
+	for(U32 i = 0; i < a.getSize(); ++i)
+	{
+		if(!(a[i] == b[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+ANKI_TEST(Scene, SceneSerializer)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	SceneMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		String filename;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(filename));
+		filename += "/AnKiSceneSerializerTest.ankiscene";
+
+		SceneDynamicArray<TestNode> nodes;
+		generateNodes(1000, nodes);
+
+		// Text and binary should give the same results
+		{
+			MemoryResourceFile text;
+			ANKI_TEST_EXPECT_NO_ERR(writeText(nodes, filename, text));
+
+			SceneDynamicArray<TestNode> textNodes;
+			textNodes.resize(nodes.getSize());
+			ANKI_TEST_EXPECT_NO_ERR(readText(text, textNodes));
+			ANKI_TEST_EXPECT_EQ(compare(nodes, textNodes), true);
+
+			SceneDynamicArrayLarge<U8> records;
+			SceneDynamicArray<U32> offsets;
+			ANKI_TEST_EXPECT_NO_ERR(writeBinary(nodes, records, offsets));
+
+			SceneDynamicArray<TestNode> binaryNodes;
+			binaryNodes.resize(nodes.getSize());
+			for(U32 i = 0; i < nodes.getSize(); ++i)
+			{
+				ANKI_TEST_EXPECT_NO_ERR(readBinaryRecord(records, offsets, i, binaryNodes[i]));
+			}
+			ANKI_TEST_EXPECT_EQ(compare(nodes, binaryNodes), true);
+
+			// The binary stores the floats as they are
+			ANKI_TEST_EXPECT_EQ(binaryNodes[10].m_origin, nodes[10].m_origin);
+		}
+
+		// Older binaries don't have the newer vars
+		{
+			SceneDynamicArrayLarge<U8> buffer;
+			BinarySceneSerializer serializer(&buffer);
+			U32 uuid = 123;
+			ANKI_TEST_EXPECT_NO_ERR(serializer.serialize("m_uuid", 1, false, uuid));
+			Vec3 origin(1.0f, 2.0f, 3.0f);
+			ANKI_TEST_EXPECT_NO_ERR(serializer.serialize("m_origin", 1, false, origin));
+
+			BinarySceneSerializer reader(ConstWeakArray<U8, PtrSize>(buffer.getBegin(), buffer.getSize()));
+			reader.setBinaryVersion(1);
+			uuid = 0;
+			ANKI_TEST_EXPECT_NO_ERR(reader.serialize("m_uuid", 1, false, uuid));
+			I32 newVar = 42;
+			ANKI_TEST_EXPECT_NO_ERR(reader.serialize("m_signed", 2, false, newVar));
+			origin = Vec3(0.0f);
+			ANKI_TEST_EXPECT_NO_ERR(reader.serialize("m_origin", 1, false, origin));
+			ANKI_TEST_EXPECT_EQ(uuid, 123);
+			ANKI_TEST_EXPECT_EQ(newVar, 42);
+			ANKI_TEST_EXPECT_EQ(origin, Vec3(1.0f, 2.0f, 3.0f));
+			ANKI_TEST_EXPECT_EQ(reader.getReadOffset(), buffer.getSize());
+		}
+
+		// Errors
+		{
+			SceneDynamicArrayLarge<U8> buffer;
+			BinarySceneSerializer serializer(&buffer);
+			U32 uuid = 123;
+			ANKI_TEST_EXPECT_NO_ERR(serializer.serialize("m_uuid", 1, false, uuid));
+
+			auto newReader = [&](PtrSize size) {
+				BinarySceneSerializer reader(ConstWeakArray<U8, PtrSize>(buffer.getBegin(), size));
+				reader.setBinaryVersion(kSceneBinaryVersion);
+				return reader;
+			};
+
+			U32 u = 0;
+			ANKI_TEST_EXPECT_ERR(newReader(buffer.getSize()).serialize("m_name", 1, false, u), Error::kUserData); // Wrong name
+			F32 f = 0.0f;
+			ANKI_TEST_EXPECT_ERR(newReader(buffer.getSize()).serialize("m_uuid", 1, false, f), Error::kUserData); // Wrong type
+			Vec2 v(0.0f);
+			ANKI_TEST_EXPECT_ERR(newReader(buffer.getSize()).serialize("m_uuid", 1, false, v), Error::kUserData); // Wrong count
+			ANKI_TEST_EXPECT_ERR(newReader(buffer.getSize() - 1).serialize("m_uuid", 1, false, u), Error::kUserData); // Truncated
+			ANKI_TEST_EXPECT_NO_ERR(newReader(buffer.getSize()).serialize("m_uuid", 1, false, u));
+			ANKI_TEST_EXPECT_EQ(u, 123);
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(removeFile(filename));
+	}
+
+	ResourceMemoryPool::freeSingleton();
+	SceneMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+// Compare the loading times of the text and the binary format on 100K nodes
+ANKI_TEST(Scene, SceneSerializerBenchmark)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	SceneMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kNodeCount = 100000;
+
+		String filename;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(filename));
+		filename += "/AnKiSceneSerializerBenchmark.ankiscene";
+
+		SceneDynamicArray<TestNode> nodes;
+		generateNodes(kNodeCount, nodes);
+
+		// Text
+		MemoryResourceFile text;
+		ANKI_TEST_EXPECT_NO_ERR(writeText(nodes, filename, text));
+
+		SceneDynamicArray<TestNode> textNodes;
+		textNodes.resize(kNodeCount);
+		Second begin = HighRezTimer::getCurrentTime();
+		ANKI_TEST_EXPECT_NO_ERR(readText(text, textNodes));
+		const Second textTime = HighRezTimer::getCurrentTime() - begin;
+		ANKI_TEST_EXPECT_EQ(compare(nodes, textNodes), true);
+
+		// Binary
+		SceneDynamicArrayLarge<U8> records;
+		SceneDynamicArray<U32> offsets;
+		ANKI_TEST_EXPECT_NO_ERR(writeBinary(nodes, records, offsets));
+
+		SceneDynamicArray<TestNode> binaryNodes;
+		binaryNodes.resize(kNodeCount);
+		begin = HighRezTimer::getCurrentTime();
+		for(U32 i = 0; i < kNodeCount; ++i)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(readBinaryRecord(records, offsets, i, binaryNodes[i]));
+		}
+		const Second binaryTime = HighRezTimer::getCurrentTime() - begin;
+		ANKI_TEST_EXPECT_EQ(compare(nodes, binaryNodes), true);
+
+		// Binary in parallel. The table of contents allows every thread to jump to its records
+		SceneDynamicArray<TestNode> parallelNodes;
+		parallelNodes.resize(kNodeCount);
+		ThreadJobManager jobManager(getCpuCoresCount());
+		Atomic<U32> crntNode(0);
+		Atomic<U32> errorCount(0);
+		begin = HighRezTimer::getCurrentTime();
+		for(U32 t = 0; t < jobManager.getThreadCount(); ++t)
+		{
+			jobManager.dispatchTask([&]([[maybe_unused]] U32 tid) {
+				constexpr U32 kBatchSize = 64;
+				U32 batchBegin;
+				while((batchBegin = crntNode.fetchAdd(kBatchSize)) < kNodeCount)
+				{
+					for(U32 i = batchBegin; i < min(batchBegin + kBatchSize, kNodeCount); ++i)
+					{
+						if(readBinaryRecord(records, offsets, i, parallelNodes[i]))
+						{
+							errorCount.fetchAdd(1);
+						}
+					}
+				}
+			});
+		}
+		jobManager.waitForAllTasksToFinish();
+		const Second parallelTime = HighRezTimer::getCurrentTime() - begin;
+		ANKI_TEST_EXPECT_EQ(errorCount.load(), 0);
+		ANKI_TEST_EXPECT_EQ(compare(nodes, parallelNodes), true);
+
+		ANKI_TEST_LOGI("%u nodes. Text: %zuKB %fms. Binary: %zuKB %fms, %fms with %u threads", kNodeCount, PtrSize(text.m_text.getLength()) / 1024,
+					   textTime * 1000.0, PtrSize(records.getSize()) / 1024, binaryTime * 1000.0, parallelTime * 1000.0, jobManager.getThreadCount());
+
+		ANKI_TEST_EXPECT_NO_ERR(removeFile(filename));
+	}
+
+	ResourceMemoryPool::freeSingleton();
+	SceneMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
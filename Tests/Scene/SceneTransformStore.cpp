@@ -0,0 +1,333 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Scene/SceneTransformStore.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/System.h>
+
+using namespace anki;
+
+namespace {
+
+class TestNode
+{
+public:
+	Transform m_local = Transform::getIdentity();
+	U32 m_parent = kMaxU32;
+	DynamicArray<U32> m_children;
+	Bool m_ignoreParent = false;
+	U32 m_slot = SceneTransformStore::kInvalidSlot;
+
+	// The state of the way SceneNode used to update its transforms
+	Transform m_world = Transform::getIdentity();
+	Transform m_prevWorld = Transform::getIdentity();
+	Bool m_localDirty = true;
+	Bool m_updatedThisFrame = true;
+};
+
+class TestScene
+{
+public:
+	DynamicArray<TestNode> m_nodes;
+	DynamicArray<U32> m_roots;
+
+	// The store points to the local transforms so the nodes can't move in memory
+	explicit TestScene(U32 maxNodeCount)
+	{
+		m_nodes.resizeStorage(maxNodeCount);
+	}
+
+	U32 newNode(U32 parent)
+	{
+		const U32 idx = m_nodes.getSize();
+		TestNode& node = *m_nodes.emplaceBack();
+		node.m_local = randomTransform();
+		node.m_parent = parent;
+		if(parent != kMaxU32)
+		{
+			m_nodes[parent].m_children.emplaceBack(idx);
+		}
+		else
+		{
+			m_roots.emplaceBack(idx);
+		}
+		return idx;
+	}
+
+	void move(SceneTransformStore& store, U32 idx)
+	{
+		TestNode& node = m_nodes[idx];
+		node.m_local = randomTransform();
+		node.m_localDirty = true;
+		if(node.m_slot != SceneTransformStore::kInvalidSlot)
+		{
+			store.markLocalTransformDirty(node.m_slot);
+		}
+	}
+
+	// Same as SceneGraph::rebuildTransformStore()
+	void rebuild(SceneTransformStore& store)
+	{
+		store.beginRebuild(m_nodes.getSize());
+
+		DynamicArray<U32> queue;
+		for(U32 root : m_roots)
+		{
+			queue.emplaceBack(root);
+		}
+
+		U32 levelBegin = 0;
+		U32 depth = 0;
+		while(levelBegin < queue.getSize())
+		{
+			const U32 levelEnd = queue.getSize();
+			for(U32 i = levelBegin; i < levelEnd; ++i)
+			{
+				TestNode& node = m_nodes[queue[i]];
+				const U32 parentSlot =
+					(node.m_parent != kMaxU32 && !node.m_ignoreParent) ? m_nodes[node.m_parent].m_slot : SceneTransformStore::kInvalidSlot;
+				const Bool firstSlot = node.m_slot == SceneTransformStore::kInvalidSlot;
+				node.m_slot = store.addSlot(&node.m_local, parentSlot, depth, node.m_slot, firstSlot && node.m_localDirty);
+
+				for(U32 child : node.m_children)
+				{
+					queue.emplaceBack(child);
+				}
+			}
+
+			levelBegin = levelEnd;
+			++depth;
+		}
+
+		store.endRebuild();
+	}
+
+	// The way SceneNode::updateTransform() used to work. Walk the hierarchy recursively
+	void referenceUpdate()
+	{
+		for(U32 root : m_roots)
+		{
+			referenceUpdate(root);
+		}
+	}
+
+	void referenceUpdate(U32 idx)
+	{
+		TestNode& node = m_nodes[idx];
+		const Bool needsUpdate = node.m_localDirty;
+		node.m_localDirty = false;
+		const Bool updatedLastFrame = node.m_updatedThisFrame;
+		node.m_updatedThisFrame = needsUpdate;
+
+		if(needsUpdate || updatedLastFrame)
+		{
+			node.m_prevWorld = node.m_world;
+		}
+
+		if(needsUpdate)
+		{
+			if(node.m_parent == kMaxU32 || node.m_ignoreParent)
+			{
+				node.m_world = node.m_local;
+			}
+			else
+			{
+				node.m_world = m_nodes[node.m_parent].m_world.combineTransformations(node.m_local);
+			}
+
+			for(U32 child : node.m_children)
+			{
+				if(!m_nodes[child].m_ignoreParent)
+				{
+					m_nodes[child].m_localDirty = true;
+				}
+			}
+		}
+
+		for(U32 child : node.m_children)
+		{
+			referenceUpdate(child);
+		}
+	}
+
+	static Transform randomTransform()
+	{
+		return Transform(Vec3(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f)),
+						 Mat3(Euler(getRandomRange(-kPi, kPi), getRandomRange(-kPi, kPi), getRandomRange(-kPi, kPi))),
+						 Vec3(getRandomRange(0.5f, 1.5f)));
+	}
+};
+
+} // namespace
+
+static Bool compare(const SceneTransformStore& store, const TestScene& scene)
+{
+	for(const TestNode& node : scene.m_nodes)
+	{
+		if(store.getWorldTransform(node.m_slot) != node.m_world || store.getPreviousWorldTransform(node.m_slot) != node.m_prevWorld
+		   || store.getWorldTransformUpdatedThisFrame(node.m_slot) != node.m_updatedThisFrame)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+ANKI_TEST(Scene, SceneTransformStore)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	SceneMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		ThreadJobManager jobManager(max(2u, getCpuCoresCount()));
+
+		srand(0);
+
+		// Random hierarchy with some big levels so the threads get some work
+		TestScene scene(2100);
+		for(U32 i = 0; i < 2000; ++i)
+		{
+			const U32 parent = (i < 10) ? kMaxU32 : U32(getRandomRange(0, I32(scene.m_nodes.getSize()) - 1));
+			const U32 idx = scene.newNode(parent);
+			scene.m_nodes[idx].m_ignoreParent = parent != kMaxU32 && (i % 17) == 0;
+		}
+
+		SceneTransformStore store;
+		scene.rebuild(store);
+		ANKI_TEST_EXPECT_EQ(store.getSlotCount(), 2000);
+
+		for(U32 frame = 0; frame < 20; ++frame)
+		{
+			// Add a few nodes in the middle of the test
+			if(frame == 10)
+			{
+				for(U32 i = 0; i < 100; ++i)
+				{
+					scene.newNode(U32(getRandomRange(0, I32(scene.m_nodes.getSize()) - 1)));
+				}
+
+				scene.rebuild(store);
+				ANKI_TEST_EXPECT_EQ(store.getSlotCount(), 2100);
+			}
+
+			// Some frames don't move anything so the "moved last frame" logic gets tested
+			if(frame % 3 != 2)
+			{
+				for(U32 i = 0; i < 50; ++i)
+				{
+					scene.move(store, U32(getRandomRange(0, I32(scene.m_nodes.getSize()) - 1)));
+				}
+			}
+
+			store.updateWorldTransforms((frame % 2) ? &jobManager : nullptr);
+			scene.referenceUpdate();
+
+			ANKI_TEST_EXPECT_EQ(compare(store, scene), true);
+		}
+	}
+
+	SceneMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+// Compare the recursive way of updating the transforms with the store on 100K nodes
+ANKI_TEST(Scene, SceneTransformStoreBenchmark)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	SceneMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kNodeCount = 100000;
+		constexpr U32 kFrameCount = 16;
+
+		ThreadJobManager jobManager(getCpuCoresCount());
+
+		srand(0);
+
+		class Case
+		{
+		public:
+			const Char* m_name;
+			U32 m_treeCount;
+			U32 m_childCount; // Children of the non-leaf nodes
+		};
+
+		const Array<Case, 2> cases = {{{"A few deep hierarchies", 10, 1}, {"Many shallow hierarchies", 10000, 3}}};
+		for(const Case& c : cases)
+		{
+			// Build the trees breadth-first till every tree has kNodeCount / m_treeCount nodes
+			TestScene scene(kNodeCount);
+			const U32 nodesPerTree = kNodeCount / c.m_treeCount;
+			for(U32 t = 0; t < c.m_treeCount; ++t)
+			{
+				const U32 root = scene.newNode(kMaxU32);
+				U32 treeNodeCount = 1;
+				for(U32 parent = root; treeNodeCount < nodesPerTree; ++parent)
+				{
+					for(U32 i = 0; i < c.m_childCount && treeNodeCount < nodesPerTree; ++i, ++treeNodeCount)
+					{
+						scene.newNode(parent);
+					}
+				}
+			}
+
+			SceneTransformStore store;
+			Second begin = HighRezTimer::getCurrentTime();
+			scene.rebuild(store);
+			const Second rebuildTime = HighRezTimer::getCurrentTime() - begin;
+
+			// Move all the roots, that updates the whole scene
+			Second refTime = 0.0;
+			Second storeTime = 0.0;
+			for(U32 frame = 0; frame < kFrameCount; ++frame)
+			{
+				for(U32 root : scene.m_roots)
+				{
+					scene.move(store, root);
+				}
+
+				begin = HighRezTimer::getCurrentTime();
+				scene.referenceUpdate();
+				refTime += HighRezTimer::getCurrentTime() - begin;
+
+				begin = HighRezTimer::getCurrentTime();
+				store.updateWorldTransforms(&jobManager);
+				storeTime += HighRezTimer::getCurrentTime() - begin;
+
+				ANKI_TEST_EXPECT_EQ(store.getUpdatedSlotCount(), scene.m_nodes.getSize());
+			}
+
+			ANKI_TEST_EXPECT_EQ(compare(store, scene), true);
+
+			ANKI_TEST_LOGI("%s: %u nodes, %u levels. Rebuild %fms. All nodes moved: recursive %fms, store %fms", c.m_name, scene.m_nodes.getSize(),
+						   store.getLevelCount(), rebuildTime * 1000.0, refTime * 1000.0 / F64(kFrameCount), storeTime * 1000.0 / F64(kFrameCount));
+
+			// Nothing moves. The store only touches the flags
+			refTime = 0.0;
+			storeTime = 0.0;
+			for(U32 frame = 0; frame < kFrameCount; ++frame)
+			{
+				begin = HighRezTimer::getCurrentTime();
+				scene.referenceUpdate();
+				refTime += HighRezTimer::getCurrentTime() - begin;
+
+				begin = HighRezTimer::getCurrentTime();
+				store.updateWorldTransforms(&jobManager);
+				storeTime += HighRezTimer::getCurrentTime() - begin;
+			}
+
+			ANKI_TEST_EXPECT_EQ(compare(store, scene), true);
+
+			ANKI_TEST_LOGI("%s: Nothing moved: recursive %fms, store %fms", c.m_name, refTime * 1000.0 / F64(kFrameCount),
+						   storeTime * 1000.0 / F64(kFrameCount));
+		}
+	}
+
+	SceneMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
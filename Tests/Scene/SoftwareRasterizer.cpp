@@ -0,0 +1,177 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Scene/SoftwareRasterizer.h>
+#include <AnKi/Collision/Aabb.h>
+#include <AnKi/Collision/Functions.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/System.h>
+
+using namespace anki;
+
+static Mat3x4 boxTransform(Vec3 center, Vec3 halfExtent)
+{
+	return Mat3x4(Transform(center, Mat3::getIdentity(), halfExtent));
+}
+
+ANKI_TEST(Scene, SoftwareRasterizer)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	SceneMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		ThreadJobManager jobManager(max(2u, getCpuCoresCount()));
+
+		// The camera is in the origin looking at -z
+		const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(90.0f), 0.1f, 1000.0f);
+
+		for(U32 threaded = 0; threaded < 2; ++threaded)
+		{
+			SoftwareRasterizer r;
+			r.prepare(Mat4::getIdentity(), proj, 256, 256);
+
+			// A wall 10 units in front of the camera
+			r.drawBox(boxTransform(Vec3(0.0f, 0.0f, -10.0f), Vec3(5.0f, 5.0f, 0.1f)));
+			r.rasterize((threaded) ? &jobManager : nullptr);
+
+			// Only the front face survives the backface culling
+			ANKI_TEST_EXPECT_EQ(r.getTriangleCount(), 2);
+
+			// Behind the wall
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec3(-1.0f, -1.0f, -21.0f), Vec3(1.0f, 1.0f, -19.0f))), false);
+
+			// In front of the wall
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec3(-1.0f, -1.0f, -6.0f), Vec3(1.0f, 1.0f, -4.0f))), true);
+
+			// Behind the wall but it peeks from the side
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec3(8.0f, -1.0f, -21.0f), Vec3(12.0f, 1.0f, -19.0f))), true);
+
+			// Intersects the wall
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec3(-1.0f, -1.0f, -11.0f), Vec3(1.0f, 1.0f, -9.0f))), true);
+
+			// Behind the camera. It's not the job of the rasterizer to do frustum culling
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec3(-1.0f, -1.0f, 5.0f), Vec3(1.0f, 1.0f, 10.0f))), true);
+
+			// Touches the near plane
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec3(-1.0f, -1.0f, -1.0f), Vec3(1.0f, 1.0f, 1.0f))), true);
+		}
+
+		// The camera is inside an occluder. Backfaces are culled so nothing is occluded
+		{
+			SoftwareRasterizer r;
+			r.prepare(Mat4::getIdentity(), proj, 128, 128);
+			r.drawBox(boxTransform(Vec3(0.0f), Vec3(50.0f)));
+			r.rasterize(&jobManager);
+
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec3(-1.0f, -1.0f, -21.0f), Vec3(1.0f, 1.0f, -19.0f))), true);
+		}
+	}
+
+	SceneMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+// Rasterize the buildings of a synthetic city and test the props that are scattered in the streets
+ANKI_TEST(Scene, SoftwareRasterizerBenchmark)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	SceneMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kBlockCount = 48; // The city is kBlockCount x kBlockCount buildings
+		constexpr F32 kBlockSize = 20.0f;
+		constexpr F32 kStreetWidth = 8.0f;
+		constexpr U32 kPropCount = 20000;
+		constexpr U32 kFrameCount = 32;
+
+		ThreadJobManager jobManager(getCpuCoresCount());
+
+		srand(0);
+
+		DynamicArray<Mat3x4> buildings;
+		const F32 cityHalfSize = F32(kBlockCount) * (kBlockSize + kStreetWidth) / 2.0f;
+		for(U32 y = 0; y < kBlockCount; ++y)
+		{
+			for(U32 x = 0; x < kBlockCount; ++x)
+			{
+				const F32 height = getRandomRange(10.0f, 60.0f);
+				const Vec3 center(F32(x) * (kBlockSize + kStreetWidth) - cityHalfSize, height / 2.0f,
+								  F32(y) * (kBlockSize + kStreetWidth) - cityHalfSize);
+				buildings.emplaceBack(boxTransform(center, Vec3(kBlockSize / 2.0f, height / 2.0f, kBlockSize / 2.0f)));
+			}
+		}
+
+		// Props in the streets
+		DynamicArray<Aabb> props;
+		for(U32 i = 0; i < kPropCount; ++i)
+		{
+			const U32 street = U32(getRandomRange(0, I32(kBlockCount) - 1));
+			const F32 along = getRandomRange(-cityHalfSize, cityHalfSize);
+			const F32 across = F32(street) * (kBlockSize + kStreetWidth) - cityHalfSize + kBlockSize / 2.0f + kStreetWidth / 2.0f;
+			const Vec3 center = (i % 2) ? Vec3(across, 1.0f, along) : Vec3(along, 1.0f, across);
+			props.emplaceBack(Aabb(center - Vec3(1.0f), center + Vec3(1.0f)));
+		}
+
+		const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(60.0f), 0.1f, 2000.0f);
+
+		Second rasterizationTime = 0.0;
+		Second testTime = 0.0;
+		U32 triangleCount = 0;
+		U32 culledCount = 0;
+		U32 insideFrustumCount = 0;
+		SoftwareRasterizer r;
+		for(U32 frame = 0; frame < kFrameCount; ++frame)
+		{
+			// Walk down a street, a bit above the ground
+			const Vec3 camPos(-cityHalfSize + kBlockSize / 2.0f + kStreetWidth / 2.0f, 2.0f, F32(frame) * 10.0f);
+			const Mat3 camRot(Euler(0.0f, F32(frame) * toRad(360.0f / F32(kFrameCount)), 0.0f));
+			const Mat4 view(Mat3x4(Transform(camPos, camRot, Vec3(1.0f)).invert()), Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+			Second begin = HighRezTimer::getCurrentTime();
+			r.prepare(view, proj, 256, 128);
+			for(const Mat3x4& building : buildings)
+			{
+				r.drawBox(building);
+			}
+			r.rasterize(&jobManager);
+			rasterizationTime += HighRezTimer::getCurrentTime() - begin;
+			triangleCount += r.getTriangleCount();
+
+			// Count only the props inside the frustum since the rasterizer doesn't do frustum culling
+			Array<Plane, 6> planes;
+			extractClipPlanes(proj * view, planes);
+			for(const Aabb& prop : props)
+			{
+				Bool inside = true;
+				for(const Plane& plane : planes)
+				{
+					inside = inside && testPlane(plane, prop) >= 0.0f;
+				}
+
+				if(inside)
+				{
+					++insideFrustumCount;
+
+					begin = HighRezTimer::getCurrentTime();
+					culledCount += !r.visibilityTest(prop);
+					testTime += HighRezTimer::getCurrentTime() - begin;
+				}
+			}
+		}
+
+		ANKI_TEST_LOGI("Rasterized %u triangles per frame at %f Mtris/sec. Frame %fms", triangleCount / kFrameCount,
+					   F64(triangleCount) / rasterizationTime / 1000000.0, rasterizationTime * 1000.0 / F64(kFrameCount));
+		ANKI_TEST_LOGI("Culled %f%% of the props inside the frustum. %fns per test", F64(culledCount) * 100.0 / F64(insideFrustumCount),
+					   testTime * 1000000000.0 / F64(insideFrustumCount));
+
+		// In a dense city most of the props are hidden
+		ANKI_TEST_EXPECT_GT(culledCount, insideFrustumCount / 2);
+	}
+
+	SceneMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
@@ -0,0 +1,141 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Script.h>
+#include <AnKi/Math.h>
+
+ANKI_TEST(Script, ScriptEnvironment)
+{
+	ScriptManager::allocateSingleton(allocAligned, nullptr);
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	constexpr CString kScript = R"(
+counter = 0
+
+function update(v)
+	counter = counter + 1
+	v:copy(v + Vec3.new(counter))
+end
+)";
+
+	// Compile once
+	ConstWeakArray<U8, PtrSize> bytecode;
+	ANKI_TEST_EXPECT_NO_ERR(ScriptManager::getSingleton().getOrCompileBytecode(kScript, "=test", bytecode));
+	ANKI_TEST_EXPECT_EQ(LuaBinder::isBytecode(bytecode), true);
+
+	ConstWeakArray<U8, PtrSize> bytecode2;
+	ANKI_TEST_EXPECT_NO_ERR(ScriptManager::getSingleton().getOrCompileBytecode(kScript, "=test", bytecode2));
+	ANKI_TEST_EXPECT_EQ(bytecode.getBegin(), bytecode2.getBegin());
+
+	// Compile errors are caught
+	ANKI_TEST_EXPECT_ERR(ScriptManager::getSingleton().getOrCompileBytecode("function (", "=test", bytecode2), Error::kUserData);
+
+	// Run the same bytecode in own and shared environments
+	for(Bool shared : {false, true})
+	{
+		ScriptEnvironment envA(shared);
+		ScriptEnvironment envB(shared);
+		ANKI_TEST_EXPECT_EQ(envA.isSharedState(), shared);
+		ANKI_TEST_EXPECT_NO_ERR(envA.evalBytecode(bytecode, "=test"));
+		ANKI_TEST_EXPECT_NO_ERR(envB.evalBytecode(bytecode, "=test"));
+
+		const I32 updateA = envA.getFunctionReference("update");
+		const I32 updateB = envB.getFunctionReference("update");
+		ANKI_TEST_EXPECT_NEQ(updateA, LUA_NOREF);
+		ANKI_TEST_EXPECT_NEQ(updateB, LUA_NOREF);
+		ANKI_TEST_EXPECT_EQ(envA.getFunctionReference("doesntExist"), LUA_NOREF);
+		ANKI_TEST_EXPECT_EQ(envA.getFunctionReference("counter"), LUA_NOREF);
+
+		auto callUpdate = [](ScriptEnvironment& env, I32 ref, Vec3& v) {
+			LockGuard lock(env);
+			lua_State* l = &env.getLuaState();
+			env.pushFunction(ref);
+			LuaBinder::pushVariableToTheStack(l, &v);
+			ANKI_TEST_EXPECT_EQ(lua_pcall(l, 1, 0, 0), 0);
+		};
+
+		// The environments don't see each other's globals
+		Vec3 a(0.0f);
+		Vec3 b(0.0f);
+		callUpdate(envA, updateA, a);
+		callUpdate(envA, updateA, a);
+		callUpdate(envB, updateB, b);
+		ANKI_TEST_EXPECT_EQ(a, Vec3(3.0f));
+		ANKI_TEST_EXPECT_EQ(b, Vec3(1.0f));
+
+		// Only the variables of the environment are visited
+		class Callbacks : public LuaBinderVisitGlobalsCallbacks
+		{
+		public:
+			U32 m_count = 0;
+			F64 m_counter = 0.0;
+
+			Bool onNumber(CString name, F64& value) override
+			{
+				++m_count;
+				if(name == "counter")
+				{
+					m_counter = value;
+					value = 10.0;
+					return true;
+				}
+				return false;
+			}
+
+			Bool onBool(CString, Bool&) override
+			{
+				++m_count;
+				return false;
+			}
+
+			Bool onString(CString, ScriptString&) override
+			{
+				++m_count;
+				return false;
+			}
+
+			Bool onUserData(CString, LuaUserData&) override
+			{
+				++m_count;
+				return false;
+			}
+		} callbacks;
+
+		envA.visitGlobals(callbacks);
+		ANKI_TEST_EXPECT_EQ(callbacks.m_count, 1);
+		ANKI_TEST_EXPECT_EQ(callbacks.m_counter, 2.0);
+
+		callUpdate(envA, updateA, a);
+		ANKI_TEST_EXPECT_EQ(a, Vec3(3.0f + 11.0f));
+	}
+
+	// The shared environments don't leak to the globals
+	{
+		ScriptEnvironment env(true);
+		ANKI_TEST_EXPECT_NO_ERR(env.evalString("leaked = 1"));
+		ANKI_TEST_EXPECT_NO_ERR(ScriptManager::getSingleton().evalString("assert(leaked == nil)"));
+	}
+
+	// Budgeted garbage collection
+	{
+		ScriptEnvironment env;
+		ANKI_TEST_EXPECT_NO_ERR(env.evalString("for i = 1, 10000 do local t = {i} end"));
+
+		const F32 oldBudget = g_cvarScriptGarbageCollectionBudget;
+		g_cvarScriptGarbageCollectionBudget = 100.0f;
+		ScriptManager::getSingleton().collectGarbage();
+		const I32 kbAfter = lua_gc(&env.getLuaState(), LUA_GCCOUNT, 0);
+		ANKI_TEST_EXPECT_NO_ERR(env.evalString("for i = 1, 10000 do local t = {i} end"));
+		ANKI_TEST_EXPECT_GEQ(lua_gc(&env.getLuaState(), LUA_GCCOUNT, 0), kbAfter); // Automatic GC is stopped
+		ScriptManager::getSingleton().collectGarbage();
+		ANKI_TEST_EXPECT_LEQ(lua_gc(&env.getLuaState(), LUA_GCCOUNT, 0), kbAfter + 1);
+
+		g_cvarScriptGarbageCollectionBudget = oldBudget;
+	}
+
+	DefaultMemoryPool::freeSingleton();
+	ScriptManager::freeSingleton();
+}
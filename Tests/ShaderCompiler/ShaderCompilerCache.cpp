@@ -0,0 +1,126 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/ShaderCompiler/ShaderCompilerCache.h>
+#include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <filesystem>
+
+using namespace anki;
+
+static ShaderCompilerDynamicArray<U8> makeIl(U32 size, U8 seed)
+{
+	ShaderCompilerDynamicArray<U8> il;
+	il.resize(size);
+	for(U32 i = 0; i < size; ++i)
+	{
+		il[i] = U8(seed + i);
+	}
+	return il;
+}
+
+ANKI_TEST(ShaderCompiler, ShaderCompilerCache)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ShaderCompilerMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		String dir;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(dir));
+		dir += "/AnKiShaderCompilerCacheTest";
+		if(directoryExists(dir))
+		{
+			ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir));
+		}
+
+		constexpr U32 kIlSize = 1000;
+		ShaderCompilerCache cache;
+		ANKI_TEST_EXPECT_NO_ERR(cache.init(dir, 3 * (kIlSize + 100)));
+
+		// Everything that affects the compilation should change the key
+		const Array<CString, 1> args = {"-Wall"};
+		const U64 key = ShaderCompilerCache::computeKey(1, "void main() {}", ShaderType::kPixel, true, true, false, ShaderModel::k6_8, {});
+		ANKI_TEST_EXPECT_EQ(key, ShaderCompilerCache::computeKey(1, "void main() {}", ShaderType::kPixel, true, true, false, ShaderModel::k6_8, {}));
+		ANKI_TEST_EXPECT_NEQ(key, ShaderCompilerCache::computeKey(2, "void main() {}", ShaderType::kPixel, true, true, false, ShaderModel::k6_8, {}));
+		ANKI_TEST_EXPECT_NEQ(key, ShaderCompilerCache::computeKey(1, "void main(){}", ShaderType::kPixel, true, true, false, ShaderModel::k6_8, {}));
+		ANKI_TEST_EXPECT_NEQ(key,
+							 ShaderCompilerCache::computeKey(1, "void main() {}", ShaderType::kVertex, true, true, false, ShaderModel::k6_8, {}));
+		ANKI_TEST_EXPECT_NEQ(key,
+							 ShaderCompilerCache::computeKey(1, "void main() {}", ShaderType::kPixel, false, true, false, ShaderModel::k6_8, {}));
+		ANKI_TEST_EXPECT_NEQ(key, ShaderCompilerCache::computeKey(1, "void main() {}", ShaderType::kPixel, true, true, true, ShaderModel::k6_8, {}));
+		ANKI_TEST_EXPECT_NEQ(key, ShaderCompilerCache::computeKey(1, "void main() {}", ShaderType::kPixel, true, true, false, ShaderModel::k6_7, {}));
+		ANKI_TEST_EXPECT_NEQ(key, ShaderCompilerCache::computeKey(1, "void main() {}", ShaderType::kPixel, true, true, false, ShaderModel::k6_8,
+																  ConstWeakArray<CString>(args)));
+
+		// Miss then hit
+		ShaderCompilerDynamicArray<U8> il;
+		ANKI_TEST_EXPECT_EQ(cache.find(key, il), false);
+
+		const ShaderCompilerDynamicArray<U8> refIl = makeIl(kIlSize, 0);
+		cache.store(key, refIl);
+		ANKI_TEST_EXPECT_EQ(cache.find(key, il), true);
+		ANKI_TEST_EXPECT_EQ(il.getSize(), kIlSize);
+		ANKI_TEST_EXPECT_EQ(memcmp(il.getBegin(), refIl.getBegin(), kIlSize), 0);
+		ANKI_TEST_EXPECT_EQ(cache.getHitCount(), 1);
+		ANKI_TEST_EXPECT_EQ(cache.getMissCount(), 1);
+
+		auto entryFilename = [&](U64 key) {
+			String fname;
+			fname.sprintf("%s/%016" PRIx64 ".ankiil", dir.cstr(), key);
+			return fname;
+		};
+
+		// A corrupted entry is a miss
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(entryFilename(key), FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+			ANKI_TEST_EXPECT_NO_ERR(file.write(refIl.getBegin(), 100));
+		}
+		ANKI_TEST_EXPECT_EQ(cache.find(key, il), false);
+
+		// Many threads store and find the same entries
+		{
+			ThreadJobManager jobManager(8);
+			Atomic<U32> failures(0);
+			for(U32 t = 0; t < 64; ++t)
+			{
+				jobManager.dispatchTask([&, t]([[maybe_unused]] U32 tid) {
+					const U64 k = t % 4;
+					const ShaderCompilerDynamicArray<U8> ref = makeIl(kIlSize, U8(k));
+					cache.store(k, ref);
+
+					ShaderCompilerDynamicArray<U8> out;
+					if(!cache.find(k, out) || memcmp(out.getBegin(), ref.getBegin(), kIlSize) != 0)
+					{
+						failures.fetchAdd(1);
+					}
+				});
+			}
+			jobManager.waitForAllTasksToFinish();
+			ANKI_TEST_EXPECT_EQ(failures.load(), 0);
+		}
+
+		// LRU eviction. Make the entries look old and use one of the oldest
+		for(U64 k = 0; k < 4; ++k)
+		{
+			std::filesystem::last_write_time(entryFilename(k).cstr(), std::filesystem::file_time_type::clock::now() - std::chrono::minutes(10 - k));
+		}
+		std::filesystem::remove(entryFilename(key).cstr());
+
+		ANKI_TEST_EXPECT_EQ(cache.find(0, il), true);
+		ANKI_TEST_EXPECT_NO_ERR(cache.trim());
+
+		ANKI_TEST_EXPECT_EQ(fileExists(entryFilename(0)), true);
+		ANKI_TEST_EXPECT_EQ(fileExists(entryFilename(1)), false);
+		ANKI_TEST_EXPECT_EQ(fileExists(entryFilename(2)), true);
+		ANKI_TEST_EXPECT_EQ(fileExists(entryFilename(3)), true);
+
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir));
+	}
+
+	ShaderCompilerMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
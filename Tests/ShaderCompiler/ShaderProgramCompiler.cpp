@@ -6,7 +6,10 @@
 #include <Tests/Framework/Framework.h>
 #include <AnKi/ShaderCompiler/ShaderCompiler.h>
 #include <AnKi/ShaderCompiler/ShaderDump.h>
+#include <AnKi/ShaderCompiler/ShaderCompilerCache.h>
 #include <AnKi/Util/ThreadHive.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/HighRezTimer.h>
 
 ANKI_TEST(ShaderCompiler, ShaderProgramCompilerSimple)
 {
@@ -138,7 +141,7 @@ void main()
 	taskManager.m_pool = &pool;
 
 	ShaderBinary* binary;
-	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", true, true, ShaderModel::k6_8, fsystem, nullptr, &taskManager, {}, binary));
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", true, true, ShaderModel::k6_8, fsystem, nullptr, &taskManager, nullptr, {}, binary));
 
 #if 1
 	ShaderCompilerString dis;
@@ -333,7 +336,7 @@ void main()
 	taskManager.m_pool = &pool;
 
 	ShaderBinary* binary;
-	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", true, true, ShaderModel::k6_8, fsystem, nullptr, &taskManager, {}, binary));
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", true, true, ShaderModel::k6_8, fsystem, nullptr, &taskManager, nullptr, {}, binary));
 
 #if 1
 	ShaderCompilerString dis;
@@ -342,3 +345,148 @@ void main()
 	ANKI_LOGI("Binary disassembly:\n%s\n", dis.cstr());
 #endif
 }
+
+// A program with many mutators where most of the mutations share code blocks. With a warm cache most of the time goes to the deduplication
+ANKI_TEST(ShaderCompiler, ShaderProgramCompilerBenchmark)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ShaderCompilerMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		const CString sourceCode = R"(
+#pragma anki mutator M0 0 1
+#pragma anki mutator M1 0 1
+#pragma anki mutator M2 0 1
+#pragma anki mutator M3 0 1
+#pragma anki mutator M4 0 1
+#pragma anki mutator M5 0 1
+#pragma anki mutator M6 0 1
+#pragma anki mutator M7 0 1
+#pragma anki mutator M8 0 1
+#pragma anki mutator M9 0 1
+#pragma anki mutator M10 0 1
+#pragma anki mutator M11 0 1
+
+#pragma anki technique Main vert mutators M0 M1
+#pragma anki technique Main pixel mutators M0 M1 M2 M3 M4 M5
+#pragma anki technique Shadow vert pixel mutators M0
+
+#if ANKI_VERTEX_SHADER
+float4 main(uint svVertexId : SV_VERTEXID) : SV_POSITION
+{
+	const float2 uv = float2(svVertexId & 1, svVertexId >> 1) * 2.0;
+#	if ANKI_TECHNIQUE_Main
+	return float4(uv * 2.0 - 1.0, M0, 1.0 + M1);
+#	else
+	return float4(uv * 2.0 - 1.0, 0.5, 3.0 + M0);
+#	endif
+}
+#else
+float4 main() : SV_TARGET0
+{
+#	if ANKI_TECHNIQUE_Main
+	return float4(M0 + M1 * 2, M2 + M3 * 2, M4 + M5 * 2, 1.0);
+#	else
+	return float4(0.5, M0, 0.25, 1.0);
+#	endif
+}
+#endif
+)";
+
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open("benchmark.ankiprog", FileOpenFlag::kWrite));
+			ANKI_TEST_EXPECT_NO_ERR(file.writeText(sourceCode));
+		}
+
+		class Fsystem : public ShaderCompilerFilesystemInterface
+		{
+		public:
+			Error readAllText(CString filename, ShaderCompilerString& txt) final
+			{
+				File file;
+				ANKI_CHECK(file.open(filename, FileOpenFlag::kRead));
+				ANKI_CHECK(file.readAllText(txt));
+				return Error::kNone;
+			}
+		} fsystem;
+
+		class TaskManager : public ShaderCompilerAsyncTaskInterface
+		{
+		public:
+			ThreadJobManager m_jobManager{getCpuCoresCount()};
+
+			void enqueueTask(void (*callback)(void* userData), void* userData) final
+			{
+				m_jobManager.dispatchTask([callback, userData]([[maybe_unused]] U32 threadIdx) {
+					callback(userData);
+				});
+			}
+
+			Error joinTasks() final
+			{
+				m_jobManager.waitForAllTasksToFinish();
+				return Error::kNone;
+			}
+		} taskManager;
+
+		String cacheDir;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(cacheDir));
+		cacheDir += "/AnKiShaderProgramCompilerBenchmark";
+		if(directoryExists(cacheDir))
+		{
+			ANKI_TEST_EXPECT_NO_ERR(removeDirectory(cacheDir));
+		}
+
+		ShaderCompilerCache cache;
+		ANKI_TEST_EXPECT_NO_ERR(cache.init(cacheDir, 128 * 1024 * 1024));
+
+		// The 1st time fills the cache and the 2nd hits it
+		Array<ShaderBinary*, 2> binaries = {};
+		for(U32 i = 0; i < 2; ++i)
+		{
+			HighRezTimer timer;
+			timer.start();
+			ANKI_TEST_EXPECT_NO_ERR(
+				compileShaderProgram("benchmark.ankiprog", true, false, ShaderModel::k6_8, fsystem, nullptr, &taskManager, &cache, {}, binaries[i]));
+			timer.stop();
+
+			ANKI_TEST_LOGI("%s cache: %u mutations, %u variants, %u code blocks in %fms", (i == 0) ? "Cold" : "Warm",
+						   binaries[i]->m_mutations.getSize(), binaries[i]->m_variants.getSize(), binaries[i]->m_codeBlocks.getSize(),
+						   timer.getElapsedTime() * 1000.0);
+		}
+
+		ANKI_TEST_EXPECT_EQ(binaries[0]->m_mutations.getSize(), 4096);
+		ANKI_TEST_EXPECT_EQ(binaries[0]->m_variants.getSize(), 64);
+		ANKI_TEST_EXPECT_EQ(binaries[0]->m_codeBlocks.getSize(), 4 + 64 + 2 + 2);
+
+		// The output shouldn't depend on the order the threads compiled things
+		const ShaderBinary& a = *binaries[0];
+		const ShaderBinary& b = *binaries[1];
+		ANKI_TEST_EXPECT_EQ(a.m_codeBlocks.getSize(), b.m_codeBlocks.getSize());
+		for(U32 i = 0; i < min(a.m_codeBlocks.getSize(), b.m_codeBlocks.getSize()); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(a.m_codeBlocks[i].m_hash, b.m_codeBlocks[i].m_hash);
+		}
+
+		ANKI_TEST_EXPECT_EQ(a.m_variants.getSize(), b.m_variants.getSize());
+		for(U32 i = 0; i < min(a.m_variants.getSize(), b.m_variants.getSize()); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(memcmp(a.m_variants[i].m_techniqueCodeBlocks.getBegin(), b.m_variants[i].m_techniqueCodeBlocks.getBegin(),
+									   a.m_variants[i].m_techniqueCodeBlocks.getSizeInBytes()),
+								0);
+		}
+
+		for(U32 i = 0; i < a.m_mutations.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(a.m_mutations[i].m_variantIndex, b.m_mutations[i].m_variantIndex);
+		}
+
+		freeShaderBinary(binaries[0]);
+		freeShaderBinary(binaries[1]);
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(cacheDir));
+	}
+
+	ShaderCompilerMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
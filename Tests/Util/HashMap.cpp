@@ -6,6 +6,8 @@
 #include <Tests/Framework/Framework.h>
 #include <Tests/Util/Foo.h>
 #include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SparseArray.h>
+#include <AnKi/Util/String.h>
 #include <AnKi/Util/DynamicArray.h>
 #include <AnKi/Util/HighRezTimer.h>
 #include <unordered_map>
@@ -24,6 +26,8 @@ public:
 
 ANKI_TEST(Util, HashMap)
 {
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
 	int vals[] = {20, 15, 5, 1, 10, 0, 18, 6, 7, 11, 13, 3};
 	U valsSize = sizeof(vals) / sizeof(vals[0]);
 
@@ -139,7 +143,97 @@ ANKI_TEST(Util, HashMap)
 		akMap.destroy();
 	}
 
-	// Bench it
+	// Keys with colliding hashes
+	{
+		class BadHasher
+		{
+		public:
+			U64 operator()(int x)
+			{
+				return x & 1;
+			}
+		};
+
+		HashMap<int, int, BadHasher> map;
+		for(int i = 0; i < 100; ++i)
+		{
+			map.emplace(i, i * 10);
+		}
+		map.validate();
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 100u);
+
+		for(int i = 0; i < 100; i += 2)
+		{
+			map.erase(map.find(i));
+		}
+		map.validate();
+
+		for(int i = 0; i < 100; ++i)
+		{
+			auto it = map.find(i);
+			if(i & 1)
+			{
+				ANKI_TEST_EXPECT_NEQ(it, map.getEnd());
+				ANKI_TEST_EXPECT_EQ(*it, i * 10);
+				ANKI_TEST_EXPECT_EQ(it.getKey(), i);
+			}
+			else
+			{
+				ANKI_TEST_EXPECT_EQ(it, map.getEnd());
+			}
+		}
+	}
+
+	// String keys, copy and replace
+	{
+		HashMap<String, int> map;
+		map.emplace("hello", 1);
+		map.emplace("world", 2);
+		map.emplace("hello", 3);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2u);
+		ANKI_TEST_EXPECT_EQ(*map.find("hello"), 3);
+
+		HashMap<String, int> map2(map);
+		ANKI_TEST_EXPECT_EQ(*map2.find("world"), 2);
+		map.destroy();
+		ANKI_TEST_EXPECT_EQ(map2.find("hello").getKey(), "hello");
+		ANKI_TEST_EXPECT_EQ(map.find("hello"), map.getEnd());
+	}
+
+	// Fuzzy test against the STL
+	{
+		HashMap<int, int, Hasher> akMap;
+		std::unordered_map<int, int> stdMap;
+
+		for(U32 i = 0; i < 20000; ++i)
+		{
+			const int key = rand() % 2000;
+			if(rand() % 3 == 0)
+			{
+				auto it = akMap.find(key);
+				ANKI_TEST_EXPECT_EQ(it != akMap.getEnd(), stdMap.find(key) != stdMap.end());
+				if(it != akMap.getEnd())
+				{
+					akMap.erase(it);
+					stdMap.erase(key);
+				}
+			}
+			else
+			{
+				akMap.emplace(key, int(i));
+				stdMap[key] = int(i);
+			}
+		}
+
+		akMap.validate();
+		ANKI_TEST_EXPECT_EQ(akMap.getSize(), stdMap.size());
+		for(auto it = akMap.getBegin(); it != akMap.getEnd(); ++it)
+		{
+			ANKI_TEST_EXPECT_EQ(*it, stdMap[it.getKey()]);
+		}
+	}
+
+	// Bench it against the STL and a hash indexed SparseArray (what used to back the HashMap)
 	{
 		class Config
 		{
@@ -163,8 +257,10 @@ ANKI_TEST(Util, HashMap)
 		};
 
 		using AkMap = HashMap<int, int, Hasher, SingletonMemoryPoolWrapper<DefaultMemoryPool>, Config>;
+		using OldMap = SparseArray<int, SingletonMemoryPoolWrapper<DefaultMemoryPool>, Config>;
 
 		AkMap akMap;
+		OldMap oldMap;
 		using StlMap = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>>;
 		StlMap stdMap(10, std::hash<int>(), std::equal_to<int>());
 
@@ -201,6 +297,15 @@ ANKI_TEST(Util, HashMap)
 			timer.stop();
 			Second akTime = timer.getElapsedTime();
 
+			// Put the vals old AnKi
+			timer.start();
+			for(U32 i = 0; i < kCount; ++i)
+			{
+				oldMap.emplace(Hasher()(vals[i]), vals[i]);
+			}
+			timer.stop();
+			Second oldTime = timer.getElapsedTime();
+
 			// Put the vals STL
 			timer.start();
 			for(U32 i = 0; i < kCount; ++i)
@@ -210,7 +315,8 @@ ANKI_TEST(Util, HashMap)
 			timer.stop();
 			Second stlTime = timer.getElapsedTime();
 
-			ANKI_TEST_LOGI("Inserting bench: STL %f AnKi %f | %f%%", stlTime, akTime, stlTime / akTime * 100.0);
+			ANKI_TEST_LOGI("Inserting bench: STL %f Old AnKi %f AnKi %f | %f%% %f%%", stlTime, oldTime, akTime, stlTime / akTime * 100.0,
+						   oldTime / akTime * 100.0);
 		}
 
 		// Search
@@ -227,6 +333,16 @@ ANKI_TEST(Util, HashMap)
 			timer.stop();
 			Second akTime = timer.getElapsedTime();
 
+			// Find values old AnKi
+			timer.start();
+			for(U32 i = 0; i < kCount; ++i)
+			{
+				auto it = oldMap.find(Hasher()(vals[i]));
+				count += *it;
+			}
+			timer.stop();
+			Second oldTime = timer.getElapsedTime();
+
 			// Find values STL
 			timer.start();
 			for(U32 i = 0; i < kCount; ++i)
@@ -236,7 +352,26 @@ ANKI_TEST(Util, HashMap)
 			timer.stop();
 			Second stlTime = timer.getElapsedTime();
 
-			ANKI_TEST_LOGI("Find bench: STL %f AnKi %f | %f%% (%ld)", stlTime, akTime, stlTime / akTime * 100.0, count);
+			// Search for values that are not there
+			timer.start();
+			for(U32 i = 0; i < kCount; ++i)
+			{
+				count += akMap.find(-vals[i] - 1) == akMap.getEnd();
+			}
+			timer.stop();
+			Second akMissTime = timer.getElapsedTime();
+
+			timer.start();
+			for(U32 i = 0; i < kCount; ++i)
+			{
+				count += oldMap.find(Hasher()(-vals[i] - 1)) == oldMap.getEnd();
+			}
+			timer.stop();
+			Second oldMissTime = timer.getElapsedTime();
+
+			ANKI_TEST_LOGI("Find bench: STL %f Old AnKi %f AnKi %f | %f%% %f%% (%ld)", stlTime, oldTime, akTime, stlTime / akTime * 100.0,
+						   oldTime / akTime * 100.0, count);
+			ANKI_TEST_LOGI("Find missing bench: Old AnKi %f AnKi %f | %f%%", oldMissTime, akMissTime, oldMissTime / akMissTime * 100.0);
 		}
 
 		// Delete
@@ -256,6 +391,18 @@ ANKI_TEST(Util, HashMap)
 				akTime += timer.getElapsedTime();
 			}
 
+			// Random delete old AnKi
+			Second oldTime = 0.0;
+			for(U32 i = 0; i < vals.getSize(); ++i)
+			{
+				auto it = oldMap.find(Hasher()(vals[i]));
+
+				timer.start();
+				oldMap.erase(it);
+				timer.stop();
+				oldTime += timer.getElapsedTime();
+			}
+
 			// Random delete STL
 			Second stlTime = 0.0;
 			for(U32 i = 0; i < vals.getSize(); ++i)
@@ -268,9 +415,13 @@ ANKI_TEST(Util, HashMap)
 				stlTime += timer.getElapsedTime();
 			}
 
-			ANKI_TEST_LOGI("Deleting bench: STL %f AnKi %f | %f%%", stlTime, akTime, stlTime / akTime * 100.0);
+			ANKI_TEST_LOGI("Deleting bench: STL %f Old AnKi %f AnKi %f | %f%% %f%%", stlTime, oldTime, akTime, stlTime / akTime * 100.0,
+						   oldTime / akTime * 100.0);
 		}
 
 		akMap.destroy();
+		oldMap.destroy();
 	}
+
+	DefaultMemoryPool::freeSingleton();
 }
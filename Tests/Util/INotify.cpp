@@ -10,6 +10,7 @@
 ANKI_TEST(Util, INotify)
 {
 	HeapMemoryPool pool(allocAligned, nullptr);
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
 
 	// Monitor a dir
 	{
@@ -35,4 +36,67 @@ ANKI_TEST(Util, INotify)
 
 		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir));
 	}
+
+	// Monitor a dir tree
+	{
+		CString dir = "in_test_dir2";
+
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory(dir));
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory("in_test_dir2/a"));
+
+		auto writeFile = [](CString fname) {
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(fname, FileOpenFlag::kWrite));
+			ANKI_TEST_EXPECT_NO_ERR(file.writeText("123"));
+		};
+
+		{
+			INotify in;
+			ANKI_TEST_EXPECT_NO_ERR(in.initRecursive(dir));
+
+			DynamicArray<String> modified;
+			auto poll = [&]() {
+				modified.destroy();
+				Bool overflow;
+				ANKI_TEST_EXPECT_NO_ERR(in.pollModifiedFiles(
+					[&](CString fname) {
+						for(const String& s : modified)
+						{
+							if(s == fname)
+							{
+								return;
+							}
+						}
+						modified.emplaceBack(fname);
+					},
+					overflow));
+				ANKI_TEST_EXPECT_EQ(overflow, false);
+			};
+
+			poll();
+			ANKI_TEST_EXPECT_EQ(modified.getSize(), 0);
+
+			writeFile("in_test_dir2/file.txt");
+			writeFile("in_test_dir2/a/file.txt");
+			poll();
+			ANKI_TEST_EXPECT_EQ(modified.getSize(), 2);
+			ANKI_TEST_EXPECT_EQ(modified[0], "file.txt");
+			ANKI_TEST_EXPECT_EQ(modified[1], "a/file.txt");
+
+			// New directories get watched as well
+			ANKI_TEST_EXPECT_NO_ERR(createDirectory("in_test_dir2/b"));
+			poll();
+			writeFile("in_test_dir2/b/file.txt");
+			poll();
+			ANKI_TEST_EXPECT_EQ(modified.getSize(), 1);
+			ANKI_TEST_EXPECT_EQ(modified[0], "b/file.txt");
+
+			poll();
+			ANKI_TEST_EXPECT_EQ(modified.getSize(), 0);
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir));
+	}
+
+	DefaultMemoryPool::freeSingleton();
 }
@@ -0,0 +1,150 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Util/Thread.h>
+
+using namespace anki;
+
+namespace {
+
+class TestLogHandler
+{
+public:
+	static constexpr U32 kThreadCount = 4;
+	static constexpr U32 kMessagesPerThread = 100;
+
+	Mutex m_mtx;
+	Array<U32, kThreadCount> m_nextMessage = {};
+	U32 m_messageCount = 0;
+	U32 m_outOfOrderCount = 0;
+	U32 m_longMessageCount = 0;
+	U32 m_errorCount = 0;
+	Bool m_calledFromLoggerThread = true;
+
+	static void callback(void* ud, const LoggerMessageInfo& info)
+	{
+		TestLogHandler& self = *static_cast<TestLogHandler*>(ud);
+		LockGuard lock(self.m_mtx);
+
+		self.m_calledFromLoggerThread = self.m_calledFromLoggerThread && Thread::getCurrentThreadName() == CString("AnKiLogger");
+
+		U32 thread, message;
+		if(sscanf(info.m_msg, "Thread %u message %u", &thread, &message) == 2 && thread < kThreadCount)
+		{
+			// The messages of a thread should arrive in order
+			if(message < self.m_nextMessage[thread])
+			{
+				++self.m_outOfOrderCount;
+			}
+			self.m_nextMessage[thread] = message + 1;
+			++self.m_messageCount;
+
+			if(strlen(info.m_msg) > 256)
+			{
+				++self.m_longMessageCount;
+			}
+		}
+
+		if(info.m_type == LoggerMessageType::kError)
+		{
+			++self.m_errorCount;
+		}
+	}
+};
+
+} // namespace
+
+static void logFromManyThreads()
+{
+	Array<Thread*, TestLogHandler::kThreadCount> threads;
+	for(U32 i = 0; i < TestLogHandler::kThreadCount; ++i)
+	{
+		threads[i] = new Thread("LogTest");
+		threads[i]->start(reinterpret_cast<void*>(PtrSize(i)), [](ThreadCallbackInfo& info) -> Error {
+			const U32 thread = U32(ptrToNumber(info.m_userData));
+			for(U32 m = 0; m < TestLogHandler::kMessagesPerThread; ++m)
+			{
+				if(m % 10 == 0)
+				{
+					// Long messages don't fit in the queue
+					ANKI_LOGI("Thread %u message %u %0300u", thread, m, 0);
+				}
+				else
+				{
+					ANKI_LOGI("Thread %u message %u", thread, m);
+				}
+			}
+			return Error::kNone;
+		});
+	}
+
+	for(Thread* thread : threads)
+	{
+		ANKI_TEST_EXPECT_NO_ERR(thread->join());
+		delete thread;
+	}
+}
+
+ANKI_TEST(Util, Logger)
+{
+	Logger& logger = Logger::getSingleton();
+	constexpr U32 kMessageCount = TestLogHandler::kThreadCount * TestLogHandler::kMessagesPerThread;
+
+	// Block when full. Nothing is lost
+	{
+		TestLogHandler handler;
+		logger.addMessageHandler(&handler, TestLogHandler::callback);
+		logger.startAsync(16, LoggerOverflowPolicy::kBlock);
+
+		logFromManyThreads();
+
+		// Errors are flushed before write returns
+		ANKI_LOGE("Test error. Ignore it");
+		{
+			LockGuard lock(handler.m_mtx);
+			ANKI_TEST_EXPECT_EQ(handler.m_errorCount, 1);
+		}
+
+		logger.stopAsync();
+		logger.removeMessageHandler(&handler, TestLogHandler::callback);
+
+		ANKI_TEST_EXPECT_EQ(handler.m_messageCount, kMessageCount);
+		ANKI_TEST_EXPECT_EQ(handler.m_outOfOrderCount, 0);
+		ANKI_TEST_EXPECT_EQ(handler.m_longMessageCount, kMessageCount / 10);
+		ANKI_TEST_EXPECT_EQ(handler.m_calledFromLoggerThread, true);
+	}
+
+	// Drop when full. The dropped messages are counted
+	{
+		TestLogHandler handler;
+		logger.addMessageHandler(&handler, TestLogHandler::callback);
+		const U32 droppedBefore = logger.getDroppedMessageCount();
+		logger.startAsync(2, LoggerOverflowPolicy::kDrop);
+
+		logFromManyThreads();
+
+		logger.flush();
+		logger.removeMessageHandler(&handler, TestLogHandler::callback);
+		logger.stopAsync();
+
+		const U32 dropped = logger.getDroppedMessageCount() - droppedBefore;
+		ANKI_TEST_LOGI("Dropped %u messages out of %u", dropped, kMessageCount);
+		ANKI_TEST_EXPECT_EQ(handler.m_messageCount + dropped, kMessageCount);
+		ANKI_TEST_EXPECT_EQ(handler.m_outOfOrderCount, 0);
+	}
+
+	// Synchronous again
+	{
+		TestLogHandler handler;
+		logger.addMessageHandler(&handler, TestLogHandler::callback);
+		ANKI_LOGI("Thread 0 message 0");
+		logger.removeMessageHandler(&handler, TestLogHandler::callback);
+
+		ANKI_TEST_EXPECT_EQ(handler.m_messageCount, 1);
+		ANKI_TEST_EXPECT_EQ(handler.m_calledFromLoggerThread, false);
+	}
+}
@@ -62,10 +62,13 @@ ANKI_TEST(Util, StackMemoryPool)
 		a = pool.allocate(kSize, 1);
 		ANKI_TEST_EXPECT_NEQ(a, nullptr);
 		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 4);
+		ANKI_TEST_EXPECT_GEQ(pool.getAllocatedSize(), 4 * kSize);
+		ANKI_TEST_EXPECT_LEQ(pool.getAllocatedSize(), pool.getMemoryCapacity());
 
 		// Reset
 		pool.reset();
 		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocatedSize(), 0);
 
 		// Allocate again
 		a = pool.allocate(kSize, 1);
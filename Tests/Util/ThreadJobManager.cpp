@@ -36,6 +36,161 @@ ANKI_TEST(Util, ThreadJobManager)
 		ANKI_TEST_EXPECT_EQ(atomic.load(), kTaskCount);
 	}
 
+	// Tasks that dispatch tasks
+	{
+		constexpr U32 kTaskCount = 128;
+		constexpr U32 kSubtaskCount = 64;
+
+		ThreadJobManager manager(getCpuCoresCount(), false, 16);
+
+		Atomic<U32> atomic(0);
+		Atomic<U32> wrongThreadIdCount(0);
+
+		for(U32 i = 0; i < kTaskCount; ++i)
+		{
+			manager.dispatchTask([&atomic, &wrongThreadIdCount, &manager](U32 tid) {
+				if(tid >= manager.getThreadCount())
+				{
+					wrongThreadIdCount.fetchAdd(1);
+				}
+
+				for(U32 j = 0; j < kSubtaskCount; ++j)
+				{
+					manager.dispatchTask([&atomic]([[maybe_unused]] U32 tid) {
+						atomic.fetchAdd(1);
+					});
+				}
+			});
+		}
+
+		manager.waitForAllTasksToFinish();
+
+		ANKI_TEST_EXPECT_EQ(atomic.load(), kTaskCount * kSubtaskCount);
+		ANKI_TEST_EXPECT_EQ(wrongThreadIdCount.load(), 0);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, ThreadJobManagerTaskGraph)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		ThreadJobManager manager(max(2u, getCpuCoresCount()), false, 64);
+
+		// Diamond: a -> (b, c) -> d. b has children that are spawned from inside b
+		constexpr U32 kChildCount = 32;
+		Atomic<U32> step(0);
+		Atomic<U32> childCount(0);
+		Atomic<U32> errors(0);
+
+		ThreadJobManager::Task* a = manager.newTask([&]([[maybe_unused]] U32 tid) {
+			HighRezTimer::sleep(10.0_ms);
+			step.store(1);
+		});
+
+		ThreadJobManager::Task* b = nullptr;
+		b = manager.newTask([&]([[maybe_unused]] U32 tid) {
+			if(step.load() != 1)
+			{
+				errors.fetchAdd(1);
+			}
+
+			for(U32 i = 0; i < kChildCount; ++i)
+			{
+				ThreadJobManager::Task* child = manager.newTask(
+					[&]([[maybe_unused]] U32 tid) {
+						HighRezTimer::sleep(1.0_ms);
+						childCount.fetchAdd(1);
+					},
+					b);
+				manager.submitTask(child);
+			}
+		});
+
+		ThreadJobManager::Task* c = manager.newTask([&]([[maybe_unused]] U32 tid) {
+			if(step.load() != 1)
+			{
+				errors.fetchAdd(1);
+			}
+		});
+
+		ThreadJobManager::Task* d = manager.newTask([&]([[maybe_unused]] U32 tid) {
+			if(childCount.load() != kChildCount)
+			{
+				errors.fetchAdd(1);
+			}
+			step.store(2);
+		});
+
+		manager.addDependency(b, a);
+		manager.addDependency(c, a);
+		manager.addDependency(d, b);
+		manager.addDependency(d, c);
+
+		// Submit in reverse order to make sure the dependencies hold
+		manager.submitTask(d);
+		manager.submitTask(c);
+		manager.submitTask(b);
+		manager.submitTask(a);
+
+		manager.waitForTask(d);
+		ANKI_TEST_EXPECT_EQ(step.load(), 2);
+		ANKI_TEST_EXPECT_EQ(manager.isTaskFinished(b), true);
+
+		manager.waitForAllTasksToFinish();
+		ANKI_TEST_EXPECT_EQ(errors.load(), 0);
+		ANKI_TEST_EXPECT_EQ(childCount.load(), kChildCount);
+
+		// Long chain mixed with plain tasks
+		constexpr U32 kChainLength = 1000;
+		Atomic<U32> counter(0);
+		ThreadJobManager::Task* prev = nullptr;
+		for(U32 i = 0; i < kChainLength; ++i)
+		{
+			ThreadJobManager::Task* task = manager.newTask([&counter, &errors, i]([[maybe_unused]] U32 tid) {
+				if(counter.fetchAdd(1) != i)
+				{
+					errors.fetchAdd(1);
+				}
+			});
+
+			if(prev)
+			{
+				manager.addDependency(task, prev);
+			}
+
+			manager.submitTask(task);
+			manager.dispatchTask([]([[maybe_unused]] U32 tid) {});
+			prev = task;
+		}
+
+		manager.waitForAllTasksToFinish();
+		ANKI_TEST_EXPECT_EQ(counter.load(), kChainLength);
+		ANKI_TEST_EXPECT_EQ(errors.load(), 0);
+
+		// A child that is never submitted doesn't block its parent
+		ThreadJobManager::Task* parent = manager.newTask([&]([[maybe_unused]] U32 tid) {
+			counter.store(0);
+		});
+		[[maybe_unused]] ThreadJobManager::Task* unsubmittedChild = manager.newTask([]([[maybe_unused]] U32 tid) {}, parent);
+		manager.submitTask(parent);
+
+		// Waiting for a task that takes a while puts the thread to sleep
+		ThreadJobManager::Task* slow = manager.newTask([&]([[maybe_unused]] U32 tid) {
+			HighRezTimer::sleep(50.0_ms);
+			counter.fetchAdd(1);
+		});
+		manager.addDependency(slow, parent);
+		manager.submitTask(slow);
+
+		manager.waitForTask(slow);
+		ANKI_TEST_EXPECT_EQ(manager.isTaskFinished(parent), true);
+		ANKI_TEST_EXPECT_EQ(counter.load(), 1);
+		manager.waitForAllTasksToFinish();
+	}
+
 	DefaultMemoryPool::freeSingleton();
 }
 
@@ -70,3 +225,49 @@ ANKI_TEST(Util, ThreadJobManagerBench)
 
 	DefaultMemoryPool::freeSingleton();
 }
+
+ANKI_TEST(Util, ThreadJobManagerDispatchBench)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	constexpr U32 kTaskCount = 1024 * 1024;
+	constexpr U32 kIterationCount = 4;
+
+	for(U32 threadCount = 1; threadCount <= max(1u, getCpuCoresCount()); threadCount *= 2)
+	{
+		ThreadJobManager manager(threadCount, false, 1024);
+
+		Atomic<U32> atomic(0);
+		Second dispatchTime = 0.0;
+		Second totalTime = 0.0;
+
+		for(U32 it = 0; it < kIterationCount; ++it)
+		{
+			const Second begin = HighRezTimer::getCurrentTime();
+
+			for(U32 i = 0; i < kTaskCount; ++i)
+			{
+				manager.dispatchTask([&atomic]([[maybe_unused]] U32 tid) {
+					atomic.fetchAdd(1);
+				});
+			}
+
+			const Second dispatchEnd = HighRezTimer::getCurrentTime();
+
+			manager.waitForAllTasksToFinish();
+
+			const Second end = HighRezTimer::getCurrentTime();
+
+			dispatchTime += dispatchEnd - begin;
+			totalTime += end - begin;
+		}
+
+		ANKI_TEST_EXPECT_EQ(atomic.load(), kTaskCount * kIterationCount);
+
+		const F64 taskCount = F64(kTaskCount * kIterationCount);
+		ANKI_TEST_LOGI("Threads %u: dispatch %f ns/task, total %f ns/task, %f tasks per ms", threadCount, dispatchTime / taskCount * 1000000000.0,
+					   totalTime / taskCount * 1000000000.0, taskCount / (totalTime * 1000.0));
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
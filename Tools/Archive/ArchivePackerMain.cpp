@@ -0,0 +1,117 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Resource/ResourceArchivePacker.h>
+#include <AnKi/Util/Logger.h>
+
+using namespace anki;
+
+static const char* kUsage = R"(Pack a directory into an .ankizip archive that can be used as a data path
+Usage: %s [options] input_dir output_archive
+Options:
+-block-size <bytes>  : Compress in blocks of that many bytes so the engine can seek fast. Default 65536
+-level <0-9>         : Compression level. Default 6
+-min-saving <0-100>  : Store a file uncompressed if compression saves less than that percent. Default 5
+-v                   : Verbose log
+)";
+
+static Error parseCommandLineArgs(WeakArray<char*> argv, ResourceArchivePackerConfig& config)
+{
+	if(argv.getSize() < 3)
+	{
+		return Error::kUserData;
+	}
+
+	config.m_inputDirectory = argv[argv.getSize() - 2];
+	config.m_outputFilename = argv[argv.getSize() - 1];
+
+	for(U32 i = 1; i < argv.getSize() - 2; i++)
+	{
+		const CString arg = argv[i];
+
+		if(arg == "-block-size")
+		{
+			++i;
+			if(i >= argv.getSize() - 2)
+			{
+				return Error::kUserData;
+			}
+
+			ANKI_CHECK(CString(argv[i]).toNumber(config.m_blockSize));
+			if(config.m_blockSize == 0)
+			{
+				return Error::kUserData;
+			}
+		}
+		else if(arg == "-level")
+		{
+			++i;
+			if(i >= argv.getSize() - 2)
+			{
+				return Error::kUserData;
+			}
+
+			ANKI_CHECK(CString(argv[i]).toNumber(config.m_level));
+			if(config.m_level < 0 || config.m_level > 9)
+			{
+				return Error::kUserData;
+			}
+		}
+		else if(arg == "-min-saving")
+		{
+			++i;
+			if(i >= argv.getSize() - 2)
+			{
+				return Error::kUserData;
+			}
+
+			ANKI_CHECK(CString(argv[i]).toNumber(config.m_minSavingPercent));
+			if(config.m_minSavingPercent > 100)
+			{
+				return Error::kUserData;
+			}
+		}
+		else if(arg == "-v")
+		{
+			Logger::getSingleton().enableVerbosity(true);
+		}
+		else
+		{
+			return Error::kUserData;
+		}
+	}
+
+	return Error::kNone;
+}
+
+ANKI_MAIN_FUNCTION(myMain)
+int myMain(int argc, char** argv)
+{
+	class Cleanup
+	{
+	public:
+		~Cleanup()
+		{
+			DefaultMemoryPool::freeSingleton();
+		}
+	} cleanup;
+
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	ResourceArchivePackerConfig config;
+	if(parseCommandLineArgs(WeakArray<char*>(argv, argc), config))
+	{
+		ANKI_LOGE(kUsage, argv[0]);
+		return 1;
+	}
+
+	if(packResourceArchive(config))
+	{
+		ANKI_LOGE("Packing failed");
+		return 1;
+	}
+
+	return 0;
+}
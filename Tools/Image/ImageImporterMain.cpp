@@ -35,6 +35,8 @@ Options:
 -flip-image <0|1>      : Flip the image. Default is 0
 -hdr-scale <3 floats>  : Apply some scale to HDR images. Default is {1 1 1}
 -hdr-bias <3 floats>   : Apply some bias to HDR images. Default is {0 0 0}
+-quality <quality>     : Quality of the S3TC encoder. One of: fast, normal, high. Default is normal
+-threads <number>      : Number of threads used for compression. 0 compresses in the main thread. Default is all cores
 )";
 
 static Error parseCommandLineArgs(int argc, char** argv, ImageImporterConfig& config, Cleanup& cleanup)
@@ -196,6 +198,41 @@ static Error parseCommandLineArgs(int argc, char** argv, ImageImporterConfig& co
 		{
 			Logger::getSingleton().enableVerbosity(true);
 		}
+		else if(CString(argv[i]) == "-quality")
+		{
+			++i;
+			if(i >= argc)
+			{
+				return Error::kUserData;
+			}
+
+			if(CString(argv[i]) == "fast")
+			{
+				config.m_compressionQuality = TextureEncoderQuality::kFast;
+			}
+			else if(CString(argv[i]) == "normal")
+			{
+				config.m_compressionQuality = TextureEncoderQuality::kNormal;
+			}
+			else if(CString(argv[i]) == "high")
+			{
+				config.m_compressionQuality = TextureEncoderQuality::kHigh;
+			}
+			else
+			{
+				return Error::kUserData;
+			}
+		}
+		else if(CString(argv[i]) == "-threads")
+		{
+			++i;
+			if(i >= argc)
+			{
+				return Error::kUserData;
+			}
+
+			ANKI_CHECK(CString(argv[i]).toNumber(config.m_threadCount));
+		}
 		else if(CString(argv[i]) == "-to-linear")
 		{
 			config.m_sRgbToLinear = true;
@@ -0,0 +1,73 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Script/LuaBinder.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Logger.h>
+
+using namespace anki;
+
+static const char* kUsage = R"(Compile a LUA script to bytecode. The engine loads the output like any other script
+Usage: %s input_lua output_lua
+)";
+
+static Error compile(CString inFilename, CString outFilename)
+{
+	File inFile;
+	ANKI_CHECK(inFile.open(inFilename, FileOpenFlag::kRead));
+	String source;
+	ANKI_CHECK(inFile.readAllText(source));
+
+	if(LuaBinder::isBytecode(ConstWeakArray<U8, PtrSize>(reinterpret_cast<const U8*>(source.cstr()), source.getLength())))
+	{
+		ANKI_LOGE("Already compiled: %s", inFilename.cstr());
+		return Error::kUserData;
+	}
+
+	// Prefix with @ to have LUA print the filename in its errors
+	String chunkName;
+	chunkName.sprintf("@%s", inFilename.cstr());
+
+	ScriptDynamicArray<U8> bytecode;
+	ANKI_CHECK(LuaBinder::compileToBytecode(source, chunkName, bytecode));
+
+	File outFile;
+	ANKI_CHECK(outFile.open(outFilename, FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+	ANKI_CHECK(outFile.write(bytecode.getBegin(), bytecode.getSizeInBytes()));
+
+	ANKI_LOGI("Compiled %s: %u -> %u bytes", inFilename.cstr(), source.getLength(), bytecode.getSize());
+	return Error::kNone;
+}
+
+ANKI_MAIN_FUNCTION(myMain)
+int myMain(int argc, char** argv)
+{
+	class Cleanup
+	{
+	public:
+		~Cleanup()
+		{
+			ScriptMemoryPool::freeSingleton();
+			DefaultMemoryPool::freeSingleton();
+		}
+	} cleanup;
+
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ScriptMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	if(argc != 3)
+	{
+		ANKI_LOGE(kUsage, argv[0]);
+		return 1;
+	}
+
+	if(compile(argv[1], argv[2]))
+	{
+		ANKI_LOGE("Compilation failed");
+		return 1;
+	}
+
+	return 0;
+}
@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/ShaderCompiler/ShaderCompiler.h>
+#include <AnKi/ShaderCompiler/ShaderCompilerCache.h>
 #include <AnKi/Util.h>
 using namespace anki;
 
@@ -18,6 +19,9 @@ Options:
 -dxil                : Compile DXIL
 -g                   : Include debug info
 -sm                  : Shader mode. "6_7" or "6_8". Default "6_8"
+-cache <dir>         : Directory of a persistent cache of the compiled code. Can be shared by many compiler processes
+-cache-size <MB>     : Size limit of the cache. The least recently used code is evicted by -trim-cache. Default 1024
+-trim-cache          : Don't compile. Trim the -cache to the -cache-size. Run it once after a batch of compilations
 )";
 
 class CmdLineArgs
@@ -33,6 +37,9 @@ public:
 	Bool m_dxil = false;
 	Bool m_debugInfo = false;
 	ShaderModel m_sm = ShaderModel::k6_8;
+	String m_cacheDir;
+	U32 m_cacheSizeMb = 1024;
+	Bool m_trimCache = false;
 };
 
 static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
@@ -162,13 +169,51 @@ static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
 				return Error::kUserData;
 			}
 		}
+		else if(strcmp(argv[i], "-cache") == 0)
+		{
+			++i;
+
+			if(i < argc && std::strlen(argv[i]) > 0)
+			{
+				info.m_cacheDir = argv[i];
+			}
+			else
+			{
+				return Error::kUserData;
+			}
+		}
+		else if(strcmp(argv[i], "-cache-size") == 0)
+		{
+			++i;
+
+			if(i < argc)
+			{
+				ANKI_CHECK(CString(argv[i]).toNumber(info.m_cacheSizeMb));
+			}
+			else
+			{
+				return Error::kUserData;
+			}
+		}
+		else if(strcmp(argv[i], "-trim-cache") == 0)
+		{
+			info.m_trimCache = true;
+		}
 		else
 		{
 			return Error::kUserData;
 		}
 	}
 
-	info.m_inputFname = argv[argc - 1];
+	// Trimming doesn't need an input file
+	if(strcmp(argv[argc - 1], "-trim-cache") == 0)
+	{
+		info.m_trimCache = true;
+	}
+	else
+	{
+		info.m_inputFname = argv[argc - 1];
+	}
 
 	return Error::kNone;
 }
@@ -240,10 +285,23 @@ static Error work(const CmdLineArgs& info)
 	taskManager.m_jobManager.reset((info.m_threadCount) ? newInstance<ThreadJobManager>(DefaultMemoryPool::getSingleton(), info.m_threadCount, true)
 														: nullptr);
 
+	// Cache
+	ShaderCompilerCache cache;
+	if(!info.m_cacheDir.isEmpty())
+	{
+		ANKI_CHECK(cache.init(info.m_cacheDir, PtrSize(info.m_cacheSizeMb) * 1024 * 1024));
+	}
+
 	// Compile
 	ShaderBinary* binary = nullptr;
 	ANKI_CHECK(compileShaderProgram(info.m_inputFname, info.m_spirv, info.m_debugInfo, info.m_sm, fsystem, nullptr,
-									(info.m_threadCount) ? &taskManager : nullptr, info.m_defines, binary));
+									(info.m_threadCount) ? &taskManager : nullptr, (info.m_cacheDir.isEmpty()) ? nullptr : &cache, info.m_defines,
+									binary));
+
+	if(!info.m_cacheDir.isEmpty())
+	{
+		ANKI_LOGV("Shader cache hits %u misses %u", cache.getHitCount(), cache.getMissCount());
+	}
 
 	class Dummy
 	{
@@ -268,6 +326,14 @@ static Error work(const CmdLineArgs& info)
 	return Error::kNone;
 }
 
+static Error trimCache(const CmdLineArgs& info)
+{
+	ShaderCompilerCache cache;
+	ANKI_CHECK(cache.init(info.m_cacheDir, PtrSize(info.m_cacheSizeMb) * 1024 * 1024));
+	ANKI_CHECK(cache.trim());
+	return Error::kNone;
+}
+
 ANKI_MAIN_FUNCTION(myMain)
 int myMain(int argc, char** argv)
 {
@@ -291,6 +357,23 @@ int myMain(int argc, char** argv)
 		return 1;
 	}
 
+	if(info.m_trimCache)
+	{
+		if(info.m_cacheDir.isEmpty())
+		{
+			ANKI_LOGE(kUsage, argv[0]);
+			return 1;
+		}
+
+		if(trimCache(info))
+		{
+			ANKI_LOGE("Trimming the shader cache failed");
+			return 1;
+		}
+
+		return 0;
+	}
+
 	if(info.m_spirv == info.m_dxil)
 	{
 		ANKI_LOGE(kUsage, argv[0]);